@@ -32,9 +32,8 @@ SOFTWARE.
 #include "entry.h"
 
 #include "Edge/forwardingtableexceptions.h"
-#include <glog/logging.h>
 
-#include <algorithm>
+#include <tuple>
 
 namespace uiiit {
 namespace edge {
@@ -44,6 +43,11 @@ Entry::Entry()
     : theDestinations() {
 }
 
+DestinationId Entry::select(const std::string& aKey) {
+  std::ignore = aKey;
+  return (*this)();
+}
+
 void Entry::change(const std::string& aDest,
                    const float        aWeight,
                    const bool         aFinal) {
@@ -52,20 +56,18 @@ void Entry::change(const std::string& aDest,
     throw InvalidDestination(aDest, aWeight);
   }
 
-  auto it = std::find_if(
-      theDestinations.begin(),
-      theDestinations.end(),
-      [&aDest](const auto& aElem) { return aElem.theDestination == aDest; });
-
-  if (it != theDestinations.end()) {
-    const auto myOldWeight = it->theWeight;
-    it->theWeight          = aWeight;
-    it->theFinal           = aFinal;
+  const auto myIndex = find(aDest);
+  if (myIndex < theDestinations.size()) {
+    auto&      myElem      = theDestinations[myIndex];
+    const auto myOldWeight = myElem.theWeight;
+    myElem.theWeight       = aWeight;
+    myElem.theFinal        = aFinal;
 
-    updateWeight(aDest, myOldWeight, aWeight);
+    updateWeight(myIndex, myOldWeight, aWeight);
   } else {
-    theDestinations.emplace_back(Element{aDest, aWeight, aFinal});
-    updateAddDest(aDest, aWeight);
+    theDestinations.emplace_back(Element{
+        DestinationRegistry::instance().intern(aDest), aWeight, aFinal});
+    updateAddDest(myIndex, aWeight);
   }
 }
 
@@ -78,19 +80,16 @@ void Entry::change(const std::string& aDest, const float aWeight) {
     throw InvalidDestination(aDest, aWeight);
   }
 
-  auto it = std::find_if(
-      theDestinations.begin(),
-      theDestinations.end(),
-      [&aDest](const auto& aElem) { return aElem.theDestination == aDest; });
-
-  if (it == theDestinations.end()) {
+  const auto myIndex = find(aDest);
+  if (myIndex == theDestinations.size()) {
     throw NoDestinations(aDest);
   }
 
-  const auto myOldWeight = it->theWeight;
-  it->theWeight          = aWeight;
+  auto&      myElem      = theDestinations[myIndex];
+  const auto myOldWeight = myElem.theWeight;
+  myElem.theWeight       = aWeight;
 
-  updateWeight(aDest, myOldWeight, aWeight);
+  updateWeight(myIndex, myOldWeight, aWeight);
 }
 
 float Entry::weight(const std::string& aDest) const {
@@ -98,45 +97,48 @@ float Entry::weight(const std::string& aDest) const {
     throw NoDestinations();
   }
 
-  auto it = std::find_if(
-      theDestinations.begin(),
-      theDestinations.end(),
-      [&aDest](const auto& aElem) { return aElem.theDestination == aDest; });
-
-  if (it == theDestinations.end()) {
+  const auto myIndex = find(aDest);
+  if (myIndex == theDestinations.size()) {
     throw NoDestinations(aDest);
   }
-  return it->theWeight;
+  return theDestinations[myIndex].theWeight;
 }
 
 bool Entry::remove(const std::string& aDest) {
-  for (auto it = theDestinations.begin(); it != theDestinations.end(); ++it) {
-    if (it->theDestination == aDest) {
-      const auto myDestination = it->theDestination;
-      const auto myWeight      = it->theWeight;
-      theDestinations.erase(it);
-      updateDelDest(myDestination, myWeight);
-      return true;
-    }
+  const auto myIndex = find(aDest);
+  if (myIndex == theDestinations.size()) {
+    return false;
   }
-  return false;
+  const auto myWeight = theDestinations[myIndex].theWeight;
+  theDestinations.erase(theDestinations.begin() + myIndex);
+  updateDelDest(myIndex, myWeight);
+  return true;
 }
 
 std::map<std::string, std::pair<float, bool>> Entry::destinations() const {
+  const auto& myRegistry = DestinationRegistry::instance();
+
   std::map<std::string, std::pair<float, bool>> myDestinations;
   for (const auto& myElem : theDestinations) {
-    myDestinations.emplace(myElem.theDestination,
+    myDestinations.emplace(myRegistry.name(myElem.theId),
                            std::make_pair(myElem.theWeight, myElem.theFinal));
   }
   return myDestinations;
 }
 
-void Entry::printPFstats() {
-  LOG(INFO) << "thePFStats = " << '\n';
-  for (auto it = thePFstats.begin(); it != thePFstats.end(); ++it) {
-    LOG(INFO) << "[" << (*it).first << "] [" << (*it).second.first << "] ["
-              << (*it).second.second << "]\n";
+size_t Entry::find(const std::string& aDest) const {
+  // a destination never interned cannot be in this entry
+  DestinationId myId;
+  if (not DestinationRegistry::instance().find(aDest, myId)) {
+    return theDestinations.size();
+  }
+  size_t i = 0;
+  for (; i < theDestinations.size(); i++) {
+    if (theDestinations[i].theId == myId) {
+      break;
+    }
   }
+  return i;
 }
 
 } // namespace entries
@@ -31,9 +31,12 @@ SOFTWARE.
 
 #pragma once
 
-#include <list>
+#include "Edge/destinationregistry.h"
+
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
@@ -41,15 +44,24 @@ namespace entries {
 
 /**
  * Generic entry of an edge router forwarding table.
+ *
+ * Once an entry is shared by a ForwardingTable among its readers it is
+ * never modified again: changes are applied to a clone, which replaces the
+ * original one. Therefore the selection of a destination must be safe to
+ * call from multiple threads at the same time.
+ *
+ * The destinations are interned in the DestinationRegistry and kept in a
+ * contiguous array, in order of insertion, so that the selection only deals
+ * with integer identifiers.
  */
 class Entry
 {
  protected:
   struct Element final {
-    std::string theDestination;
-    float       theWeight;
-    bool        theFinal;
-    bool        operator<(const Element& aOther) const noexcept {
+    DestinationId theId;
+    float         theWeight;
+    bool          theFinal;
+    bool          operator<(const Element& aOther) const noexcept {
       return theWeight < aOther.theWeight;
     }
   };
@@ -61,6 +73,9 @@ class Entry
   virtual ~Entry() {
   }
 
+  //! \return a copy of this entry, which can be modified independently.
+  virtual std::unique_ptr<Entry> clone() const = 0;
+
   //! \return True if there are no destinations.
   bool empty() const noexcept {
     return theDestinations.empty();
@@ -69,9 +84,20 @@ class Entry
   /**
    * Return a random destination according to the weights.
    *
+   * \return the identifier of the destination in the DestinationRegistry.
+   *
+   * \throw NoDestinations if the current entry is empty.
+   */
+  virtual DestinationId operator()() = 0;
+
+  /**
+   * Return a destination for a request with a given key. Requests with the
+   * same key are expected to be correlated, e.g., because they share the
+   * same application state. By default the key is ignored.
+   *
    * \throw NoDestinations if the current entry is empty.
    */
-  virtual std::string operator()() = 0;
+  virtual DestinationId select(const std::string& aKey);
 
   /**
    * Add a new destination or change the weight of a destination.
@@ -121,29 +147,23 @@ class Entry
   //! \return All the destinations, weights, and final flags.
   std::map<std::string, std::pair<float, bool>> destinations() const;
 
-  //! print content of thePFstats (used for testing)
-  void printPFstats();
-
  private:
-  virtual void updateWeight(const std::string& aDest,
-                            const float        aOldWeight,
-                            const float        aNewWeight)                         = 0;
-  virtual void updateAddDest(const std::string& aDest, const float aWeight) = 0;
-  virtual void updateDelDest(const std::string& aDest, const float aWeight) = 0;
-
- protected:
-  std::list<Element> theDestinations;
-
   /**
-   * data structure used only if the scheduling policy is PF:
-   * - the string is the destination (field theDestination in datastructure
-   *   Element);
-   * - pair.first is theLambdaServedCount related to the destination,
-   *   datastructure
-   * - pair.second is theTimestamp in which the destination joined the system
-   *   or has served the last Lambda Request
+   * \return the position of a destination in theDestinations, or its size
+   * if not found.
    */
-  std::map<std::string, std::pair<int, double>> thePFstats;
+  size_t find(const std::string& aDest) const;
+
+  // the hooks below receive the position of the destination changed, which
+  // for a removed destination is the one it had before being erased
+  virtual void updateWeight(const size_t aIndex,
+                            const float  aOldWeight,
+                            const float  aNewWeight)                  = 0;
+  virtual void updateAddDest(const size_t aIndex, const float aWeight) = 0;
+  virtual void updateDelDest(const size_t aIndex, const float aWeight) = 0;
+
+ protected:
+  std::vector<Element> theDestinations;
 };
 
 } // namespace entries
@@ -0,0 +1,173 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "entryconsistenthash.h"
+
+#include "Edge/destinationload.h"
+#include "Edge/forwardingtableexceptions.h"
+#include "Support/random.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+namespace uiiit {
+namespace edge {
+namespace entries {
+
+EntryConsistentHash::EntryConsistentHash(
+    const std::shared_ptr<const DestinationLoad>& aLoad)
+    : Entry()
+    , theLoad(aLoad)
+    , theRing() {
+  if (not aLoad) {
+    throw std::runtime_error("Invalid null load in a consistent-hash entry");
+  }
+}
+
+std::unique_ptr<Entry> EntryConsistentHash::clone() const {
+  return std::make_unique<EntryConsistentHash>(*this);
+}
+
+DestinationId EntryConsistentHash::operator()() {
+  return select(std::string());
+}
+
+DestinationId EntryConsistentHash::select(const std::string& aKey) {
+  if (theDestinations.empty()) {
+    throw NoDestinations();
+  }
+
+  // if there is a single destination then we can skip the logic for selection
+  if (theDestinations.size() == 1) {
+    return theDestinations.front().theId;
+  }
+
+  if (aKey.empty()) {
+    return walk(static_cast<uint64_t>(
+        support::random() * std::pow(2.0, 64))); // [0, 2^64)
+  }
+  return walk(hash(aKey));
+}
+
+DestinationId EntryConsistentHash::walk(const uint64_t aPoint) const {
+  assert(not theRing.empty());
+
+  // the maximum load admitted, accounting also for the new request
+  size_t myTotal = 0;
+  for (const auto& myElem : theDestinations) {
+    myTotal += (*theLoad)(myElem.theId);
+  }
+  const auto myMaxLoad = static_cast<size_t>(std::ceil(
+      balance() * (myTotal + 1) / static_cast<double>(theDestinations.size())));
+
+  // there is always a destination with load below the average, thus the
+  // walk ends within one round of the ring
+  auto it = std::lower_bound(theRing.begin(), theRing.end(), Point{aPoint, 0});
+  auto mySelected = theDestinations.size();
+  auto myMinLoad  = std::numeric_limits<size_t>::max();
+  for (size_t i = 0; i < theRing.size(); i++, ++it) {
+    if (it == theRing.end()) {
+      it = theRing.begin();
+    }
+    const auto myLoad = (*theLoad)(theDestinations[it->second].theId);
+    if (myLoad + 1 <= myMaxLoad) {
+      return theDestinations[it->second].theId;
+    }
+    if (myLoad < myMinLoad) {
+      mySelected = it->second;
+      myMinLoad  = myLoad;
+    }
+  }
+
+  // the loads may have changed in the meanwhile
+  assert(mySelected < theDestinations.size());
+  return theDestinations[mySelected].theId;
+}
+
+uint64_t EntryConsistentHash::hash(const std::string& aValue) noexcept {
+  // FNV-1a, followed by a finalizer to spread similar strings on the ring
+  uint64_t ret = 14695981039346656037ull;
+  for (const auto myChar : aValue) {
+    ret ^= static_cast<unsigned char>(myChar);
+    ret *= 1099511628211ull;
+  }
+  ret ^= ret >> 33;
+  ret *= 0xff51afd7ed558ccdull;
+  ret ^= ret >> 33;
+  ret *= 0xc4ceb9fe1a85ec53ull;
+  ret ^= ret >> 33;
+  return ret;
+}
+
+void EntryConsistentHash::updateWeight(const size_t aIndex,
+                                       const float  aOldWeight,
+                                       const float  aNewWeight) {
+  std::ignore = aIndex;
+  std::ignore = aOldWeight;
+  std::ignore = aNewWeight;
+}
+
+void EntryConsistentHash::updateAddDest(const size_t aIndex,
+                                        const float  aWeight) {
+  std::ignore = aIndex;
+  std::ignore = aWeight;
+  rebuild();
+}
+
+void EntryConsistentHash::updateDelDest(const size_t aIndex,
+                                        const float  aWeight) {
+  std::ignore = aIndex;
+  std::ignore = aWeight;
+  rebuild();
+}
+
+void EntryConsistentHash::rebuild() {
+  const auto& myRegistry = DestinationRegistry::instance();
+
+  theRing.clear();
+  theRing.reserve(theDestinations.size() * replicas());
+  for (size_t i = 0; i < theDestinations.size(); i++) {
+    const auto& myName = myRegistry.name(theDestinations[i].theId);
+    for (size_t j = 0; j < replicas(); j++) {
+      theRing.emplace_back(hash(myName + '#' + std::to_string(j)), i);
+    }
+  }
+  std::sort(theRing.begin(), theRing.end());
+}
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
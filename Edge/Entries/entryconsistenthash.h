@@ -0,0 +1,117 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Edge/Entries/entry.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+class DestinationLoad;
+
+namespace entries {
+
+/**
+ * Consistent hashing with bounded loads.
+ *
+ * Every destination is mapped to a number of points on a ring of hash
+ * values. A request is mapped to the ring via the hash of its key and it is
+ * assigned to the first destination found walking clockwise whose number of
+ * requests in flight, including the new one, does not exceed the average
+ * across all the destinations of the entry by a balance factor. Therefore
+ * requests with the same key are served by the same destination as long as
+ * it is not overloaded, and only a few keys move to other destinations when
+ * destinations are added or removed.
+ *
+ * The weights are not used: a request without a key is mapped to a random
+ * point of the ring.
+ *
+ * The requests in flight are counted by the owner of the forwarding table,
+ * which shares the counters with all the entries.
+ */
+class EntryConsistentHash final : public Entry
+{
+  // first:  point on the ring
+  // second: position of the destination in theDestinations
+  using Point = std::pair<uint64_t, size_t>;
+
+ public:
+  /**
+   * \param aLoad the number of requests in flight per destination.
+   *
+   * \throw std::runtime_error if aLoad is null.
+   */
+  explicit EntryConsistentHash(
+      const std::shared_ptr<const DestinationLoad>& aLoad);
+
+  std::unique_ptr<Entry> clone() const override;
+
+  DestinationId select(const std::string& aKey) override;
+
+  //! \return the hash of a string, which is the same on all platforms.
+  static uint64_t hash(const std::string& aValue) noexcept;
+
+ private:
+  DestinationId operator()() override;
+
+  void updateWeight(const size_t aIndex,
+                    const float  aOldWeight,
+                    const float  aNewWeight) override;
+  void updateAddDest(const size_t aIndex, const float aWeight) override;
+  void updateDelDest(const size_t aIndex, const float aWeight) override;
+
+  //! Rebuild the ring from the current destinations.
+  void rebuild();
+
+  //! \return the destination of a request mapped to the given point.
+  DestinationId walk(const uint64_t aPoint) const;
+
+ private:
+  const std::shared_ptr<const DestinationLoad> theLoad;
+  std::vector<Point>                           theRing; // sorted
+
+  // static configuration
+  // clang-format off
+  static constexpr size_t replicas() { return 64;   } // points per destination
+  static constexpr double balance()  { return 1.25; } // max load over average
+  // clang-format on
+};
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
@@ -35,6 +35,7 @@ SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <tuple>
 
 namespace uiiit {
 namespace edge {
@@ -42,45 +43,56 @@ namespace entries {
 
 EntryLeastImpedance::EntryLeastImpedance()
     : Entry()
-    , theMinElement(theDestinations.end()) {
+    , theMinElement(0) {
 }
 
-std::string EntryLeastImpedance::operator()() {
+std::unique_ptr<Entry> EntryLeastImpedance::clone() const {
+  return std::make_unique<EntryLeastImpedance>(*this);
+}
+
+DestinationId EntryLeastImpedance::operator()() {
   if (theDestinations.empty()) {
     throw NoDestinations();
   }
-  return theMinElement->theDestination;
+  assert(theMinElement < theDestinations.size());
+  return theDestinations[theMinElement].theId;
 }
 
-void EntryLeastImpedance::updateWeight(const std::string& aDest,
-                                       const float        aOldWeight,
-                                       const float        aNewWeight) {
-  assert(theMinElement != theDestinations.end());
-  if (aNewWeight <= theMinElement->theWeight or
-      aOldWeight == theMinElement->theWeight) {
+void EntryLeastImpedance::updateWeight(const size_t aIndex,
+                                       const float  aOldWeight,
+                                       const float  aNewWeight) {
+  assert(theMinElement < theDestinations.size());
+  if (aNewWeight <= theDestinations[theMinElement].theWeight or
+      aIndex == theMinElement) {
     update();
   }
+  std::ignore = aOldWeight;
 }
 
-void EntryLeastImpedance::updateAddDest(const std::string& aDest,
-                                        const float        aWeight) {
-  if (theMinElement == theDestinations.end()) {
-    theMinElement = theDestinations.begin();
-  } else if (aWeight < theMinElement->theWeight) {
-    update();
+void EntryLeastImpedance::updateAddDest(const size_t aIndex,
+                                        const float  aWeight) {
+  if (theDestinations.size() == 1) {
+    theMinElement = aIndex;
+  } else if (aWeight < theDestinations[theMinElement].theWeight) {
+    theMinElement = aIndex;
   }
 }
 
-void EntryLeastImpedance::updateDelDest(const std::string& aDest,
-                                        const float        aWeight) {
-  if (theMinElement->theWeight == aWeight) {
+void EntryLeastImpedance::updateDelDest(const size_t aIndex,
+                                        const float  aWeight) {
+  std::ignore = aWeight;
+  if (aIndex == theMinElement) {
     update();
+  } else if (aIndex < theMinElement) {
+    // the elements after the one removed have been shifted back
+    theMinElement--;
   }
 }
 
 void EntryLeastImpedance::update() {
   theMinElement =
-      std::min_element(theDestinations.begin(), theDestinations.end());
+      std::min_element(theDestinations.begin(), theDestinations.end()) -
+      theDestinations.begin();
 }
 
 } // namespace entries
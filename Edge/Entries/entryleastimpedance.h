@@ -33,8 +33,7 @@ SOFTWARE.
 
 #include "entry.h"
 
-#include <list>
-#include <string>
+#include <cstddef>
 
 namespace uiiit {
 namespace edge {
@@ -48,18 +47,20 @@ class EntryLeastImpedance final : public Entry
  public:
   explicit EntryLeastImpedance();
 
+  std::unique_ptr<Entry> clone() const override;
+
  private:
-  std::string operator()() override;
+  DestinationId operator()() override;
 
-  void updateWeight(const std::string& aDest,
-                    const float        aOldWeight,
-                    const float        aNewWeight) override;
-  void updateAddDest(const std::string& aDest, const float aWeight) override;
-  void updateDelDest(const std::string& aDest, const float aWeight) override;
+  void updateWeight(const size_t aIndex,
+                    const float  aOldWeight,
+                    const float  aNewWeight) override;
+  void updateAddDest(const size_t aIndex, const float aWeight) override;
+  void updateDelDest(const size_t aIndex, const float aWeight) override;
   void update();
 
  private:
-  std::list<Element>::iterator theMinElement;
+  size_t theMinElement; // position of the smallest weight
 };
 
 } // namespace entries
@@ -0,0 +1,101 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "entrypowerofchoices.h"
+
+#include "Edge/destinationload.h"
+#include "Edge/forwardingtableexceptions.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace uiiit {
+namespace edge {
+namespace entries {
+
+EntryPowerOfChoices::EntryPowerOfChoices(
+    const size_t                                  aChoices,
+    const std::shared_ptr<const DestinationLoad>& aLoad)
+    : EntryWeighted()
+    , theChoices(aChoices)
+    , theLoad(aLoad) {
+  if (aChoices == 0) {
+    throw std::runtime_error(
+        "Invalid number of choices in a power-of-choices entry: 0");
+  }
+  if (not aLoad) {
+    throw std::runtime_error("Invalid null load in a power-of-choices entry");
+  }
+}
+
+std::unique_ptr<Entry> EntryPowerOfChoices::clone() const {
+  return std::make_unique<EntryPowerOfChoices>(*this);
+}
+
+DestinationId EntryPowerOfChoices::operator()() {
+  if (theDestinations.empty()) {
+    throw NoDestinations();
+  }
+
+  // with few destinations we can simply inspect all of them
+  const auto myAll = theDestinations.size() <= theChoices;
+  const auto myNum = myAll ? theDestinations.size() : theChoices;
+
+  // the positions of the candidates drawn so far, sorted, so that the same
+  // destination is not drawn twice
+  thread_local std::vector<size_t> myDrawn;
+  myDrawn.clear();
+
+  size_t myBest     = 0;
+  size_t myBestLoad = 0;
+  for (size_t i = 0; i < myNum; i++) {
+    auto myCur = i;
+    if (not myAll) {
+      myCur = draw(myDrawn);
+      myDrawn.insert(std::upper_bound(myDrawn.begin(), myDrawn.end(), myCur),
+                     myCur);
+    }
+    const auto& myElem = theDestinations[myCur];
+    const auto  myLoad = (*theLoad)(myElem.theId);
+    if (i == 0 or myLoad < myBestLoad or
+        (myLoad == myBestLoad and myElem < theDestinations[myBest])) {
+      myBest     = myCur;
+      myBestLoad = myLoad;
+    }
+  }
+
+  return theDestinations[myBest].theId;
+}
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,87 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Edge/Entries/entryweighted.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+class DestinationLoad;
+
+namespace entries {
+
+/**
+ * If the are multiple options available, draw a number of distinct
+ * candidates at random according to the weights, as with EntryRandom, then
+ * return the one with the fewest requests in flight. Ties are broken in favor
+ * of the candidate with smallest weight.
+ *
+ * Since only a few candidates are considered, the cost of a selection does
+ * not depend on the number of destinations, while the load is still spread
+ * almost as evenly as if all the destinations were inspected.
+ *
+ * The requests in flight are counted by the owner of the forwarding table,
+ * which shares the counters with all the entries.
+ */
+class EntryPowerOfChoices final : public EntryWeighted
+{
+ public:
+  /**
+   * \param aChoices the number of candidates drawn at every selection.
+   *
+   * \param aLoad the number of requests in flight per destination.
+   *
+   * \throw std::runtime_error if aChoices is zero or aLoad is null.
+   */
+  explicit EntryPowerOfChoices(
+      const size_t                                  aChoices,
+      const std::shared_ptr<const DestinationLoad>& aLoad);
+
+  std::unique_ptr<Entry> clone() const override;
+
+ private:
+  DestinationId operator()() override;
+
+ private:
+  const size_t                                 theChoices;
+  const std::shared_ptr<const DestinationLoad> theLoad;
+};
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
@@ -33,8 +33,11 @@ SOFTWARE.
 
 #include "Edge/forwardingtableexceptions.h"
 
-#include <algorithm>
+#include <glog/logging.h>
+
 #include <cassert>
+#include <cmath>
+#include <limits>
 
 namespace uiiit {
 namespace edge {
@@ -45,90 +48,116 @@ EntryProportionalFairness::EntryProportionalFairness(double aAlpha,
     : Entry()
     , theChrono(true)
     , theAlpha(aAlpha)
-    , theBeta(aBeta) {
+    , theBeta(aBeta)
+    , theServed()
+    , theTimestamps()
+    , theScores() {
+}
+
+std::unique_ptr<Entry> EntryProportionalFairness::clone() const {
+  return std::make_unique<EntryProportionalFairness>(*this);
 }
 
 /**
  * The Entry functional operator must compute all the prioritarization
  * coefficients and return the maximum one.
  */
-std::string EntryProportionalFairness::operator()() {
+DestinationId EntryProportionalFairness::operator()() {
   if (theDestinations.empty()) {
     throw NoDestinations();
   }
+  assert(theScores.size() == theDestinations.size());
+  assert(theTimestamps.size() == theDestinations.size());
+
+  const auto    mySize  = theScores.size();
+  const double* myScore = theScores.data();
+  size_t        ret     = 0;
+
+  // with beta = 0 the time since the last service does not matter, which
+  // also avoids multiplying 0 by -inf if a destination has just been served
+  if (theBeta == 0) {
+    for (size_t i = 1; i < mySize; i++) {
+      if (myScore[i] > myScore[ret]) {
+        ret = i;
+      }
+    }
+    return theDestinations[ret].theId;
+  }
 
-  std::string ret;
-  float       myMaxWeight = 0;
-  const auto  myNow = theChrono.time();
-
-  for (auto it = theDestinations.begin(); it != theDestinations.end(); ++it) {
-    auto destinationStatsIt = thePFstats.find((*it).theDestination);
-    assert(destinationStatsIt != thePFstats.end());
-
-    const auto myCurWeight = computeWeight((*it).theWeight,
-                                           (*destinationStatsIt).second.first,
-                                           (*destinationStatsIt).second.second,
-                                           myNow);
-    if (ret.empty() or myCurWeight > myMaxWeight) {
-      myMaxWeight = myCurWeight;
-      ret         = (*it).theDestination;
+  const auto    myNow       = theChrono.time();
+  const double* myTimestamp = theTimestamps.data();
+  auto          myMaxScore  = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < mySize; i++) {
+    const auto myCurScore =
+        myScore[i] + theBeta * std::log(myNow - myTimestamp[i]);
+    if (i == 0 or myCurScore > myMaxScore) {
+      myMaxScore = myCurScore;
+      ret        = i;
     }
   }
 
-  return ret;
+  return theDestinations[ret].theId;
 }
 
 /**
- * experiencedLatency is the latency experienced and stored in theWeight field
- * by the LocalOptimizer during the processSuccess or 1  if the entry is "fresh"
- * (just inserted by the controller)
+ * The weight of a destination is the latency experienced and stored in
+ * theWeight field by the LocalOptimizer during the processSuccess or 1 if
+ * the entry is "fresh" (just inserted by the controller).
  */
-float EntryProportionalFairness::computeWeight(float  experiencedLatency,
-                                               int    theLambdaServedCount,
-                                               double theDestinationTimestamp,
-                                               double curTimestamp) {
-  return pow((1 / experiencedLatency), theAlpha) /
-         pow((theLambdaServedCount / (curTimestamp - theDestinationTimestamp)),
-             theBeta);
+void EntryProportionalFairness::updateScore(const size_t aIndex) {
+  assert(aIndex < theScores.size());
+  theScores[aIndex] = -theAlpha * std::log(theDestinations[aIndex].theWeight) -
+                      theBeta * std::log(theServed[aIndex]);
 }
 
 /**
- * this function only updates thePFstats (theLambdaServedCount and the
- * Timestamp) of the destination which has served the LambdaRequest
+ * this function updates the statistics (theServed and theTimestamps) of the
+ * destination which has served the LambdaRequest
  */
 void EntryProportionalFairness::updateWeight(
-    const std::string&           aDest,
+    const size_t                 aIndex,
     [[maybe_unused]] const float aOldWeight,
     [[maybe_unused]] const float aNewWeight) {
-  const auto myNow = theChrono.time();
-  auto       it    = thePFstats.find(aDest);
-  assert(it != thePFstats.end());
-  it->second = {it->second.first + 1, myNow};
-  printPFstats();
+  assert(aIndex < theServed.size());
+  theServed[aIndex]++;
+  theTimestamps[aIndex] = theChrono.time();
+  updateScore(aIndex);
 }
 
 /**
- * this function only updates thePFstats data structure inserting a new
- * destination as key and a pair in which theLambdaServedCount is set to 1
- * otherwise a "division by 0" exception is thrown during the computation of its
- * weight in the functional operator (invoked by the EdgeRouter.destination).
+ * this function appends the statistics of the new destination, in which
+ * theServed is set to 1 otherwise a "division by 0" exception is thrown during
+ * the computation of its weight in the functional operator (invoked by the
+ * EdgeRouter.destination).
  */
 void EntryProportionalFairness::updateAddDest(
-    const std::string& aDest, [[maybe_unused]] const float aWeight) {
-  thePFstats.insert({aDest, std::make_pair(1, theChrono.time())});
-  printPFstats();
+    const size_t aIndex, [[maybe_unused]] const float aWeight) {
+  assert(aIndex == theServed.size());
+  theServed.emplace_back(1);
+  theTimestamps.emplace_back(theChrono.time());
+  theScores.emplace_back(0);
+  updateScore(aIndex);
 }
 
 /**
- * this function only updates thePFstats data structure deleting the detination
- * removed in theDestination data structure.
+ * this function deletes the statistics of the destination removed in
+ * theDestinations data structure.
  */
 void EntryProportionalFairness::updateDelDest(
-    const std::string& aDest, [[maybe_unused]] const float aWeight) {
-  auto it = thePFstats.find(aDest);
-  assert(it != thePFstats.end());
-  thePFstats.erase(it);
-  printPFstats();
+    const size_t aIndex, [[maybe_unused]] const float aWeight) {
+  assert(aIndex < theServed.size());
+  theServed.erase(theServed.begin() + aIndex);
+  theTimestamps.erase(theTimestamps.begin() + aIndex);
+  theScores.erase(theScores.begin() + aIndex);
+}
+
+void EntryProportionalFairness::printPFstats() {
+  const auto& myRegistry = DestinationRegistry::instance();
+  LOG(INFO) << "thePFStats = " << '\n';
+  for (size_t i = 0; i < theServed.size(); i++) {
+    LOG(INFO) << "[" << myRegistry.name(theDestinations[i].theId) << "] ["
+              << theServed[i] << "] [" << theTimestamps[i] << "]\n";
+  }
 }
 
 } // namespace entries
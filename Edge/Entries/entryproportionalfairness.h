@@ -34,9 +34,7 @@ SOFTWARE.
 #include "Edge/Entries/entry.h"
 #include "Support/chrono.h"
 
-#include <cmath>
-#include <list>
-#include <string>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
@@ -61,30 +59,44 @@ namespace entries {
  *    - alpha = 0, beta = 1 => Round Robin
  *    - alpha = 1, beta = 0 => max unfairness, max throughput
  *    - alpha ~= 1, beta ~= 1 => 3G scheduling algorithm
+ *
+ * The coefficients are compared in the logarithmic domain, i.e.,
+ * log PC = -alpha log(latency) - beta log(count) + beta log(now - timestamp),
+ * where only the last term changes between two updates of the destination.
+ * The other terms are kept in a contiguous array, together with the
+ * timestamps, so that a selection is a single tight loop.
  */
 class EntryProportionalFairness final : public Entry
 {
  public:
   explicit EntryProportionalFairness(double aAlpha, double aBeta);
 
+  std::unique_ptr<Entry> clone() const override;
+
+  //! print content of the PF statistics (used for testing)
+  void printPFstats();
+
  private:
-  std::string operator()() override;
+  DestinationId operator()() override;
 
-  void updateWeight(const std::string& aDest,
-                    const float        aOldWeight,
-                    const float        aNewWeight) override;
-  void updateAddDest(const std::string& aDest, const float aWeight) override;
-  void updateDelDest(const std::string& aDest, const float aWeight) override;
+  void updateWeight(const size_t aIndex,
+                    const float  aOldWeight,
+                    const float  aNewWeight) override;
+  void updateAddDest(const size_t aIndex, const float aWeight) override;
+  void updateDelDest(const size_t aIndex, const float aWeight) override;
 
-  float computeWeight(float  experiencedLatency,
-                      int    theLambdaServedCount,
-                      double theDestinationTimestamp,
-                      double curTimestamp);
+  //! Update the time-invariant part of the score of a destination.
+  void updateScore(const size_t aIndex);
 
  private:
   support::Chrono theChrono;
   const double    theAlpha;
   const double    theBeta;
+
+  // per-destination statistics, in the same order as theDestinations
+  std::vector<int>    theServed;     // lambda requests served
+  std::vector<double> theTimestamps; // joined or served the last request
+  std::vector<double> theScores;     // -alpha log(latency) - beta log(served)
 };
 
 } // namespace entries
@@ -32,61 +32,30 @@ SOFTWARE.
 #include "entryrandom.h"
 
 #include "Edge/forwardingtableexceptions.h"
-#include "Support/random.h"
-
-#include <cassert>
 
 namespace uiiit {
 namespace edge {
 namespace entries {
 
 EntryRandom::EntryRandom()
-    : Entry()
-    , theInvSum(0) {
+    : EntryWeighted() {
+}
+
+std::unique_ptr<Entry> EntryRandom::clone() const {
+  return std::make_unique<EntryRandom>(*this);
 }
 
-std::string EntryRandom::operator()() {
+DestinationId EntryRandom::operator()() {
   if (theDestinations.empty()) {
     throw NoDestinations();
   }
 
   // if there is a single destination then we can skip the logic for selection
   if (theDestinations.size() == 1) {
-    return theDestinations.front().theDestination;
-  }
-
-  const auto myRand = support::random() * theInvSum; // [0, theSum)
-
-  float mySum{0.0f};
-  for (auto it = theDestinations.begin();
-       it != std::prev(theDestinations.end());
-       ++it) {
-    assert(it->theWeight != 0.0f);
-    mySum += 1.0f / it->theWeight;
-    if (myRand <= mySum) {
-      return it->theDestination;
-    }
+    return theDestinations.front().theId;
   }
 
-  return theDestinations.back().theDestination;
-}
-
-void EntryRandom::updateWeight(const std::string& aDest,
-                               const float        aOldWeight,
-                               const float        aNewWeight) {
-  assert(aNewWeight != 0);
-  assert(aOldWeight != 0);
-  theInvSum += (1.0f / aNewWeight) - (1.0f / aOldWeight);
-}
-
-void EntryRandom::updateAddDest(const std::string& aDest, const float aWeight) {
-  assert(aWeight != 0);
-  theInvSum += 1.0f / aWeight;
-}
-
-void EntryRandom::updateDelDest(const std::string& aDest, const float aWeight) {
-  assert(aWeight != 0);
-  theInvSum -= 1.0f / aWeight;
+  return theDestinations[draw()].theId;
 }
 
 } // namespace entries
@@ -31,9 +31,7 @@ SOFTWARE.
 
 #pragma once
 
-#include "entry.h"
-
-#include <string>
+#include "Edge/Entries/entryweighted.h"
 
 namespace uiiit {
 namespace edge {
@@ -42,25 +40,19 @@ namespace entries {
 /**
  * If the are multiple options available, one at random is
  * returned according to the associated weights.
+ *
+ * The probability of a destination is proportional to the inverse of its
+ * weight, see EntryWeighted.
  */
-class EntryRandom final : public Entry
+class EntryRandom final : public EntryWeighted
 {
  public:
   explicit EntryRandom();
 
- private:
-  std::string operator()() override;
-
-  void updateWeight(const std::string& aDest,
-                    const float        aOldWeight,
-                    const float        aNewWeight) override;
-  void updateAddDest(const std::string& aDest, const float aWeight) override;
-  void updateDelDest(const std::string& aDest, const float aWeight) override;
-
-  static float random();
+  std::unique_ptr<Entry> clone() const override;
 
  private:
-  float theInvSum;
+  DestinationId operator()() override;
 };
 
 } // namespace entries
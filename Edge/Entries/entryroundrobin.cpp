@@ -45,13 +45,39 @@ namespace edge {
 namespace entries {
 
 EntryRoundRobin::EntryRoundRobin()
-    : theCache()
+    : theMutex()
+    , theCache()
     , theQueue()
     , theChrono(true)
     , theStat() {
 }
 
-std::string EntryRoundRobin::operator()() {
+EntryRoundRobin::EntryRoundRobin(const EntryRoundRobin& aOther)
+    : Entry(aOther)
+    , theMutex()
+    , theCache()
+    , theQueue()
+    , theChrono(aOther.theChrono)
+    , theStat(aOther.theStat) {
+  const std::lock_guard<std::mutex> myLock(aOther.theMutex);
+  theCache = aOther.theCache;
+
+  // rebuild the active set with the elements of the new cache
+  auto myDup = aOther.theQueue;
+  while (not myDup.empty()) {
+    const auto it = theCache.find(myDup.top().theElem->first);
+    assert(it != theCache.end());
+    theQueue.push(QueueElement{it});
+    myDup.pop();
+  }
+}
+
+std::unique_ptr<Entry> EntryRoundRobin::clone() const {
+  return std::make_unique<EntryRoundRobin>(*this);
+}
+
+DestinationId EntryRoundRobin::operator()() {
+  const std::lock_guard<std::mutex> myLock(theMutex);
   if (theQueue.empty()) {
     assert(theDestinations.empty());
     throw NoDestinations();
@@ -75,29 +101,29 @@ bool EntryRoundRobin::good(const double aWeight) {
   return false;
 }
 
-void EntryRoundRobin::updateWeight(const std::string& aDest,
-                                   const float        aOldWeight,
-                                   const float        aNewWeight) {
+void EntryRoundRobin::updateWeight(const size_t aIndex,
+                                   const float  aOldWeight,
+                                   const float  aNewWeight) {
   std::ignore = aOldWeight;
-  updateWeight(aDest, aNewWeight);
+  updateWeight(theDestinations[aIndex].theId, aNewWeight);
 }
 
-void EntryRoundRobin::updateAddDest(const std::string& aDest,
-                                    const float        aWeight) {
-  std::ignore = aDest;
+void EntryRoundRobin::updateAddDest(const size_t aIndex,
+                                    const float  aWeight) {
+  std::ignore = aIndex;
   std::ignore = aWeight;
   updateList();
 }
 
-void EntryRoundRobin::updateDelDest(const std::string& aDest,
-                                    const float        aWeight) {
-  std::ignore = aDest;
+void EntryRoundRobin::updateDelDest(const size_t aIndex,
+                                    const float  aWeight) {
+  std::ignore = aIndex;
   std::ignore = aWeight;
   updateList();
 }
 
-void EntryRoundRobin::updateWeight(const std::string& aDest,
-                                   const float        aWeight) {
+void EntryRoundRobin::updateWeight(const DestinationId aDest,
+                                   const float         aWeight) {
   auto it = theCache.find(aDest);
   assert(it != theCache.end());
   it->second.theWeight      = aWeight;
@@ -143,7 +169,7 @@ void EntryRoundRobin::updateList() {
   const auto myMinDeficit = minDeficit();
   for (const auto& myDestination : theDestinations) {
     const auto ret =
-        theCache.insert({myDestination.theDestination,
+        theCache.insert({myDestination.theId,
                          CacheElement(myDestination.theWeight, myMinDeficit)});
     if (not ret.second) {
       // update weight and mark as non-vanishing
@@ -234,12 +260,14 @@ void EntryRoundRobin::updateActiveSet() {
 
 void EntryRoundRobin::debugPrintActiveSet() {
   if (VLOG_IS_ON(2)) {
+    const auto&       myRegistry = DestinationRegistry::instance();
     std::stringstream myStream;
     const auto        myNow = theChrono.time();
     for (auto it = theCache.begin(); it != theCache.end(); ++it) {
       myStream << '\n'
-               << it->first << " weight " << it->second.theWeight
-               << " last-updated " << it->second.theLastUpdated << " deficit "
+               << myRegistry.name(it->first) << " weight "
+               << it->second.theWeight << " last-updated "
+               << it->second.theLastUpdated << " deficit "
                << it->second.theDeficit << " stale-period "
                << it->second.theStalePeriod << " ("
                << (it->second.theLastUpdated >= 0 ?
@@ -251,12 +279,13 @@ void EntryRoundRobin::debugPrintActiveSet() {
     }
     LOG(INFO) << "destinations " << theCache.size() << ", active set ("
               << theQueue.size() << "), current "
-              << theQueue.top().theElem->first << myStream.str();
+              << myRegistry.name(theQueue.top().theElem->first)
+              << myStream.str();
     auto myDup = theQueue;
     while (not myDup.empty()) {
       const auto myElem = myDup.top();
       myDup.pop();
-      LOG(INFO) << myElem.theElem->first << ' '
+      LOG(INFO) << myRegistry.name(myElem.theElem->first) << ' '
                 << myElem.theElem->second.theDeficit;
     }
   }
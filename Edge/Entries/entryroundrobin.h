@@ -38,8 +38,8 @@ SOFTWARE.
 
 #include <list>
 #include <map>
+#include <mutex>
 #include <queue>
-#include <string>
 
 namespace uiiit {
 namespace edge {
@@ -58,6 +58,9 @@ namespace entries {
  * The stale period id doubled every time a destination is moved away from the
  * active set and it is reset to the initial value if its weight eventually
  * matches the active set admission condition.
+ *
+ * Since the selection of a destination updates the deficit counters, it
+ * is serialized by a mutex of the entry.
  */
 class EntryRoundRobin final : public Entry
 {
@@ -91,7 +94,7 @@ class EntryRoundRobin final : public Entry
     double theStalePeriod; // in seconds
     bool   theProbing;
   };
-  using Cache = std::map<std::string, CacheElement>;
+  using Cache = std::map<DestinationId, CacheElement>;
 
   struct QueueElement final {
     Cache::iterator theElem;
@@ -104,16 +107,21 @@ class EntryRoundRobin final : public Entry
  public:
   explicit EntryRoundRobin();
 
+  //! Copy the state, with the active set pointing to the new cache.
+  EntryRoundRobin(const EntryRoundRobin& aOther);
+
+  std::unique_ptr<Entry> clone() const override;
+
  private:
-  std::string operator()() override;
+  DestinationId operator()() override;
 
-  void updateWeight(const std::string& aDest,
-                    const float        aOldWeight,
-                    const float        aNewWeight) override;
-  void updateAddDest(const std::string& aDest, const float aWeight) override;
-  void updateDelDest(const std::string& aDest, const float aWeight) override;
+  void updateWeight(const size_t aIndex,
+                    const float  aOldWeight,
+                    const float  aNewWeight) override;
+  void updateAddDest(const size_t aIndex, const float aWeight) override;
+  void updateDelDest(const size_t aIndex, const float aWeight) override;
 
-  void  updateWeight(const std::string& aDest, const float aWeight);
+  void  updateWeight(const DestinationId aDest, const float aWeight);
   void  updateList();
   void  updateStat();
   void  updateActiveSet();
@@ -127,6 +135,7 @@ class EntryRoundRobin final : public Entry
  private:
   // the active set consists of all the elements with similar weight
   // and all the elements that have not been used for too long
+  mutable std::mutex                theMutex;
   Cache                             theCache;
   std::priority_queue<QueueElement> theQueue;
   support::Chrono                   theChrono;
@@ -0,0 +1,96 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "entryweighted.h"
+
+#include "Support/random.h"
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+
+namespace uiiit {
+namespace edge {
+namespace entries {
+
+EntryWeighted::EntryWeighted()
+    : Entry()
+    , theTree() {
+}
+
+size_t EntryWeighted::draw() const {
+  assert(theTree.size() == theDestinations.size());
+  return theTree.find(support::random() * theTree.sum());
+}
+
+size_t EntryWeighted::draw(const std::vector<size_t>& aExcluded) const {
+  assert(theTree.size() == theDestinations.size());
+  double myExcluded = 0;
+  for (const auto myIndex : aExcluded) {
+    myExcluded += theTree.value(myIndex);
+  }
+  const auto mySum = std::max(0.0, theTree.sum() - myExcluded);
+  return theTree.find(support::random() * mySum, aExcluded);
+}
+
+void EntryWeighted::updateWeight(const size_t aIndex,
+                                 const float  aOldWeight,
+                                 const float  aNewWeight) {
+  assert(aNewWeight != 0);
+  std::ignore = aOldWeight;
+  theTree.update(aIndex, 1.0 / aNewWeight);
+}
+
+void EntryWeighted::updateAddDest(const size_t aIndex, const float aWeight) {
+  assert(aWeight != 0);
+  std::ignore = aIndex;
+  rebuild();
+}
+
+void EntryWeighted::updateDelDest(const size_t aIndex, const float aWeight) {
+  assert(aWeight != 0);
+  std::ignore = aIndex;
+  rebuild();
+}
+
+void EntryWeighted::rebuild() {
+  std::vector<double> myValues;
+  myValues.reserve(theDestinations.size());
+  for (const auto& myElem : theDestinations) {
+    assert(myElem.theWeight != 0.0f);
+    myValues.emplace_back(1.0 / myElem.theWeight);
+  }
+  theTree.assign(std::move(myValues));
+}
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,83 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Edge/Entries/entry.h"
+#include "Edge/Entries/fenwicktree.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+namespace entries {
+
+/**
+ * Entry drawing its destinations at random with a probability proportional
+ * to the inverse of their weights.
+ *
+ * The inverse weights are kept in a Fenwick tree, aligned with the array of
+ * destinations of the entry, which allows to draw a destination and to
+ * change a weight in O(log n).
+ */
+class EntryWeighted : public Entry
+{
+ protected:
+  explicit EntryWeighted();
+
+  //! \return the position of a destination drawn at random.
+  size_t draw() const;
+
+  /**
+   * \return the position of a destination drawn at random among those not
+   * in aExcluded, which must be sorted in increasing order and distinct, and
+   * must not include all the destinations.
+   */
+  size_t draw(const std::vector<size_t>& aExcluded) const;
+
+ private:
+  void updateWeight(const size_t aIndex,
+                    const float  aOldWeight,
+                    const float  aNewWeight) final;
+  void updateAddDest(const size_t aIndex, const float aWeight) final;
+  void updateDelDest(const size_t aIndex, const float aWeight) final;
+
+  //! Rebuild the tree from the current destinations.
+  void rebuild();
+
+ private:
+  FenwickTree theTree;
+};
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
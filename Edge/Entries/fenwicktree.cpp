@@ -0,0 +1,153 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "fenwicktree.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace uiiit {
+namespace edge {
+namespace entries {
+
+FenwickTree::FenwickTree()
+    : theValues()
+    , theTree(1, 0.0)
+    , theSum(0)
+    , theNumUpdates(0) {
+}
+
+void FenwickTree::assign(std::vector<double>&& aValues) {
+  theValues = std::move(aValues);
+  rebuild();
+}
+
+void FenwickTree::update(const size_t aIndex, const double aValue) {
+  assert(aIndex < theValues.size());
+  assert(aValue >= 0);
+
+  const auto myDelta = aValue - theValues[aIndex];
+  theValues[aIndex]  = aValue;
+
+  if (++theNumUpdates >= std::max(theValues.size(), maxUpdates())) {
+    rebuild();
+    return;
+  }
+
+  add(aIndex, myDelta);
+  theSum += myDelta;
+}
+
+void FenwickTree::rebuild() {
+  theTree.assign(theValues.size() + 1, 0.0);
+  theSum        = 0;
+  theNumUpdates = 0;
+
+  // build the tree in O(n) by pushing every partial sum to its parent
+  for (size_t i = 0; i < theValues.size(); i++) {
+    theTree[i + 1] += theValues[i];
+    theSum += theValues[i];
+    const auto myParent = (i + 1) + ((i + 1) & (~(i + 1) + 1));
+    if (myParent < theTree.size()) {
+      theTree[myParent] += theTree[i + 1];
+    }
+  }
+}
+
+void FenwickTree::add(size_t aIndex, const double aValue) {
+  for (aIndex++; aIndex < theTree.size(); aIndex += aIndex & (~aIndex + 1)) {
+    theTree[aIndex] += aValue;
+  }
+}
+
+double FenwickTree::prefix(size_t aIndex) const {
+  assert(aIndex < theTree.size());
+  double ret = 0;
+  for (; aIndex > 0; aIndex -= aIndex & (~aIndex + 1)) {
+    ret += theTree[aIndex];
+  }
+  return ret;
+}
+
+size_t FenwickTree::find(double aRand) const {
+  const auto mySize = theValues.size();
+  assert(mySize > 0);
+
+  // descend the tree from the largest power of two not greater than the size
+  size_t myStep = 1;
+  while ((myStep << 1) <= mySize) {
+    myStep <<= 1;
+  }
+  size_t myPos = 0;
+  for (; myStep > 0; myStep >>= 1) {
+    if (myPos + myStep <= mySize and theTree[myPos + myStep] <= aRand) {
+      myPos += myStep;
+      aRand -= theTree[myPos];
+    }
+  }
+
+  // with rounding errors we may end up beyond the last element
+  return std::min(myPos, mySize - 1);
+}
+
+size_t FenwickTree::find(double                     aRand,
+                         const std::vector<size_t>& aExcluded) const {
+  assert(std::is_sorted(aExcluded.begin(), aExcluded.end()));
+  assert(aExcluded.size() < theValues.size());
+
+  // skip the cumulative range of every excluded element that comes before
+  // the one drawn, which is found in the tree of all the elements
+  for (const auto myIndex : aExcluded) {
+    if (aRand < prefix(myIndex)) {
+      break;
+    }
+    aRand += theValues[myIndex];
+  }
+  auto ret = find(aRand);
+
+  // with rounding errors we may end up on an excluded element, in which case
+  // the first next element that is not excluded is returned
+  auto it = std::lower_bound(aExcluded.begin(), aExcluded.end(), ret);
+  while (it != aExcluded.end() and *it == ret) {
+    ret = (ret + 1) % theValues.size();
+    if (ret == 0) {
+      it = aExcluded.begin();
+    } else {
+      ++it;
+    }
+  }
+  return ret;
+}
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
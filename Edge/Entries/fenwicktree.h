@@ -0,0 +1,116 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+namespace entries {
+
+/**
+ * Binary indexed tree of non-negative values, which allows to draw an
+ * element with probability proportional to its value and to change a value
+ * in O(log n).
+ *
+ * The incremental changes accumulate rounding errors, thus the tree is
+ * rebuilt from scratch periodically, which costs O(1) per change on average.
+ */
+class FenwickTree final
+{
+ public:
+  //! Create an empty tree.
+  explicit FenwickTree();
+
+  //! Replace all the values, in O(n).
+  void assign(std::vector<double>&& aValues);
+
+  //! Change the value of the i-th element, 0-based.
+  void update(const size_t aIndex, const double aValue);
+
+  /**
+   * \return the index of the element whose cumulative range includes aRand,
+   * which must be in [0, sum()).
+   */
+  size_t find(const double aRand) const;
+
+  /**
+   * \return the index of the element whose cumulative range includes aRand
+   * as if the elements in aExcluded had a null value, thus aRand must be in
+   * [0, sum() - the sum of their values). The excluded indices must be
+   * sorted in increasing order and distinct, and there must be at least one
+   * element not excluded. The cost is O(k log n) with k excluded elements.
+   */
+  size_t find(double aRand, const std::vector<size_t>& aExcluded) const;
+
+  //! \return the value of the i-th element, 0-based.
+  double value(const size_t aIndex) const noexcept {
+    return theValues[aIndex];
+  }
+
+  //! \return the sum of all the values.
+  double sum() const noexcept {
+    return theSum;
+  }
+
+  //! \return the number of elements.
+  size_t size() const noexcept {
+    return theValues.size();
+  }
+
+ private:
+  //! Rebuild the tree from the current values.
+  void rebuild();
+
+  //! \return the sum of the values of the elements before the i-th one.
+  double prefix(size_t aIndex) const;
+
+  //! Add a value to the i-th element of the tree, 0-based.
+  void add(size_t aIndex, const double aValue);
+
+ private:
+  std::vector<double> theValues;
+  std::vector<double> theTree; // 1-based
+  double              theSum;
+  size_t              theNumUpdates;
+
+  // static configuration
+  static constexpr size_t maxUpdates() {
+    return 64; // minimum number of changes between two rebuilds
+  }
+};
+
+} // namespace entries
+} // namespace edge
+} // namespace uiiit
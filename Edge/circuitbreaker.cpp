@@ -0,0 +1,245 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "circuitbreaker.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <stdexcept>
+
+namespace uiiit {
+namespace edge {
+
+CircuitBreaker::CircuitBreaker(const size_t aMaxFailures,
+                               const double aMaxErrorRate,
+                               const double aEjection)
+    : theMaxFailures(aMaxFailures)
+    , theMaxErrorRate(aMaxErrorRate)
+    , theEjection(aEjection)
+    , theMutex()
+    , theDescriptors() {
+  if (aMaxErrorRate < 0 or aMaxErrorRate > 1) {
+    throw std::runtime_error("Invalid circuit breaker error rate: " +
+                             std::to_string(aMaxErrorRate));
+  }
+  if (aEjection <= 0) {
+    throw std::runtime_error("Invalid circuit breaker ejection time: " +
+                             std::to_string(aEjection));
+  }
+}
+
+bool CircuitBreaker::allow(const std::string& aDestination) {
+  if (not enabled()) {
+    return true;
+  }
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto it = theDescriptors.find(aDestination);
+  if (it == theDescriptors.end()) {
+    return true;
+  }
+
+  auto& myDesc = it->second;
+  switch (myDesc.theState) {
+    case State::Closed:
+      return true;
+
+    case State::Open:
+      if (Clock::now() < myDesc.theEjectedUntil) {
+        return false;
+      }
+      VLOG(1) << "destination " << aDestination << " half-open";
+      myDesc.theState   = State::HalfOpen;
+      myDesc.theProbing = true;
+      return true;
+
+    case State::HalfOpen:
+      // only one probe at a time
+      if (myDesc.theProbing) {
+        return false;
+      }
+      myDesc.theProbing = true;
+      return true;
+  }
+
+  assert(false);
+  return true;
+}
+
+void CircuitBreaker::success(const std::string& aDestination) {
+  if (not enabled()) {
+    return;
+  }
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        myNow  = Clock::now();
+  auto&                             myDesc = descriptor(aDestination, myNow);
+  if (myDesc.theState == State::Closed) {
+    roll(myDesc, myNow);
+    myDesc.theRequests++;
+    myDesc.theFailures = 0;
+
+  } else if (myDesc.theState == State::HalfOpen) {
+    LOG(INFO) << "destination " << aDestination << " restored";
+    myDesc.theState       = State::Closed;
+    myDesc.theFailures    = 0;
+    myDesc.theRequests    = 0;
+    myDesc.theErrors      = 0;
+    myDesc.theWindowStart = myNow;
+    myDesc.theProbing     = false;
+  }
+  // a late response received while open is ignored
+}
+
+bool CircuitBreaker::failure(const std::string& aDestination) {
+  if (not enabled()) {
+    return false;
+  }
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        myNow  = Clock::now();
+  auto&                             myDesc = descriptor(aDestination, myNow);
+  if (myDesc.theState == State::Closed) {
+    roll(myDesc, myNow);
+    myDesc.theRequests++;
+    myDesc.theErrors++;
+    myDesc.theFailures++;
+    if (myDesc.theFailures < theMaxFailures and
+        (theMaxErrorRate == 0 or myDesc.theRequests < minRequests() or
+         myDesc.theErrors < theMaxErrorRate * myDesc.theRequests)) {
+      return false;
+    }
+
+  } else if (myDesc.theState == State::Open) {
+    // a late response received while open is ignored
+    return false;
+  }
+
+  eject(myDesc, myNow);
+  LOG(WARNING) << "destination " << aDestination << " ejected for "
+               << std::chrono::duration<double>(myDesc.theEjectedUntil - myNow)
+                      .count()
+               << " s";
+  return true;
+}
+
+void CircuitBreaker::release(const std::string& aDestination) {
+  if (not enabled()) {
+    return;
+  }
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it = theDescriptors.find(aDestination);
+  if (it != theDescriptors.end() and it->second.theState == State::HalfOpen) {
+    it->second.theProbing = false;
+  }
+}
+
+CircuitBreaker::State
+CircuitBreaker::state(const std::string& aDestination) const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it = theDescriptors.find(aDestination);
+  return it == theDescriptors.end() ? State::Closed : it->second.theState;
+}
+
+double CircuitBreaker::ejection(const std::string& aDestination) const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it = theDescriptors.find(aDestination);
+  if (it == theDescriptors.end() or it->second.theState != State::Open) {
+    return 0;
+  }
+  return std::max(
+      0.0,
+      std::chrono::duration<double>(it->second.theEjectedUntil - Clock::now())
+          .count());
+}
+
+bool CircuitBreaker::exhausted(const std::string& aDestination) const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it = theDescriptors.find(aDestination);
+  // the last ejection lasts the maximum time if preceded by maxDoublings()
+  // others without the destination being restored for a full window
+  return it != theDescriptors.end() and it->second.theState == State::Open and
+         it->second.theEjections > maxDoublings();
+}
+
+CircuitBreaker::Descriptor&
+CircuitBreaker::descriptor(const std::string&       aDestination,
+                           const Clock::time_point& aNow) {
+  auto it = theDescriptors.find(aDestination);
+  if (it == theDescriptors.end()) {
+    it = theDescriptors.emplace(aDestination, Descriptor(aNow)).first;
+  }
+  return it->second;
+}
+
+void CircuitBreaker::roll(Descriptor&              aDesc,
+                          const Clock::time_point& aNow) const {
+  if (std::chrono::duration<double>(aNow - aDesc.theWindowStart).count() <
+      window()) {
+    return;
+  }
+  aDesc.theRequests    = 0;
+  aDesc.theErrors      = 0;
+  aDesc.theWindowStart = aNow;
+  aDesc.theEjections   = 0; // a full window has elapsed since restored
+}
+
+void CircuitBreaker::eject(Descriptor&              aDesc,
+                           const Clock::time_point& aNow) const {
+  const auto myDuration =
+      theEjection *
+      static_cast<double>(1u << std::min(aDesc.theEjections, maxDoublings()));
+  aDesc.theState        = State::Open;
+  aDesc.theFailures     = 0;
+  aDesc.theRequests     = 0;
+  aDesc.theErrors       = 0;
+  aDesc.theEjections++;
+  aDesc.theEjectedUntil = aNow + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(myDuration));
+  aDesc.theProbing      = false;
+}
+
+const std::string& toString(const CircuitBreaker::State aState) {
+  static const std::map<CircuitBreaker::State, std::string> myValues({
+      {CircuitBreaker::State::Closed, "closed"},
+      {CircuitBreaker::State::Open, "open"},
+      {CircuitBreaker::State::HalfOpen, "half-open"},
+  });
+  assert(myValues.find(aState) != myValues.end());
+  return myValues.find(aState)->second;
+}
+
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,200 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Support/macros.h"
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace uiiit {
+namespace edge {
+
+//! Return code of the lambda requests towards an ejected destination.
+inline const std::string EJECTED_RETCODE("ejected");
+
+//! Thrown when a lambda request cannot be sent to an ejected destination.
+struct Ejected : public std::runtime_error {
+  explicit Ejected()
+      : std::runtime_error(EJECTED_RETCODE) {
+  }
+};
+
+/**
+ * Thread-safe circuit breaker of the destinations of the lambda requests.
+ *
+ * A destination is ejected, i.e., no requests are allowed towards it, if
+ * either the number of consecutive failures reaches a threshold or the
+ * fraction of failed requests in the current window reaches a threshold,
+ * provided that enough requests have been sent in the window.
+ *
+ * Once the ejection time has elapsed the destination is half-open: one
+ * request is allowed as a probe and, if successful, the destination is
+ * restored, otherwise it is ejected again for twice as long as the last
+ * time, up to a maximum. The ejection time is reset after the destination
+ * has been restored for a full window.
+ */
+class CircuitBreaker final
+{
+ public:
+  enum class State : int {
+    Closed   = 0,
+    Open     = 1,
+    HalfOpen = 2,
+  };
+
+  NONCOPYABLE_NONMOVABLE(CircuitBreaker);
+
+  /**
+   * \param aMaxFailures The number of consecutive failures after which a
+   * destination is ejected. 0 means that the breaker is disabled, i.e., all
+   * the requests are allowed.
+   *
+   * \param aMaxErrorRate The fraction of failed requests in a window after
+   * which a destination is ejected. 0 means that only the consecutive
+   * failures are considered.
+   *
+   * \param aEjection The duration of the first ejection, in s.
+   *
+   * \throw std::runtime_error if the error rate is not in [0, 1] or the
+   * ejection time is not positive.
+   */
+  explicit CircuitBreaker(const size_t aMaxFailures,
+                          const double aMaxErrorRate,
+                          const double aEjection);
+
+  //! \return true if the breaker is enabled.
+  bool enabled() const noexcept {
+    return theMaxFailures > 0;
+  }
+
+  /**
+   * \return true if a request can be sent to the destination, which must be
+   * followed by exactly one call to success(), failure() or release().
+   */
+  bool allow(const std::string& aDestination);
+
+  //! A request allowed towards the destination has succeeded.
+  void success(const std::string& aDestination);
+
+  /**
+   * A request allowed towards the destination has failed.
+   *
+   * \return true if the destination has been ejected as a consequence.
+   */
+  bool failure(const std::string& aDestination);
+
+  /**
+   * A request allowed towards the destination has completed with no
+   * indication about the health of the destination, e.g., because its
+   * deadline expired.
+   */
+  void release(const std::string& aDestination);
+
+  //! \return the current state of a destination.
+  State state(const std::string& aDestination) const;
+
+  /**
+   * \return the time until an ejected destination becomes half-open, in s,
+   * or zero if the destination is not ejected.
+   */
+  double ejection(const std::string& aDestination) const;
+
+  /**
+   * \return true if the destination is ejected for the maximum time, i.e.,
+   * the probes sent to it kept failing until the ejection time has been
+   * doubled maxDoublings() times.
+   */
+  bool exhausted(const std::string& aDestination) const;
+
+  // static configuration
+  // clang-format off
+  static constexpr size_t defaultMaxFailures() { return 5; }
+  static constexpr double defaultMaxErrorRate() { return 0.5; }
+  static constexpr double defaultEjection() { return 1; } // seconds
+  static constexpr size_t minRequests() { return 20; }
+  static constexpr double window() { return 10; } // seconds
+  static constexpr size_t maxDoublings() { return 6; }
+  // clang-format on
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Descriptor {
+    explicit Descriptor(const Clock::time_point& aNow)
+        : theState(State::Closed)
+        , theFailures(0)
+        , theRequests(0)
+        , theErrors(0)
+        , theWindowStart(aNow)
+        , theEjections(0)
+        , theEjectedUntil()
+        , theProbing(false) {
+    }
+
+    State             theState;
+    size_t            theFailures; // consecutive
+    size_t            theRequests; // in the current window
+    size_t            theErrors;   // in the current window
+    Clock::time_point theWindowStart;
+    size_t            theEjections; // since last restored for a full window
+    Clock::time_point theEjectedUntil;
+    bool              theProbing; // only in half-open state
+  };
+
+  //! \return the descriptor of a destination, created if needed.
+  Descriptor& descriptor(const std::string&       aDestination,
+                         const Clock::time_point& aNow);
+
+  //! Start a new window if the current one is over.
+  void roll(Descriptor& aDesc, const Clock::time_point& aNow) const;
+
+  //! Eject the destination.
+  void eject(Descriptor& aDesc, const Clock::time_point& aNow) const;
+
+ private:
+  const size_t       theMaxFailures;
+  const double       theMaxErrorRate;
+  const double       theEjection;
+  mutable std::mutex theMutex;
+
+  std::unordered_map<std::string, Descriptor> theDescriptors;
+};
+
+const std::string& toString(const CircuitBreaker::State aState);
+
+} // namespace edge
+} // namespace uiiit
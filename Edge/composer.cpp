@@ -53,6 +53,11 @@ void Composer::operator()(const support::Conf& aConf,
                           Computer&            aComputer) const {
   static const auto GB     = uint64_t(1) << uint64_t(30);
   const auto        myType = aConf("type");
+
+  // bound on the pending tasks of every container, 0 means unlimited
+  const size_t myMaxPending =
+      aConf.count("max-pending") > 0 ? aConf.getUint("max-pending") : 0;
+
   if (myType == "raspberry") {
     // add processors
     aComputer.addProcessor("arm", ProcessorType::GenericCpu, 1e11, 4, GB / 2);
@@ -69,7 +74,8 @@ void Composer::operator()(const support::Conf& aConf,
           "arm",
           Lambda("clambda" + myId,
                  ProportionalRequirements(1e6, 4 * 1e6, 100, 0)),
-          myNumCpuWorkers);
+          myNumCpuWorkers,
+          myMaxPending);
     }
 
     auto myNumGpuContainers = aConf.getUint("num-gpu-containers");
@@ -80,7 +86,8 @@ void Composer::operator()(const support::Conf& aConf,
           "gcontainer" + myId,
           "bm2837",
           Lambda("glambda" + myId, ProportionalRequirements(1e6, 1e6, 100, 0)),
-          myNumGpuWorkers);
+          myNumGpuWorkers,
+          myMaxPending);
     }
 
   } else if (myType == "intel-server") {
@@ -98,7 +105,8 @@ void Composer::operator()(const support::Conf& aConf,
           "xeon",
           Lambda("clambda" + myId,
                  ProportionalRequirements(1e6, 4 * 1e6, 100, 0)),
-          myNumCpuWorkers);
+          myNumCpuWorkers,
+          myMaxPending);
     }
 
   } else if (myType == "file") {
@@ -187,7 +195,10 @@ void Composer::operator()(const support::Conf& aConf,
       aComputer.addContainer(myContainer["name"],
                              myContainer["processor"],
                              *myLambdaPtr,
-                             myContainer["num-workers"]);
+                             myContainer["num-workers"],
+                             myContainer.count("max-pending") > 0 ?
+                                 myContainer["max-pending"].get<size_t>() :
+                                 myMaxPending);
     }
 
   } else {
@@ -45,6 +45,14 @@ namespace edge {
 class Computer;
 
 struct Composer {
+  /**
+   * Add processors and containers to a computer based on a configuration.
+   *
+   * The optional parameter max-pending=N limits the number of pending tasks
+   * of every container, beyond which new tasks are rejected as overloaded.
+   * With type=file the same limit can be overridden per container with
+   * the key "max-pending" in the JSON file.
+   */
   void operator()(const support::Conf& aConf, Computer& aComputer) const;
 
   static std::string jsonExample() noexcept;
@@ -35,6 +35,7 @@ SOFTWARE.
 #include "edgecontrollermessages.h"
 #include "edgemessages.h"
 #include "lambda.h"
+#include "overload.h"
 #include "processor.h"
 
 #include <glog/logging.h>
@@ -51,6 +52,7 @@ Computer::Computer(const std::string&  aName,
     : theName(aName)
     , theCallback(aCallback)
     , theUtilCallback(aUtilCallback)
+    , theLoadCallback()
     , theMutex()
     , theCondition()
     , theUtilCondition()
@@ -58,6 +60,8 @@ Computer::Computer(const std::string&  aName,
     , theTerminating(false)
     , theNewTask(false)
     , theNextId(0)
+    , theNumExpired(0)
+    , theNumOverloaded(0)
     , theChrono(false)
     , theDispatcher()
     , theUtilCollector()
@@ -76,7 +80,7 @@ Computer::~Computer() {
     assert(theDispatcher.joinable());
     theDispatcher.join();
 
-    if (theUtilCallback) {
+    if (theUtilCallback or theLoadCallback) {
       theUtilCondition.notify_one();
       assert(theUtilCollector.joinable());
       theUtilCollector.join();
@@ -84,6 +88,12 @@ Computer::~Computer() {
   }
 }
 
+void Computer::loadCallback(const LoadCallback& aLoadCallback) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  throwIfInitDone();
+  theLoadCallback = aLoadCallback;
+}
+
 void Computer::addProcessor(const std::string&  aName,
                             const ProcessorType aType,
                             const float         aSpeed,
@@ -103,7 +113,8 @@ void Computer::addProcessor(const std::string&  aName,
 void Computer::addContainer(const std::string& aName,
                             const std::string& aProcName,
                             const Lambda&      aLambda,
-                            const size_t       aNumWorkers) {
+                            const size_t       aNumWorkers,
+                            const size_t       aMaxPending) {
   const std::lock_guard<std::mutex> myLock(theMutex);
   throwIfInitDone();
   if (theContainerNames.find(aName) != theContainerNames.end()) {
@@ -119,8 +130,8 @@ void Computer::addContainer(const std::string& aName,
 
   // everything is fine: add this container
   theContainerNames.insert(aName);
-  theContainers[aLambda.name()] =
-      std::make_unique<Container>(aName, *myIt->second, aLambda, aNumWorkers);
+  theContainers[aLambda.name()] = std::make_unique<Container>(
+      aName, *myIt->second, aLambda, aNumWorkers, aMaxPending);
 }
 
 uint64_t Computer::addTask(const LambdaRequest& aRequest) {
@@ -131,6 +142,11 @@ uint64_t Computer::addTask(const LambdaRequest& aRequest) {
     throw NoContainerFound(theName, aRequest.theName);
   }
 
+  if (deadlineExpired(aRequest.theDeadline)) {
+    theNumExpired++;
+    throw DeadlineExpired(theName, aRequest.theName);
+  }
+
   if (not theInitDone) {
     // no more configuration allowed
     theInitDone = true;
@@ -141,7 +157,7 @@ uint64_t Computer::addTask(const LambdaRequest& aRequest) {
 
     // start the utilization collector, if needed
     assert(not theUtilCollector.joinable());
-    if (theUtilCallback) {
+    if (theUtilCallback or theLoadCallback) {
       theUtilCollector = std::thread([this]() { utilCollector(); });
     }
 
@@ -155,8 +171,18 @@ uint64_t Computer::addTask(const LambdaRequest& aRequest) {
   pause();
 
   // add the new task to the container
+  // the computer must be resumed even if the task is not admitted
   assert(myIt->second);
-  myIt->second->push(aRequest, myId);
+  try {
+    myIt->second->push(aRequest, myId);
+  } catch (const Overloaded&) {
+    theNumOverloaded++;
+    resume();
+    throw;
+  } catch (...) {
+    resume();
+    throw;
+  }
   theNewTask = true;
   theCondition.notify_one();
 
@@ -183,6 +209,16 @@ double Computer::simTask(const LambdaRequest&   aRequest,
   return myIt->second->simulate(aRequest);
 }
 
+size_t Computer::numExpired() const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  return theNumExpired;
+}
+
+size_t Computer::numOverloaded() const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  return theNumOverloaded;
+}
+
 std::shared_ptr<ContainerList> Computer::containerList() const {
   std::shared_ptr<ContainerList> myRet(new ContainerList());
   for (const auto& myContainer : theContainers) {
@@ -271,8 +307,9 @@ void Computer::dispatcher() {
 }
 
 void Computer::utilCollector() {
-  assert(theUtilCallback);
-  std::map<std::string, double> myUtil;
+  assert(theUtilCallback or theLoadCallback);
+  std::map<std::string, double>        myUtil;
+  std::map<std::string, ContainerLoad> myLoads;
   while (true) {
     std::unique_lock<std::mutex> myLock(theMutex);
     theUtilCondition.wait_for(
@@ -280,10 +317,24 @@ void Computer::utilCollector() {
     if (theTerminating) {
       break;
     }
-    for (const auto& myProcessor : theProcessors) {
-      myUtil[myProcessor.first] = myProcessor.second->utilization();
+    if (theUtilCallback) {
+      for (const auto& myProcessor : theProcessors) {
+        myUtil[myProcessor.first] = myProcessor.second->utilization();
+      }
+      theUtilCallback(myUtil);
+    }
+    if (theLoadCallback) {
+      // advance the clocks so that the residual times are up to date
+      pause();
+      for (const auto& myPair : theContainers) {
+        assert(myPair.second);
+        const auto& myContainer = *myPair.second;
+        myLoads[myPair.first] = ContainerLoad{
+            myContainer.active(), myContainer.pending(), myContainer.wait()};
+      }
+      resume();
+      theLoadCallback(myLoads);
     }
-    theUtilCallback(myUtil);
   }
 }
 
@@ -317,6 +368,14 @@ void Computer::dispatchCompletedTasks() {
       auto myCompletedTask = myContainer.pop();
       theCallback(myCompletedTask.theId, myCompletedTask.theResp);
     }
+    if (myContainer.expired() > 0) {
+      const auto myResp = std::make_shared<const LambdaResponse>(
+          DeadlineExpired(theName, myContainer.lambda().name()).what(), "");
+      for (const auto& myTask : myContainer.takeExpired()) {
+        theNumExpired++;
+        theCallback(myTask.theId, myResp);
+      }
+    }
   }
 }
 
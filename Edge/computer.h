@@ -96,6 +96,14 @@ struct DupLambdaName : public std::runtime_error {
   }
 };
 
+struct DeadlineExpired : public std::runtime_error {
+  explicit DeadlineExpired(const std::string& aComputer,
+                           const std::string& aLambda)
+      : std::runtime_error("Deadline expired for lambda " + aLambda +
+                           " on computer " + aComputer) {
+  }
+};
+
 struct NoContainerFound : public std::runtime_error {
   explicit NoContainerFound(const std::string& aComputer,
                             const std::string& aLambda)
@@ -120,6 +128,21 @@ class Computer final
   using UtilCallback =
       std::function<void(const std::map<std::string, double>&)>;
 
+  //! Load of the container of a lambda function.
+  struct ContainerLoad {
+    size_t theActive;  //!< number of tasks in execution
+    size_t thePending; //!< number of tasks waiting for a worker
+    double theWait;    //!< time a new task would wait, in s
+  };
+
+  /**
+   * Function called periodically with the loads of all the containers.
+   * key:   lambda name
+   * value: container load
+   */
+  using LoadCallback =
+      std::function<void(const std::map<std::string, ContainerLoad>&)>;
+
   /**
    * Build an empty computer.
    * Processors and containers must be added using addProcessor() and
@@ -167,6 +190,8 @@ class Computer final
    * \param aLambda The function that this container executes.
    * \param aNumWorkers The number of available workers. This value limits the
    * concurrency level within the container.
+   * \param aMaxPending The maximum number of tasks waiting for a worker to
+   * become available, beyond which new tasks are rejected. 0 means unlimited.
    *
    * \throw DupContainerName if there is already another container with the
    * same name
@@ -181,7 +206,19 @@ class Computer final
   void addContainer(const std::string& aName,
                     const std::string& aProcName,
                     const Lambda&      aLambda,
-                    const size_t       aNumWorkers);
+                    const size_t       aNumWorkers,
+                    const size_t       aMaxPending = 0);
+
+  /**
+   * Set the function called periodically, together with the utilization
+   * callback specified in the ctor, with the loads of all containers.
+   *
+   * \param aLoadCallback The function called. If empty, then the loads
+   * are not reported.
+   *
+   * \throw InitDone if this method is called once the initialized is complete.
+   */
+  void loadCallback(const LoadCallback& aLoadCallback);
 
   /**
    * Add a new task to the computer.
@@ -194,7 +231,15 @@ class Computer final
    * \return The identifier of the request, that will allow the recipient of the
    * callback to identify which task has been actually completed.
    *
+   * If the request has a deadline that expires before its execution begins,
+   * then the task is dropped and the callback is called with a response
+   * reporting the expiry.
+   *
    * \throw NoContainerFound if there is no matching container for this request.
+   *
+   * \throw DeadlineExpired if the deadline of the request has already expired.
+   *
+   * \throw Overloaded if the container has too many pending tasks already.
    */
   uint64_t addTask(const LambdaRequest& aRequest);
 
@@ -211,6 +256,12 @@ class Computer final
   double simTask(const LambdaRequest&   aRequest,
                  std::array<double, 3>& aLastUtils);
 
+  //! \return the number of tasks dropped since their deadline expired.
+  size_t numExpired() const;
+
+  //! \return the number of tasks rejected because of overload.
+  size_t numOverloaded() const;
+
   //! \return The computer's name.
   const std::string& name() const noexcept {
     return theName;
@@ -246,6 +297,7 @@ class Computer final
   const std::string  theName;
   const Callback     theCallback;
   const UtilCallback theUtilCallback;
+  LoadCallback       theLoadCallback;
 
   mutable std::mutex      theMutex;
   std::condition_variable theCondition;
@@ -254,6 +306,8 @@ class Computer final
   bool                    theTerminating;
   bool                    theNewTask;
   uint64_t                theNextId;
+  size_t                  theNumExpired;
+  size_t                  theNumOverloaded;
   support::Chrono         theChrono;
   std::thread             theDispatcher;
   std::thread             theUtilCollector;
@@ -32,6 +32,7 @@ SOFTWARE.
 #include "container.h"
 
 #include "edgemessages.h"
+#include "overload.h"
 #include "processor.h"
 
 #include <glog/logging.h>
@@ -44,9 +45,11 @@ namespace edge {
 
 Task::Task(const uint64_t aId,
            const uint64_t aMemory,
-           const uint64_t aResidualOps)
+           const uint64_t aResidualOps,
+           const Deadline aDeadline)
     : theId(aId)
     , theMemory(aMemory)
+    , theDeadline(aDeadline)
     , theResidualOps(aResidualOps)
     , theResp(nullptr) {
 }
@@ -54,13 +57,16 @@ Task::Task(const uint64_t aId,
 Container::Container(const std::string& aName,
                      Processor&         aProcessor,
                      const Lambda&      aLambda,
-                     const size_t       aNumWorkers)
+                     const size_t       aNumWorkers,
+                     const size_t       aMaxPending)
     : theName(aName)
     , theProcessor(aProcessor)
     , theLambda(aLambda)
     , theNumWorkers(aNumWorkers)
+    , theMaxPending(aMaxPending)
     , theActive()
-    , thePending() {
+    , thePending()
+    , theExpired() {
   if (aNumWorkers == 0) {
     throw std::runtime_error("Zero workers used for container " + aName);
   }
@@ -68,13 +74,24 @@ Container::Container(const std::string& aName,
 
 void Container::push(const LambdaRequest& aReq, uint64_t aId) {
   const auto myRequirements = requirements(aReq);
-  Task myTask(aId, myRequirements.theMemory, myRequirements.theOperations);
-  myTask.theResp = theLambda.execute(aReq, theProcessor.lastUtils());
 
   // if there are no spare workers or there is no spare memory available then
-  // the current task becomes pending
-  if (theActive.size() == theNumWorkers or
-      theProcessor.memAvailable() < myRequirements.theMemory) {
+  // the current task becomes pending, unless the pending list is full
+  const auto myPending = theActive.size() == theNumWorkers or
+                         theProcessor.memAvailable() < myRequirements.theMemory;
+  if (myPending and theMaxPending > 0 and thePending.size() >= theMaxPending) {
+    VLOG(2) << "task rejected by container " << theName << ": "
+            << thePending.size() << " pending tasks";
+    throw Overloaded();
+  }
+
+  Task myTask(aId,
+              myRequirements.theMemory,
+              myRequirements.theOperations,
+              aReq.theDeadline);
+  myTask.theResp = theLambda.execute(aReq, theProcessor.lastUtils());
+
+  if (myPending) {
     thePending.emplace_back(std::move(myTask));
 
   } else {
@@ -95,20 +112,7 @@ double Container::simulate(const LambdaRequest& aReq) const {
   // new task may require further resources on the processor for its execution
   const auto myOneMoreTask = theActive.size() < theNumWorkers;
 
-  // simulate the dispatch of all the pending tasks
-  auto myElapsed = // return value, in seconds
-      std::accumulate(thePending.cbegin(),
-                      thePending.cend(),
-                      0.0,
-                      [this](const double sum, const Task& aTask) {
-                        return sum +
-                               theProcessor.opsToTime(aTask.theResidualOps);
-                      });
-
-  // if all the workers are busy, then dispatch the one that will finish first
-  if (theActive.size() == theNumWorkers) {
-    myElapsed += theProcessor.opsToTime(theActive.front().theResidualOps);
-  }
+  auto myElapsed = wait(); // return value, in seconds
 
   // the new task can be put into (simulated) execution
   myElapsed += myOneMoreTask ?
@@ -119,6 +123,25 @@ double Container::simulate(const LambdaRequest& aReq) const {
   return myElapsed;
 }
 
+double Container::wait() const {
+  // simulate the dispatch of all the pending tasks
+  auto ret = std::accumulate(thePending.cbegin(),
+                             thePending.cend(),
+                             0.0,
+                             [this](const double sum, const Task& aTask) {
+                               return sum +
+                                      theProcessor.opsToTime(
+                                          aTask.theResidualOps);
+                             });
+
+  // if all the workers are busy, then dispatch the one that will finish first
+  if (theActive.size() == theNumWorkers) {
+    ret += theProcessor.opsToTime(theActive.front().theResidualOps);
+  }
+
+  return ret;
+}
+
 std::array<double, 3> Container::lastUtils() const noexcept {
   return theProcessor.lastUtils();
 }
@@ -136,7 +159,14 @@ Task Container::pop() {
   // add as many pending tasks as possible provided that
   // 1. there are workers available in the container
   // 2. there is sufficient memory available on the processor
+  // the tasks that have expired in the meanwhile are skipped
   for (auto myIt = thePending.begin(); myIt != thePending.end();) {
+    if (deadlineExpired(myIt->theDeadline)) {
+      VLOG(2) << "task expired in container " << theName << ": " << *myIt;
+      theExpired.splice(theExpired.end(), thePending, myIt++);
+      continue;
+    }
+
     if (theActive.size() == theNumWorkers or
         theProcessor.memAvailable() < myIt->theMemory) {
       break;
@@ -152,6 +182,12 @@ Task Container::pop() {
   return myRet;
 }
 
+std::list<Task> Container::takeExpired() {
+  std::list<Task> ret;
+  ret.swap(theExpired);
+  return ret;
+}
+
 void Container::advance(const double aElapsed) {
   if (aElapsed < 0) {
     throw std::runtime_error("cannot advance a container in the past by " +
@@ -219,7 +255,7 @@ LambdaRequirements Container::requirements(const LambdaRequest& aReq) const {
   const auto myRequirements = theLambda.requirements(theProcessor, aReq);
   if (myRequirements.theMemory > theProcessor.memTotal()) {
     throw std::runtime_error("Container " + theName +
-                             " cannot handle request " + aReq.theName +
+                             " cannot handle request " + aReq.theName.str() +
                              " since the memory requirements exceed the total "
                              "available in the processor: " +
                              std::to_string(theProcessor.memTotal()) +
@@ -244,6 +280,7 @@ std::ostream& operator<<(std::ostream&                 aStream,
   aStream << "name " << aContainer.name() << ", "
           << "lambda " << aContainer.lambda() << ", "
           << "num-workers " << aContainer.numWorkers() << ", "
+          << "max-pending " << aContainer.maxPending() << ", "
           << "active " << aContainer.active() << ", "
           << "pending " << aContainer.pending();
   return aStream;
@@ -31,6 +31,7 @@ SOFTWARE.
 
 #pragma once
 
+#include "deadline.h"
 #include "lambda.h"
 
 #include <iostream>
@@ -48,10 +49,12 @@ struct LambdaResponse;
 struct Task {
   explicit Task(const uint64_t aId,
                 const uint64_t aMemory,
-                const uint64_t aResidualOps);
+                const uint64_t aResidualOps,
+                const Deadline aDeadline = 0);
 
   const uint64_t theId;
   const uint64_t theMemory;
+  const Deadline theDeadline;
 
   uint64_t                              theResidualOps;
   std::shared_ptr<const LambdaResponse> theResp;
@@ -70,19 +73,23 @@ class Container final
    * \param aLambda The function that this container executes.
    * \param aNumWorkers The number of available workers. This value limits the
    * concurrency level within the container.
+   * \param aMaxPending The maximum number of pending tasks, i.e., waiting for
+   * a worker to become available. 0 means unlimited.
    *
    * \throw std::runtime_error if the number of workers is zero.
    */
   explicit Container(const std::string& aName,
                      Processor&         aProcessor,
                      const Lambda&      aLambda,
-                     const size_t       aNumWorkers);
+                     const size_t       aNumWorkers,
+                     const size_t       aMaxPending = 0);
 
   /**
    * Add a new task to this container.
    * If there are available workers then the request is activated immediately,
    * otherwise execution is postponed until a worker is available. Requests are
-   * handled on a first come first serve basis.
+   * handled on a first come first serve basis. A pending request whose
+   * deadline expires is dropped without being executed.
 
    * \param aReq The lambda request, containinig the input.
    * \param aId A unique identifier of the request, used to identify task
@@ -90,6 +97,9 @@ class Container final
    *
    * \throw std::runtime_error if the task would require more memory than the
    * total available in the processor.
+   *
+   * \throw Overloaded if the task would become pending but there are already
+   * as many pending tasks as the maximum allowed.
    */
   void push(const LambdaRequest& aReq, uint64_t aId);
 
@@ -103,13 +113,20 @@ class Container final
    */
   double simulate(const LambdaRequest& aReq) const;
 
+  /**
+   * \return the time a new task would wait before being put in execution,
+   * assuming that all the pending tasks are served first, in seconds.
+   */
+  double wait() const;
+
   //! \return the average loads in the last 1, 10, and 30 seconds.
   std::array<double, 3> lastUtils() const noexcept;
 
   /**
    * Return the task whose execution time is earliest.
    * This automatically advances the computation of all the active tasks and
-   * may activate one or more pending tasks.
+   * may activate one or more pending tasks, while the pending tasks whose
+   * deadline has expired are moved to the expired ones.
    *
    * \throw std::runtime_error if there are no active tasks.
    */
@@ -138,6 +155,14 @@ class Container final
     return thePending.size();
   }
 
+  //! \return the number of tasks expired before their execution.
+  size_t expired() const noexcept {
+    return theExpired.size();
+  }
+
+  //! \return the tasks expired before their execution, which are removed.
+  std::list<Task> takeExpired();
+
   /**
    * \return the residual processing time of the task nearest to completion.
    *
@@ -158,6 +183,9 @@ class Container final
   size_t numWorkers() const noexcept {
     return theNumWorkers;
   }
+  size_t maxPending() const noexcept {
+    return theMaxPending;
+  }
 
  private:
   void               throwIfEmpty() const;
@@ -169,9 +197,11 @@ class Container final
   Processor&        theProcessor;
   const Lambda      theLambda;
   const size_t      theNumWorkers;
+  const size_t      theMaxPending;
 
   std::list<Task> theActive;
   std::list<Task> thePending;
+  std::list<Task> theExpired;
 };
 
 } // namespace edge
@@ -0,0 +1,72 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Edge/deadline.h"
+
+#include <cassert>
+
+namespace uiiit {
+namespace edge {
+
+Deadline deadlineAfter(const double aTime) {
+  return deadlineFromTimePoint(
+      std::chrono::system_clock::now() +
+      std::chrono::microseconds(static_cast<int64_t>(0.5 + aTime * 1e6)));
+}
+
+bool deadlineExpired(const Deadline aDeadline) {
+  return aDeadline > 0 and
+         deadlineToTimePoint(aDeadline) <= std::chrono::system_clock::now();
+}
+
+std::chrono::system_clock::time_point
+deadlineToTimePoint(const Deadline aDeadline) {
+  assert(aDeadline > 0);
+  return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::microseconds(aDeadline)));
+}
+
+Deadline deadlineFromTimePoint(
+    const std::chrono::system_clock::time_point& aTimePoint) {
+  if (aTimePoint == std::chrono::system_clock::time_point::max()) {
+    return 0;
+  }
+  const auto ret = std::chrono::duration_cast<std::chrono::microseconds>(
+                       aTimePoint.time_since_epoch())
+                       .count();
+  // a deadline in the past is still a (expired) deadline
+  return ret > 0 ? static_cast<Deadline>(ret) : 1;
+}
+
+} // namespace edge
+} // namespace uiiit
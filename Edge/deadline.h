@@ -0,0 +1,66 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace uiiit {
+namespace edge {
+
+/**
+ * The deadline of a lambda request is the absolute time by which its
+ * response is useful, expressed in microseconds since the epoch of the
+ * system clock, with 0 meaning that the request has no deadline.
+ */
+using Deadline = uint64_t;
+
+//! \return the deadline expiring after a given time, in fractional seconds.
+Deadline deadlineAfter(const double aTime);
+
+//! \return true if the deadline is set and has already expired.
+bool deadlineExpired(const Deadline aDeadline);
+
+//! \return the time point of a deadline, which must be set.
+std::chrono::system_clock::time_point
+deadlineToTimePoint(const Deadline aDeadline);
+
+/**
+ * \return the deadline of a time point, e.g., from a gRPC context, or 0
+ * if the time point is the maximum representable, which means no deadline.
+ */
+Deadline deadlineFromTimePoint(
+    const std::chrono::system_clock::time_point& aTimePoint);
+
+} // namespace edge
+} // namespace uiiit
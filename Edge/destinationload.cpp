@@ -0,0 +1,87 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "destinationload.h"
+
+#include <cassert>
+
+namespace uiiit {
+namespace edge {
+
+DestinationLoad::DestinationLoad()
+    : theChunks(new std::atomic<Counter*>[numChunks()]()) {
+  // noop
+}
+
+DestinationLoad::~DestinationLoad() {
+  for (size_t i = 0; i < numChunks(); i++) {
+    delete[] theChunks[i].load();
+  }
+}
+
+void DestinationLoad::increment(const DestinationId aId) {
+  counter(aId).fetch_add(1, std::memory_order_relaxed);
+}
+
+void DestinationLoad::decrement(const DestinationId aId) {
+  [[maybe_unused]] const auto myOld =
+      counter(aId).fetch_sub(1, std::memory_order_relaxed);
+  assert(myOld > 0);
+}
+
+size_t DestinationLoad::operator()(const DestinationId aId) const {
+  assert(aId / chunkSize() < numChunks());
+  const auto myChunk = theChunks[aId / chunkSize()].load();
+  if (myChunk == nullptr) {
+    return 0;
+  }
+  return myChunk[aId % chunkSize()].load(std::memory_order_relaxed);
+}
+
+DestinationLoad::Counter& DestinationLoad::counter(const DestinationId aId) {
+  assert(aId / chunkSize() < numChunks());
+  auto& myChunk = theChunks[aId / chunkSize()];
+  auto  myPtr   = myChunk.load();
+  if (myPtr == nullptr) {
+    // allocate the chunk, unless another thread has done so in the meanwhile
+    auto myNew = new Counter[chunkSize()]();
+    if (myChunk.compare_exchange_strong(myPtr, myNew)) {
+      myPtr = myNew;
+    } else {
+      delete[] myNew;
+    }
+  }
+  return myPtr[aId % chunkSize()];
+}
+
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,90 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Edge/destinationregistry.h"
+#include "Support/macros.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace uiiit {
+namespace edge {
+
+/**
+ * Number of requests in flight towards each destination, indexed by its
+ * identifier in the DestinationRegistry.
+ *
+ * All the operations are lock-free: the counters are allocated in chunks
+ * as needed, which are never released until the object is destroyed.
+ */
+class DestinationLoad final
+{
+  NONCOPYABLE_NONMOVABLE(DestinationLoad);
+
+  using Counter = std::atomic<size_t>;
+
+ public:
+  //! Create an object with no requests in flight.
+  explicit DestinationLoad();
+
+  ~DestinationLoad();
+
+  //! A new request has been sent to the destination.
+  void increment(const DestinationId aId);
+
+  //! A request sent to the destination has returned.
+  void decrement(const DestinationId aId);
+
+  //! \return the number of requests in flight towards the destination.
+  size_t operator()(const DestinationId aId) const;
+
+ private:
+  //! \return the counter of the destination, allocated if needed.
+  Counter& counter(const DestinationId aId);
+
+ private:
+  std::unique_ptr<std::atomic<Counter*>[]> theChunks;
+
+  // static configuration
+  // clang-format off
+  static constexpr size_t chunkSize() { return 256; }
+  static constexpr size_t numChunks() {
+    return (DestinationRegistry::capacity() + chunkSize() - 1) / chunkSize();
+  }
+  // clang-format on
+};
+
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,105 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "destinationregistry.h"
+
+#include <cassert>
+#include <mutex>
+
+namespace uiiit {
+namespace edge {
+
+DestinationRegistry& DestinationRegistry::instance() {
+  static DestinationRegistry myInstance;
+  return myInstance;
+}
+
+DestinationRegistry::DestinationRegistry()
+    : theMutex()
+    , theIds()
+    , theChunks(maxChunks())
+    , theSize(0) {
+  // noop
+}
+
+DestinationId DestinationRegistry::intern(const std::string& aName) {
+  DestinationId myId;
+  if (find(aName, myId)) {
+    return myId;
+  }
+
+  const std::unique_lock<std::shared_mutex> myLock(theMutex);
+
+  // the end-point may have been added while the lock was released
+  const auto it = theIds.find(aName);
+  if (it != theIds.end()) {
+    return it->second;
+  }
+
+  const auto mySize = theSize.load(std::memory_order_relaxed);
+  if (mySize == capacity()) {
+    throw DestinationRegistryFull();
+  }
+  auto& myChunk = theChunks[mySize / chunkSize()];
+  if (not myChunk) {
+    myChunk.reset(new std::string[chunkSize()]);
+  }
+  myChunk[mySize % chunkSize()] = aName;
+  myId                          = static_cast<DestinationId>(mySize);
+  theIds.emplace(aName, myId);
+
+  // make the name visible to the lock-free readers
+  theSize.store(mySize + 1, std::memory_order_release);
+  return myId;
+}
+
+bool DestinationRegistry::find(const std::string& aName,
+                               DestinationId&     aId) const {
+  const std::shared_lock<std::shared_mutex> myLock(theMutex);
+  const auto                                it = theIds.find(aName);
+  if (it == theIds.end()) {
+    return false;
+  }
+  aId = it->second;
+  return true;
+}
+
+const std::string& DestinationRegistry::name(const DestinationId aId) const {
+  if (aId >= theSize.load(std::memory_order_acquire)) {
+    throw InvalidDestinationId(aId);
+  }
+  assert(theChunks[aId / chunkSize()]);
+  return theChunks[aId / chunkSize()][aId % chunkSize()];
+}
+
+} // namespace edge
+} // namespace uiiit
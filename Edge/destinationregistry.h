@@ -0,0 +1,147 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/macros.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+//! Compact identifier of an edge end-point interned in the registry.
+using DestinationId = uint32_t;
+
+struct InvalidDestinationId : public std::runtime_error {
+  explicit InvalidDestinationId(const DestinationId aId)
+      : std::runtime_error("Invalid destination identifier " +
+                           std::to_string(aId)) {
+  }
+};
+
+struct DestinationRegistryFull : public std::runtime_error {
+  explicit DestinationRegistryFull()
+      : std::runtime_error("No more destinations can be interned") {
+  }
+};
+
+/**
+ * Process-wide registry of the end-points of edge nodes.
+ *
+ * Every end-point is interned once and then referred to by a small integer
+ * identifier, which is cheap to copy, compare and hash. The identifiers are
+ * assigned consecutively starting from 0 and are never reused, i.e., an
+ * end-point remains in the registry until the process terminates: this is
+ * fine since the number of distinct edge nodes is small.
+ *
+ * Interning a new end-point requires an exclusive lock, but retrieving the
+ * name of an identifier is lock-free, because the names are stored in
+ * fixed-size chunks that are never moved once allocated.
+ */
+class DestinationRegistry final
+{
+  NONCOPYABLE_NONMOVABLE(DestinationRegistry);
+
+ public:
+  //! \return the registry shared by all the components of this process.
+  static DestinationRegistry& instance();
+
+  /**
+   * \return the identifier of the given end-point, which is added to the
+   * registry if not already present.
+   *
+   * \throw DestinationRegistryFull if the registry cannot host more names.
+   */
+  DestinationId intern(const std::string& aName);
+
+  /**
+   * Look up an end-point without adding it.
+   *
+   * \param aName the end-point to search.
+   * \param aId set to the identifier of the end-point, if found.
+   *
+   * \return true if the end-point is in the registry.
+   */
+  bool find(const std::string& aName, DestinationId& aId) const;
+
+  /**
+   * \return the end-point of a given identifier, which remains valid for the
+   * whole lifetime of the process.
+   *
+   * \throw InvalidDestinationId if the identifier has never been assigned.
+   */
+  const std::string& name(const DestinationId aId) const;
+
+  //! \return an identifier that is never assigned to any end-point.
+  static constexpr DestinationId invalid() {
+    return std::numeric_limits<DestinationId>::max();
+  }
+
+  //! \return the maximum number of end-points that can be interned.
+  static constexpr size_t capacity() {
+    return chunkSize() * maxChunks();
+  }
+
+  //! \return the number of end-points interned so far.
+  size_t size() const noexcept {
+    return theSize.load(std::memory_order_acquire);
+  }
+
+ private:
+  explicit DestinationRegistry();
+
+  using Chunk = std::unique_ptr<std::string[]>;
+
+ private:
+  mutable std::shared_mutex                      theMutex; // for writers
+  std::unordered_map<std::string, DestinationId> theIds;
+  std::vector<Chunk>                             theChunks; // never resized
+  std::atomic<size_t>                            theSize;
+
+  // static configuration
+  // clang-format off
+  static constexpr size_t chunkSize() { return 1024; }
+  static constexpr size_t maxChunks() { return 1024; }
+  // clang-format on
+};
+
+} // namespace edge
+} // namespace uiiit
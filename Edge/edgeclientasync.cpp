@@ -0,0 +1,776 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "edgeclientasync.h"
+
+#include "RpcSupport/utils.h"
+
+#include <glog/logging.h>
+
+#include <grpc++/impl/codegen/proto_utils.h>
+
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+namespace {
+
+// name of the method to execute lambda functions on edge servers
+const std::string theRunLambdaMethod("/uiiit.rpc.EdgeServer/RunLambda");
+
+// name of the method to execute batches of lambda functions on edge servers
+const std::string theRunLambdaBatchMethod(
+    "/uiiit.rpc.EdgeServer/RunLambdaBatch");
+
+// name of the method to execute lambda functions on edge servers via streams
+const std::string theRunLambdaStreamMethod(
+    "/uiiit.rpc.EdgeServer/RunLambdaStream");
+
+// append a varint to a protobuf wire-format buffer
+void appendVarint(std::string& aBuffer, uint64_t aValue) {
+  while (aValue >= 0x80) {
+    aBuffer.push_back(static_cast<char>((aValue & 0x7f) | 0x80));
+    aValue >>= 7;
+  }
+  aBuffer.push_back(static_cast<char>(aValue));
+}
+
+// append a varint field to a protobuf wire-format buffer
+void appendField(std::string&   aBuffer,
+                 const int      aField,
+                 const uint64_t aValue) {
+  appendVarint(aBuffer, static_cast<uint64_t>(aField) << 3); // wire type 0
+  appendVarint(aBuffer, aValue);
+}
+
+// serialize a lambda request into a buffer
+grpc::ByteBuffer serialize(const rpc::LambdaRequest& aReq) {
+  grpc::ByteBuffer myBuffer;
+  bool             myOwnBuffer;
+  const auto       myStatus =
+      grpc::SerializationTraits<rpc::LambdaRequest>::Serialize(
+          aReq, &myBuffer, &myOwnBuffer);
+  if (not myStatus.ok()) {
+    throw std::runtime_error("Could not serialize lambda request: " +
+                             myStatus.error_message());
+  }
+  return myBuffer;
+}
+
+/**
+ * Serialize a lambda request and then append to it the new values of the
+ * hops, forward, and dry fields, as well as the identifier if not zero:
+ * when parsing a message the last value found for a singular field
+ * overrides the previous ones.
+ *
+ * \return the size of the patched message, whose slices are added to
+ * aSlices.
+ */
+size_t appendPassThrough(std::vector<grpc::Slice>& aSlices,
+                         const rpc::LambdaRequest& aReq,
+                         const bool                aDry,
+                         const uint64_t            aId) {
+  auto myBuffer = serialize(aReq);
+
+  std::string myPatch;
+  appendField(myPatch, rpc::LambdaRequest::kHopsFieldNumber, aReq.hops() + 1);
+  appendField(myPatch, rpc::LambdaRequest::kForwardFieldNumber, 1);
+  appendField(myPatch, rpc::LambdaRequest::kDryFieldNumber, aDry ? 1 : 0);
+  if (aId > 0) {
+    appendField(myPatch, rpc::LambdaRequest::kIdFieldNumber, aId);
+  }
+
+  // the slices of the serialized message are reference-counted
+  std::vector<grpc::Slice> mySlices;
+  myBuffer.Dump(&mySlices);
+  aSlices.insert(aSlices.end(), mySlices.begin(), mySlices.end());
+  aSlices.emplace_back(myPatch.data(), myPatch.size());
+  return myBuffer.Length() + myPatch.size();
+}
+
+//! \return a lambda request patched as in appendPassThrough().
+grpc::ByteBuffer passThrough(const rpc::LambdaRequest& aReq,
+                             const bool                aDry,
+                             const uint64_t            aId) {
+  std::vector<grpc::Slice> mySlices;
+  appendPassThrough(mySlices, aReq, aDry, aId);
+  return grpc::ByteBuffer(mySlices.data(), mySlices.size());
+}
+
+/**
+ * \return a batch of lambda requests, each patched as in appendPassThrough()
+ * and then added as a length-delimited entry of the repeated field.
+ */
+grpc::ByteBuffer
+passThroughBatch(const std::vector<const rpc::LambdaRequest*>& aReqs,
+                 const bool                                    aDry) {
+  std::vector<grpc::Slice> mySlices;
+  for (const auto myReq : aReqs) {
+    assert(myReq != nullptr);
+    // the header with the length is known only after serialization
+    const auto mySlot = mySlices.size();
+    mySlices.emplace_back();
+    const auto mySize = appendPassThrough(mySlices, *myReq, aDry, 0);
+
+    std::string myHeader;
+    appendVarint(myHeader,
+                 (static_cast<uint64_t>(
+                      rpc::LambdaRequestBatch::kRequestsFieldNumber)
+                  << 3) |
+                     2); // wire type 2: length-delimited
+    appendVarint(myHeader, mySize);
+    mySlices[mySlot] = grpc::Slice(myHeader.data(), myHeader.size());
+  }
+  return grpc::ByteBuffer(mySlices.data(), mySlices.size());
+}
+
+} // namespace
+
+struct EdgeClientAsync::Call final : public Tag {
+  explicit Call(EdgeClientAsync&   aParent,
+                const std::string& aDestination,
+                Callback&&         aCallback)
+      : theParent(aParent)
+      , theDestination(aDestination)
+      , theCallback(std::move(aCallback))
+      , theChrono(true)
+      , theContext()
+      , theResponse()
+      , theStatus()
+      , theReader()
+      , theBuffer()
+      , theGenericReader() {
+    // noop
+  }
+
+  void proceed(const bool aOk) override {
+    theParent.done(&theContext);
+    std::unique_ptr<LambdaResponse> myResp;
+    try {
+      if (not aOk) {
+        throw std::runtime_error("Invalid event");
+      }
+      rpc::checkStatus(theStatus);
+      if (theGenericReader) {
+        rpc::checkStatus(
+            grpc::SerializationTraits<rpc::LambdaResponse>::Deserialize(
+                &theBuffer, &theResponse));
+      }
+      myResp = std::make_unique<LambdaResponse>(std::move(theResponse));
+
+      // if the lambda does not include the actual responder then we set it
+      // to the destination
+      if (myResp->theResponder.empty()) {
+        myResp->theResponder = theDestination;
+      }
+    } catch (const std::exception& aErr) {
+      myResp = std::make_unique<LambdaResponse>(aErr.what(), "");
+    }
+    assert(myResp);
+    theCallback(std::move(*myResp), theChrono.stop());
+    delete this;
+  }
+
+  using Reader        = grpc::ClientAsyncResponseReader<rpc::LambdaResponse>;
+  using GenericReader = grpc::GenericClientAsyncResponseReader;
+
+  EdgeClientAsync&               theParent;
+  const std::string              theDestination;
+  const Callback                 theCallback;
+  support::Chrono                theChrono;
+  grpc::ClientContext            theContext;
+  rpc::LambdaResponse            theResponse;
+  grpc::Status                   theStatus;
+  std::unique_ptr<Reader>        theReader;
+  grpc::ByteBuffer               theBuffer; // only with generic reader
+  std::unique_ptr<GenericReader> theGenericReader;
+};
+
+struct EdgeClientAsync::BatchCall final : public Tag {
+  explicit BatchCall(EdgeClientAsync&   aParent,
+                     const std::string& aDestination,
+                     const size_t       aSize,
+                     BatchCallback&&    aCallback)
+      : theParent(aParent)
+      , theDestination(aDestination)
+      , theSize(aSize)
+      , theCallback(std::move(aCallback))
+      , theChrono(true)
+      , theContext()
+      , theStatus()
+      , theBuffer()
+      , theReader() {
+    // noop
+  }
+
+  void proceed(const bool aOk) override {
+    theParent.done(&theContext);
+    std::vector<LambdaResponse> myResps;
+    myResps.reserve(theSize);
+    try {
+      if (not aOk) {
+        throw std::runtime_error("Invalid event");
+      }
+      rpc::checkStatus(theStatus);
+      rpc::LambdaResponseBatch myMsg;
+      rpc::checkStatus(
+          grpc::SerializationTraits<rpc::LambdaResponseBatch>::Deserialize(
+              &theBuffer, &myMsg));
+      if (static_cast<size_t>(myMsg.responses_size()) != theSize) {
+        throw std::runtime_error(
+            "Invalid number of responses in batch from " + theDestination +
+            ": " + std::to_string(myMsg.responses_size()) + " instead of " +
+            std::to_string(theSize));
+      }
+      for (auto& myResp : *myMsg.mutable_responses()) {
+        myResps.emplace_back(std::move(myResp));
+        // same as for a single response
+        if (myResps.back().theResponder.empty()) {
+          myResps.back().theResponder = theDestination;
+        }
+      }
+    } catch (const std::exception& aErr) {
+      myResps.clear();
+      for (size_t i = 0; i < theSize; i++) {
+        myResps.emplace_back(aErr.what(), "");
+      }
+    }
+    assert(myResps.size() == theSize);
+    theCallback(std::move(myResps), theChrono.stop());
+    delete this;
+  }
+
+  using Reader = grpc::GenericClientAsyncResponseReader;
+
+  EdgeClientAsync&        theParent;
+  const std::string       theDestination;
+  const size_t            theSize;
+  const BatchCallback     theCallback;
+  support::Chrono         theChrono;
+  grpc::ClientContext     theContext;
+  grpc::Status            theStatus;
+  grpc::ByteBuffer        theBuffer;
+  std::unique_ptr<Reader> theReader;
+};
+
+struct EdgeClientAsync::Timer final : public Tag {
+  explicit Timer(EdgeClientAsync& aParent, Timeout&& aTimeout)
+      : theParent(aParent)
+      , theTimeout(std::move(aTimeout))
+      , theAlarm() {
+    // noop
+  }
+
+  void proceed(const bool aOk) override {
+    theParent.done(&theAlarm);
+    // the timer has been cancelled if the event is not ok
+    theTimeout(aOk);
+    delete this;
+  }
+
+  EdgeClientAsync& theParent;
+  const Timeout    theTimeout;
+  grpc::Alarm      theAlarm;
+};
+
+/**
+ * A stream towards a destination, with any number of requests pending.
+ *
+ * The stream is retired from the parent as soon as reading from it fails,
+ * at which point all the pending requests fail, and it deallocates itself
+ * when there are no more operations pending on the completion queue.
+ */
+struct EdgeClientAsync::Stream final {
+  using Handler = void (Stream::*)(const bool);
+
+  // An operation on the stream, which notifies a given handler.
+  struct Event final : public Tag {
+    explicit Event(Stream& aStream, const Handler aHandler)
+        : theStream(aStream)
+        , theHandler(aHandler) {
+    }
+    void proceed(const bool aOk) override {
+      (theStream.*theHandler)(aOk);
+    }
+    Stream&       theStream;
+    const Handler theHandler;
+  };
+
+  // A request waiting for its response.
+  struct Pending {
+    Callback        theCallback;
+    support::Chrono theChrono;
+  };
+
+  using Reader = grpc::GenericClientAsyncReaderWriter;
+
+  explicit Stream(EdgeClientAsync&   aParent,
+                  const std::string& aDestination,
+                  grpc::GenericStub& aStub)
+      : theParent(aParent)
+      , theDestination(aDestination)
+      , theContext()
+      , theReader(aStub.PrepareCall(
+            &theContext, theRunLambdaStreamMethod, &aParent.theCq))
+      , theStartEvent(*this, &Stream::started)
+      , theReadEvent(*this, &Stream::read)
+      , theWriteEvent(*this, &Stream::written)
+      , theFinishEvent(*this, &Stream::finished)
+      , theIncoming()
+      , theStatus()
+      , theMutex()
+      , theOutgoing()
+      , thePending()
+      , theStarted(false)
+      , theWriting(false)
+      , theBroken(false)
+      , theFinished(false) {
+    theReader->StartCall(&theStartEvent);
+  }
+
+  //! Send a request. Must be called with the parent's mutex held.
+  void send(const uint64_t     aId,
+            grpc::ByteBuffer&& aBuffer,
+            Callback&&         aCallback) {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    assert(not theBroken);
+    thePending.emplace(aId,
+                       Pending{std::move(aCallback), support::Chrono(true)});
+    theOutgoing.emplace_back(std::move(aBuffer));
+    flush();
+  }
+
+  //! Write the next request, if possible. Must be called with theMutex held.
+  void flush() {
+    if (theStarted and not theWriting and not theBroken and
+        not theOutgoing.empty()) {
+      // only one write at a time can be pending on a stream
+      theWriting = true;
+      theReader->Write(theOutgoing.front(), &theWriteEvent);
+    }
+  }
+
+  void started(const bool aOk) {
+    if (not aOk) {
+      terminate();
+      return;
+    }
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    theStarted = true;
+    theReader->Read(&theIncoming, &theReadEvent);
+    flush();
+  }
+
+  void read(const bool aOk) {
+    if (not aOk) {
+      terminate();
+      return;
+    }
+
+    rpc::LambdaResponse myMsg;
+    const auto          myStatus =
+        grpc::SerializationTraits<rpc::LambdaResponse>::Deserialize(
+            &theIncoming, &myMsg);
+    theIncoming.Clear();
+
+    std::unique_ptr<Pending> myPending;
+    {
+      const std::lock_guard<std::mutex> myLock(theMutex);
+      const auto                        it = thePending.find(myMsg.id());
+      if (it != thePending.end()) {
+        myPending = std::make_unique<Pending>(std::move(it->second));
+        thePending.erase(it);
+      }
+    }
+
+    std::unique_ptr<LambdaResponse> myResp;
+    if (not myPending) {
+      LOG(WARNING) << "unexpected response from " << theDestination
+                   << " with id " << myMsg.id();
+    } else if (not myStatus.ok()) {
+      myResp = std::make_unique<LambdaResponse>(
+          "Could not deserialize lambda response: " + myStatus.error_message(),
+          "");
+    } else {
+      myResp = std::make_unique<LambdaResponse>(std::move(myMsg));
+      if (myResp->theResponder.empty()) {
+        myResp->theResponder = theDestination;
+      }
+    }
+
+    // this object may be deallocated by another thread after the next read
+    theReader->Read(&theIncoming, &theReadEvent);
+
+    if (myPending) {
+      assert(myResp);
+      myPending->theCallback(std::move(*myResp), myPending->theChrono.stop());
+    }
+  }
+
+  void written(const bool aOk) {
+    bool myDelete = false;
+    {
+      const std::lock_guard<std::mutex> myLock(theMutex);
+      assert(theWriting);
+      theWriting = false;
+      theOutgoing.pop_front();
+      if (aOk) {
+        flush();
+      }
+      myDelete = theFinished;
+    }
+    // if the write failed, then reading fails, too
+    if (myDelete) {
+      delete this;
+    }
+  }
+
+  void finished([[maybe_unused]] const bool aOk) {
+    VLOG(2) << "stream to " << theDestination
+            << " closed: " << theStatus.error_message();
+    bool myDelete = false;
+    {
+      const std::lock_guard<std::mutex> myLock(theMutex);
+      theFinished = true;
+      myDelete    = not theWriting;
+    }
+    if (myDelete) {
+      delete this;
+    }
+  }
+
+  //! Fail all the pending requests and close the stream.
+  void terminate() {
+    // no new requests will be sent on this stream
+    theParent.retire(this);
+
+    std::unordered_map<uint64_t, Pending> myPending;
+    {
+      const std::lock_guard<std::mutex> myLock(theMutex);
+      assert(not theBroken);
+      theBroken = true;
+      myPending.swap(thePending);
+      theReader->Finish(&theStatus, &theFinishEvent);
+    }
+
+    for (auto& elem : myPending) {
+      elem.second.theCallback(LambdaResponse("stream broken", ""),
+                              elem.second.theChrono.stop());
+    }
+  }
+
+  EdgeClientAsync&        theParent;
+  const std::string       theDestination;
+  grpc::ClientContext     theContext;
+  std::unique_ptr<Reader> theReader;
+  Event                   theStartEvent;
+  Event                   theReadEvent;
+  Event                   theWriteEvent;
+  Event                   theFinishEvent;
+  grpc::ByteBuffer        theIncoming;
+  grpc::Status            theStatus;
+
+  std::mutex                            theMutex;
+  std::deque<grpc::ByteBuffer>          theOutgoing;
+  std::unordered_map<uint64_t, Pending> thePending;
+  bool                                  theStarted;
+  bool                                  theWriting;
+  bool                                  theBroken;
+  bool                                  theFinished;
+};
+
+EdgeClientAsync::EdgeClientAsync(const size_t aNumThreads,
+                                 const bool   aStreaming)
+    : theStreaming(aStreaming)
+    , theNextId(0)
+    , theMutex()
+    , theStreamsCond()
+    , theStubs()
+    , theStreams()
+    , theStopping(false)
+    , theCalls()
+    , theTimers()
+    , theCq()
+    , thePollers() {
+  if (aNumThreads == 0) {
+    throw std::runtime_error("Cannot spawn 0 threads");
+  }
+  for (size_t i = 0; i < aNumThreads; i++) {
+    thePollers.emplace_back(std::thread([this]() { poll(); }));
+  }
+}
+
+EdgeClientAsync::~EdgeClientAsync() {
+  shutdown();
+}
+
+void EdgeClientAsync::shutdown() {
+  // cancel the operations in progress and wait until the streams are closed,
+  // which requires the completion queue to be still running
+  {
+    std::unique_lock<std::mutex> myLock(theMutex);
+    if (theStopping) {
+      return;
+    }
+    theStopping = true;
+    for (const auto myStream : theStreams) {
+      myStream->theContext.TryCancel();
+    }
+    for (const auto myContext : theCalls) {
+      myContext->TryCancel();
+    }
+    for (const auto myAlarm : theTimers) {
+      myAlarm->Cancel();
+    }
+    theStreamsCond.wait(myLock, [this]() { return theStreams.empty(); });
+  }
+
+  theCq.Shutdown();
+  for (auto& myPoller : thePollers) {
+    myPoller.join();
+  }
+}
+
+void EdgeClientAsync::RunLambda(const std::string&   aDestination,
+                                const LambdaRequest& aReq,
+                                const bool           aDry,
+                                Callback&&           aCallback) {
+  VLOG(3) << aReq;
+
+  auto myReq = aReq.makeOneMoreHop().toProtobuf();
+  myReq.set_dry(aDry);
+
+  if (theStreaming) {
+    const auto myId = ++theNextId;
+    myReq.set_id(myId);
+    send(aDestination, myId, serialize(myReq), std::move(aCallback));
+    return;
+  }
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  checkRunning();
+
+  // the call is deallocated after its callback has been invoked
+  auto myCall = new Call(*this, aDestination, std::move(aCallback));
+  if (myReq.deadline() > 0) {
+    myCall->theContext.set_deadline(deadlineToTimePoint(myReq.deadline()));
+  }
+  myCall->theReader = lookup(aDestination)
+                          .theStub->AsyncRunLambda(
+                              &myCall->theContext, myReq, &theCq);
+  myCall->theReader->Finish(&myCall->theResponse, &myCall->theStatus, myCall);
+  theCalls.emplace(&myCall->theContext);
+}
+
+void EdgeClientAsync::ForwardLambda(const std::string&        aDestination,
+                                    const rpc::LambdaRequest& aReq,
+                                    const bool                aDry,
+                                    Callback&&                aCallback,
+                                    const double              aTimeout) {
+  if (theStreaming) {
+    const auto myId = ++theNextId;
+    send(aDestination,
+         myId,
+         passThrough(aReq, aDry, myId),
+         std::move(aCallback));
+    return;
+  }
+
+  const auto myBuffer = passThrough(aReq, aDry, 0);
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  checkRunning();
+
+  // the call is deallocated after its callback has been invoked
+  auto myCall     = new Call(*this, aDestination, std::move(aCallback));
+  auto myDeadline = aReq.deadline();
+  if (aTimeout > 0) {
+    const auto myTimeout = deadlineAfter(aTimeout);
+    if (myDeadline == 0 or myTimeout < myDeadline) {
+      myDeadline = myTimeout;
+    }
+  }
+  if (myDeadline > 0) {
+    myCall->theContext.set_deadline(deadlineToTimePoint(myDeadline));
+  }
+  myCall->theGenericReader =
+      lookup(aDestination)
+          .theGenericStub->PrepareUnaryCall(
+              &myCall->theContext, theRunLambdaMethod, myBuffer, &theCq);
+  myCall->theGenericReader->StartCall();
+  myCall->theGenericReader->Finish(
+      &myCall->theBuffer, &myCall->theStatus, myCall);
+  theCalls.emplace(&myCall->theContext);
+}
+
+void EdgeClientAsync::ForwardLambdaBatch(
+    const std::string&                            aDestination,
+    const std::vector<const rpc::LambdaRequest*>& aReqs,
+    const bool                                    aDry,
+    BatchCallback&&                               aCallback) {
+  const auto myBuffer = passThroughBatch(aReqs, aDry);
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  checkRunning();
+
+  // the call is deallocated after its callback has been invoked
+  auto myCall =
+      new BatchCall(*this, aDestination, aReqs.size(), std::move(aCallback));
+  myCall->theReader =
+      lookup(aDestination)
+          .theGenericStub->PrepareUnaryCall(
+              &myCall->theContext, theRunLambdaBatchMethod, myBuffer, &theCq);
+  myCall->theReader->StartCall();
+  myCall->theReader->Finish(&myCall->theBuffer, &myCall->theStatus, myCall);
+  theCalls.emplace(&myCall->theContext);
+}
+
+void EdgeClientAsync::schedule(const double aDelay, Timeout&& aTimeout) {
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    if (not theStopping) {
+      // the timer is deallocated after it has expired or has been cancelled
+      auto myTimer = new Timer(*this, std::move(aTimeout));
+      myTimer->theAlarm.Set(
+          &theCq,
+          std::chrono::system_clock::now() +
+              std::chrono::microseconds(static_cast<long>(0.5 + aDelay * 1e6)),
+          myTimer);
+      theTimers.emplace(&myTimer->theAlarm);
+      return;
+    }
+  }
+
+  // the function may use this object, hence it is called without the lock
+  VLOG(2) << "timer discarded after shutdown";
+  aTimeout(false);
+}
+
+void EdgeClientAsync::warm(const std::string& aDestination) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  if (theStopping) {
+    return;
+  }
+  lookup(aDestination).theChannel->GetState(true);
+}
+
+void EdgeClientAsync::close(const std::string& aDestination) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it = theStubs.find(aDestination);
+  if (it == theStubs.end()) {
+    return;
+  }
+  // the stream is retired once terminated, then it deallocates itself
+  if (it->second.theStream != nullptr) {
+    it->second.theStream->theContext.TryCancel();
+  }
+  // the calls in progress keep a reference to the channel
+  theStubs.erase(it);
+  VLOG(1) << "closed the channel to " << aDestination;
+}
+
+EdgeClientAsync::Stubs&
+EdgeClientAsync::lookup(const std::string& aDestination) {
+  auto& myStubs = theStubs[aDestination]; // may insert
+  if (not myStubs.theStub) {
+    assert(not myStubs.theGenericStub);
+    myStubs.theChannel = grpc::CreateChannel(
+        aDestination, grpc::InsecureChannelCredentials());
+    myStubs.theStub = rpc::EdgeServer::NewStub(myStubs.theChannel);
+    myStubs.theGenericStub =
+        std::make_unique<grpc::GenericStub>(myStubs.theChannel);
+  }
+  assert(myStubs.theGenericStub);
+  return myStubs;
+}
+
+void EdgeClientAsync::send(const std::string& aDestination,
+                           const uint64_t     aId,
+                           grpc::ByteBuffer&& aBuffer,
+                           Callback&&         aCallback) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  checkRunning();
+  auto& myStubs = lookup(aDestination);
+  if (myStubs.theStream == nullptr) {
+    // the stream deallocates itself once closed
+    myStubs.theStream =
+        new Stream(*this, aDestination, *myStubs.theGenericStub);
+    theStreams.emplace(myStubs.theStream);
+  }
+  myStubs.theStream->send(aId, std::move(aBuffer), std::move(aCallback));
+}
+
+void EdgeClientAsync::retire(Stream* aStream) {
+  assert(aStream != nullptr);
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto it = theStubs.find(aStream->theDestination);
+  if (it != theStubs.end() and it->second.theStream == aStream) {
+    it->second.theStream = nullptr;
+  }
+  theStreams.erase(aStream);
+  theStreamsCond.notify_all();
+}
+
+void EdgeClientAsync::checkRunning() const {
+  if (theStopping) {
+    throw std::runtime_error("Asynchronous client shut down");
+  }
+}
+
+void EdgeClientAsync::done(grpc::ClientContext* aContext) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theCalls.erase(aContext);
+}
+
+void EdgeClientAsync::done(grpc::Alarm* aAlarm) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theTimers.erase(aAlarm);
+}
+
+void EdgeClientAsync::poll() {
+  void* myTag;
+  bool  myOk;
+  while (theCq.Next(&myTag, &myOk)) {
+    assert(myTag != nullptr);
+    static_cast<Tag*>(myTag)->proceed(myOk);
+  }
+  VLOG(2) << "terminating";
+}
+
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,296 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Edge/edgemessages.h"
+#include "Support/chrono.h"
+#include "Support/macros.h"
+
+#include <grpc++/alarm.h>
+#include <grpc++/generic/generic_stub.h>
+#include <grpc++/grpc++.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "edgeserver.grpc.pb.h"
+
+namespace uiiit {
+namespace edge {
+
+/**
+ * Asynchronous gRPC client to execute lambda functions on any number of
+ * destinations.
+ *
+ * The requests are issued on a completion queue served by a given number
+ * of threads, which also invoke the callbacks with the responses. There is
+ * one channel per destination, which is created upon the first request, or
+ * in advance with warm(), and shared by all the subsequent ones to the same
+ * destination until close().
+ *
+ * In streaming mode, instead, all the requests to the same destination are
+ * sent on a bidirectional stream, which is opened upon the first request
+ * and re-opened if broken, and the responses are matched to the requests
+ * through their identifiers: this saves the overhead of setting up a new
+ * call for every request.
+ *
+ * The deadline of a request, if any, is also set as the deadline of its
+ * gRPC call, unless sent on a stream or in a batch.
+ *
+ * The object can also be used to schedule the execution of a function after
+ * a given delay, without blocking the caller.
+ *
+ * Upon shutdown the operations in progress are cancelled: the callbacks of
+ * the requests are invoked with an error, while the functions of the timers
+ * are not invoked at all. No new operation can be started afterwards.
+ */
+class EdgeClientAsync final
+{
+  // Base class of the operations pending on the completion queue.
+  struct Tag {
+    virtual ~Tag() {
+    }
+    //! Called upon completion, deallocates the tag itself if needed.
+    virtual void proceed(const bool aOk) = 0;
+  };
+
+  struct Call;
+  struct BatchCall;
+  struct Timer;
+  struct Stream;
+
+  // Stubs to reach a destination through the same channel.
+  struct Stubs {
+    std::shared_ptr<grpc::Channel>         theChannel;
+    std::unique_ptr<rpc::EdgeServer::Stub> theStub;
+    std::unique_ptr<grpc::GenericStub>     theGenericStub;
+    Stream*                                theStream = nullptr;
+  };
+
+ public:
+  /**
+   * Function called with the lambda response and the time elapsed since the
+   * request was issued, in fractional seconds.
+   */
+  using Callback = std::function<void(LambdaResponse&&, double)>;
+
+  /**
+   * Function called with the lambda responses to a batch of requests, in the
+   * same order, and the time elapsed since the batch was issued, in
+   * fractional seconds.
+   */
+  using BatchCallback =
+      std::function<void(std::vector<LambdaResponse>&&, double)>;
+
+  /**
+   * Function called upon expiry of a timer, with true, or when the timer is
+   * discarded because the client is shut down, with false.
+   */
+  using Timeout = std::function<void(const bool aExpired)>;
+
+  NONCOPYABLE_NONMOVABLE(EdgeClientAsync);
+
+  /**
+   * \param aNumThreads The number of threads serving the completion queue.
+   *
+   * \param aStreaming If true send the requests on streams.
+   *
+   * \throw std::runtime_error if aNumThreads is zero.
+   */
+  explicit EdgeClientAsync(const size_t aNumThreads,
+                           const bool   aStreaming = false);
+
+  ~EdgeClientAsync();
+
+  /**
+   * Cancel the operations in progress and wait until all their callbacks
+   * have returned. Called by the dtor if not called before.
+   */
+  void shutdown();
+
+  /**
+   * Create the channel to a destination, unless it exists already, and
+   * start connecting it without waiting.
+   *
+   * \param aDestination The edge computer end-point.
+   */
+  void warm(const std::string& aDestination);
+
+  /**
+   * Release the channel to a destination, which is closed when the calls in
+   * progress are complete. The stream to the destination, if any, is
+   * cancelled instead.
+   *
+   * \param aDestination The edge computer end-point.
+   */
+  void close(const std::string& aDestination);
+
+  /**
+   * Execute a lambda on a given destination, without waiting for the response.
+   *
+   * \param aDestination The edge computer end-point.
+   * \param aReq The lambda request, which is sent with one more hop.
+   * \param aDry If true do not actually execute the lambda function.
+   * \param aCallback The function called exactly once with the response,
+   * which contains the error in its return code if the execution failed. The
+   * responder is set to the destination, if the response does not contain it.
+   *
+   * \throw std::runtime_error if the client has been shut down.
+   */
+  void RunLambda(const std::string&   aDestination,
+                 const LambdaRequest& aReq,
+                 const bool           aDry,
+                 Callback&&           aCallback);
+
+  /**
+   * Forward a lambda request received from another edge node to a given
+   * destination, without waiting for the response.
+   *
+   * The request is serialized as it is, and the hops, forward, and dry
+   * fields are then overridden by appending their new values to the
+   * serialized message, so that the content of the request is never copied
+   * except for its serialization.
+   *
+   * \param aDestination The edge computer end-point.
+   * \param aReq The lambda request, which must remain valid until this
+   * method returns and is sent with one more hop and the forward flag set.
+   * \param aDry If true do not actually execute the lambda function.
+   * \param aCallback The function called exactly once with the response,
+   * with the same semantics as in RunLambda().
+   * \param aTimeout If positive, the call fails after this time, in
+   * fractional seconds, unless the deadline of the request expires earlier.
+   * Not enforced in streaming mode.
+   *
+   * \throw std::runtime_error if the client has been shut down.
+   */
+  void ForwardLambda(const std::string&        aDestination,
+                     const rpc::LambdaRequest& aReq,
+                     const bool                aDry,
+                     Callback&&                aCallback,
+                     const double              aTimeout = 0);
+
+  /**
+   * Forward a batch of lambda requests received from other edge nodes to a
+   * given destination with a single call, without waiting for the responses.
+   *
+   * Every request is passed through as in ForwardLambda(). The batch is
+   * always sent with a unary call, even in streaming mode.
+   *
+   * \param aDestination The edge computer end-point.
+   * \param aReqs The lambda requests, which must remain valid until this
+   * method returns.
+   * \param aDry If true do not actually execute the lambda functions.
+   * \param aCallback The function called exactly once with the responses.
+   * If the call failed, then every response contains the error in its
+   * return code.
+   *
+   * \throw std::runtime_error if the client has been shut down.
+   */
+  void ForwardLambdaBatch(
+      const std::string&                            aDestination,
+      const std::vector<const rpc::LambdaRequest*>& aReqs,
+      const bool                                    aDry,
+      BatchCallback&&                               aCallback);
+
+  /**
+   * Execute a function after a given delay. The function is always called
+   * exactly once: if the client is shut down in the meanwhile, or it has
+   * been already, then it is called with false, possibly from within this
+   * method.
+   *
+   * \param aDelay The delay, in fractional seconds.
+   * \param aTimeout The function to be called upon expiry of the timer.
+   */
+  void schedule(const double aDelay, Timeout&& aTimeout);
+
+ private:
+  /**
+   * \return the stubs of a given destination, which are created if needed.
+   *
+   * Must be called with theMutex held.
+   */
+  Stubs& lookup(const std::string& aDestination);
+
+  //! Send a serialized request on the stream of a given destination.
+  void send(const std::string& aDestination,
+            const uint64_t     aId,
+            grpc::ByteBuffer&& aBuffer,
+            Callback&&         aCallback);
+
+  //! Stop using a stream for new requests, since it is broken.
+  void retire(Stream* aStream);
+
+  /**
+   * \throw std::runtime_error if the client has been shut down.
+   *
+   * Must be called with theMutex held.
+   */
+  void checkRunning() const;
+
+  //! Forget a call that is not in progress anymore.
+  void done(grpc::ClientContext* aContext);
+
+  //! Forget a timer that is not pending anymore.
+  void done(grpc::Alarm* aAlarm);
+
+  //! Thread execution body.
+  void poll();
+
+ private:
+  const bool                   theStreaming;
+  std::atomic<uint64_t>        theNextId;
+  std::mutex                   theMutex;
+  std::condition_variable      theStreamsCond;
+  std::map<std::string, Stubs> theStubs;
+  std::unordered_set<Stream*>  theStreams; // not retired yet
+  bool                         theStopping;
+
+  // calls and timers in progress, cancelled upon shutdown
+  std::unordered_set<grpc::ClientContext*> theCalls;
+  std::unordered_set<grpc::Alarm*>         theTimers;
+
+  grpc::CompletionQueue  theCq;
+  std::list<std::thread> thePollers;
+};
+
+} // namespace edge
+} // namespace uiiit
@@ -57,7 +57,9 @@ EdgeClientFactory::make(const std::set<std::string>& aEndpoints,
   const auto myType = aConf("type");
   if (aEndpoints.size() == 1) {
     if (myType == "grpc") {
-      return std::make_unique<EdgeClientGrpc>(*aEndpoints.begin());
+      return std::make_unique<EdgeClientGrpc>(
+          *aEndpoints.begin(),
+          aConf.count("streaming") > 0 and aConf.getBool("streaming"));
 #ifdef WITH_QUIC
     } else if (myType == "quic") {
       return std::make_unique<EdgeClientQuic>(
@@ -48,6 +48,16 @@ class EdgeClientInterface;
 class EdgeClientFactory final
 {
  public:
+  /**
+   * Create an edge client.
+   *
+   * \param aEndpoints The destinations: if more than one, then an
+   * EdgeClientMulti is returned.
+   *
+   * \param aConf The configuration. With type=grpc the optional key
+   * streaming=true sends the requests on a stream rather than with unary
+   * calls.
+   */
   static std::unique_ptr<EdgeClientInterface>
   make(const std::set<std::string>& aEndpoints, const support::Conf& aConf);
 }; // end class EdgeClient
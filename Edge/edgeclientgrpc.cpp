@@ -36,28 +36,198 @@ SOFTWARE.
 #include <glog/logging.h>
 #include <grpc++/grpc++.h>
 
+#include <cassert>
+#include <chrono>
+
 namespace uiiit {
 namespace edge {
 
-EdgeClientGrpc::EdgeClientGrpc(const std::string& aServerEndpoint)
+EdgeClientGrpc::EdgeClientGrpc(const std::string& aServerEndpoint,
+                               const bool         aStreaming,
+                               const bool         aDedicated)
     : EdgeClientInterface()
-    , SimpleClient(aServerEndpoint) {
+    , SimpleClient(aServerEndpoint)
+    , theStreaming(aStreaming)
+    , theChannel()
+    , theStreamMutex()
+    , theStreamContext()
+    , theStream()
+    , theNextId(0)
+    , theWatchdogMutex()
+    , theWatchdogCond()
+    , theWatchdogArmed(false)
+    , theWatchdogStop(false)
+    , theWatchdogDeadline()
+    , theWatchdog() {
+  // by default gRPC channels with the same target and arguments share
+  // their connections through a global pool of subchannels
+  grpc::ChannelArguments myArgs;
+  if (aDedicated) {
+    myArgs.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  }
+  theChannel = grpc::CreateCustomChannel(
+      aServerEndpoint, grpc::InsecureChannelCredentials(), myArgs);
+  theStub = rpc::EdgeServer::NewStub(theChannel);
 }
 
 EdgeClientGrpc::~EdgeClientGrpc() {
-  // nihil
+  if (theWatchdog.joinable()) {
+    {
+      const std::lock_guard<std::mutex> myLock(theWatchdogMutex);
+      theWatchdogStop = true;
+    }
+    theWatchdogCond.notify_one();
+    theWatchdog.join();
+  }
+  if (theStream) {
+    theStream->WritesDone();
+    const auto myStatus = theStream->Finish();
+    LOG_IF(WARNING, not myStatus.ok())
+        << "stream to " << serverEndpoint()
+        << " closed with error: " << myStatus.error_message();
+  }
 }
 
 LambdaResponse EdgeClientGrpc::RunLambda(const LambdaRequest& aReq,
                                          const bool           aDry) {
   VLOG(3) << aReq;
 
-  rpc::LambdaResponse myRep;
-  grpc::ClientContext myContext;
-  auto                myReq = aReq.toProtobuf();
+  auto myReq = aReq.toProtobuf();
   myReq.set_dry(aDry);
-  rpc::checkStatus(theStub->RunLambda(&myContext, myReq, &myRep));
-  return LambdaResponse(myRep);
+  return call(myReq);
+}
+
+LambdaResponse EdgeClientGrpc::ForwardLambda(const rpc::LambdaRequest& aReq,
+                                             const bool                aDry) {
+  auto myReq = aReq;
+  myReq.set_hops(aReq.hops() + 1);
+  myReq.set_forward(true);
+  myReq.set_dry(aDry);
+  return call(myReq);
+}
+
+std::vector<LambdaResponse>
+EdgeClientGrpc::RunLambdaBatch(const std::vector<LambdaRequest>& aReqs,
+                               const bool                        aDry) {
+  rpc::LambdaRequestBatch myReqs;
+  myReqs.mutable_requests()->Reserve(aReqs.size());
+  for (const auto& myReq : aReqs) {
+    VLOG(3) << myReq;
+    auto& myMsg = *myReqs.add_requests();
+    myMsg       = myReq.toProtobuf();
+    myMsg.set_dry(aDry);
+  }
+
+  rpc::LambdaResponseBatch myReps;
+  grpc::ClientContext      myContext;
+  rpc::checkStatus(theStub->RunLambdaBatch(&myContext, myReqs, &myReps));
+  if (static_cast<size_t>(myReps.responses_size()) != aReqs.size()) {
+    throw std::runtime_error("Invalid number of responses in batch from " +
+                             serverEndpoint() + ": " +
+                             std::to_string(myReps.responses_size()) +
+                             " instead of " + std::to_string(aReqs.size()));
+  }
+
+  std::vector<LambdaResponse> ret;
+  ret.reserve(aReqs.size());
+  for (auto& myRep : *myReps.mutable_responses()) {
+    ret.emplace_back(std::move(myRep));
+  }
+  return ret;
+}
+
+bool EdgeClientGrpc::connect(const double aTimeout) {
+  assert(theChannel);
+  return theChannel->WaitForConnected(
+      std::chrono::system_clock::now() +
+      std::chrono::microseconds(static_cast<long>(0.5 + aTimeout * 1e6)));
+}
+
+LambdaResponse EdgeClientGrpc::call(rpc::LambdaRequest& aReq) {
+  rpc::LambdaResponse myRep;
+  if (not theStreaming) {
+    grpc::ClientContext myContext;
+    if (aReq.deadline() > 0) {
+      myContext.set_deadline(deadlineToTimePoint(aReq.deadline()));
+    }
+    rpc::checkStatus(theStub->RunLambda(&myContext, aReq, &myRep));
+    return LambdaResponse(std::move(myRep));
+  }
+
+  const std::lock_guard<std::mutex> myLock(theStreamMutex);
+  if (not theStream) {
+    theStreamContext = std::make_unique<grpc::ClientContext>();
+    theStream        = theStub->RunLambdaStream(theStreamContext.get());
+  }
+
+  aReq.set_id(++theNextId);
+  if (aReq.deadline() > 0) {
+    armWatchdog(deadlineToTimePoint(aReq.deadline()));
+  }
+  const auto myOk = theStream->Write(aReq) and theStream->Read(&myRep);
+  if (aReq.deadline() > 0) {
+    disarmWatchdog();
+  }
+
+  // after any error the stream is closed, and re-opened at the next call
+  if (not myOk) {
+    rpc::checkStatus(closeStream(false));
+    throw std::runtime_error("Stream closed by " + serverEndpoint());
+  }
+  if (myRep.id() != aReq.id()) {
+    closeStream(true);
+    throw std::runtime_error("Unexpected response from " + serverEndpoint() +
+                             " with id " + std::to_string(myRep.id()) +
+                             " (expected " + std::to_string(aReq.id()) + ")");
+  }
+  return LambdaResponse(std::move(myRep));
+}
+
+grpc::Status EdgeClientGrpc::closeStream(const bool aCancel) {
+  assert(theStream);
+  if (aCancel) {
+    // do not wait for the server to close a stream in an unknown state
+    theStreamContext->TryCancel();
+  }
+  const auto myStatus = theStream->Finish();
+  theStream.reset();
+  theStreamContext.reset();
+  return myStatus;
+}
+
+void EdgeClientGrpc::armWatchdog(const TimePoint& aDeadline) {
+  {
+    const std::lock_guard<std::mutex> myLock(theWatchdogMutex);
+    if (not theWatchdog.joinable()) {
+      theWatchdog = std::thread([this]() { watchdog(); });
+    }
+    theWatchdogArmed    = true;
+    theWatchdogDeadline = aDeadline;
+  }
+  theWatchdogCond.notify_one();
+}
+
+void EdgeClientGrpc::disarmWatchdog() {
+  const std::lock_guard<std::mutex> myLock(theWatchdogMutex);
+  theWatchdogArmed = false;
+}
+
+void EdgeClientGrpc::watchdog() {
+  std::unique_lock<std::mutex> myLock(theWatchdogMutex);
+  while (not theWatchdogStop) {
+    if (not theWatchdogArmed) {
+      theWatchdogCond.wait(myLock);
+    } else if (std::chrono::system_clock::now() < theWatchdogDeadline) {
+      theWatchdogCond.wait_until(myLock, theWatchdogDeadline);
+    } else {
+      // the blocking call in progress returns with an error
+      VLOG(2) << "cancelling the stream to " << serverEndpoint()
+              << " upon deadline expiry";
+      assert(theStreamContext);
+      theStreamContext->TryCancel();
+      theWatchdogArmed = false;
+    }
+  }
 }
 
 } // namespace edge
@@ -35,22 +35,107 @@ SOFTWARE.
 #include "Edge/edgemessages.h"
 #include "RpcSupport/simpleclient.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
 
+/**
+ * Edge client using gRPC.
+ *
+ * The deadline of a request, if any, is also set as the deadline of its
+ * gRPC call.
+ *
+ * In streaming mode the requests are sent on a bidirectional stream, which
+ * is opened upon the first request and kept open until the object is
+ * destroyed or an error occurs. Calls are serialized, i.e., only one
+ * request at a time is pending on the stream. Since the messages on a stream
+ * cannot have their own deadlines, a watchdog thread, started with the first
+ * request that has a deadline, cancels the stream if the response does not
+ * arrive in time.
+ *
+ * Otherwise, the object can be used by multiple threads at the same time,
+ * whose calls are multiplexed on the same channel.
+ */
 class EdgeClientGrpc final : public EdgeClientInterface,
                              public rpc::SimpleClient<rpc::EdgeServer>
 {
+  using Stream =
+      grpc::ClientReaderWriter<rpc::LambdaRequest, rpc::LambdaResponse>;
+
  public:
   /**
    * \param aServerEndpoint the edge server
+   * \param aStreaming true to send the requests on a stream
+   * \param aDedicated true to open a connection to the edge server that is
+   * not shared with the other clients in the same process
    */
-  explicit EdgeClientGrpc(const std::string& aServerEndpoint);
+  explicit EdgeClientGrpc(const std::string& aServerEndpoint,
+                          const bool         aStreaming = false,
+                          const bool         aDedicated = false);
   ~EdgeClientGrpc() override;
 
   LambdaResponse RunLambda(const LambdaRequest& aReq, const bool aDry) override;
+
+  //! Forward the request as a copy of the protobuf message received.
+  LambdaResponse ForwardLambda(const rpc::LambdaRequest& aReq,
+                               const bool                aDry) override;
+
+  //! Send all the requests with a single call, also in streaming mode.
+  std::vector<LambdaResponse>
+  RunLambdaBatch(const std::vector<LambdaRequest>& aReqs,
+                 const bool                        aDry) override;
+
+  /**
+   * Connect to the edge server, if not already connected.
+   *
+   * \param aTimeout The maximum time to wait for the connection, in s.
+   *
+   * \return true if the connection is ready.
+   */
+  bool connect(const double aTimeout);
+
+ private:
+  using TimePoint = std::chrono::system_clock::time_point;
+
+  //! Send a request and wait for its response.
+  LambdaResponse call(rpc::LambdaRequest& aReq);
+
+  //! Close the stream, which must exist, and \return its status.
+  grpc::Status closeStream(const bool aCancel);
+
+  //! Cancel the stream at the given time, unless disarmed before.
+  void armWatchdog(const TimePoint& aDeadline);
+
+  //! Do not cancel the stream anymore.
+  void disarmWatchdog();
+
+  //! Thread body of the watchdog.
+  void watchdog();
+
+ private:
+  const bool                           theStreaming;
+  std::shared_ptr<grpc::Channel>       theChannel;
+  std::mutex                           theStreamMutex;
+  std::unique_ptr<grpc::ClientContext> theStreamContext;
+  std::unique_ptr<Stream>              theStream;
+  uint64_t                             theNextId;
+
+  // only in streaming mode, the context of the stream must not be changed
+  // while the watchdog is armed
+  std::mutex              theWatchdogMutex;
+  std::condition_variable theWatchdogCond;
+  bool                    theWatchdogArmed;
+  bool                    theWatchdogStop;
+  TimePoint               theWatchdogDeadline;
+  std::thread             theWatchdog;
 }; // end class EdgeClientGrpc
 
 } // end namespace edge
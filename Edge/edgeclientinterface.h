@@ -34,6 +34,8 @@ SOFTWARE.
 #include "Support/macros.h"
 #include "edgemessages.h"
 
+#include <vector>
+
 namespace uiiit {
 namespace edge {
 
@@ -57,6 +59,43 @@ class EdgeClientInterface
    */
   virtual LambdaResponse RunLambda(const LambdaRequest& aReq,
                                    const bool           aDry) = 0;
+
+  /**
+   * Forward a lambda request received from another edge node, with one more
+   * hop and the forward flag set.
+   *
+   * The default implementation converts the message into a LambdaRequest,
+   * which can be overridden by clients that are able to pass the protobuf
+   * message through without materializing its content.
+   *
+   * \param aReq The lambda function request received.
+   * \param aDry if true do not actually execute the lambda
+   */
+  virtual LambdaResponse ForwardLambda(const rpc::LambdaRequest& aReq,
+                                       const bool                aDry) {
+    return RunLambda(LambdaRequest(aReq).makeOneMoreHop(), aDry);
+  }
+
+  /**
+   * Execute a batch of independent lambda requests.
+   *
+   * The default implementation executes the requests one by one, which can
+   * be overridden by clients that are able to send the whole batch at once.
+   *
+   * \param aReqs The lambda function requests.
+   * \param aDry if true do not actually execute the lambdas
+   *
+   * \return the responses, in the same order as the requests.
+   */
+  virtual std::vector<LambdaResponse>
+  RunLambdaBatch(const std::vector<LambdaRequest>& aReqs, const bool aDry) {
+    std::vector<LambdaResponse> ret;
+    ret.reserve(aReqs.size());
+    for (const auto& myReq : aReqs) {
+      ret.emplace_back(RunLambda(myReq, aDry));
+    }
+    return ret;
+  }
 }; // end class EdgeClientInterface
 
 } // end namespace edge
@@ -31,8 +31,8 @@ SOFTWARE.
 
 #include "edgeclientmulti.h"
 
-#include "Edge/edgeclientfactory.h"
-#include "Edge/edgeclientgrpc.h"
+#include "Edge/deadline.h"
+#include "RpcSupport/utils.h"
 #include "Support/random.h"
 #include "Support/tostring.h"
 
@@ -41,6 +41,8 @@ SOFTWARE.
 #endif
 
 #include <cassert>
+#include <condition_variable>
+#include <list>
 #include <stdexcept>
 
 #include <glog/logging.h>
@@ -48,16 +50,112 @@ SOFTWARE.
 namespace uiiit {
 namespace edge {
 
+/**
+ * State shared by the replicas of a lambda request, which is kept alive
+ * until the last of the calls has completed, possibly after the caller has
+ * already returned.
+ */
+struct EdgeClientMulti::Multicast final {
+  explicit Multicast(const size_t aPending)
+      : theMutex()
+      , theCond()
+      , thePending(aPending)
+      , theDone(false)
+      , theWinner(0)
+      , theResponse()
+      , theCalls() {
+    // noop
+  }
+
+  std::mutex                      theMutex;
+  std::condition_variable         theCond;
+  size_t                          thePending;
+  bool                            theDone; // true if a good response arrived
+  size_t                          theWinner;
+  std::unique_ptr<LambdaResponse> theResponse; // good or last bad response
+  std::list<Call*>                theCalls;    // still pending
+};
+
+//! A gRPC call towards one of the destinations.
+struct EdgeClientMulti::Call final {
+  explicit Call(const size_t                      aIndex,
+                const std::string&                aEndpoint,
+                const std::shared_ptr<Multicast>& aMulticast)
+      : theIndex(aIndex)
+      , theEndpoint(aEndpoint)
+      , theMulticast(aMulticast)
+      , theContext()
+      , theResponse()
+      , theStatus()
+      , theReader() {
+    // noop
+  }
+
+  //! Called upon completion, deallocates the call itself.
+  void proceed(const bool aOk) {
+    std::unique_ptr<LambdaResponse> myResp;
+    try {
+      if (not aOk) {
+        throw std::runtime_error("Invalid event");
+      }
+      rpc::checkStatus(theStatus);
+      myResp = std::make_unique<LambdaResponse>(std::move(theResponse));
+      myResp->theResponder = theEndpoint;
+    } catch (const std::exception& aErr) {
+      // cancelled calls end up here, too
+      VLOG(2) << "call to " << theEndpoint << " failed: " << aErr.what();
+    }
+
+    auto& myMulticast = *theMulticast;
+    {
+      const std::lock_guard<std::mutex> myLock(myMulticast.theMutex);
+      myMulticast.theCalls.remove(this);
+      assert(myMulticast.thePending > 0);
+      myMulticast.thePending--;
+
+      if (myMulticast.theDone) {
+        VLOG_IF(2, myResp) << "non-fastest executor " << theEndpoint
+                           << " replied with " << myResp->toString();
+
+      } else if (myResp and myResp->theRetCode == "OK") {
+        // the calls still pending can be cancelled: the remaining replicas
+        // are then aborted on the executors, too
+        myMulticast.theDone     = true;
+        myMulticast.theWinner   = theIndex;
+        myMulticast.theResponse = std::move(myResp);
+        for (const auto myCall : myMulticast.theCalls) {
+          myCall->theContext.TryCancel();
+        }
+
+      } else if (myResp) {
+        myMulticast.theResponse = std::move(myResp);
+      }
+    }
+    myMulticast.theCond.notify_one();
+
+    delete this;
+  }
+
+  using Reader = grpc::ClientAsyncResponseReader<rpc::LambdaResponse>;
+
+  const size_t                     theIndex;
+  const std::string                theEndpoint;
+  const std::shared_ptr<Multicast> theMulticast;
+  grpc::ClientContext              theContext;
+  rpc::LambdaResponse              theResponse;
+  grpc::Status                     theStatus;
+  std::unique_ptr<Reader>          theReader;
+};
+
 EdgeClientMulti::EdgeClientMulti(const std::set<std::string>& aServerEndpoints,
                                  const support::Conf&         aClientConf)
     : EdgeClientInterface()
     , thePersistenceProb(aClientConf.getDouble("persistence"))
+    , theGrpc(aClientConf("type") == "grpc")
     , theDesc(aServerEndpoints.size())
-    , theConsumer()
-    , theConsumerQueue()
-    , theQueueOut()
-    , thePendingRequest(nullptr)
-    , thePrimary(0) {
+    , thePrimary(0)
+    , theCq()
+    , thePoller() {
   if (aClientConf.getDouble("persistence") < 0 or
       aClientConf.getDouble("persistence") > 1) {
     throw std::runtime_error(
@@ -70,16 +168,16 @@ EdgeClientMulti::EdgeClientMulti(const std::set<std::string>& aServerEndpoints,
     throw std::runtime_error("Empty set of destinations");
   }
 
-  // start executors
+  // create the stubs or clients
   size_t     i            = 0;
   const auto myClientType = aClientConf("type");
   for (const auto& myEndpoint : aServerEndpoints) {
     auto& myDesc       = theDesc[i];
-    myDesc.theIndex    = i;
     myDesc.theEndpoint = myEndpoint;
 
     if (myClientType == "grpc") {
-      myDesc.theClient.reset(new EdgeClientGrpc(myEndpoint));
+      myDesc.theStub = rpc::EdgeServer::NewStub(
+          grpc::CreateChannel(myEndpoint, grpc::InsecureChannelCredentials()));
 #ifdef WITH_QUIC
     } else if (myClientType == "quic") {
       myDesc.theClient.reset(new EdgeClientQuic(
@@ -88,25 +186,14 @@ EdgeClientMulti::EdgeClientMulti(const std::set<std::string>& aServerEndpoints,
     } else {
       throw std::runtime_error("Unknown client type: " + myClientType);
     }
-
-    myDesc.theThread = std::thread([this, &myDesc]() {
-      while (execLambda(myDesc)) {
-        // do nothing
-      }
-    });
     i++;
   }
   assert(theDesc.size() == aServerEndpoints.size());
 
-  // start consumer
-  theConsumer = std::thread([this]() {
-    while (consume()) {
-      // do nothing
-    }
-  });
-
-  // unblock the calling thread upon first lambda call
-  theCallingQueue.push(true);
+  // start the poller of the completion queue
+  if (theGrpc) {
+    thePoller = std::thread([this]() { poll(); });
+  }
 
   LOG(INFO) << "starting an edge multi-client towards ["
             << toString(aServerEndpoints, ",")
@@ -115,160 +202,125 @@ EdgeClientMulti::EdgeClientMulti(const std::set<std::string>& aServerEndpoints,
 }
 
 EdgeClientMulti::~EdgeClientMulti() {
-  // force termination of the consumer thread
-  theConsumerQueue.push({});
-
-  // force termination of the calling thread
-  theCallingQueue.push(false);
-
-  // force termination of the executors
-  for (auto& myDesc : theDesc) {
-    myDesc.theQueueIn.push(MessageIn());
-  }
-
-  // join threads
-  assert(theConsumer.joinable());
-  theConsumer.join();
-  for (auto& myDesc : theDesc) {
-    assert(myDesc.theThread.joinable());
-    myDesc.theThread.join();
-  }
-}
-
-bool EdgeClientMulti::consume() {
-  // get the set of pending clients
-  auto myPending = theConsumerQueue.pop();
-
-  // empty set means we are terminating
-  if (myPending.empty()) {
-    return false;
-  }
-
-  // wait for all edge clients to return
-  while (not myPending.empty()) {
-    auto myResponse = theQueueOut.pop();
-
-    VLOG_IF(2, myResponse) << "non-fastest executor "
-                           << theDesc[myResponse.theIndex].theEndpoint
-                           << " replied with "
-                           << myResponse.theResponse->toString();
-
-    assert(myPending.count(myResponse.theIndex) == 1);
-    myPending.erase(myResponse.theIndex);
-  }
-
-  // unblock the calling thread when done
-  theCallingQueue.push(true);
-
-  return true; // go on buddy
-}
-
-bool EdgeClientMulti::execLambda(Desc& aDesc) {
-  try {
-    // wait for a new lambda request to arrive
-    const auto myMessageIn = aDesc.theQueueIn.pop();
-
-    // if the lambda request is empty then we are terminating
-    if (not myMessageIn) {
-      return false;
-    }
-
-    // execute the lambda request and push the message
-    try {
-      theQueueOut.push(MessageOut(
-          aDesc.theIndex,
-          std::make_unique<LambdaResponse>(aDesc.theClient->RunLambda(
-              *myMessageIn.theRequest, myMessageIn.theDry))));
-    } catch (...) {
-      // an error occurred, we push an empty response
-      // to be handled by the other threads in this object
-      theQueueOut.push(MessageOut(aDesc.theIndex));
-    }
-
-  } catch (const support::QueueClosed&) {
-    // communication channel has been closed, we must terminate
-    return false;
+  // the calls still pending, if any, have been cancelled already, unless
+  // none of them has succeeded yet, so they are drained quickly
+  theCq.Shutdown();
+  if (thePoller.joinable()) {
+    thePoller.join();
+  } else {
+    poll(); // the queue must be drained anyway
   }
-  return true;
 }
 
 LambdaResponse EdgeClientMulti::RunLambda(const LambdaRequest& aReq,
                                           const bool           aDry) {
-  // wait until the consumer is done
-  const auto myGoAhead = theCallingQueue.pop();
-  if (not myGoAhead) {
-    return LambdaResponse("terminating", "");
-  }
-
   // find which clients should be reached in addition to the primary
   // destination
-  auto myPending = secondary();
-
-  // reach out for the primary, too
-  myPending.insert(thePrimary);
+  auto myDestinations = secondary();
 
-  // create a local copy of the lambda request, which may not survive
-  // when this function returns (but some threads may still use it)
-  thePendingRequest = std::make_unique<LambdaRequest>(aReq.copy());
+  if (theGrpc) {
+    auto myReq = aReq.toProtobuf();
+    myReq.set_dry(aDry);
+    return multicast(myReq, myDestinations);
+  }
+  return sequential(aReq, aDry, myDestinations);
+}
 
-  // unblock the selected clients
-  assert(not myPending.empty());
-  for (const auto ndx : myPending) {
-    assert(thePendingRequest.get() != nullptr);
-    theDesc[ndx].theQueueIn.push(MessageIn(thePendingRequest.get(), aDry));
+LambdaResponse
+EdgeClientMulti::multicast(const rpc::LambdaRequest& aReq,
+                           const std::set<size_t>&   aDestinations) {
+  const auto myPrimary   = thePrimary.load();
+  const auto myMulticast =
+      std::make_shared<Multicast>(aDestinations.size() + 1);
+
+  // create all the calls before starting any, so that the first good
+  // response can cancel all the others
+  std::vector<Call*> myCalls;
+  myCalls.reserve(aDestinations.size() + 1);
+  myCalls.emplace_back(
+      new Call(myPrimary, theDesc[myPrimary].theEndpoint, myMulticast));
+  for (const auto ndx : aDestinations) {
+    assert(ndx != myPrimary);
+    myCalls.emplace_back(new Call(ndx, theDesc[ndx].theEndpoint, myMulticast));
   }
+  myMulticast->theCalls.assign(myCalls.begin(), myCalls.end());
 
-  // wait for the fastest client
-  MessageOut myFastest(thePrimary);
-  while (not myPending.empty()) {
-    myFastest = theQueueOut.pop();
-    assert(myPending.count(myFastest.theIndex) == 1);
-    myPending.erase(myFastest.theIndex);
-    if (myFastest and myFastest.theResponse->theRetCode == "OK") {
-      // good response, we may proceed after recording who responded
-      myFastest.theResponse->theResponder =
-          theDesc[myFastest.theIndex].theEndpoint;
-      break;
+  // the calls are deallocated upon completion, and the request is
+  // serialized when each of them is started
+  for (const auto myCall : myCalls) {
+    if (aReq.deadline() > 0) {
+      myCall->theContext.set_deadline(deadlineToTimePoint(aReq.deadline()));
     }
+    myCall->theReader = theDesc[myCall->theIndex].theStub->AsyncRunLambda(
+        &myCall->theContext, aReq, &theCq);
+    myCall->theReader->Finish(&myCall->theResponse, &myCall->theStatus, myCall);
   }
 
+  // wait for the first good response or for all the calls to fail
+  std::unique_lock<std::mutex> myLock(myMulticast->theMutex);
+  myMulticast->theCond.wait(myLock, [&myMulticast]() {
+    return myMulticast->theDone or myMulticast->thePending == 0;
+  });
+
   // none of the destinations worked out
-  if (not myFastest) {
-    assert(myPending.empty());
-    theCallingQueue.push(true);
+  if (not myMulticast->theResponse) {
+    assert(myMulticast->thePending == 0);
     return LambdaResponse("none of the destinations responded correctly", "");
   }
 
   // only non-OK responses
-  if (myFastest.theResponse->theRetCode != "OK") {
-    assert(myPending.empty());
-    theCallingQueue.push(true);
-    return *myFastest.theResponse;
-  }
-
-  // pass the pending set to the consumer only if it is non-empty
-  if (myPending.empty()) {
-    // do not wait at all
-    theCallingQueue.push(true);
-  } else {
-    theConsumerQueue.push(myPending);
+  if (not myMulticast->theDone) {
+    return *myMulticast->theResponse;
   }
 
   // the fastest executor becomes the new primary
-  thePrimary = myFastest.theIndex;
+  thePrimary = myMulticast->theWinner;
 
-  VLOG(2) << "fastest executor " << theDesc[myFastest.theIndex].theEndpoint
-          << " replied with " << myFastest.theResponse->toString();
+  VLOG(2) << "fastest executor "
+          << theDesc[myMulticast->theWinner].theEndpoint << " replied with "
+          << myMulticast->theResponse->toString();
 
-  // return the response while there may be other threads working
-  assert(myFastest.theResponse);
-  return *myFastest.theResponse;
+  return *myMulticast->theResponse;
 }
 
-std::set<size_t> EdgeClientMulti::secondary() {
+LambdaResponse
+EdgeClientMulti::sequential(const LambdaRequest&    aReq,
+                            const bool              aDry,
+                            const std::set<size_t>& aDestinations) {
+  std::vector<size_t> myOrder({thePrimary.load()});
+  myOrder.insert(myOrder.end(), aDestinations.begin(), aDestinations.end());
+
+  std::unique_ptr<LambdaResponse> myLast;
+  for (const auto ndx : myOrder) {
+    auto& myDesc = theDesc[ndx];
+    try {
+      const std::lock_guard<std::mutex> myLock(myDesc.theMutex);
+      assert(myDesc.theClient);
+      myLast = std::make_unique<LambdaResponse>(
+          myDesc.theClient->RunLambda(aReq, aDry));
+    } catch (const std::exception& aErr) {
+      VLOG(2) << "call to " << myDesc.theEndpoint
+              << " failed: " << aErr.what();
+      continue;
+    }
+    if (myLast->theRetCode == "OK") {
+      myLast->theResponder = myDesc.theEndpoint;
+      thePrimary           = ndx;
+      return *myLast;
+    }
+  }
+
+  if (not myLast) {
+    return LambdaResponse("none of the destinations responded correctly", "");
+  }
+  return *myLast;
+}
+
+std::set<size_t> EdgeClientMulti::secondary() const {
+  const auto       myPrimary = thePrimary.load();
   std::set<size_t> ret;
   for (size_t i = 0; i < theDesc.size(); i++) {
-    if (i == thePrimary) {
+    if (i == myPrimary) {
       continue;
     }
     if (support::random() < thePersistenceProb) {
@@ -278,5 +330,15 @@ std::set<size_t> EdgeClientMulti::secondary() {
   return ret;
 }
 
+void EdgeClientMulti::poll() {
+  void* myTag;
+  bool  myOk;
+  while (theCq.Next(&myTag, &myOk)) {
+    assert(myTag != nullptr);
+    static_cast<Call*>(myTag)->proceed(myOk);
+  }
+  VLOG(2) << "terminating";
+}
+
 } // namespace edge
 } // namespace uiiit
@@ -33,106 +33,50 @@ SOFTWARE.
 
 #include "Edge/edgeclientinterface.h"
 #include "Edge/edgemessages.h"
-#include "RpcSupport/simpleclient.h"
 #include "Support/conf.h"
-#include "Support/queue.h"
 
+#include <grpc++/grpc++.h>
+
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "edgeserver.grpc.pb.h"
+
 namespace uiiit {
 namespace edge {
 
-// forward declaration
-class EdgeClient;
-
 /**
  * An edge client that has multiple possible destinations.
  *
- * Objects of this class spawn N+1 threads, where N is the number of
- * destinations.
- *
- * Each of the N threads contains an EdgeClient that performs lambda requests
- * as dispatched by the calling thread.
+ * With gRPC, every lambda request is multicast to the primary destination
+ * and, possibly, to other secondary destinations through asynchronous calls
+ * issued on a completion queue, which is served by a single thread
+ * regardless of the number of destinations. Any number of callers can have
+ * their lambda requests in flight at the same time. As soon as the first
+ * good response is received, the calls still pending towards the other
+ * destinations are cancelled, so that the losing replicas do not keep
+ * running to completion.
  *
- * The +1 thread does the clean-up after the first EdgeClient has returned,
- * which makes the calling thread move on. The calling thread blocks if this
- * thread is still waiting for still-pending previous lambda requests.
+ * With other transports, which do not have an asynchronous interface, the
+ * destinations are instead tried one after the other, starting from the
+ * primary, until the first good response is received.
  */
 class EdgeClientMulti final : public EdgeClientInterface
 {
-  //! Message-passing structure from main thread to client threads.
-  struct MessageIn {
-    MOVEONLY(MessageIn);
-
-    //! Empty message for terminating.
-    explicit MessageIn()
-        : theRequest(nullptr)
-        , theDry(false) {
-      // nihil
-    }
-
-    /**
-     * \param aRequest pointer to the lambda request.
-     * \param aDry true if the lambda is not to be actually executed.
-     *
-     * \pre aRequest is not null.
-     */
-    explicit MessageIn(const LambdaRequest* aRequest, const bool aDry)
-        : theRequest(aRequest)
-        , theDry(aDry) {
-      assert(aRequest != nullptr);
-    }
-
-    operator bool() const noexcept {
-      return theRequest != nullptr;
-    }
-
-    const LambdaRequest* theRequest; // nullptr means terminating
-    bool                 theDry;
-  };
-
-  //! Message-passing structure from client threads to main thread.
-  struct MessageOut {
-    MOVEONLY(MessageOut);
-
-    //! Empty message for terminating.
-    explicit MessageOut(const size_t aIndex)
-        : theIndex(aIndex)
-        , theResponse(nullptr) {
-    }
-
-    /**
-     * \param aIndex The index of the client returning the response.
-     * \param aResponse The response returned.
-     *
-     * \pre aResponse is not null.
-     */
-    explicit MessageOut(const size_t                      aIndex,
-                        std::unique_ptr<LambdaResponse>&& aResponse)
-        : theIndex(aIndex)
-        , theResponse(std::move(aResponse)) {
-      assert(theResponse);
-    }
-
-    operator bool() const noexcept {
-      return theResponse.get() != nullptr;
-    }
-
-    size_t                          theIndex;
-    std::unique_ptr<LambdaResponse> theResponse; // nullptr means terminating
-  };
+  struct Call;
+  struct Multicast;
 
-  //! One per client connected.
+  //! One per destination.
   struct Desc {
-    size_t                               theIndex;
-    std::string                          theEndpoint;
-    std::unique_ptr<EdgeClientInterface> theClient;
-    support::Queue<MessageIn>            theQueueIn;
-    std::thread                          theThread;
+    std::string                            theEndpoint;
+    std::unique_ptr<rpc::EdgeServer::Stub> theStub;   // only with gRPC
+    std::unique_ptr<EdgeClientInterface>   theClient; // only without gRPC
+    std::mutex                             theMutex;  // serializes theClient
   };
 
  public:
@@ -156,9 +100,9 @@ class EdgeClientMulti final : public EdgeClientInterface
    * destination. Additionaly, depending on the policy used, it may also be sent
    * to other secondary executors.
    *
-   * This function returns after the first of the lambda responses is
-   * received. However, if the same function is called again, it blocks
-   * until the last of the lambda responses is received.
+   * This function returns after the first good lambda response is received,
+   * after cancelling the requests still pending. It can be called
+   * concurrently by multiple threads.
    *
    * If a connection error occurs or the executor replies with an
    * error code, the response is discarded if there are other pending
@@ -170,41 +114,29 @@ class EdgeClientMulti final : public EdgeClientInterface
   LambdaResponse RunLambda(const LambdaRequest& aReq, const bool aDry) override;
 
  private:
-  //! \return the smoothing factor for delay computation
-  static constexpr float alpha() {
-    return 0.05;
-  }
+  //! Multicast a lambda request with gRPC asynchronous calls.
+  LambdaResponse multicast(const rpc::LambdaRequest& aReq,
+                           const std::set<size_t>&   aDestinations);
 
-  //! Consumer body. When terminating returns false.
-  bool consume();
-
-  /**
-   * Lambda execution body.
-   *
-   * If waits for an incoming message in the Desc::theQueueIn, then try
-   * to execute the lambda via Desc::theClient; if something fails it
-   * pushes to Desc::theQueueOut an empty pointer, otherwise a newly
-   * created LambdaResponse object.
-   *
-   * \param aDesc The descriptor to be used by this thread.
-   *
-   * \return False when terminating, ie. Desc::theQueueIn is closed.
-   */
-  bool execLambda(Desc& aDesc);
+  //! Try the destinations one after the other, starting from the primary.
+  LambdaResponse sequential(const LambdaRequest&    aReq,
+                            const bool              aDry,
+                            const std::set<size_t>& aDestinations);
 
   //! \return the set of other destinations to be reached.
-  std::set<size_t> secondary();
+  std::set<size_t> secondary() const;
+
+  //! Thread execution body.
+  void poll();
 
  private:
   const float thePersistenceProb;
+  const bool  theGrpc;
 
-  std::vector<Desc>                    theDesc; // never modified after ctor
-  std::thread                          theConsumer;
-  support::Queue<std::set<size_t>>     theConsumerQueue;
-  support::Queue<bool>                 theCallingQueue;
-  support::Queue<MessageOut>           theQueueOut;
-  std::unique_ptr<const LambdaRequest> thePendingRequest;
-  size_t                               thePrimary;
+  std::vector<Desc>     theDesc; // never modified after ctor
+  std::atomic<size_t>   thePrimary;
+  grpc::CompletionQueue theCq;
+  std::thread           thePoller; // only with gRPC
 }; // end class EdgeClientMulti
 
 } // end namespace edge
@@ -32,6 +32,7 @@ SOFTWARE.
 #include "edgeclientpool.h"
 
 #include "Edge/edgeclientfactory.h"
+#include "Edge/edgeclientgrpc.h"
 #include "Support/chrono.h"
 #include "Support/conf.h"
 
@@ -43,30 +44,143 @@ SOFTWARE.
 namespace uiiit {
 namespace edge {
 
+EdgeClientPool::Channel::Channel(const std::string& aDestination)
+    : theClient(std::make_unique<EdgeClientGrpc>(
+          aDestination, false, true)) // not streaming, dedicated
+    , theCalls(0) {
+}
+
+EdgeClientPool::Channel::~Channel() {
+  // noop
+}
+
+EdgeClientPool::Channels::Channels(const std::string& aDestination,
+                                   const size_t       aSize)
+    : theChannels()
+    , theNext(0) {
+  assert(aSize > 0);
+  theChannels.reserve(aSize);
+  for (size_t i = 0; i < aSize; i++) {
+    theChannels.emplace_back(std::make_unique<Channel>(aDestination));
+  }
+}
+
 EdgeClientPool::EdgeClientPool(const support::Conf& aConf,
                                const size_t         aMaxClients)
     : theMaxClients(aMaxClients)
     , theMutex()
     , theConf(aConf)
-    , thePool() {
-  // noop
+    , thePool()
+    , theNumChannels(aConf.count("channels") > 0 ? aConf.getUint("channels") :
+                                                   0)
+    , theChunks()
+    , theWarmQueue()
+    , theWarmer()
+    , theWarming() {
+  if (theNumChannels > 0) {
+    if (aConf("type") != "grpc" or
+        (aConf.count("streaming") > 0 and aConf.getBool("streaming"))) {
+      throw std::runtime_error(
+          "Shared channels are only supported by non-streaming gRPC clients");
+    }
+    theChunks.reset(new std::atomic<Slot*>[numChunks()]());
+    LOG(INFO) << "edge client pool with " << theNumChannels
+              << " shared channels per destination";
+  }
+}
+
+EdgeClientPool::~EdgeClientPool() {
+  theWarmQueue.close();
+  if (theWarmer.joinable()) {
+    theWarmer.join();
+  }
+  if (theChunks) {
+    for (size_t i = 0; i < numChunks(); i++) {
+      delete[] theChunks[i].load();
+    }
+  }
+}
+
+void EdgeClientPool::warm(const std::string& aDestination) {
+  const auto myId = DestinationRegistry::instance().intern(aDestination);
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    if (not theWarmer.joinable()) {
+      theWarmer = std::thread([this]() { warmer(); });
+    }
+    if (not theWarming.emplace(myId).second) {
+      return; // already queued
+    }
+  }
+  theWarmQueue.push(myId);
+}
+
+void EdgeClientPool::close(const std::string& aDestination) {
+  DestinationId myId;
+  if (not DestinationRegistry::instance().find(aDestination, myId)) {
+    return; // never used
+  }
+
+  // do not connect if still in the queue of the destinations to be warmed
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    theWarming.erase(myId);
+  }
+
+  if (theNumChannels > 0) {
+    // the channels are destroyed, hence their connections closed, when the
+    // last call in progress releases them
+    std::atomic_store(&slot(myId), std::shared_ptr<Channels>());
+    VLOG(1) << "closed the shared channels to " << aDestination;
+    return;
+  }
+
+  // the clients are destroyed without holding the lock
+  std::list<std::unique_ptr<EdgeClientInterface>> myClients;
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    const auto                        it = thePool.find(myId);
+    if (it == thePool.end()) {
+      return;
+    }
+    myClients.swap(it->second.theFree);
+    if (it->second.theBusy == 0) {
+      thePool.erase(it);
+    } else {
+      // the clients busy now are dropped when released
+      it->second.theGeneration++;
+    }
+  }
+  VLOG(1) << "closed " << myClients.size() << " clients to " << aDestination;
 }
 
 std::pair<LambdaResponse, double>
 EdgeClientPool::operator()(const std::string&   aDestination,
                            const LambdaRequest& aReq,
                            const bool           aDry) {
+  return execute(aDestination, [&aReq, aDry](EdgeClientInterface& aClient) {
+    return aClient.RunLambda(aReq.makeOneMoreHop(), aDry);
+  });
+}
+
+std::pair<LambdaResponse, double>
+EdgeClientPool::operator()(const std::string&        aDestination,
+                           const rpc::LambdaRequest& aReq,
+                           const bool                aDry) {
+  return execute(aDestination, [&aReq, aDry](EdgeClientInterface& aClient) {
+    return aClient.ForwardLambda(aReq, aDry);
+  });
+}
+
+std::pair<LambdaResponse, double>
+EdgeClientPool::execute(const std::string& aDestination, const Call& aCall) {
   debugPrintPool();
 
   support::Chrono myChrono(true);
 
-  // obtain a client from the pool
-  std::unique_ptr<EdgeClientInterface> myClient = getClient(aDestination);
-  assert(myClient);
-
-  // execute the lambda function
-  const auto myReq  = aReq.makeOneMoreHop();
-  auto       myResp = myClient->RunLambda(myReq, aDry);
+  const auto myId   = DestinationRegistry::instance().intern(aDestination);
+  auto       myResp = theNumChannels > 0 ? executeShared(myId, aCall) :
+                                           executeExclusive(myId, aCall);
 
   // if the lambda does not include the actual responder then we set it to
   // the destination
@@ -74,14 +188,182 @@ EdgeClientPool::operator()(const std::string&   aDestination,
     myResp.theResponder = aDestination;
   }
 
-  // release the client to the pool
-  releaseClient(aDestination, std::move(myClient));
-
   return std::make_pair(myResp, myChrono.stop());
 }
 
+LambdaResponse
+EdgeClientPool::executeExclusive(const DestinationId aDestination,
+                                 const Call&         aCall) {
+  // obtain a client from the pool
+  size_t myGeneration = 0;
+  auto   myClient     = getClient(aDestination, myGeneration);
+  assert(myClient);
+
+  // execute the lambda function
+  // if the client throws, then it is dropped, but its slot is released
+  // anyway so that other calls to the same destination do not block forever
+  try {
+    auto myResp = aCall(*myClient);
+
+    // release the client to the pool
+    releaseClient(aDestination, myGeneration, std::move(myClient));
+
+    return myResp;
+  } catch (...) {
+    releaseClient(aDestination, myGeneration, nullptr);
+    throw;
+  }
+}
+
+LambdaResponse EdgeClientPool::executeShared(const DestinationId aDestination,
+                                             const Call&         aCall) {
+  // keep the channels alive until the call returns, even if closed
+  const auto myChannels = channels(aDestination);
+  assert(myChannels);
+  auto& myVector = myChannels->theChannels;
+  assert(not myVector.empty());
+
+  // select the channel with fewest calls in progress, starting from a
+  // different one every time so that ties are broken in a round-robin manner
+  const auto mySize  = myVector.size();
+  const auto myFirst = myChannels->theNext.fetch_add(1) % mySize;
+  auto       myBest  = myVector[myFirst].get();
+  auto       myCalls = myBest->theCalls.load();
+  for (size_t i = 1; i < mySize and myCalls > 0; i++) {
+    const auto myCur      = myVector[(myFirst + i) % mySize].get();
+    const auto myCurCalls = myCur->theCalls.load();
+    if (myCurCalls < myCalls) {
+      myBest  = myCur;
+      myCalls = myCurCalls;
+    }
+  }
+
+  // unlike the exclusive clients, the channel is kept even if the call
+  // throws, since gRPC re-establishes the connection as needed
+  myBest->theCalls++;
+  try {
+    auto myResp = aCall(*myBest->theClient);
+    myBest->theCalls--;
+    return myResp;
+  } catch (...) {
+    myBest->theCalls--;
+    throw;
+  }
+}
+
+std::shared_ptr<EdgeClientPool::Channels>
+EdgeClientPool::channels(const DestinationId aDestination) {
+  auto& mySlot     = slot(aDestination);
+  auto  myChannels = std::atomic_load(&mySlot);
+  if (not myChannels) {
+    // creating a channel does not connect to the destination yet
+    auto myNew = std::make_shared<Channels>(
+        DestinationRegistry::instance().name(aDestination), theNumChannels);
+    if (std::atomic_compare_exchange_strong(&mySlot, &myChannels, myNew)) {
+      myChannels = std::move(myNew);
+    }
+  }
+  assert(myChannels);
+  return myChannels;
+}
+
+std::shared_ptr<EdgeClientPool::Channels>&
+EdgeClientPool::slot(const DestinationId aDestination) {
+  assert(theChunks);
+  assert(aDestination / chunkSize() < numChunks());
+  auto& myChunk = theChunks[aDestination / chunkSize()];
+  auto  myPtr   = myChunk.load();
+  if (myPtr == nullptr) {
+    // allocate the chunk, unless another thread has done so in the meanwhile
+    auto myNew = new Slot[chunkSize()]();
+    if (myChunk.compare_exchange_strong(myPtr, myNew)) {
+      myPtr = myNew;
+    } else {
+      delete[] myNew;
+    }
+  }
+  return myPtr[aDestination % chunkSize()];
+}
+
+void EdgeClientPool::warmer() {
+  try {
+    while (true) {
+      connect(theWarmQueue.pop());
+    }
+  } catch (const support::QueueClosed&) {
+    // terminating
+  }
+}
+
+void EdgeClientPool::connect(const DestinationId aDestination) {
+  const auto& myDestination =
+      DestinationRegistry::instance().name(aDestination);
+
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    if (theWarming.count(aDestination) == 0) {
+      VLOG(2) << "not warming " << myDestination << ", closed in the meanwhile";
+      return;
+    }
+  }
+
+  // collect the gRPC clients whose connections must be established
+  std::vector<EdgeClientGrpc*>         myClients;
+  std::shared_ptr<Channels>            myChannels;
+  std::unique_ptr<EdgeClientInterface> myNewClient;
+  if (theNumChannels > 0) {
+    myChannels = channels(aDestination);
+    for (const auto& myChannel : myChannels->theChannels) {
+      myClients.emplace_back(myChannel->theClient.get());
+    }
+  } else {
+    {
+      // only create a client if there is none for this destination
+      const std::lock_guard<std::mutex> myLock(theMutex);
+      const auto                        it = thePool.find(aDestination);
+      if (it != thePool.end() and
+          (it->second.theBusy > 0 or not it->second.theFree.empty())) {
+        theWarming.erase(aDestination);
+        return;
+      }
+    }
+    myNewClient = EdgeClientFactory::make({myDestination}, theConf);
+    if (const auto myGrpc = dynamic_cast<EdgeClientGrpc*>(myNewClient.get())) {
+      myClients.emplace_back(myGrpc);
+    }
+  }
+
+  // start connecting all the clients without waiting, so that the
+  // connections are established in parallel, then wait for all of them
+  for (const auto myClient : myClients) {
+    myClient->connect(0);
+  }
+  size_t myReady = 0;
+  for (const auto myClient : myClients) {
+    if (myClient->connect(connectTimeout())) {
+      myReady++;
+    }
+  }
+  VLOG(1) << "warmed connections to " << myDestination << ": " << myReady
+          << " ready out of " << myClients.size();
+  LOG_IF(WARNING, myReady < myClients.size())
+      << "could not connect to " << myDestination << " within "
+      << connectTimeout() << " s";
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  // the client is dropped if the destination was closed while connecting
+  if (theWarming.erase(aDestination) > 0 and myNewClient) {
+    auto& myDesc = thePool[aDestination]; // may insert
+    if (myDesc.theBusy == 0 and myDesc.theFree.empty()) {
+      myDesc.theFree.emplace_back(std::move(myNewClient));
+      myDesc.theAvailableCond.notify_one();
+    }
+  }
+}
+
 std::unique_ptr<EdgeClientInterface>
-EdgeClientPool::getClient(const std::string& aDestination) {
+EdgeClientPool::getClient(const DestinationId aDestination,
+                          size_t&             aGeneration) {
   std::unique_lock<std::mutex> myLock(theMutex);
   auto&                        myDesc = thePool[aDestination]; // may insert
   if (theMaxClients > 0) {
@@ -89,11 +371,13 @@ EdgeClientPool::getClient(const std::string& aDestination) {
       return not myDesc.theFree.empty() or myDesc.theBusy < theMaxClients;
     });
   }
+  aGeneration = myDesc.theGeneration;
   if (myDesc.theFree.empty()) {
     assert(theMaxClients == 0 or myDesc.theBusy < theMaxClients);
     myDesc.theBusy++;
 
-    return EdgeClientFactory::make({aDestination}, theConf);
+    return EdgeClientFactory::make(
+        {DestinationRegistry::instance().name(aDestination)}, theConf);
   }
   assert(not myDesc.theFree.empty());
   std::unique_ptr<EdgeClientInterface> myNewClient;
@@ -104,11 +388,25 @@ EdgeClientPool::getClient(const std::string& aDestination) {
 }
 
 void EdgeClientPool::releaseClient(
-    const std::string&                     aDestination,
+    const DestinationId                    aDestination,
+    const size_t                           aGeneration,
     std::unique_ptr<EdgeClientInterface>&& aClient) {
+  // a client taken before the destination was closed is destroyed without
+  // holding the lock, i.e., after myLock is released
+  std::unique_ptr<EdgeClientInterface> myClosed;
+
   const std::lock_guard<std::mutex> myLock(theMutex);
   auto& myDesc = thePool[aDestination]; // may insert
-  myDesc.theFree.emplace_back(std::move(aClient));
+  if (aClient) {
+    if (aGeneration == myDesc.theGeneration) {
+      myDesc.theFree.emplace_back(std::move(aClient));
+    } else {
+      VLOG(2) << "dropping a client to "
+              << DestinationRegistry::instance().name(aDestination)
+              << " released after closing";
+      myClosed = std::move(aClient);
+    }
+  }
   myDesc.theBusy--;
   myDesc.theAvailableCond.notify_one();
 }
@@ -119,7 +417,8 @@ void EdgeClientPool::debugPrintPool() {
     std::stringstream                 myStr;
     size_t                            myCur = 0;
     for (const auto& myDesc : thePool) {
-      myStr << "\ndest " << myDesc.first << ", busy " << myDesc.second.theBusy
+      myStr << "\ndest " << DestinationRegistry::instance().name(myDesc.first)
+            << ", busy " << myDesc.second.theBusy
             << ", free " << myDesc.second.theFree.size();
       myCur += myDesc.second.theFree.size();
     }
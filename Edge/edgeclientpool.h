@@ -31,24 +31,51 @@ SOFTWARE.
 
 #pragma once
 
+#include "Edge/destinationregistry.h"
 #include "Edge/edgeclientinterface.h"
 #include "Edge/edgemessages.h"
 #include "Support/conf.h"
 #include "Support/macros.h"
+#include "Support/queue.h"
 
+#include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
 
+class EdgeClientGrpc;
+
 /**
  * A thread-safe pool of edge clients.
+ *
+ * The clients are indexed by the identifier of their destination in the
+ * DestinationRegistry.
+ *
+ * By default every call takes a client from the pool for its exclusive use,
+ * hence there are as many clients, each with its own connection, as the
+ * calls in progress towards a destination. If the edge client configuration
+ * has channels=C, with C > 0, then instead every destination is reached
+ * through C gRPC channels, each with its own connection, which are shared by
+ * all the calls as HTTP/2 streams: every call uses the channel with fewest
+ * calls in progress, without acquiring any lock after the channels have been
+ * created upon the first call to the destination. Shared channels are only
+ * supported with type=grpc and streaming disabled.
+ *
+ * The connections to a destination can be established in advance with
+ * warm(), e.g., as soon as the destination is announced, and closed with
+ * close() when it is not used anymore.
  */
 class EdgeClientPool
 {
@@ -56,14 +83,34 @@ class EdgeClientPool
     explicit Descriptor()
         : theFree()
         , theBusy(0)
+        , theGeneration(0)
         , theAvailableCond() {
     }
 
     std::list<std::unique_ptr<EdgeClientInterface>> theFree;
     size_t                                          theBusy;
+    // incremented by close() while some clients are busy
+    size_t                                          theGeneration;
     std::condition_variable                         theAvailableCond;
   };
 
+  //! Channel shared by multiple calls to the same destination.
+  struct Channel {
+    explicit Channel(const std::string& aDestination);
+    ~Channel();
+
+    const std::unique_ptr<EdgeClientGrpc> theClient;
+    std::atomic<size_t>                   theCalls; // in progress
+  };
+
+  //! Channels to a destination and index to break ties among them.
+  struct Channels {
+    explicit Channels(const std::string& aDestination, const size_t aSize);
+
+    std::vector<std::unique_ptr<Channel>> theChannels;
+    std::atomic<size_t>                   theNext;
+  };
+
  public:
   NONCOPYABLE_NONMOVABLE(EdgeClientPool);
 
@@ -73,10 +120,15 @@ class EdgeClientPool
    * \param aConf The edge client configuration.
    *
    * \param aMaxClients The maximum number of clients per destination. 0 means
-   * unlimited.
+   * unlimited. Unused with shared channels.
+   *
+   * \throw std::runtime_error if shared channels are requested with a client
+   * configuration that does not support them.
    */
   explicit EdgeClientPool(const support::Conf& aConf, const size_t aMaxClients);
 
+  ~EdgeClientPool();
+
   /**
    * Execute a lambda on a given edge computer identified by its end-point.
    *
@@ -93,20 +145,114 @@ class EdgeClientPool
                                                const LambdaRequest& aReq,
                                                const bool           aDry);
 
+  /**
+   * Create the connections to a destination, unless they exist already.
+   *
+   * This method is asynchronous: the connections are established by a
+   * background thread, which is started upon the first call.
+   *
+   * \param aDestination The edge computer end-point.
+   */
+  void warm(const std::string& aDestination);
+
+  /**
+   * Close the connections to a destination. The calls in progress are not
+   * interrupted, but their clients are not reused. The connections not yet
+   * established after a call to warm() are not established anymore.
+   *
+   * \param aDestination The edge computer end-point.
+   */
+  void close(const std::string& aDestination);
+
+  /**
+   * Forward a lambda request received from another edge node to a given
+   * edge computer, without converting it into a LambdaRequest.
+   *
+   * \param aDestination The edge computer end-point.
+   * \param aReq The lambda request, sent with one more hop.
+   * \param aDry If true do not actually execute the lambda function.
+   *
+   * \return the lambda response and the execution time.
+   */
+  std::pair<LambdaResponse, double> operator()(const std::string& aDestination,
+                                               const rpc::LambdaRequest& aReq,
+                                               const bool                aDry);
+
  private:
+  /**
+   * Take a client from the pool, or create a new one.
+   *
+   * \param aDestination The destination identifier.
+   * \param aGeneration Set to the generation of the destination, which must
+   * be passed to releaseClient().
+   */
   std::unique_ptr<EdgeClientInterface>
-  getClient(const std::string& aDestination);
+  getClient(const DestinationId aDestination, size_t& aGeneration);
 
-  void releaseClient(const std::string&                     aDestination,
+  /**
+   * Release a client taken with getClient(), which is dropped if null or if
+   * the destination has been closed since it was taken.
+   */
+  void releaseClient(const DestinationId                    aDestination,
+                     const size_t                           aGeneration,
                      std::unique_ptr<EdgeClientInterface>&& aClient);
 
+  using Call = std::function<LambdaResponse(EdgeClientInterface&)>;
+
+  //! Execute a lambda function on a client from the pool.
+  std::pair<LambdaResponse, double> execute(const std::string& aDestination,
+                                            const Call&        aCall);
+
+  //! Execute a lambda function on a client for exclusive use.
+  LambdaResponse executeExclusive(const DestinationId aDestination,
+                                  const Call&         aCall);
+
+  //! Execute a lambda function on the least loaded shared channel.
+  LambdaResponse executeShared(const DestinationId aDestination,
+                               const Call&         aCall);
+
+  //! \return the shared channels of a destination, created if needed.
+  std::shared_ptr<Channels> channels(const DestinationId aDestination);
+
+  //! \return the slot of the shared channels of a destination.
+  std::shared_ptr<Channels>& slot(const DestinationId aDestination);
+
+  //! Thread body establishing the connections to the destinations warmed.
+  void warmer();
+
+  //! Establish the connections to a destination.
+  void connect(const DestinationId aDestination);
+
   void debugPrintPool();
 
  private:
-  const size_t                      theMaxClients;
-  mutable std::mutex                theMutex;
-  const support::Conf               theConf;
-  std::map<std::string, Descriptor> thePool;
+  const size_t                                  theMaxClients;
+  mutable std::mutex                            theMutex;
+  const support::Conf                           theConf;
+  std::unordered_map<DestinationId, Descriptor> thePool;
+
+  // only with shared channels, allocated in chunks as needed, accessed
+  // with the atomic free functions of std::shared_ptr
+  using Slot = std::shared_ptr<Channels>;
+  const size_t                          theNumChannels;
+  std::unique_ptr<std::atomic<Slot*>[]> theChunks;
+
+  // only after the first call to warm()
+  support::Queue<DestinationId> theWarmQueue;
+  std::thread                   theWarmer;
+
+  // destinations warmed and not connected or closed yet, protected by
+  // theMutex
+  std::unordered_set<DestinationId> theWarming;
+
+  // static configuration
+  // clang-format off
+  static constexpr size_t chunkSize() { return 256; }
+  static constexpr double connectTimeout() { return 2; } // seconds
+  static constexpr size_t numChunks() {
+    return (DestinationRegistry::capacity() + chunkSize() - 1) / chunkSize();
+  }
+  // clang-format on
 };
 
 } // namespace edge
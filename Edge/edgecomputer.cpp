@@ -77,7 +77,7 @@ void EdgeComputer::AsyncWorker::operator()() {
 
         // send the response to the callback server indicated in the request
         CallbackClient myClient(myRequest.callback());
-        LambdaResponse myResponse(myResp);
+        LambdaResponse myResponse(std::move(myResp));
         myResponse.removePtimeLoad();
         VLOG(3) << "sending response to " << myRequest.callback() << ", "
                 << myResponse;
@@ -125,10 +125,12 @@ void EdgeComputer::AsyncWorker::operator()() {
         const auto myCompanionEndpoint =
             theParent.theCompanionClient->serverEndpoint();
 
-        // invoke all functions
+        // invoke all functions, which share the same output and data
+        const LambdaRequest  myCurRequest(std::move(myRequest));
+        const LambdaResponse myCurResponse(std::move(myResp));
         for (const auto& elem : myFunctions) {
-          const auto myNewRequest = LambdaRequest(myRequest).regenerate(
-              elem.second, elem.first, myResp);
+          const auto myNewRequest =
+              myCurRequest.regenerate(elem.second, elem.first, myCurResponse);
 
           // send the next request, we expect immediate async response
           VLOG(3) << "invoking next function on " << myCompanionEndpoint << ", "
@@ -330,6 +332,52 @@ rpc::LambdaResponse EdgeComputer::process(const rpc::LambdaRequest& aReq) {
   return myResp;
 }
 
+void EdgeComputer::processBatchAsync(const rpc::LambdaRequestBatch& aReqs,
+                                     BatchContinuation&& aContinuation) {
+  rpc::LambdaResponseBatch myResps;
+  myResps.mutable_responses()->Reserve(aReqs.requests_size());
+
+  // add the tasks of all the function executions without waiting
+  // key:   index in the batch
+  // value: task identifier
+  std::vector<std::pair<int, uint64_t>> myTasks;
+  for (int i = 0; i < aReqs.requests_size(); i++) {
+    const auto& myReq  = aReqs.requests(i);
+    auto&       myResp = *myResps.add_responses();
+    if (not plainExecution(myReq)) {
+      myResp = process(myReq);
+      continue;
+    }
+    VLOG(3) << LambdaRequest(myReq);
+    try {
+      myTasks.emplace_back(i, startExecution(myReq));
+    } catch (const std::exception& aErr) {
+      myResp.set_retcode(aErr.what());
+    } catch (...) {
+      myResp.set_retcode("Unknown error");
+    }
+    myResp.set_hops(myReq.hops() + 1);
+  }
+
+  // then collect the responses of the functions executed
+  for (const auto& elem : myTasks) {
+    const auto& myReq     = aReqs.requests(elem.first);
+    auto&       myResp    = *myResps.mutable_responses(elem.first);
+    std::string myRetCode = "OK";
+    try {
+      myResp = waitExecution(myReq, elem.second);
+    } catch (const std::exception& aErr) {
+      myRetCode = aErr.what();
+    } catch (...) {
+      myRetCode = "Unknown error";
+    }
+    myResp.set_hops(myReq.hops() + 1);
+    myResp.set_retcode(myRetCode);
+  }
+
+  aContinuation(std::move(myResps));
+}
+
 bool EdgeComputer::checkPreconditions(const rpc::LambdaRequest& aRequest) {
   // no DAG or single-function DAG or first function in a DAG: return now
   if (aRequest.dag().names_size() <= 1 or aRequest.nextfunctionindex() == 0) {
@@ -384,27 +432,44 @@ bool EdgeComputer::lastFunction(const rpc::LambdaRequest& aRequest) {
   return false;
 }
 
+bool EdgeComputer::plainExecution(const rpc::LambdaRequest& aRequest) {
+  return not aRequest.dry() and aRequest.callback().empty() and
+         aRequest.chain_size() == 0 and aRequest.dag().names_size() == 0;
+}
+
 std::string EdgeComputer::makeHash(const rpc::LambdaRequest& aRequest) {
   return std::to_string(aRequest.nextfunctionindex()) + "-" + aRequest.uuid();
 }
 
 rpc::LambdaResponse
 EdgeComputer::blockingExecution(const rpc::LambdaRequest& aReq) {
+  return waitExecution(aReq, startExecution(aReq));
+}
+
+uint64_t EdgeComputer::startExecution(const rpc::LambdaRequest& aReq) {
   // the task must be added outside the critical section below
   // to avoid deadlock due to a race condition on tasks
   // that are very short (and become completed before
   // a new descriptor is added to theDescriptors)
   const auto myId = theComputer.addTask(LambdaRequest(aReq));
 
-  std::unique_lock<std::mutex> myLock(theMutex);
-
-  auto myNewDesc = std::make_unique<Descriptor>();
+  const std::lock_guard<std::mutex> myLock(theMutex);
 
-  const auto myIt = theDescriptors.insert(std::make_pair(myId, nullptr));
+  [[maybe_unused]] const auto myIt =
+      theDescriptors.emplace(myId, std::make_unique<Descriptor>());
   assert(myIt.second);
-  myIt.first->second = std::move(myNewDesc);
-  theDescriptorsCv.notify_one();
-  auto& myDescriptor = *myIt.first->second;
+  theDescriptorsCv.notify_all();
+
+  return myId;
+}
+
+rpc::LambdaResponse EdgeComputer::waitExecution(const rpc::LambdaRequest& aReq,
+                                                const uint64_t            aId) {
+  std::unique_lock<std::mutex> myLock(theMutex);
+
+  const auto myIt = theDescriptors.find(aId);
+  assert(myIt != theDescriptors.end());
+  auto& myDescriptor = *myIt->second;
 
   // wait until we get a response
   myDescriptor.theCondition.wait(
@@ -414,13 +479,18 @@ EdgeComputer::blockingExecution(const rpc::LambdaRequest& aReq) {
   auto myResp = myDescriptor.theResponse->toProtobuf();
   myResp.set_ptime(myDescriptor.theChrono.stop() * 1e3 + 0.5); // to ms
 
+  VLOG(2) << "number of busy descriptors " << theDescriptors.size();
+  theDescriptors.erase(myIt);
+
+  // the task has not been executed, e.g., because its deadline expired
+  if (myResp.retcode() != "OK") {
+    throw std::runtime_error(myResp.retcode());
+  }
+
   if (not handleRemoteStates(aReq, myResp)) {
     throw std::runtime_error("could not handle all the remote states");
   }
 
-  VLOG(2) << "number of busy descriptors " << theDescriptors.size();
-  theDescriptors.erase(myIt.first);
-
   return myResp;
 }
 
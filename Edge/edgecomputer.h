@@ -187,9 +187,27 @@ class EdgeComputer final : public EdgeServer
   //! Perform actual processing of a lambda request.
   rpc::LambdaResponse process(const rpc::LambdaRequest& aReq) override;
 
+  /**
+   * Process a batch of lambda requests.
+   *
+   * The tasks of all the synchronous requests in the batch are added to the
+   * computer before waiting for any of them, so that they are executed
+   * concurrently, while the other requests are processed one by one as in
+   * process(). The continuation is called by the current thread.
+   */
+  void processBatchAsync(const rpc::LambdaRequestBatch& aReqs,
+                         BatchContinuation&&            aContinuation) override;
+
   //! Execute a lambda function (blocks until done).
   rpc::LambdaResponse blockingExecution(const rpc::LambdaRequest& aReq);
 
+  //! Start the execution of a lambda function. \return the task identifier.
+  uint64_t startExecution(const rpc::LambdaRequest& aReq);
+
+  //! Wait for the execution of a lambda function started with the given task.
+  rpc::LambdaResponse waitExecution(const rpc::LambdaRequest& aReq,
+                                    const uint64_t            aId);
+
   /**
    * @brief Handle remote states.
    *
@@ -247,6 +265,9 @@ class EdgeComputer final : public EdgeServer
    */
   static bool lastFunction(const rpc::LambdaRequest& aRequest);
 
+  //! @return true if the request is for the execution of a single function.
+  static bool plainExecution(const rpc::LambdaRequest& aRequest);
+
   //! @return a hash of a request.
   static std::string makeHash(const rpc::LambdaRequest& aRequest);
 
@@ -42,6 +42,8 @@ namespace edge {
 
 EdgeComputerClient::EdgeComputerClient(const std::string& aServerEndpoint)
     : SimpleClient(aServerEndpoint)
+    , theMutex()
+    , theCanceled(false)
     , theContext() {
 }
 
@@ -49,17 +51,25 @@ EdgeComputerClient::~EdgeComputerClient() {
 }
 
 void EdgeComputerClient::cancel() {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theCanceled = true;
   if (theContext) {
     theContext->TryCancel();
   }
 }
 
-void EdgeComputerClient::StreamUtil(
-    const std::function<void(const std::string&, const float)>& aCallback) {
-  if (theContext) {
-    throw std::runtime_error("Cannot call more than once StreamUtil");
+void EdgeComputerClient::StreamUtil(const UtilCallback& aCallback,
+                                    const LoadCallback& aLoadCallback) {
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    if (theContext) {
+      throw std::runtime_error("Cannot call more than once StreamUtil");
+    }
+    theContext.reset(new grpc::ClientContext());
+    if (theCanceled) {
+      theContext->TryCancel();
+    }
   }
-  theContext.reset(new grpc::ClientContext());
   rpc::Void        myReq;
   rpc::Utilization myRep;
   auto             myReader = theStub->StreamUtil(theContext.get(), myReq);
@@ -69,6 +79,14 @@ void EdgeComputerClient::StreamUtil(
     for (const auto& myPair : myRep.values()) {
       aCallback(myPair.first, myPair.second);
     }
+    if (aLoadCallback) {
+      for (const auto& myPair : myRep.loads()) {
+        aLoadCallback(myPair.first,
+                      myPair.second.active(),
+                      myPair.second.pending(),
+                      myPair.second.wait());
+      }
+    }
   }
 
   rpc::checkStatus(myReader->Finish());
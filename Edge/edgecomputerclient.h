@@ -35,7 +35,9 @@ SOFTWARE.
 
 #include "edgecomputer.grpc.pb.h"
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace uiiit {
@@ -44,21 +46,42 @@ namespace edge {
 class EdgeComputerClient final : public rpc::SimpleClient<rpc::EdgeComputer>
 {
  public:
+  //! Function called with the name and utilization of a processor.
+  using UtilCallback = std::function<void(const std::string&, const float)>;
+
+  /**
+   * Function called with the name of a lambda, the number of active and
+   * pending tasks in its container, and the time a new task would wait, in s.
+   */
+  using LoadCallback = std::function<void(
+      const std::string&, const size_t, const size_t, const float)>;
+
   explicit EdgeComputerClient(const std::string& aServerEndpoint);
   ~EdgeComputerClient() override;
 
-  //! Try canceling the pending request. If none, do nothing.
+  /**
+   * Try canceling the pending request. If none, then the next request is
+   * canceled as soon as it is issued.
+   *
+   * Can be called from any thread.
+   */
   void cancel();
 
   /**
    * Start streaming the processor utilizations from the server.
    *
+   * \param aCallback The function called with every processor utilization.
+   * \param aLoadCallback The function called with every container load, if
+   * not empty.
+   *
    * \throw std::runtime_error if called a second time.
    */
-  void StreamUtil(
-      const std::function<void(const std::string&, const float)>& aCallback);
+  void StreamUtil(const UtilCallback& aCallback,
+                  const LoadCallback& aLoadCallback = LoadCallback());
 
  private:
+  std::mutex                           theMutex;
+  bool                                 theCanceled;
   std::unique_ptr<grpc::ClientContext> theContext;
 }; // end class EdgeComputerClient
 
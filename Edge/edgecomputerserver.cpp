@@ -64,5 +64,17 @@ void EdgeComputerServer::add(const std::map<std::string, double>& aUtil) {
   push(myMsg);
 }
 
+void EdgeComputerServer::add(
+    const std::map<std::string, Computer::ContainerLoad>& aLoads) {
+  auto myMsg = std::make_shared<rpc::Utilization>();
+  for (const auto& myPair : aLoads) {
+    auto& myLoad = (*myMsg->mutable_loads())[myPair.first];
+    myLoad.set_active(myPair.second.theActive);
+    myLoad.set_pending(myPair.second.thePending);
+    myLoad.set_wait(myPair.second.theWait);
+  }
+  push(myMsg);
+}
+
 } // namespace edge
 } // end namespace uiiit
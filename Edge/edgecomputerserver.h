@@ -31,6 +31,7 @@ SOFTWARE.
 
 #pragma once
 
+#include "Edge/computer.h"
 #include "RpcSupport/simplestreamingserver.h"
 
 #include "edgecomputer.grpc.pb.h"
@@ -58,8 +59,12 @@ class EdgeComputerServer final
  public:
   explicit EdgeComputerServer(const std::string& aServerEndpoint);
 
+  //! Send the utilization of the processors to all the clients.
   void add(const std::map<std::string, double>& aUtil);
 
+  //! Send the loads of the containers to all the clients.
+  void add(const std::map<std::string, Computer::ContainerLoad>& aLoads);
+
  private:
   grpc::Service& service() override {
     return theServerImpl;
@@ -55,13 +55,21 @@ EdgeDispatcher::EdgeDispatcher(const std::string&   aLambdaEndpoint,
     , thePtimeEstimator(PtimeEstimatorFactory::make(aPtimeEstimatorConf)) {
 }
 
+EdgeDispatcher::~EdgeDispatcher() {
+  // the asynchronous operations in progress use the members of this class
+  stop();
+}
+
 std::vector<ForwardingTableInterface*> EdgeDispatcher::tables() {
   std::vector<ForwardingTableInterface*> myRet(1);
   myRet[0] = thePtimeEstimator.get();
   return myRet;
 }
 
-std::string EdgeDispatcher::destination(const rpc::LambdaRequest& aReq) {
+std::string EdgeDispatcher::destination(const rpc::LambdaRequest& aReq,
+                                        DestinationId&            aId) {
+  // the processing time estimators do not keep track of requests in flight
+  std::ignore = aId;
   return (*thePtimeEstimator)(aReq);
 }
 
@@ -77,5 +85,10 @@ void EdgeDispatcher::processFailure(const rpc::LambdaRequest& aReq,
   thePtimeEstimator->processFailure(aReq, aDestination);
 }
 
+void EdgeDispatcher::processAbort(const rpc::LambdaRequest& aReq,
+                                  const std::string&        aDestination) {
+  thePtimeEstimator->processAbort(aReq, aDestination);
+}
+
 } // namespace edge
 } // namespace uiiit
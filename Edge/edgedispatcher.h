@@ -83,11 +83,14 @@ class EdgeDispatcher final : public EdgeLambdaProcessor
                           const support::Conf& aPtimeEstimatorConf,
                           const support::Conf& aClientConf);
 
+  ~EdgeDispatcher() override;
+
   std::vector<ForwardingTableInterface*> tables() override;
 
  private:
   //! \return the destination associated to the given lambda request.
-  std::string destination(const rpc::LambdaRequest& aReq) override;
+  std::string destination(const rpc::LambdaRequest& aReq,
+                          DestinationId&            aId) override;
 
   //! Called upon successful execution of a lambda function on a computer.
   void processSuccess(const rpc::LambdaRequest& aReq,
@@ -99,6 +102,10 @@ class EdgeDispatcher final : public EdgeLambdaProcessor
   void processFailure(const rpc::LambdaRequest& aReq,
                       const std::string&        aDestination) override;
 
+  //! Called when a lambda function is not executed on a computer.
+  void processAbort(const rpc::LambdaRequest& aReq,
+                    const std::string&        aDestination) override;
+
  private:
   const std::shared_ptr<PtimeEstimator> thePtimeEstimator;
 };
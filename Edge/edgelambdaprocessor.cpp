@@ -35,17 +35,86 @@ SOFTWARE.
 #include "Support/random.h"
 #include "edgecontrollerclient.h"
 #include "edgemessages.h"
+#include "forwardingtableinterface.h"
 
 #include <glog/logging.h>
 
 #include <grpc++/grpc++.h>
 
+#include <algorithm>
+#include <cassert>
 #include <chrono>
+#include <map>
+#include <mutex>
 #include <thread>
+#include <tuple>
+#include <utility>
 
 namespace uiiit {
 namespace edge {
 
+namespace {
+
+// return code of the requests whose deadline has expired
+const std::string theExpiredRetCode("deadline expired");
+
+// continuation of the aIndex-th request of a batch
+std::shared_ptr<EdgeServer::Continuation>
+batchContinuation(const std::shared_ptr<EdgeServer::BatchJoin>& aJoin,
+                  const int                                     aIndex) {
+  return std::make_shared<EdgeServer::Continuation>(
+      [aJoin, aIndex](rpc::LambdaResponse&& aResponse) {
+        (*aJoin)(aIndex, std::move(aResponse));
+      });
+}
+
+} // namespace
+
+/**
+ * State of a request that may be hedged, which owns a copy of the request
+ * so that the losing copy can be still in flight after the response has
+ * been returned. Every copy sent ends with a call to complete().
+ */
+struct EdgeLambdaProcessor::Hedge final {
+  explicit Hedge(const rpc::LambdaRequest& aReq, Continuation&& aContinuation)
+      : theRequest(aReq)
+      , theContinuation(std::move(aContinuation))
+      , theMutex()
+      , thePending(1)
+      , theDone(false)
+      , theHedged(false) {
+    // noop
+  }
+
+  //! Return the first good response, or the last one if all failed.
+  void complete(rpc::LambdaResponse&& aResp) {
+    {
+      const std::lock_guard<std::mutex> myLock(theMutex);
+      assert(thePending > 0);
+      thePending--;
+      if (theDone or (aResp.retcode() != "OK" and thePending > 0)) {
+        VLOG(3) << "response of hedged request discarded: " << aResp.retcode();
+        return;
+      }
+      theDone = true;
+    }
+    theContinuation(std::move(aResp));
+  }
+
+  //! \return true if a response has been already returned.
+  bool done() {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    return theDone;
+  }
+
+  const rpc::LambdaRequest theRequest;
+  const Continuation       theContinuation;
+  std::mutex               theMutex;
+  size_t                   thePending;
+  bool                     theDone;
+  bool                     theHedged; // a request is hedged at most once
+};
+
 EdgeLambdaProcessor::EdgeLambdaProcessor(const std::string& aLambdaEndpoint,
                                          const std::string& aCommandsEndpoint,
                                          const std::string& aControllerEndpoint,
@@ -56,16 +125,70 @@ EdgeLambdaProcessor::EdgeLambdaProcessor(const std::string& aLambdaEndpoint,
     , theControllerEndpoint(aControllerEndpoint)
     , theFakeProcessor(aRouterConf.count("fake") > 0 and
                        aRouterConf.getBool("fake"))
+    , theOverloadRetries(aRouterConf.count("overload-retries") > 0 ?
+                             aRouterConf.getUint("overload-retries") :
+                             0)
+    , theFailureRetries(aRouterConf.count("failure-retries") > 0 ?
+                            aRouterConf.getUint("failure-retries") :
+                            defaultFailureRetries())
     , theClientPool(aClientConf, aRouterConf.getUint("max-pending-clients"))
     , theControllerClient(aControllerEndpoint.empty() ?
                               nullptr :
                               new EdgeControllerClient(aControllerEndpoint))
+    , theNotifyInterval(aRouterConf.count("notify-interval") > 0 ?
+                            aRouterConf.getDouble("notify-interval") :
+                            defaultNotifyInterval())
     , theRandomWaiter(aRouterConf.getDouble("min-forward-time"),
-                      aRouterConf.getDouble("max-forward-time")) {
+                      aRouterConf.getDouble("max-forward-time"))
+    , theBudget(aRouterConf.count("max-in-flight") > 0 ?
+                    aRouterConf.getUint("max-in-flight") :
+                    0)
+    , theBreaker(aRouterConf.count("breaker-failures") > 0 ?
+                     aRouterConf.getUint("breaker-failures") :
+                     0,
+                 aRouterConf.count("breaker-error-rate") > 0 ?
+                     aRouterConf.getDouble("breaker-error-rate") :
+                     CircuitBreaker::defaultMaxErrorRate(),
+                 aRouterConf.count("breaker-ejection") > 0 ?
+                     aRouterConf.getDouble("breaker-ejection") :
+                     CircuitBreaker::defaultEjection())
+    , theHedging(aRouterConf.count("hedge-budget") > 0 ?
+                     aRouterConf.getDouble("hedge-budget") :
+                     HedgePolicy::defaultBudget(),
+                 aRouterConf.count("hedge-quantile") > 0 ?
+                     aRouterConf.getDouble("hedge-quantile") :
+                     HedgePolicy::defaultQuantile())
+    , theNumExpired(0)
+    , theNumOverloaded(0)
+    , theNumHedged(0)
+    , theStopping(false)
+    , theTablesMutex()
+    , theWatcherMutex()
+    , theWatcherCond()
+    , theToNotify()
+    , theToEject()
+    , theEjections()
+    , theWatcher()
+    , theAsyncClient(aClientConf("type") == "grpc" and
+                             aRouterConf.count("async-threads") > 0 and
+                             aRouterConf.getUint("async-threads") > 0 ?
+                         std::make_unique<EdgeClientAsync>(
+                             aRouterConf.getUint("async-threads"),
+                             aClientConf.count("streaming") > 0 and
+                                 aClientConf.getBool("streaming")) :
+                         nullptr) {
+  if (theControllerClient or theBreaker.enabled()) {
+    theWatcher = std::thread([this]() { watcher(); });
+  }
   LOG(INFO) << "Created an EdgeLambdaProcessor with max-pending-clients "
             << aRouterConf.getUint("max-pending-clients") << ", forward-time ["
             << (aRouterConf.getDouble("min-forward-time") * 1e3) << ","
-            << (aRouterConf.getDouble("max-forward-time") * 1e3) << "] ms";
+            << (aRouterConf.getDouble("max-forward-time") * 1e3) << "] ms"
+            << ", max-in-flight " << theBudget.max() << ", overload-retries "
+            << theOverloadRetries << ", failure-retries " << theFailureRetries
+            << (theAsyncClient ? ", asynchronous clients" : "")
+            << (theBreaker.enabled() ? ", circuit breaker" : "")
+            << (theAsyncClient and theHedging.enabled() ? ", hedging" : "");
   LOG_IF(WARNING, not aControllerEndpoint.empty() and aCommandsEndpoint.empty())
       << "No edge router specified";
   LOG_IF(INFO, aControllerEndpoint.empty())
@@ -84,16 +207,87 @@ void EdgeLambdaProcessor::init([
 }
 
 EdgeLambdaProcessor::~EdgeLambdaProcessor() {
+  stop();
+}
+
+void EdgeLambdaProcessor::stop() {
+  if (theStopping.exchange(true)) {
+    return;
+  }
+  // the requests in progress fail and are not forwarded again
+  if (theAsyncClient) {
+    theAsyncClient->shutdown();
+  }
+  {
+    // the watcher checks theStopping with the lock held
+    const std::lock_guard<std::mutex> myLock(theWatcherMutex);
+  }
+  theWatcherCond.notify_all();
+  if (theWatcher.joinable()) {
+    theWatcher.join();
+  }
 }
 
 std::string EdgeLambdaProcessor::defaultConf() {
-  return "max-pending-clients=2,min-forward-time=0,max-forward-time=0";
+  return "max-pending-clients=2,min-forward-time=0,max-forward-time=0,"
+         "async-threads=0,max-in-flight=0,overload-retries=2,"
+         "failure-retries=2,"
+         "breaker-failures=0,breaker-error-rate=0.5,breaker-ejection=1,"
+         "notify-interval=10,hedge-budget=0,hedge-quantile=0.95";
+}
+
+void EdgeLambdaProcessor::destinationsChanged(
+    const std::set<std::string>& aAdded,
+    const std::set<std::string>& aRemoved) {
+  for (const auto& myDestination : aAdded) {
+    theClientPool.warm(myDestination);
+    if (theAsyncClient) {
+      theAsyncClient->warm(myDestination);
+    }
+  }
+  for (const auto& myDestination : aRemoved) {
+    theClientPool.close(myDestination);
+    if (theAsyncClient) {
+      theAsyncClient->close(myDestination);
+    }
+  }
+}
+
+void EdgeLambdaProcessor::entryChanged(const std::string& aLambda,
+                                       const std::string& aDestination) {
+  if (not theBreaker.enabled()) {
+    return;
+  }
+
+  const std::lock_guard<std::mutex> myLock(theWatcherMutex);
+  if (aLambda.empty() and aDestination.empty()) {
+    theEjections.clear();
+    return;
+  }
+  const auto it = theEjections.find(aDestination);
+  if (it == theEjections.end()) {
+    return;
+  }
+  auto& myEntries = it->second.theEntries;
+  myEntries.erase(std::remove_if(myEntries.begin(),
+                                 myEntries.end(),
+                                 [&aLambda](const auto& aEntry) {
+                                   return std::get<1>(aEntry) == aLambda;
+                                 }),
+                  myEntries.end());
+  if (myEntries.empty()) {
+    VLOG(1) << "destination " << aDestination
+            << " changed by the controller while ejected";
+    theEjections.erase(it);
+  }
 }
 
 rpc::LambdaResponse
 EdgeLambdaProcessor::process(const rpc::LambdaRequest& aReq) {
   std::string myRetCode        = "OK";
   auto        myNoDestinations = false;
+  size_t      myRetries        = 0;
+  size_t      myFailures       = 0;
 
   while (not myNoDestinations) {
     VLOG(3) << LambdaRequest(aReq).toString();
@@ -101,9 +295,14 @@ EdgeLambdaProcessor::process(const rpc::LambdaRequest& aReq) {
       myRetCode = "loop detected";
       break;
     }
-    std::string myDestination;
+    if (expired(aReq)) {
+      myRetCode = theExpiredRetCode;
+      break;
+    }
+    std::string   myDestination;
+    DestinationId myId = DestinationRegistry::invalid();
     try {
-      myDestination = destination(aReq);
+      myDestination = destination(aReq, myId);
 
       theRandomWaiter();
 
@@ -112,7 +311,7 @@ EdgeLambdaProcessor::process(const rpc::LambdaRequest& aReq) {
       const auto ret =
           theFakeProcessor ?
               std::make_pair(LambdaResponse("OK", ""), 0.001 + random()) :
-              theClientPool(myDestination, LambdaRequest(aReq), false);
+              call(myDestination, myId, aReq);
 
       myRetCode = ret.first.theRetCode;
 
@@ -129,16 +328,39 @@ EdgeLambdaProcessor::process(const rpc::LambdaRequest& aReq) {
       myRetCode = "Unknown error";
     }
 
-    // purge this entry from both the local table and the controller if there
-    // have been errors
+    // the call may have failed because the deadline expired in the meanwhile,
+    // which is not a fault of the destination
     assert(myRetCode != "OK");
-    if (not myDestination.empty()) {
-      processFailure(aReq, myDestination);
-      controllerCommand([&myDestination](EdgeControllerClient& aClient) {
-        aClient.removeComputer(myDestination);
-      });
-    } else {
+    if (deadlineExpired(aReq.deadline())) {
+      if (not myDestination.empty()) {
+        processAbort(aReq, myDestination);
+      }
+      continue;
+    }
+
+    // an overloaded or ejected destination is not purged, but we try
+    // another one
+    if (myRetCode == OVERLOADED_RETCODE or myRetCode == EJECTED_RETCODE) {
+      processAbort(aReq, myDestination);
+      if (myRetCode == OVERLOADED_RETCODE) {
+        theNumOverloaded++;
+      }
+      if (myRetries++ < theOverloadRetries) {
+        continue;
+      }
+      break;
+    }
+
+    // purge this entry from both the local table and the controller if there
+    // have been errors, then try another destination a limited number of
+    // times
+    if (myDestination.empty()) {
       myNoDestinations = true;
+    } else {
+      purge(aReq, myDestination);
+      if (myFailures++ >= theFailureRetries) {
+        break;
+      }
     }
   }
 
@@ -147,6 +369,582 @@ EdgeLambdaProcessor::process(const rpc::LambdaRequest& aReq) {
   return myResp;
 }
 
+void EdgeLambdaProcessor::processAsync(const rpc::LambdaRequest& aReq,
+                                       Continuation&& aContinuation) {
+  if (not theAsyncClient) {
+    EdgeServer::processAsync(aReq, std::move(aContinuation));
+    return;
+  }
+
+  if (not theHedging.enabled()) {
+    forward(aReq, std::make_shared<Continuation>(std::move(aContinuation)));
+    return;
+  }
+
+  // all the copies of the request share the same continuation
+  theHedging.request();
+  const auto myHedge = std::make_shared<Hedge>(aReq, std::move(aContinuation));
+  forward(myHedge->theRequest,
+          std::make_shared<Continuation>(
+              [myHedge](rpc::LambdaResponse&& aResp) {
+                myHedge->complete(std::move(aResp));
+              }),
+          0,
+          0,
+          myHedge);
+}
+
+std::pair<LambdaResponse, double>
+EdgeLambdaProcessor::call(const std::string&        aDestination,
+                          const DestinationId       aId,
+                          const rpc::LambdaRequest& aReq) {
+  if (not theBreaker.allow(aDestination)) {
+    throw Ejected();
+  }
+  if (not theBudget.acquire(aDestination)) {
+    theBreaker.release(aDestination);
+    throw Overloaded();
+  }
+  processStart(aReq, aId);
+  try {
+    auto ret = theClientPool(aDestination, aReq, false);
+    processEnd(aReq, aId);
+    theBudget.release(aDestination);
+    breakerOutcome(aReq, aDestination, true);
+    return ret;
+  } catch (...) {
+    // the clients throw if the destination cannot be reached
+    processEnd(aReq, aId);
+    theBudget.release(aDestination);
+    breakerOutcome(aReq, aDestination, false);
+    throw;
+  }
+}
+
+std::string
+EdgeLambdaProcessor::alternative(const rpc::LambdaRequest& aReq,
+                                 const std::string&        aExcluded,
+                                 DestinationId&            aId) {
+  std::ignore = aReq;
+  std::ignore = aExcluded;
+  std::ignore = aId;
+  return std::string();
+}
+
+void EdgeLambdaProcessor::processAbort(const rpc::LambdaRequest& aReq,
+                                       const std::string&        aDestination) {
+  std::ignore = aReq;
+  std::ignore = aDestination;
+}
+
+void EdgeLambdaProcessor::processStart(const rpc::LambdaRequest& aReq,
+                                       const DestinationId       aId) {
+  std::ignore = aReq;
+  std::ignore = aId;
+}
+
+void EdgeLambdaProcessor::processEnd(const rpc::LambdaRequest& aReq,
+                                     const DestinationId       aId) {
+  std::ignore = aReq;
+  std::ignore = aId;
+}
+
+void EdgeLambdaProcessor::processBatchAsync(
+    const rpc::LambdaRequestBatch& aReqs, BatchContinuation&& aContinuation) {
+  if (not theAsyncClient or aReqs.requests_size() == 0) {
+    EdgeServer::processBatchAsync(aReqs, std::move(aContinuation));
+    return;
+  }
+
+  const auto myJoin = std::make_shared<BatchJoin>(aReqs.requests_size(),
+                                                  std::move(aContinuation));
+
+  // split the batch into sub-batches with a single destination each
+  // key:   forward flag and lambda name
+  // value: indices of the requests in the batch
+  std::map<std::pair<bool, std::string>, std::vector<int>> myGroups;
+  for (int i = 0; i < aReqs.requests_size(); i++) {
+    const auto& myReq = aReqs.requests(i);
+    if (myReq.hops() > 254) { // loop detection
+      fail("loop detected", batchContinuation(myJoin, i));
+      continue;
+    }
+    if (expired(myReq)) {
+      fail(theExpiredRetCode, batchContinuation(myJoin, i));
+      continue;
+    }
+    myGroups[std::make_pair(myReq.forward(), myReq.name())].push_back(i);
+  }
+
+  for (const auto& elem : myGroups) {
+    forwardBatch(aReqs, elem.second, myJoin);
+  }
+}
+
+void EdgeLambdaProcessor::forwardBatch(
+    const rpc::LambdaRequestBatch&    aReqs,
+    const std::vector<int>&           aIndices,
+    const std::shared_ptr<BatchJoin>& aJoin) {
+  assert(not aIndices.empty());
+  VLOG(3) << "batch of " << aIndices.size() << " requests, first "
+          << LambdaRequest(aReqs.requests(aIndices.front())).toString();
+  if (theStopping) {
+    for (const auto i : aIndices) {
+      fail("shutting down", batchContinuation(aJoin, i));
+    }
+    return;
+  }
+
+  // one forwarding decision for the whole sub-batch
+  std::string   myDestination;
+  DestinationId myId = DestinationRegistry::invalid();
+  try {
+    myDestination = destination(aReqs.requests(aIndices.front()), myId);
+  } catch (const std::exception& aErr) {
+    for (const auto i : aIndices) {
+      fail(aErr.what(), batchContinuation(aJoin, i));
+    }
+    return;
+  } catch (...) {
+    for (const auto i : aIndices) {
+      fail("Unknown error", batchContinuation(aJoin, i));
+    }
+    return;
+  }
+
+  // the artificial processing time, if any, is drawn once per sub-batch
+  const auto myDelay = theRandomWaiter.draw();
+  if (myDelay > 0) {
+    theAsyncClient->schedule(
+        myDelay,
+        [this, &aReqs, aIndices, myDestination, myId, aJoin](
+            const bool aExpired) {
+          if (aExpired) {
+            sendBatch(aReqs, aIndices, myDestination, myId, aJoin);
+            return;
+          }
+          // the client is shutting down: the requests are not sent
+          for (const auto i : aIndices) {
+            processAbort(aReqs.requests(i), myDestination);
+            fail("shutting down", batchContinuation(aJoin, i));
+          }
+        });
+  } else {
+    sendBatch(aReqs, aIndices, myDestination, myId, aJoin);
+  }
+}
+
+void EdgeLambdaProcessor::sendBatch(
+    const rpc::LambdaRequestBatch&    aReqs,
+    const std::vector<int>&           aIndices,
+    const std::string&                aDestination,
+    const DestinationId               aId,
+    const std::shared_ptr<BatchJoin>& aJoin) {
+  // if this is fake processor then we do not contact the next
+  // destination, but rather return immediately fake OK responses
+  if (theFakeProcessor) {
+    for (const auto i : aIndices) {
+      receive(aReqs.requests(i),
+              aDestination,
+              LambdaResponse("OK", ""),
+              0.001 + random(),
+              batchContinuation(aJoin, i));
+    }
+    return;
+  }
+
+  // the whole sub-batch is allowed once by the circuit breaker and takes
+  // one unit of the budget of the destination
+  if (not theBreaker.allow(aDestination)) {
+    for (const auto i : aIndices) {
+      receive(aReqs.requests(i),
+              aDestination,
+              LambdaResponse(EJECTED_RETCODE, ""),
+              0,
+              batchContinuation(aJoin, i));
+    }
+    return;
+  }
+  if (not theBudget.acquire(aDestination)) {
+    theBreaker.release(aDestination);
+    for (const auto i : aIndices) {
+      receive(aReqs.requests(i),
+              aDestination,
+              LambdaResponse(OVERLOADED_RETCODE, ""),
+              0,
+              batchContinuation(aJoin, i));
+    }
+    return;
+  }
+
+  std::vector<const rpc::LambdaRequest*> myReqs;
+  myReqs.reserve(aIndices.size());
+  for (const auto i : aIndices) {
+    myReqs.emplace_back(&aReqs.requests(i));
+    processStart(aReqs.requests(i), aId);
+  }
+
+  try {
+    assert(theAsyncClient);
+    theAsyncClient->ForwardLambdaBatch(
+        aDestination,
+        myReqs,
+        false,
+        [this, &aReqs, aIndices, aDestination, aId, aJoin](
+            std::vector<LambdaResponse>&& aResps, const double aTime) {
+          for (const auto i : aIndices) {
+            processEnd(aReqs.requests(i), aId);
+          }
+          theBudget.release(aDestination);
+          assert(aResps.size() == aIndices.size());
+          // the batch has been allowed once by the circuit breaker
+          breakerOutcome(aReqs.requests(aIndices.front()),
+                         aDestination,
+                         not aResps.front().theResponder.empty());
+          for (size_t k = 0; k < aIndices.size(); k++) {
+            receive(aReqs.requests(aIndices[k]),
+                    aDestination,
+                    std::move(aResps[k]),
+                    aTime,
+                    batchContinuation(aJoin, aIndices[k]));
+          }
+        });
+  } catch (const std::exception& aErr) {
+    for (const auto i : aIndices) {
+      processEnd(aReqs.requests(i), aId);
+    }
+    theBudget.release(aDestination);
+    breakerOutcome(aReqs.requests(aIndices.front()), aDestination, false);
+    for (const auto i : aIndices) {
+      receive(aReqs.requests(i),
+              aDestination,
+              LambdaResponse(aErr.what(), ""),
+              0,
+              batchContinuation(aJoin, i));
+    }
+  }
+}
+
+void EdgeLambdaProcessor::forward(
+    const rpc::LambdaRequest&            aReq,
+    const std::shared_ptr<Continuation>& aContinuation,
+    const size_t                         aRetries,
+    const size_t                         aFailures,
+    const std::shared_ptr<Hedge>&        aHedge) {
+  VLOG(3) << LambdaRequest(aReq).toString();
+  if (theStopping) {
+    fail("shutting down", aContinuation);
+    return;
+  }
+  if (aReq.hops() > 254) { // loop detection
+    fail("loop detected", aContinuation);
+    return;
+  }
+  if (expired(aReq)) {
+    fail(theExpiredRetCode, aContinuation);
+    return;
+  }
+  if (aHedge and aHedge->done()) {
+    // the response of this copy would be discarded anyway
+    fail("hedged request already answered", aContinuation);
+    return;
+  }
+
+  std::string   myDestination;
+  DestinationId myId = DestinationRegistry::invalid();
+  try {
+    myDestination = destination(aReq, myId);
+  } catch (const std::exception& aErr) {
+    fail(aErr.what(), aContinuation);
+    return;
+  } catch (...) {
+    fail("Unknown error", aContinuation);
+    return;
+  }
+
+  // the artificial processing time, if any, does not block this thread
+  const auto myDelay = theRandomWaiter.draw();
+  if (myDelay > 0) {
+    theAsyncClient->schedule(myDelay,
+                             [this,
+                              &aReq,
+                              myDestination,
+                              myId,
+                              aContinuation,
+                              aRetries,
+                              aFailures,
+                              aHedge](const bool aExpired) {
+                               if (not aExpired) {
+                                 // the client is shutting down
+                                 processAbort(aReq, myDestination);
+                                 fail("shutting down", aContinuation);
+                                 return;
+                               }
+                               send(aReq,
+                                    myDestination,
+                                    myId,
+                                    aContinuation,
+                                    aRetries,
+                                    aFailures,
+                                    aHedge);
+                             });
+  } else {
+    send(aReq,
+         myDestination,
+         myId,
+         aContinuation,
+         aRetries,
+         aFailures,
+         aHedge);
+  }
+}
+
+void EdgeLambdaProcessor::send(
+    const rpc::LambdaRequest&            aReq,
+    const std::string&                   aDestination,
+    const DestinationId                  aId,
+    const std::shared_ptr<Continuation>& aContinuation,
+    const size_t                         aRetries,
+    const size_t                         aFailures,
+    const std::shared_ptr<Hedge>&        aHedge) {
+  // if this is fake processor then we do not contact the next
+  // destination, but rather return immediately a fake OK response
+  if (theFakeProcessor) {
+    receive(aReq,
+            aDestination,
+            LambdaResponse("OK", ""),
+            0.001 + random(),
+            aContinuation,
+            aRetries,
+            aFailures,
+            aHedge);
+    return;
+  }
+
+  if (not theBreaker.allow(aDestination)) {
+    receive(aReq,
+            aDestination,
+            LambdaResponse(EJECTED_RETCODE, ""),
+            0,
+            aContinuation,
+            aRetries,
+            aFailures,
+            aHedge);
+    return;
+  }
+  if (not theBudget.acquire(aDestination)) {
+    theBreaker.release(aDestination);
+    receive(aReq,
+            aDestination,
+            LambdaResponse(OVERLOADED_RETCODE, ""),
+            0,
+            aContinuation,
+            aRetries,
+            aFailures,
+            aHedge);
+    return;
+  }
+
+  processStart(aReq, aId);
+  try {
+    assert(theAsyncClient);
+    theAsyncClient->ForwardLambda(
+        aDestination,
+        aReq,
+        false,
+        [this,
+         &aReq,
+         aDestination,
+         aId,
+         aContinuation,
+         aRetries,
+         aFailures,
+         aHedge](LambdaResponse&& aResp, const double aTime) {
+          processEnd(aReq, aId);
+          theBudget.release(aDestination);
+          // the responder is empty if the destination could not be reached
+          breakerOutcome(aReq, aDestination, not aResp.theResponder.empty());
+          receive(aReq,
+                  aDestination,
+                  std::move(aResp),
+                  aTime,
+                  aContinuation,
+                  aRetries,
+                  aFailures,
+                  aHedge);
+        });
+  } catch (const std::exception& aErr) {
+    processEnd(aReq, aId);
+    theBudget.release(aDestination);
+    breakerOutcome(aReq, aDestination, false);
+    receive(aReq,
+            aDestination,
+            LambdaResponse(aErr.what(), ""),
+            0,
+            aContinuation,
+            aRetries,
+            aFailures,
+            aHedge);
+    return;
+  }
+
+  // hedge the request if the destination does not answer in time
+  if (aHedge) {
+    const auto myDelay = theHedging.delay(aReq.name(), aDestination);
+    if (myDelay > 0) {
+      theAsyncClient->schedule(
+          myDelay,
+          [this, aHedge, aDestination, aContinuation](const bool aExpired) {
+            // no copy is sent if the client is shutting down
+            if (aExpired) {
+              hedge(aHedge, aDestination, aContinuation);
+            }
+          });
+    }
+  }
+}
+
+void EdgeLambdaProcessor::hedge(
+    const std::shared_ptr<Hedge>&        aHedge,
+    const std::string&                   aPrimary,
+    const std::shared_ptr<Continuation>& aContinuation) {
+  const auto& myReq = aHedge->theRequest;
+  if (theStopping or deadlineExpired(myReq.deadline())) {
+    return;
+  }
+
+  // most timers fire after the response has been received: in this case,
+  // or without budget, the destination is not even selected
+  {
+    const std::lock_guard<std::mutex> myLock(aHedge->theMutex);
+    if (aHedge->theDone or aHedge->theHedged or not theHedging.acquire()) {
+      return;
+    }
+    aHedge->theHedged = true;
+  }
+
+  std::string   myDestination;
+  DestinationId myId = DestinationRegistry::invalid();
+  try {
+    myDestination = alternative(myReq, aPrimary, myId);
+  } catch (const std::exception& aErr) {
+    VLOG(3) << "cannot hedge request: " << aErr.what();
+  }
+  if (myDestination.empty()) {
+    theHedging.refund();
+    return;
+  }
+
+  {
+    const std::lock_guard<std::mutex> myLock(aHedge->theMutex);
+    if (aHedge->theDone) {
+      theHedging.refund();
+      return;
+    }
+    aHedge->thePending++;
+  }
+  theNumHedged++;
+  VLOG(2) << "hedging request for " << myReq.name() << " from " << aPrimary
+          << " to " << myDestination;
+
+  // the copy is not forwarded again if the destination is overloaded or
+  // fails
+  send(myReq,
+       myDestination,
+       myId,
+       aContinuation,
+       theOverloadRetries,
+       theFailureRetries);
+}
+
+void EdgeLambdaProcessor::receive(
+    const rpc::LambdaRequest&            aReq,
+    const std::string&                   aDestination,
+    LambdaResponse&&                     aResp,
+    const double                         aTime,
+    const std::shared_ptr<Continuation>& aContinuation,
+    const size_t                         aRetries,
+    const size_t                         aFailures,
+    const std::shared_ptr<Hedge>&        aHedge) {
+  if (aResp.theRetCode == "OK") {
+    auto mySuccess = false;
+    try {
+      processSuccess(aReq, aDestination, aResp, aTime);
+      mySuccess = true;
+    } catch (const std::exception& aErr) {
+      VLOG(3) << "error when handling response, " << aErr.what();
+    } catch (...) {
+      VLOG(3) << "unknown error when handling response";
+    }
+    if (mySuccess) {
+      if (theHedging.enabled()) {
+        theHedging.add(aReq.name(), aDestination, aTime);
+      }
+      (*aContinuation)(aResp.toProtobuf());
+      return;
+    }
+  } else {
+    VLOG(3) << "error received, " << aResp;
+  }
+
+  // the request has been cancelled, which is not a fault of the destination
+  if (theStopping) {
+    processAbort(aReq, aDestination);
+    fail(aResp.theRetCode, aContinuation);
+    return;
+  }
+
+  // do not blame the destination if the deadline expired in the meanwhile
+  if (deadlineExpired(aReq.deadline())) {
+    processAbort(aReq, aDestination);
+    forward(aReq, aContinuation, aRetries, aFailures, aHedge);
+    return;
+  }
+
+  // an overloaded or ejected destination is not purged, but we try
+  // another one
+  if (aResp.theRetCode == OVERLOADED_RETCODE or
+      aResp.theRetCode == EJECTED_RETCODE) {
+    processAbort(aReq, aDestination);
+    if (aResp.theRetCode == OVERLOADED_RETCODE) {
+      theNumOverloaded++;
+    }
+    if (aRetries < theOverloadRetries) {
+      forward(aReq, aContinuation, aRetries + 1, aFailures, aHedge);
+    } else {
+      fail(aResp.theRetCode, aContinuation);
+    }
+    return;
+  }
+
+  // purge this entry from both the local table and the controller if there
+  // have been errors, then try with another destination a limited number of
+  // times
+  purge(aReq, aDestination);
+  if (aFailures < theFailureRetries) {
+    forward(aReq, aContinuation, aRetries, aFailures + 1, aHedge);
+  } else {
+    fail(aResp.theRetCode, aContinuation);
+  }
+}
+
+bool EdgeLambdaProcessor::expired(const rpc::LambdaRequest& aReq) {
+  if (not deadlineExpired(aReq.deadline())) {
+    return false;
+  }
+  VLOG(2) << "deadline expired for " << aReq.name();
+  theNumExpired++;
+  return true;
+}
+
+void EdgeLambdaProcessor::fail(
+    const std::string&                   aRetCode,
+    const std::shared_ptr<Continuation>& aContinuation) {
+  rpc::LambdaResponse myResp;
+  myResp.set_retcode(aRetCode);
+  (*aContinuation)(std::move(myResp));
+}
+
 void EdgeLambdaProcessor::controllerCommand(
     const std::function<void(EdgeControllerClient&)>& aCommand) noexcept {
   if (not theControllerClient) {
@@ -164,6 +962,193 @@ void EdgeLambdaProcessor::controllerCommand(
   }
 }
 
+void EdgeLambdaProcessor::breakerOutcome(
+    const rpc::LambdaRequest& aReq,
+    const std::string&        aDestination,
+    const bool                aReached) noexcept {
+  if (not theBreaker.enabled()) {
+    return;
+  }
+  try {
+    // a destination that answers is alive, whatever the return code, while
+    // a request whose deadline expired in the meanwhile tells nothing about
+    // the destination
+    if (aReached) {
+      theBreaker.success(aDestination);
+    } else if (deadlineExpired(aReq.deadline())) {
+      theBreaker.release(aDestination);
+    } else if (theBreaker.failure(aDestination)) {
+      ejected(aDestination);
+      if (theBreaker.exhausted(aDestination)) {
+        notifyFailure(aDestination);
+      }
+    }
+  } catch (const std::exception& aErr) {
+    LOG(ERROR) << "Could not update the circuit breaker of " << aDestination
+               << ": " << aErr.what();
+  }
+}
+
+void EdgeLambdaProcessor::purge(const rpc::LambdaRequest& aReq,
+                                const std::string&        aDestination) {
+  // with the circuit breaker the destination is not purged upon every
+  // failure, but only ejected after repeated failures
+  if (theBreaker.enabled()) {
+    processAbort(aReq, aDestination);
+    return;
+  }
+  processFailure(aReq, aDestination);
+  notifyFailure(aDestination);
+}
+
+void EdgeLambdaProcessor::notifyFailure(const std::string& aDestination) {
+  if (not theControllerClient) {
+    return;
+  }
+  {
+    const std::lock_guard<std::mutex> myLock(theWatcherMutex);
+    theToNotify.push_back(aDestination);
+  }
+  theWatcherCond.notify_one();
+}
+
+void EdgeLambdaProcessor::ejected(const std::string& aDestination) {
+  {
+    const std::lock_guard<std::mutex> myLock(theWatcherMutex);
+    theToEject.push_back(aDestination);
+  }
+  theWatcherCond.notify_one();
+}
+
+EdgeLambdaProcessor::Entries
+EdgeLambdaProcessor::eject(const std::string& aDestination) {
+  Entries    ret;
+  const auto myTables = tables();
+  for (size_t i = 0; i < myTables.size(); i++) {
+    try {
+      for (const auto& myLambda : myTables[i]->fullTable()) {
+        const auto it = myLambda.second.find(aDestination);
+        if (it == myLambda.second.end()) {
+          continue;
+        }
+        ret.emplace_back(
+            i, myLambda.first, it->second.first, it->second.second);
+        myTables[i]->remove(myLambda.first, aDestination);
+      }
+    } catch (const std::exception& aErr) {
+      LOG(ERROR) << "Could not remove " << aDestination
+                 << " from the tables: " << aErr.what();
+    }
+  }
+  VLOG(1) << "destination " << aDestination << " ejected, " << ret.size()
+          << " entries removed";
+  return ret;
+}
+
+void EdgeLambdaProcessor::restore(const std::string& aDestination,
+                                  const Entries&     aEntries) {
+  const auto myTables = tables();
+  for (const auto& myEntry : aEntries) {
+    try {
+      myTables.at(std::get<0>(myEntry))
+          ->change(std::get<1>(myEntry),
+                   aDestination,
+                   std::get<2>(myEntry),
+                   std::get<3>(myEntry));
+    } catch (const std::exception& aErr) {
+      LOG(ERROR) << "Could not restore " << aDestination << " for lambda "
+                 << std::get<1>(myEntry) << ": " << aErr.what();
+    }
+  }
+  VLOG(1) << "destination " << aDestination << " restored, "
+          << aEntries.size() << " entries added";
+}
+
+void EdgeLambdaProcessor::watcher() {
+  // key:   destination
+  // value: time of the last notification
+  std::map<std::string, std::chrono::steady_clock::time_point> myLast;
+
+  // return the ejection that ends first, if any
+  const auto myEarliest = [this]() {
+    auto ret = theEjections.end();
+    for (auto it = theEjections.begin(); it != theEjections.end(); ++it) {
+      if (ret == theEjections.end() or
+          it->second.theUntil < ret->second.theUntil) {
+        ret = it;
+      }
+    }
+    return ret;
+  };
+
+  std::unique_lock<std::mutex> myLock(theWatcherMutex);
+  while (not theStopping) {
+    const auto myNow = std::chrono::steady_clock::now();
+    auto       it    = myEarliest();
+    const auto myDue =
+        it != theEjections.end() and it->second.theUntil <= myNow;
+
+    if (not theToEject.empty() or myDue) {
+      // the tables are changed with the lock held by the controller
+      // interface, which is taken before that of the watcher
+      myLock.unlock();
+      const std::lock_guard<std::mutex> myTablesLock(theTablesMutex);
+      myLock.lock();
+      if (theStopping) {
+        break;
+      }
+
+      if (not theToEject.empty()) {
+        const auto myDestination = std::move(theToEject.front());
+        theToEject.pop_front();
+        auto myEntries = eject(myDestination);
+
+        // a destination ejected again while still out of the tables, e.g.,
+        // a failed probe, keeps the entries removed the first time
+        const std::chrono::microseconds myDuration(
+            static_cast<long>(theBreaker.ejection(myDestination) * 1e6));
+        auto& myEjection    = theEjections[myDestination];
+        myEjection.theUntil = std::chrono::steady_clock::now() + myDuration;
+        for (auto& myEntry : myEntries) {
+          myEjection.theEntries.emplace_back(std::move(myEntry));
+        }
+
+      } else {
+        // the ejection may have been dropped by the controller meanwhile
+        it = myEarliest();
+        if (it != theEjections.end() and
+            it->second.theUntil <= std::chrono::steady_clock::now()) {
+          restore(it->first, it->second.theEntries);
+          theEjections.erase(it);
+        }
+      }
+
+    } else if (not theToNotify.empty()) {
+      const auto myDestination = std::move(theToNotify.front());
+      theToNotify.pop_front();
+      const auto jt = myLast.find(myDestination);
+      if (jt != myLast.end() and
+          std::chrono::duration<double>(myNow - jt->second).count() <
+              theNotifyInterval) {
+        VLOG(2) << "notification about " << myDestination << " suppressed";
+        continue;
+      }
+      myLast[myDestination] = myNow;
+      myLock.unlock();
+      controllerCommand([&myDestination](EdgeControllerClient& aClient) {
+        aClient.removeComputer(myDestination);
+      });
+      myLock.lock();
+
+    } else if (it != theEjections.end()) {
+      theWatcherCond.wait_until(myLock, it->second.theUntil);
+
+    } else {
+      theWatcherCond.wait(myLock);
+    }
+  }
+}
+
 EdgeLambdaProcessor::RandomWaiter::RandomWaiter(const double aMin,
                                                 const double aMax)
     : theMin(aMin)
@@ -172,13 +1157,18 @@ EdgeLambdaProcessor::RandomWaiter::RandomWaiter(const double aMin,
 }
 
 void EdgeLambdaProcessor::RandomWaiter::operator()() const {
-  if (theMin == 0 and theSpan == 0) {
-    return;
+  const auto myRndTime = draw();
+  if (myRndTime > 0) {
+    std::this_thread::sleep_for(
+        std::chrono::microseconds(static_cast<long>(0.5 + myRndTime * 1e6)));
   }
+}
 
-  const auto myRndTime = theMin + theSpan * uiiit::support::random();
-  std::this_thread::sleep_for(
-      std::chrono::microseconds(static_cast<long>(0.5 + myRndTime * 1e6)));
+double EdgeLambdaProcessor::RandomWaiter::draw() const {
+  if (theMin == 0 and theSpan == 0) {
+    return 0;
+  }
+  return theMin + theSpan * uiiit::support::random();
 }
 
 } // namespace edge
@@ -31,10 +31,25 @@ SOFTWARE.
 
 #pragma once
 
+#include "circuitbreaker.h"
+#include "destinationregistry.h"
+#include "edgeclientasync.h"
 #include "edgeclientpool.h"
 #include "edgeserver.h"
+#include "hedgepolicy.h"
+#include "overload.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 namespace uiiit {
@@ -54,6 +69,37 @@ class ForwardingTableInterface;
  *
  * The actual logic for deciding the destination must be implemented by derived
  * classes.
+ *
+ * The requests whose deadline has expired are not forwarded, but rather
+ * they are immediately answered with an error. A failure to execute a
+ * request whose deadline has expired is not attributed to the destination.
+ *
+ * A destination that answers that it is overloaded, or towards which there
+ * are already too many requests in flight, is not purged: the request is
+ * rather forwarded again to a newly selected destination, up to a maximum
+ * number of times, after which it is answered as overloaded.
+ *
+ * A destination that fails to execute a request is purged from the tables
+ * and the controller is notified, unless the circuit breaker is enabled: in
+ * this case the destination is only ejected after repeated failures to reach
+ * it. An ejected destination is removed from the tables until its ejection
+ * time has elapsed, then it is added back so that a probe can be sent to
+ * it, see CircuitBreaker. The controller is notified only when the breaker
+ * gives up on a destination, i.e., when the latter is ejected for the
+ * maximum time. In all cases a request is forwarded again only a limited
+ * number of times after a failure.
+ *
+ * The notifications to the controller and the changes of the tables upon
+ * ejection are carried out by a background thread, serialized with the
+ * changes of the tables made by the controller, see tablesMutex() and
+ * entryChanged(). The notifications are
+ * sent at most once per destination within a given interval.
+ *
+ * With asynchronous clients a request can also be hedged: if the
+ * destination selected first has not answered within a given quantile of
+ * the latencies measured towards it, a second copy of the request is sent to
+ * another destination and the first good response is returned. The
+ * additional load is capped by a budget, see HedgePolicy.
  */
 class EdgeLambdaProcessor : public EdgeServer
 {
@@ -79,9 +125,59 @@ class EdgeLambdaProcessor : public EdgeServer
    *   In addition to the real time of selecting the destination of any lambda,
    *   we add an artificial process time randomly drawn from U[A, B].
    *   A and B are in fractional seconds.
-
+   *
+   * - async-threads=N
+   *   Number of threads serving the completion queue of the asynchronous
+   *   clients used to forward lambdas, which are only used if the client
+   *   type is grpc. If N is zero, or the parameter is missing, then
+   *   lambdas are forwarded by the calling thread with synchronous clients.
+   *
+   * - max-in-flight=M
+   *   Maximum number of requests in flight towards every destination, beyond
+   *   which the destination is considered overloaded. If M is zero, or the
+   *   parameter is missing, then there is no limit. With synchronous
+   *   clients M should not exceed K, otherwise the calling threads may
+   *   block waiting for a client to become available.
+   *
+   * - overload-retries=R
+   *   Maximum number of times that a request is forwarded again after
+   *   finding the destination overloaded or ejected. If missing then R is
+   *   zero.
+   *
+   * - failure-retries=G
+   *   Maximum number of times that a request is forwarded again after the
+   *   destination failed to execute it. If missing then G is
+   *   defaultFailureRetries().
+   *
+   * - breaker-failures=F
+   * - breaker-error-rate=E
+   * - breaker-ejection=T
+   *   A destination is ejected after F consecutive failures to reach it or
+   *   if the fraction of such failures reaches E, see CircuitBreaker, for T
+   *   seconds, doubled at every new ejection. If F is zero, or the parameter
+   *   is missing, then the circuit breaker is disabled and it does not add
+   *   any locking to the forwarding of the requests.
+   *
+   * - notify-interval=I
+   *   Minimum time between two notifications to the controller about the
+   *   same destination, in fractional seconds.
+   *
+   * - hedge-budget=H
+   * - hedge-quantile=Q
+   *   Maximum fraction of requests hedged and quantile of the latencies
+   *   after which a request is hedged. Only used with asynchronous clients
+   *   and not with batches. If H is zero, or the parameter is missing, then
+   *   the requests are not hedged. Every request is copied when hedging is
+   *   enabled, since the losing copy may be still in flight when the
+   *   response is returned. A request is hedged at most once and only if
+   *   the derived class provides an alternative destination, see
+   *   alternative().
+   *
    * \param aClientConf the configuration of the clients used to forward lambda
-   * requests.
+   * requests. With type=grpc and streaming=true both the synchronous and
+   * asynchronous clients send the requests on streams. With type=grpc and
+   * channels=C the synchronous clients share C connections per destination
+   * instead of opening one connection per request in progress.
    */
   explicit EdgeLambdaProcessor(const std::string&   aLambdaEndpoint,
                                const std::string&   aCommandsEndpoint,
@@ -95,9 +191,100 @@ class EdgeLambdaProcessor : public EdgeServer
 
   virtual std::vector<ForwardingTableInterface*> tables() = 0;
 
+  /**
+   * Establish in advance the connections to the destinations added to the
+   * forwarding tables and close those to the destinations removed, so that
+   * the first requests to a new destination do not wait for them.
+   *
+   * \param aAdded the destinations that were not in the tables before.
+   * \param aRemoved the destinations that are not in the tables anymore.
+   */
+  void destinationsChanged(const std::set<std::string>& aAdded,
+                           const std::set<std::string>& aRemoved);
+
+  /**
+   * \return the mutex held while the tables are changed by the controller,
+   * see ForwardingTableServer::tablesMutex(), which is also held when the
+   * ejected destinations are removed from the tables and added back.
+   */
+  std::mutex& tablesMutex() noexcept {
+    return theTablesMutex;
+  }
+
+  /**
+   * Forget the entries of an ejected destination that are about to be
+   * changed or removed by the controller, so that they are not added back
+   * at the end of the ejection. Must be called with tablesMutex() held.
+   *
+   * \param aLambda the lambda changed or removed.
+   * \param aDestination the destination changed or removed.
+   *
+   * If both are empty then all the tables are about to be flushed.
+   */
+  void entryChanged(const std::string& aLambda,
+                    const std::string& aDestination);
+
+  //! \return the number of requests dropped since their deadline expired.
+  size_t numExpired() const noexcept {
+    return theNumExpired;
+  }
+
+  //! \return the number of times a destination was found overloaded.
+  size_t numOverloaded() const noexcept {
+    return theNumOverloaded;
+  }
+
+  //! \return the number of requests hedged.
+  size_t numHedged() const noexcept {
+    return theNumHedged;
+  }
+
+ protected:
+  /**
+   * Stop forwarding requests and wait until the asynchronous operations in
+   * progress are complete, which may call the virtual methods: must be
+   * called in the dtor of the derived classes. Can be called multiple times.
+   */
+  void stop();
+
  private:
-  //! \return the destination associated to the given lambda request.
-  virtual std::string destination(const rpc::LambdaRequest& aReq) = 0;
+  struct Hedge;
+
+  // entries of a destination in the tables: index of the table, lambda,
+  // weight, and final flag
+  using Entries = std::vector<std::tuple<size_t, std::string, float, bool>>;
+
+  // a destination removed from the tables while ejected
+  struct Ejection {
+    std::chrono::steady_clock::time_point theUntil;
+    Entries                               theEntries;
+  };
+
+  /**
+   * \return the destination associated to the given lambda request.
+   *
+   * \param aId set to the identifier of the destination in the
+   * DestinationRegistry, if known to the derived class, which is then passed
+   * to processStart() and processEnd(). Otherwise left to
+   * DestinationRegistry::invalid().
+   */
+  virtual std::string destination(const rpc::LambdaRequest& aReq,
+                                  DestinationId&            aId) = 0;
+
+  /**
+   * \return a destination other than the given one to which a copy of the
+   * lambda request can be sent when hedging, or an empty string if there is
+   * none, which is the default. Unlike destination(), it is not followed by
+   * processAbort() if the copy is not executed.
+   *
+   * \param aExcluded the destination of the request to be hedged.
+   *
+   * \param aId set to the identifier of the destination returned, as with
+   * destination().
+   */
+  virtual std::string alternative(const rpc::LambdaRequest& aReq,
+                                  const std::string&        aExcluded,
+                                  DestinationId&            aId);
 
   /**
    * Called upon successful execution of a lambda function on a computer.
@@ -125,9 +312,137 @@ class EdgeLambdaProcessor : public EdgeServer
   virtual void processFailure(const rpc::LambdaRequest& aReq,
                               const std::string&        aDestination) = 0;
 
+  /**
+   * Called when a lambda request is not executed on the computer returned
+   * by destination(), without the latter being at fault, e.g., because it is
+   * overloaded, before the request is forwarded again or answered with an
+   * error. Every call to destination() is followed by exactly one call to
+   * processSuccess(), processFailure(), or processAbort(). Does nothing by
+   * default.
+   *
+   * \param aReq the lambda request.
+   *
+   * \param aDestination the edge computer that did not execute the lambda.
+   */
+  virtual void processAbort(const rpc::LambdaRequest& aReq,
+                            const std::string&        aDestination);
+
+  /**
+   * Called as a lambda request is sent to a computer, which is then
+   * followed by exactly one call to processEnd() when the response is
+   * received or the request fails. Does nothing by default.
+   *
+   * \param aReq the lambda request.
+   *
+   * \param aId the identifier of the edge computer to which the request is
+   * sent, as returned by destination().
+   */
+  virtual void processStart(const rpc::LambdaRequest& aReq,
+                            const DestinationId       aId);
+
+  //! Called when a lambda request notified with processStart() returns.
+  virtual void processEnd(const rpc::LambdaRequest& aReq,
+                          const DestinationId       aId);
+
   //! Perform actual processing of a lambda request.
   rpc::LambdaResponse process(const rpc::LambdaRequest& aReq) override;
 
+  /**
+   * Start the processing of a lambda request via asynchronous clients,
+   * if enabled, otherwise fall back to synchronous processing.
+   */
+  void processAsync(const rpc::LambdaRequest& aReq,
+                    Continuation&&            aContinuation) override;
+
+  /**
+   * Start the processing of a batch of lambda requests via asynchronous
+   * clients, if enabled, otherwise fall back to processing them one by one.
+   *
+   * The batch is split into sub-batches of requests for the same lambda,
+   * each forwarded with a single call to the destination selected for its
+   * first request. The requests that fail are then forwarded again one by
+   * one.
+   */
+  void processBatchAsync(const rpc::LambdaRequestBatch& aReqs,
+                         BatchContinuation&&            aContinuation) override;
+
+  //! Forward a sub-batch of lambda requests to the next destination.
+  void forwardBatch(const rpc::LambdaRequestBatch&    aReqs,
+                    const std::vector<int>&           aIndices,
+                    const std::shared_ptr<BatchJoin>& aJoin);
+
+  //! Send a sub-batch of lambda requests to a given destination.
+  void sendBatch(const rpc::LambdaRequestBatch&    aReqs,
+                 const std::vector<int>&           aIndices,
+                 const std::string&                aDestination,
+                 const DestinationId               aId,
+                 const std::shared_ptr<BatchJoin>& aJoin);
+
+  /**
+   * Forward a lambda request to the next destination, asynchronously.
+   *
+   * \param aRetries the number of times the request has been already
+   * forwarded to overloaded destinations.
+   *
+   * \param aFailures the number of times the request has been already
+   * forwarded to destinations that failed to execute it.
+   *
+   * \param aHedge the state of the hedged request, only if the request may
+   * be hedged. The request is not forwarded again if another copy has been
+   * already answered.
+   */
+  void forward(const rpc::LambdaRequest&            aReq,
+               const std::shared_ptr<Continuation>& aContinuation,
+               const size_t                         aRetries  = 0,
+               const size_t                         aFailures = 0,
+               const std::shared_ptr<Hedge>&        aHedge    = nullptr);
+
+  //! Send a lambda request to a given destination, asynchronously.
+  void send(const rpc::LambdaRequest&            aReq,
+            const std::string&                   aDestination,
+            const DestinationId                  aId,
+            const std::shared_ptr<Continuation>& aContinuation,
+            const size_t                         aRetries,
+            const size_t                         aFailures,
+            const std::shared_ptr<Hedge>&        aHedge = nullptr);
+
+  /**
+   * Send a second copy of a lambda request to a destination other than the
+   * one selected first, if the request is still pending, it has not been
+   * hedged already, and the budget allows it. The budget and the state of
+   * the request are checked before selecting the destination.
+   */
+  void hedge(const std::shared_ptr<Hedge>&        aHedge,
+             const std::string&                   aPrimary,
+             const std::shared_ptr<Continuation>& aContinuation);
+
+  //! Handle the response received from a destination.
+  void receive(const rpc::LambdaRequest&            aReq,
+               const std::string&                   aDestination,
+               LambdaResponse&&                     aResp,
+               const double                         aTime,
+               const std::shared_ptr<Continuation>& aContinuation,
+               const size_t                         aRetries  = 0,
+               const size_t                         aFailures = 0,
+               const std::shared_ptr<Hedge>&        aHedge    = nullptr);
+
+  /**
+   * Execute a lambda request on a given destination with a synchronous
+   * client, within the budget of requests in flight.
+   *
+   * \throw Overloaded if the destination has no budget left.
+   */
+  std::pair<LambdaResponse, double> call(const std::string&        aDestination,
+                                         const DestinationId       aId,
+                                         const rpc::LambdaRequest& aReq);
+
+  //! \return true if the deadline of the request has expired.
+  bool expired(const rpc::LambdaRequest& aReq);
+
+  //! Complete the processing of a lambda request with an error.
+  static void fail(const std::string&                   aRetCode,
+                   const std::shared_ptr<Continuation>& aContinuation);
+
   /**
    * If the end-point of a controller was specified in the ctor, announce this
    * element to it.
@@ -138,9 +453,47 @@ class EdgeLambdaProcessor : public EdgeServer
   void controllerCommand(
       const std::function<void(EdgeControllerClient&)>& aCommand) noexcept;
 
+  /**
+   * Report to the circuit breaker the outcome of a request sent to a
+   * destination, which is ejected if needed.
+   *
+   * \param aReached true if a response has been received from the
+   * destination, whatever its return code, since this means that the
+   * destination is alive.
+   */
+  void breakerOutcome(const rpc::LambdaRequest& aReq,
+                      const std::string&        aDestination,
+                      const bool                aReached) noexcept;
+
+  //! Handle the failure of a destination to execute a lambda request.
+  void purge(const rpc::LambdaRequest& aReq, const std::string& aDestination);
+
+  //! Notify the controller asynchronously that a destination has failed.
+  void notifyFailure(const std::string& aDestination);
+
+  /**
+   * Remove asynchronously from the tables a destination that has been
+   * ejected, until its ejection time has elapsed.
+   */
+  void ejected(const std::string& aDestination);
+
+  //! Remove a destination from all the tables. \return the entries removed.
+  Entries eject(const std::string& aDestination);
+
+  //! Add back the entries of a destination removed by eject().
+  void restore(const std::string& aDestination, const Entries& aEntries);
+
+  /**
+   * Thread body sending the notifications to the controller and removing
+   * the ejected destinations from the tables, then restoring them.
+   */
+  void watcher();
+
   struct RandomWaiter {
     explicit RandomWaiter(const double aMin, const double aMax);
     void operator()() const;
+    //! \return the random time drawn, in fractional seconds.
+    double draw() const;
 
     const double theMin;
     const double theSpan;
@@ -150,10 +503,42 @@ class EdgeLambdaProcessor : public EdgeServer
   const std::string theCommandsEndpoint;
   const std::string theControllerEndpoint;
   const bool        theFakeProcessor;
+  const size_t      theOverloadRetries;
+  const size_t      theFailureRetries;
 
   EdgeClientPool                        theClientPool;
   std::unique_ptr<EdgeControllerClient> theControllerClient;
+  const double                          theNotifyInterval;
   RandomWaiter                          theRandomWaiter;
+  InFlightBudget                        theBudget;
+  CircuitBreaker                        theBreaker;
+  HedgePolicy                           theHedging;
+  std::atomic<size_t>                   theNumExpired;
+  std::atomic<size_t>                   theNumOverloaded;
+  std::atomic<size_t>                   theNumHedged;
+  std::atomic<bool>                     theStopping;
+
+  // held while changing the tables, except to update their weights
+  std::mutex theTablesMutex;
+
+  // state of the watcher thread, protected by theWatcherMutex
+  std::mutex                      theWatcherMutex;
+  std::condition_variable         theWatcherCond;
+  std::deque<std::string>         theToNotify;
+  std::deque<std::string>         theToEject;
+  std::map<std::string, Ejection> theEjections;
+  std::thread                     theWatcher;
+
+  // declared last since its callbacks use the members above
+  std::unique_ptr<EdgeClientAsync> theAsyncClient;
+
+  // static configuration
+  static constexpr double defaultNotifyInterval() {
+    return 10; // seconds
+  }
+  static constexpr size_t defaultFailureRetries() {
+    return 2;
+  }
 };
 
 } // end namespace edge
@@ -35,6 +35,9 @@ SOFTWARE.
 #include "Edge/Model/dag.h"
 #include "Support/uuid.h"
 
+#include <atomic>
+#include <cassert>
+#include <mutex>
 #include <sstream>
 
 namespace uiiit {
@@ -81,26 +84,63 @@ bool State::operator==(const State& aOther) const {
 // LambdaRequest
 ////////////////////////////////////////////////////////////////////////////////
 
-LambdaRequest::LambdaRequest(const std::string& aName,
-                             const std::string& aInput)
-    : LambdaRequest(aName, aInput, std::string()) {
+//! Unique identifier of a request, generated lazily and at most once.
+class LambdaRequest::Uuid final
+{
+ public:
+  //! Create with a known value, if not empty.
+  explicit Uuid(const std::string& aValue)
+      : theFlag()
+      , theValue(aValue)
+      , theAssigned(not aValue.empty()) {
+    // noop
+  }
+
+  //! \return the identifier, which is generated if not yet assigned.
+  const std::string& get() {
+    std::call_once(theFlag, [this]() {
+      if (theValue.empty()) {
+        theValue = support::Uuid().toString();
+      }
+      theAssigned.store(true, std::memory_order_release);
+    });
+    return theValue;
+  }
+
+  //! \return true if the identifier has been generated or received.
+  bool assigned() const noexcept {
+    return theAssigned.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::once_flag    theFlag;
+  std::string       theValue;
+  std::atomic<bool> theAssigned;
+};
+
+LambdaRequest::LambdaRequest(const Payload& aName, const Payload& aInput)
+    : LambdaRequest(aName, aInput, Payload()) {
   // noop
 }
 
-LambdaRequest::LambdaRequest(const std::string& aName,
-                             const std::string& aInput,
-                             const std::string& aDataIn)
-    : LambdaRequest(
-          aName, aInput, aDataIn, false, 0, support::Uuid().toString()) {
+LambdaRequest::LambdaRequest(const Payload& aName,
+                             const Payload& aInput,
+                             const Payload& aDataIn)
+    : LambdaRequest(aName,
+                    aInput,
+                    aDataIn,
+                    false,
+                    0,
+                    std::make_shared<Uuid>(std::string())) {
   // noop
 }
 
-LambdaRequest::LambdaRequest(const std::string& aName,
-                             const std::string& aInput,
-                             const std::string& aDataIn,
-                             const bool         aForward,
-                             const unsigned int aHops,
-                             const std::string& aUuid)
+LambdaRequest::LambdaRequest(const Payload&               aName,
+                             const Payload&               aInput,
+                             const Payload&               aDataIn,
+                             const bool                   aForward,
+                             const unsigned int           aHops,
+                             const std::shared_ptr<Uuid>& aUuid)
     : theName(aName)
     , theInput(aInput)
     , theDataIn(aDataIn)
@@ -111,14 +151,34 @@ LambdaRequest::LambdaRequest(const std::string& aName,
     , theChain(nullptr)
     , theDag(nullptr)
     , theNextFunctionIndex(0)
+    , theDeadline(0)
     , theUuid(aUuid) {
-  // noop
+  assert(theUuid);
 }
 
 LambdaRequest::LambdaRequest(const rpc::LambdaRequest& aMsg)
-    : theName(aMsg.name())
-    , theInput(aMsg.input())
-    , theDataIn(aMsg.datain())
+    : LambdaRequest(aMsg,
+                    Payload(aMsg.name()),
+                    Payload(aMsg.input()),
+                    Payload(aMsg.datain())) {
+  // noop
+}
+
+LambdaRequest::LambdaRequest(rpc::LambdaRequest&& aMsg)
+    : LambdaRequest(aMsg,
+                    Payload(std::move(*aMsg.mutable_name())),
+                    Payload(std::move(*aMsg.mutable_input())),
+                    Payload(std::move(*aMsg.mutable_datain()))) {
+  // noop
+}
+
+LambdaRequest::LambdaRequest(const rpc::LambdaRequest& aMsg,
+                             Payload&&                 aName,
+                             Payload&&                 aInput,
+                             Payload&&                 aDataIn)
+    : theName(std::move(aName))
+    , theInput(std::move(aInput))
+    , theDataIn(std::move(aDataIn))
     , theForward(true)
     , theHops(aMsg.hops())
     , theStates(deserializeStates(aMsg))
@@ -126,7 +186,8 @@ LambdaRequest::LambdaRequest(const rpc::LambdaRequest& aMsg)
     , theChain(nullptr)
     , theDag(nullptr)
     , theNextFunctionIndex(aMsg.nextfunctionindex())
-    , theUuid(aMsg.uuid()) {
+    , theDeadline(aMsg.deadline())
+    , theUuid(std::make_shared<Uuid>(aMsg.uuid())) {
   // the serialized message also contains a chain
   if (aMsg.chain_size() > 0) {
     model::Chain::Functions myFunctions;
@@ -169,9 +230,9 @@ LambdaRequest::getDependencies(const rpc::LambdaRequest& aMsg) {
 }
 
 LambdaRequest::LambdaRequest(LambdaRequest&& aOther)
-    : theName(aOther.theName)
-    , theInput(aOther.theInput)
-    , theDataIn(aOther.theDataIn)
+    : theName(std::move(aOther.theName))
+    , theInput(std::move(aOther.theInput))
+    , theDataIn(std::move(aOther.theDataIn))
     , theForward(aOther.theForward)
     , theHops(aOther.theHops)
     , theStates(std::move(aOther.theStates))
@@ -179,8 +240,9 @@ LambdaRequest::LambdaRequest(LambdaRequest&& aOther)
     , theChain(std::move(aOther.theChain))
     , theDag(std::move(aOther.theDag))
     , theNextFunctionIndex(aOther.theNextFunctionIndex)
+    , theDeadline(aOther.theDeadline)
     , theUuid(aOther.theUuid) {
-  // noop
+  // the moved-from request keeps a valid (shared) identifier
 }
 
 LambdaRequest::~LambdaRequest() {
@@ -225,7 +287,12 @@ rpc::LambdaRequest LambdaRequest::toProtobuf() const {
     }
   }
   myRet.set_nextfunctionindex(theNextFunctionIndex);
-  myRet.set_uuid(theUuid);
+  myRet.set_deadline(theDeadline);
+  // a DAG always needs an identifier, since it is used by the e-computers
+  // to match the invocations of a function from its predecessors
+  if (theUuid->assigned() or theDag.get() != nullptr) {
+    myRet.set_uuid(uuid());
+  }
   return myRet;
 }
 
@@ -238,7 +305,8 @@ bool LambdaRequest::operator==(const LambdaRequest& aOther) const {
          (theChain.get() == nullptr or *theChain == *aOther.theChain) and
          ((theDag.get() == nullptr) == (aOther.theDag.get() == nullptr)) and
          (theDag.get() == nullptr or *theDag == *aOther.theDag) and
-         theNextFunctionIndex == aOther.theNextFunctionIndex
+         theNextFunctionIndex == aOther.theNextFunctionIndex and
+         theDeadline == aOther.theDeadline
       /* and theUuid == aOther.theUuid */;
 }
 
@@ -259,29 +327,33 @@ LambdaRequest LambdaRequest::copy() const {
     ret.theDag = std::make_unique<model::Dag>(*theDag);
   }
   ret.theNextFunctionIndex = theNextFunctionIndex;
+  ret.theDeadline          = theDeadline;
   return ret;
 }
 
+const std::string& LambdaRequest::uuid() const {
+  return theUuid->get();
+}
+
 LambdaRequest LambdaRequest::regenerate(const std::string& aName,
                                         const size_t       aNextFunctionIndex,
-                                        const rpc::LambdaResponse& aResponse) {
+                                        const LambdaResponse& aResponse) const {
   LambdaRequest ret(aName,
-                    aResponse.output(),
-                    aResponse.dataout(),
+                    aResponse.theOutput,
+                    aResponse.theDataOut,
                     false,
                     theHops + 1,
                     theUuid);
-  ret.theStates   = deserializeStates(aResponse);
+  ret.theStates   = aResponse.theStates;
   ret.theCallback = theCallback;
   if (theChain.get() != nullptr) {
-    ret.theChain = std::move(theChain);
-    theChain     = nullptr;
+    ret.theChain = std::make_unique<model::Chain>(*theChain);
   }
   if (theDag.get() != nullptr) {
-    ret.theDag = std::move(theDag);
-    theDag     = nullptr;
+    ret.theDag = std::make_unique<model::Dag>(*theDag);
   }
   ret.theNextFunctionIndex = aNextFunctionIndex;
+  ret.theDeadline          = theDeadline;
   return ret;
 }
 
@@ -296,11 +368,14 @@ std::string LambdaRequest::toString() const {
   std::stringstream myStream;
   myStream << "name: " << theName << ", "
            << (theForward ? "from edge node" : "from edge client") << ", uuid "
-           << theUuid
+           << (theUuid->assigned() ? uuid() : std::string("n/a"))
            << (theCallback.empty() ? std::string() :
                                      (std::string(", callback ") + theCallback))
            << ", hops: " << theHops << ", input: " << theInput
            << ", datain size: " << theDataIn.size();
+  if (theDeadline > 0) {
+    myStream << ", deadline: " << theDeadline;
+  }
   if (not theStates.empty()) {
     myStream << ", states: [";
     for (auto it = theStates.cbegin(); it != theStates.end(); ++it) {
@@ -336,20 +411,20 @@ LambdaResponse::LambdaResponse()
 }
 
 LambdaResponse::LambdaResponse(const std::string& aRetCode,
-                               const std::string& aOutput)
+                               const Payload&     aOutput)
     : LambdaResponse(aRetCode, aOutput, {{0.0, 0.0, 0.0}}, false) {
   // noop
 }
 
 LambdaResponse::LambdaResponse(const std::string&           aRetCode,
-                               const std::string&           aOutput,
+                               const Payload&               aOutput,
                                const std::array<double, 3>& aLoads)
     : LambdaResponse(aRetCode, aOutput, aLoads, false) {
   // noop
 }
 
 LambdaResponse::LambdaResponse(const std::string&           aRetCode,
-                               const std::string&           aOutput,
+                               const Payload&               aOutput,
                                const std::array<double, 3>& aLoads,
                                const bool                   aAsynchronous)
     : theRetCode(aRetCode)
@@ -367,8 +442,19 @@ LambdaResponse::LambdaResponse(const std::string&           aRetCode,
 }
 
 LambdaResponse::LambdaResponse(const rpc::LambdaResponse& aMsg)
+    : LambdaResponse(aMsg, Payload(aMsg.output())) {
+  // noop
+}
+
+LambdaResponse::LambdaResponse(rpc::LambdaResponse&& aMsg)
+    : LambdaResponse(aMsg, Payload(std::move(*aMsg.mutable_output()))) {
+  // noop
+}
+
+LambdaResponse::LambdaResponse(const rpc::LambdaResponse& aMsg,
+                               Payload&&                  aOutput)
     : theRetCode(aMsg.retcode())
-    , theOutput(aMsg.output())
+    , theOutput(std::move(aOutput))
     , theResponder(aMsg.responder())
     , theProcessingTime(aMsg.ptime())
     , theDataOut(aMsg.dataout())
@@ -34,6 +34,8 @@ SOFTWARE.
 #include "edgeserver.grpc.pb.h"
 
 #include "Edge/Model/states.h"
+#include "Edge/deadline.h"
+#include "Edge/payload.h"
 
 #include <array>
 #include <iostream>
@@ -48,6 +50,8 @@ class Chain;
 class Dag;
 }; // namespace model
 
+struct LambdaResponse;
+
 //! An application's state.
 struct State {
   //! Create with given location and content.
@@ -101,7 +105,7 @@ struct LambdaRequest final {
    *
    * The forward flag is not set.
    */
-  explicit LambdaRequest(const std::string& aName, const std::string& aInput);
+  explicit LambdaRequest(const Payload& aName, const Payload& aInput);
 
   /**
    * Create a lambda request with text and data input only and no states.
@@ -112,9 +116,9 @@ struct LambdaRequest final {
    *
    * The forward flag is not set.
    */
-  explicit LambdaRequest(const std::string& aName,
-                         const std::string& aInput,
-                         const std::string& aDataIn);
+  explicit LambdaRequest(const Payload& aName,
+                         const Payload& aInput,
+                         const Payload& aDataIn);
   /**
    * Create a lambda request from an underlying protobuf.
    *
@@ -122,6 +126,10 @@ struct LambdaRequest final {
    */
   explicit LambdaRequest(const rpc::LambdaRequest& aMsg);
 
+  //! Create from an underlying protobuf, stealing its input buffers.
+  explicit LambdaRequest(rpc::LambdaRequest&& aMsg);
+
+  //! Move the content of another request, without copying its payloads.
   LambdaRequest(LambdaRequest&& aOther);
 
   LambdaRequest(LambdaRequest&) = delete;
@@ -134,13 +142,21 @@ struct LambdaRequest final {
   //! \return a lambda request identical to the input with +1 hops.
   LambdaRequest makeOneMoreHop() const;
 
-  //! \return a lambda request identical to this one.
+  /**
+   * \return a lambda request identical to this one.
+   *
+   * The name, input, data input and unique identifier are shared with this
+   * request, i.e., they are not duplicated.
+   */
   LambdaRequest copy() const;
 
   /**
    * @brief Regenerate a lambda request.
    *
-   * Note that the chain and DAG in this request are invalidated.
+   * The chain and DAG in this request are copied, hence the same request
+   * can be used to regenerate the invocations of multiple functions.
+   * The output and data output of the response are shared with (not copied
+   * into) the new request.
    *
    * @param aName lambda function name.
    * @param aNextFunctionIndex the index of the next function.
@@ -148,9 +164,9 @@ struct LambdaRequest final {
    *
    * @return a new lambda request regenerated from this one.
    */
-  LambdaRequest regenerate(const std::string&         aName,
-                           const size_t               aNextFunctionIndex,
-                           const rpc::LambdaResponse& aResponse);
+  LambdaRequest regenerate(const std::string&    aName,
+                           const size_t          aNextFunctionIndex,
+                           const LambdaResponse& aResponse) const;
 
   /**
    * @brief Return the request name
@@ -170,14 +186,24 @@ struct LambdaRequest final {
     return theStates;
   }
 
+  /**
+   * \return the unique identifier of this request.
+   *
+   * The identifier is generated upon the first call, unless it has been
+   * received with the protobuf message, and it is shared with all the
+   * requests obtained from this one with copy(), makeOneMoreHop() and
+   * regenerate().
+   */
+  const std::string& uuid() const;
+
   //! \return the protobuf-encoded message.
   rpc::LambdaRequest toProtobuf() const;
   //! \return a human-readable representation of the request.
   std::string toString() const;
 
-  const std::string             theName;
-  const std::string             theInput;
-  const std::string             theDataIn;
+  Payload                       theName;
+  Payload                       theInput;
+  Payload                       theDataIn;
   const bool                    theForward;
   unsigned int                  theHops;
   std::map<std::string, State>  theStates;
@@ -185,18 +211,28 @@ struct LambdaRequest final {
   std::unique_ptr<model::Chain> theChain;
   std::unique_ptr<model::Dag>   theDag;
   unsigned int                  theNextFunctionIndex;
-  const std::string             theUuid;
+  Deadline                      theDeadline; //!< 0 if none
 
  private:
-  explicit LambdaRequest(const std::string& aName,
-                         const std::string& aInput,
-                         const std::string& aDataIn,
-                         const bool         aForward,
-                         const unsigned int aHops,
-                         const std::string& aUuid);
+  class Uuid;
+
+  explicit LambdaRequest(const Payload&               aName,
+                         const Payload&               aInput,
+                         const Payload&               aDataIn,
+                         const bool                   aForward,
+                         const unsigned int           aHops,
+                         const std::shared_ptr<Uuid>& aUuid);
+
+  explicit LambdaRequest(const rpc::LambdaRequest& aMsg,
+                         Payload&&                 aName,
+                         Payload&&                 aInput,
+                         Payload&&                 aDataIn);
 
   static model::States::Dependencies
   getDependencies(const rpc::LambdaRequest& aMsg);
+
+  // never null, possibly shared with other requests
+  std::shared_ptr<Uuid> theUuid;
 };
 
 //! A function return, possibly also embeddeding states.
@@ -205,17 +241,19 @@ struct LambdaResponse final {
   explicit LambdaResponse();
 
   //! Create a synchronous response (with output).
-  explicit LambdaResponse(const std::string& aRetCode,
-                          const std::string& aOutput);
+  explicit LambdaResponse(const std::string& aRetCode, const Payload& aOutput);
 
   //! Create a synchronous response (with output), with load indications.
   explicit LambdaResponse(const std::string&           aRetCode,
-                          const std::string&           aOutput,
+                          const Payload&               aOutput,
                           const std::array<double, 3>& aLoads);
 
   //! Deserialize from protobuf.
   explicit LambdaResponse(const rpc::LambdaResponse& aMsg);
 
+  //! Deserialize from protobuf, stealing its output buffer.
+  explicit LambdaResponse(rpc::LambdaResponse&& aMsg);
+
   //! \return true if the messages are identical.
   bool operator==(const LambdaResponse& aOther) const;
 
@@ -241,10 +279,10 @@ struct LambdaResponse final {
   std::string toString() const;
 
   const std::string            theRetCode;
-  const std::string            theOutput;
+  Payload                      theOutput;
   std::string                  theResponder;
   unsigned int                 theProcessingTime;
-  std::string                  theDataOut;
+  Payload                      theDataOut;
   unsigned short               theLoad1;
   unsigned short               theLoad10;
   unsigned short               theLoad30;
@@ -254,9 +292,11 @@ struct LambdaResponse final {
 
  private:
   explicit LambdaResponse(const std::string&           aRetCode,
-                          const std::string&           aOutput,
+                          const Payload&               aOutput,
                           const std::array<double, 3>& aLoads,
                           const bool                   aAsynchronous);
+
+  explicit LambdaResponse(const rpc::LambdaResponse& aMsg, Payload&& aOutput);
 };
 
 // free functions
@@ -32,11 +32,14 @@ SOFTWARE.
 #include "edgerouter.h"
 
 #include "Support/conf.h"
+#include "destinationregistry.h"
 #include "edgemessages.h"
 #include "forwardingtablefactory.h"
 #include "localoptimizer.h"
 #include "localoptimizerfactory.h"
 
+#include <algorithm>
+
 namespace uiiit {
 namespace edge {
 
@@ -60,11 +63,31 @@ EdgeRouter::EdgeRouter(const std::string&   aLambdaEndpoint,
           LocalOptimizerFactory::make(*theFinalTable, aLocalOptimizerConf)) {
 }
 
-std::string EdgeRouter::destination(const rpc::LambdaRequest& aReq) {
-  if (aReq.forward()) {
-    return (*theFinalTable)(aReq.name());
+EdgeRouter::~EdgeRouter() {
+  // the asynchronous operations in progress use the members of this class
+  stop();
+}
+
+std::string EdgeRouter::destination(const rpc::LambdaRequest& aReq,
+                                    DestinationId&            aId) {
+  auto& myTable = table(aReq);
+  aId           = myTable.type() == ForwardingTable::Type::ConsistentHash ?
+                      myTable.select(aReq.name(), affinityKey(aReq)) :
+                      myTable.select(aReq.name());
+  return DestinationRegistry::instance().name(aId);
+}
+
+std::string EdgeRouter::alternative(const rpc::LambdaRequest& aReq,
+                                    const std::string&        aExcluded,
+                                    DestinationId&            aId) {
+  for (size_t i = 0; i < alternativeDraws(); i++) {
+    auto ret = destination(aReq, aId);
+    if (ret != aExcluded) {
+      return ret;
+    }
   }
-  return (*theOverallTable)(aReq.name());
+  aId = DestinationRegistry::invalid();
+  return std::string();
 }
 
 void EdgeRouter::processSuccess(const rpc::LambdaRequest& aReq,
@@ -93,6 +116,43 @@ void EdgeRouter::processFailure(const rpc::LambdaRequest& aReq,
   (*theFinalTable).remove(aReq.name(), aDestination);
 }
 
+void EdgeRouter::processStart(const rpc::LambdaRequest& aReq,
+                              const DestinationId       aId) {
+  table(aReq).load().increment(aId);
+}
+
+void EdgeRouter::processEnd(const rpc::LambdaRequest& aReq,
+                            const DestinationId       aId) {
+  table(aReq).load().decrement(aId);
+}
+
+ForwardingTable& EdgeRouter::table(const rpc::LambdaRequest& aReq) {
+  assert(theOverallTable);
+  assert(theFinalTable);
+  return aReq.forward() ? *theFinalTable : *theOverallTable;
+}
+
+std::string EdgeRouter::affinityKey(const rpc::LambdaRequest& aReq) {
+  if (not aReq.uuid().empty()) {
+    return aReq.uuid();
+  }
+
+  // the order of the states in the message is not specified
+  std::vector<std::string> myNames;
+  myNames.reserve(aReq.states_size());
+  for (const auto& myState : aReq.states()) {
+    myNames.emplace_back(myState.first);
+  }
+  std::sort(myNames.begin(), myNames.end());
+
+  std::string ret;
+  for (const auto& myName : myNames) {
+    ret += myName;
+    ret += '\n';
+  }
+  return ret;
+}
+
 std::vector<ForwardingTableInterface*> EdgeRouter::tables() {
   std::vector<ForwardingTableInterface*> myRet(2);
   myRet[0] = theOverallTable.get();
@@ -96,12 +96,24 @@ class EdgeRouter final : public EdgeLambdaProcessor
                       const support::Conf& aLocalOptimizerConf,
                       const support::Conf& aClientConf);
 
+  ~EdgeRouter() override;
+
   //! \return The forwarding tables: 0 is the overall, 1 is the final.
   std::vector<ForwardingTableInterface*> tables() override;
 
  private:
   //! \return the destination associated to the given lambda request.
-  std::string destination(const rpc::LambdaRequest& aReq) override;
+  std::string destination(const rpc::LambdaRequest& aReq,
+                          DestinationId&            aId) override;
+
+  /**
+   * \return a destination other than the given one, drawn again from the
+   * table a few times, or an empty string if none is found, e.g., with
+   * consistent hashing.
+   */
+  std::string alternative(const rpc::LambdaRequest& aReq,
+                          const std::string&        aExcluded,
+                          DestinationId&            aId) override;
 
   //! Called upon successful execution of a lambda function on a computer.
   void processSuccess(const rpc::LambdaRequest& aReq,
@@ -113,11 +125,35 @@ class EdgeRouter final : public EdgeLambdaProcessor
   void processFailure(const rpc::LambdaRequest& aReq,
                       const std::string&        aDestination) override;
 
+  //! Count a new request in flight towards the destination.
+  void processStart(const rpc::LambdaRequest& aReq,
+                    const DestinationId       aId) override;
+
+  //! Count a request in flight towards the destination as returned.
+  void processEnd(const rpc::LambdaRequest& aReq,
+                  const DestinationId       aId) override;
+
+  //! \return the table used for the given lambda request.
+  ForwardingTable& table(const rpc::LambdaRequest& aReq);
+
+  /**
+   * \return the key of a lambda request for the tables that keep correlated
+   * requests together: the identifier of the request, which is shared by all
+   * the invocations of the functions in a DAG, if assigned; otherwise the
+   * names of its states. Can be empty.
+   */
+  static std::string affinityKey(const rpc::LambdaRequest& aReq);
+
  private:
   std::unique_ptr<ForwardingTable> theOverallTable;
   std::shared_ptr<LocalOptimizer>  theOverallOptimizer;
   std::unique_ptr<ForwardingTable> theFinalTable;
   std::shared_ptr<LocalOptimizer>  theFinalOptimizer;
+
+  // static configuration
+  static constexpr size_t alternativeDraws() {
+    return 3; // attempts to select a destination other than the excluded one
+  }
 }; // namespace edge
 
 } // namespace edge
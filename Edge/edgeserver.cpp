@@ -31,6 +31,8 @@ SOFTWARE.
 
 #include "edgeserver.h"
 
+#include <cassert>
+
 namespace uiiit {
 namespace edge {
 
@@ -39,5 +41,50 @@ EdgeServer::EdgeServer(const std::string& aServerEndpoint)
     , theServerEndpoint(aServerEndpoint) {
 }
 
+void EdgeServer::processBatchAsync(const rpc::LambdaRequestBatch& aReqs,
+                                   BatchContinuation&& aContinuation) {
+  const size_t mySize = aReqs.requests_size();
+  if (mySize == 0) {
+    aContinuation(rpc::LambdaResponseBatch());
+    return;
+  }
+  const auto myJoin =
+      std::make_shared<BatchJoin>(mySize, std::move(aContinuation));
+  for (size_t i = 0; i < mySize; i++) {
+    processAsync(aReqs.requests(i),
+                 [myJoin, i](rpc::LambdaResponse&& aResponse) {
+                   (*myJoin)(i, std::move(aResponse));
+                 });
+  }
+}
+
+EdgeServer::BatchJoin::BatchJoin(const size_t        aSize,
+                                 BatchContinuation&& aContinuation)
+    : theMutex()
+    , theResponses()
+    , theMissing(aSize)
+    , theContinuation(std::move(aContinuation)) {
+  assert(aSize > 0);
+  theResponses.mutable_responses()->Reserve(aSize);
+  for (size_t i = 0; i < aSize; i++) {
+    theResponses.add_responses();
+  }
+}
+
+void EdgeServer::BatchJoin::operator()(const size_t          aIndex,
+                                       rpc::LambdaResponse&& aResponse) {
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    assert(static_cast<int>(aIndex) < theResponses.responses_size());
+    assert(theMissing > 0);
+    *theResponses.mutable_responses(aIndex) = std::move(aResponse);
+    if (--theMissing > 0) {
+      return;
+    }
+  }
+  // the last response has been received: no other thread can access them
+  theContinuation(std::move(theResponses));
+}
+
 } // namespace edge
 } // namespace uiiit
@@ -35,6 +35,8 @@ SOFTWARE.
 
 #include "edgeserver.grpc.pb.h"
 
+#include <functional>
+#include <mutex>
 #include <set>
 #include <thread>
 
@@ -53,6 +55,34 @@ class EdgeServer
  public:
   NONCOPYABLE_NONMOVABLE(EdgeServer);
 
+  //! Function called with the response once a lambda request is complete.
+  using Continuation = std::function<void(rpc::LambdaResponse&&)>;
+
+  //! Function called with the responses once a batch of requests is complete.
+  using BatchContinuation = std::function<void(rpc::LambdaResponseBatch&&)>;
+
+  /**
+   * Collect the responses to the requests of a batch, which can be set in any
+   * order and by any thread, then call the continuation once all of them are
+   * available.
+   */
+  class BatchJoin final
+  {
+   public:
+    NONCOPYABLE_NONMOVABLE(BatchJoin);
+
+    explicit BatchJoin(const size_t aSize, BatchContinuation&& aContinuation);
+
+    //! Set the response of the aIndex-th request of the batch.
+    void operator()(const size_t aIndex, rpc::LambdaResponse&& aResponse);
+
+   private:
+    std::mutex               theMutex;
+    rpc::LambdaResponseBatch theResponses;
+    size_t                   theMissing;
+    const BatchContinuation  theContinuation;
+  };
+
   //! Create an edge server with just a mutex and an endpoint
   explicit EdgeServer(const std::string& aServerEndpoint);
 
@@ -66,6 +96,43 @@ class EdgeServer
   //! Perform actual processing of a lambda request.
   virtual rpc::LambdaResponse process(const rpc::LambdaRequest& aReq) = 0;
 
+  /**
+   * Start the processing of a lambda request without requiring the caller to
+   * wait for the response.
+   *
+   * The default implementation calls process() and then the continuation
+   * from the caller's thread. Specialized classes may override this method
+   * to complete the processing later on from any thread.
+   *
+   * \param aReq The lambda request, which remains valid until the
+   * continuation is called.
+   *
+   * \param aContinuation The function to be called exactly once with the
+   * response.
+   */
+  virtual void processAsync(const rpc::LambdaRequest& aReq,
+                            Continuation&&            aContinuation) {
+    aContinuation(process(aReq));
+  }
+
+  /**
+   * Start the processing of a batch of independent lambda requests without
+   * requiring the caller to wait for the responses.
+   *
+   * The default implementation starts the processing of every request via
+   * processAsync() and calls the continuation when the last one is complete.
+   * Specialized classes may override this method to handle the batch as a
+   * whole.
+   *
+   * \param aReqs The lambda requests, which remain valid until the
+   * continuation is called.
+   *
+   * \param aContinuation The function to be called exactly once with the
+   * responses, in the same order as the requests.
+   */
+  virtual void processBatchAsync(const rpc::LambdaRequestBatch& aReqs,
+                                 BatchContinuation&&            aContinuation);
+
   /**
    * This method is invoked by the implementation class immediately after the
    * communication interface has been set up. It can be overriden by
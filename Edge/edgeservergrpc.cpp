@@ -32,10 +32,19 @@ SOFTWARE.
 #include "edgeservergrpc.h"
 
 #include "Support/chrono.h"
+#include "deadline.h"
 #include "edgemessages.h"
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 // #define TRACE_TASKS
 
 GPRAPI void gpr_log(const char*, int, gpr_log_severity, const char*, ...) {
@@ -44,21 +53,71 @@ GPRAPI void gpr_log(const char*, int, gpr_log_severity, const char*, ...) {
 namespace uiiit {
 namespace edge {
 
+namespace {
+
+google::protobuf::ArenaOptions arenaOptions(char* aBlock, const size_t aSize) {
+  google::protobuf::ArenaOptions ret;
+  ret.initial_block      = aBlock;
+  ret.initial_block_size = aSize;
+  return ret;
+}
+
+} // namespace
+
 EdgeServerGrpc::CallData::CallData(rpc::EdgeServer::AsyncService* aService,
                                    grpc::ServerCompletionQueue*   aCq,
-                                   EdgeServerGrpc&                aEdgeServer)
+                                   EdgeServerGrpc&                aEdgeServer,
+                                   Pool*                          aPool)
     : theService(aService)
     , theCq(aCq)
     , theEdgeServer(aEdgeServer)
+    , thePool(aPool)
+    , theArena(arenaOptions(theInitialBlock, theInitialBlockSize))
     , theContext()
-    , theRequest()
-    , theResponse()
-    , theResponder(&theContext)
+    , theRequest(nullptr)
+    , theResponse(nullptr)
+    , theResponder()
     , theStatus(CREATE) {
   // Invoke the serving logic right away.
+  reset();
+}
+
+void EdgeServerGrpc::CallData::reset() {
+  // the responder and the context refer to the messages on the arena
+  theResponder.reset();
+  theContext.reset();
+  theArena.Reset();
+
+  theContext.emplace();
+  theRequest =
+      google::protobuf::Arena::CreateMessage<rpc::LambdaRequest>(&theArena);
+  theResponse =
+      google::protobuf::Arena::CreateMessage<rpc::LambdaResponse>(&theArena);
+  theResponder.emplace(&*theContext);
+  theStatus = CREATE;
+
   Proceed();
 }
 
+void EdgeServerGrpc::CallData::proceed(const bool aOk) {
+  if (not aOk) {
+    // either the server is shutting down while waiting for a request or the
+    // response could not be sent: in both cases no other event will follow
+    VLOG(1) << "Invalid event found (status " << theStatus << ")";
+    dispose();
+  } else {
+    Proceed();
+  }
+}
+
+void EdgeServerGrpc::CallData::dispose() {
+  if (thePool != nullptr) {
+    thePool->release(this);
+  } else {
+    delete this;
+  }
+}
+
 void EdgeServerGrpc::CallData::Proceed() {
   if (theStatus == CREATE) {
     VLOG(2) << "CREATE";
@@ -72,54 +131,332 @@ void EdgeServerGrpc::CallData::Proceed() {
     // instances can serve different requests concurrently), in this case
     // the memory address of this CallData instance.
     theService->RequestRunLambda(
-        &theContext, &theRequest, &theResponder, theCq, theCq, this);
+        &*theContext, theRequest, &*theResponder, theCq, theCq, this);
 
   } else if (theStatus == PROCESS) {
-    VLOG(2) << "PROCESS (" << theContext.peer() << ")";
+    VLOG(2) << "PROCESS (" << theContext->peer() << ")";
 
-#ifdef TRACE_TASKS
-    support::Chrono myChrono(true);
-#endif
+    // the deadline of the call is propagated with the request, if the client
+    // has not set one explicitly
+    if (theRequest->deadline() == 0) {
+      theRequest->set_deadline(deadlineFromTimePoint(theContext->deadline()));
+    }
 
     // Spawn a new CallData instance to serve new clients while we process
-    // the one for this CallData. The instance will deallocate itself as
-    // part of its FINISH state.
-    new CallData(theService, theCq, theEdgeServer);
+    // the one for this CallData. The instance will deallocate itself, or
+    // return to the pool, as part of its FINISH state.
+    if (thePool != nullptr) {
+      thePool->spawn();
+    } else {
+      new CallData(theService, theCq, theEdgeServer, nullptr);
+    }
 
-    // The actual processing.
-    theResponse = theEdgeServer.process(theRequest);
+    // The actual processing, which will be complete asynchronously.
+    theEdgeServer.dispatch(this);
+
+  } else {
+    VLOG(2) << "FINISH";
+    assert(theStatus == FINISH);
+
+    // Once in the FINISH state, deallocate ourselves (CallData) or give
+    // ourselves back to the pool.
+    dispose();
+  }
+}
+
+void EdgeServerGrpc::CallData::complete(rpc::LambdaResponse&& aResponse) {
+  assert(theStatus == PROCESS);
+
+  *theResponse = std::move(aResponse);
+
+  // And we are done! Let the gRPC runtime know we've finished, using the
+  // memory address of this instance as the uniquely identifying tag for
+  // the event.
+  theStatus = FINISH;
+  theResponder->Finish(*theResponse, grpc::Status::OK, this);
+}
+
+EdgeServerGrpc::BatchCall::BatchCall(rpc::EdgeServer::AsyncService* aService,
+                                     grpc::ServerCompletionQueue*   aCq,
+                                     EdgeServerGrpc&                aEdgeServer)
+    : theService(aService)
+    , theCq(aCq)
+    , theEdgeServer(aEdgeServer)
+    , theContext()
+    , theRequest()
+    , theResponse()
+    , theResponder(&theContext)
+    , theFinished(false) {
+  theService->RequestRunLambdaBatch(
+      &theContext, &theRequest, &theResponder, theCq, theCq, this);
+}
+
+void EdgeServerGrpc::BatchCall::proceed(const bool aOk) {
+  if (theFinished or not aOk) {
+    // the response has been sent or the server is shutting down
+    delete this;
+    return;
+  }
+
+  VLOG(2) << "batch of " << theRequest.requests_size() << " PROCESS ("
+          << theContext.peer() << ")";
+
+  // serve new clients while we serve this one
+  new BatchCall(theService, theCq, theEdgeServer);
+
+  // same as for unary calls
+  const auto myDeadline = deadlineFromTimePoint(theContext.deadline());
+  for (auto& myRequest : *theRequest.mutable_requests()) {
+    if (myRequest.deadline() == 0) {
+      myRequest.set_deadline(myDeadline);
+    }
+  }
+
+  theEdgeServer.dispatch(this);
+}
+
+void EdgeServerGrpc::BatchCall::start(EdgeServerGrpc& aEdgeServer) {
+  aEdgeServer.theEdgeServer.processBatchAsync(
+      theRequest, [this, &aEdgeServer](rpc::LambdaResponseBatch&& aResponse) {
+        theResponse = std::move(aResponse);
+        theFinished = true;
+        // this object may be deallocated by another thread from now on
+        theResponder.Finish(theResponse, grpc::Status::OK, this);
+        aEdgeServer.done();
+      });
+}
+
+void EdgeServerGrpc::SingleJob::start(EdgeServerGrpc& aEdgeServer) {
+  EdgeServer::Continuation myContinuation =
+      [this, &aEdgeServer](rpc::LambdaResponse&& aResponse) {
+        complete(std::move(aResponse));
+        aEdgeServer.done();
+      };
 
 #ifdef TRACE_TASKS
-    std::cout << theRequest.name() << " took " << myChrono.stop()
-              << " return-code " << theResponse.retcode() << std::endl;
+  myContinuation = [myContinuation,
+                    myName   = request().name(),
+                    myChrono = std::make_shared<support::Chrono>(true)](
+                       rpc::LambdaResponse&& aResponse) {
+    std::cout << myName << " took " << myChrono->stop() << " return-code "
+              << aResponse.retcode() << std::endl;
+    myContinuation(std::move(aResponse));
+  };
 #endif
 
-    // And we are done! Let the gRPC runtime know we've finished, using the
-    // memory address of this instance as the uniquely identifying tag for
-    // the event.
-    theStatus = FINISH;
-    theResponder.Finish(theResponse, grpc::Status::OK, this);
+  aEdgeServer.theEdgeServer.processAsync(request(), std::move(myContinuation));
+}
+
+void EdgeServerGrpc::Stream::Request::complete(
+    rpc::LambdaResponse&& aResponse) {
+  aResponse.set_id(theRequest.id());
+  theStream.write(std::move(aResponse));
+  delete this;
+}
 
-  } else {
-    VLOG(2) << "FINISH";
-    assert(theStatus == FINISH);
+EdgeServerGrpc::Stream::Stream(rpc::EdgeServer::AsyncService* aService,
+                               grpc::ServerCompletionQueue*   aCq,
+                               EdgeServerGrpc&                aEdgeServer)
+    : theService(aService)
+    , theCq(aCq)
+    , theEdgeServer(aEdgeServer)
+    , theContext()
+    , theStream(&theContext)
+    , theConnectEvent(*this, &Stream::connected)
+    , theReadEvent(*this, &Stream::read)
+    , theWriteEvent(*this, &Stream::written)
+    , theFinishEvent(*this, &Stream::finished)
+    , theNext(std::make_unique<Request>(*this))
+    , theMutex()
+    , theOutgoing()
+    , theInFlight(0)
+    , theReading(true)
+    , theWriting(false)
+    , theBroken(false) {
+  theService->RequestRunLambdaStream(
+      &theContext, &theStream, theCq, theCq, &theConnectEvent);
+}
+
+EdgeServerGrpc::Stream::~Stream() {
+  const std::lock_guard<std::mutex> myLock(theEdgeServer.theMutex);
+  theEdgeServer.theStreams.erase(this);
+}
+
+void EdgeServerGrpc::Stream::cancel() {
+  theContext.TryCancel();
+}
 
-    // Once in the FINISH state, deallocate ourselves (CallData).
+void EdgeServerGrpc::Stream::connected(const bool aOk) {
+  if (not aOk) {
+    // the server is shutting down
     delete this;
+    return;
+  }
+
+  VLOG(2) << "stream CONNECTED (" << theContext.peer() << ")";
+
+  // serve new clients while we serve this one
+  new Stream(theService, theCq, theEdgeServer);
+
+  {
+    const std::lock_guard<std::mutex> myLock(theEdgeServer.theMutex);
+    theEdgeServer.theStreams.insert(this);
+    if (theEdgeServer.theStopping) {
+      cancel();
+    }
+  }
+
+  theStream.Read(&theNext->theRequest, &theReadEvent);
+}
+
+void EdgeServerGrpc::Stream::read(const bool aOk) {
+  if (not aOk) {
+    // the client will not send further requests, or the stream is broken
+    VLOG(2) << "stream READ-DONE (" << theContext.peer() << ")";
+    theNext.reset();
+    std::unique_lock<std::mutex> myLock(theMutex);
+    theReading = false;
+    flush(myLock);
+    return;
   }
+
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    theInFlight++;
+  }
+  auto myJob = theNext.release();
+  theNext    = std::make_unique<Request>(*this);
+  theStream.Read(&theNext->theRequest, &theReadEvent);
+
+  // the actual processing, which will be complete asynchronously
+  theEdgeServer.dispatch(myJob);
+}
+
+void EdgeServerGrpc::Stream::written(const bool aOk) {
+  std::unique_lock<std::mutex> myLock(theMutex);
+  assert(theWriting);
+  assert(not theOutgoing.empty());
+  theWriting = false;
+  theOutgoing.pop_front();
+  if (not aOk) {
+    VLOG(2) << "stream BROKEN (" << theContext.peer() << ")";
+    theBroken = true;
+    theOutgoing.clear();
+  }
+  flush(myLock);
+}
+
+void EdgeServerGrpc::Stream::finished([[maybe_unused]] const bool aOk) {
+  VLOG(2) << "stream FINISH (" << theContext.peer() << ")";
+  delete this;
+}
+
+void EdgeServerGrpc::Stream::write(rpc::LambdaResponse&& aResponse) {
+  std::unique_lock<std::mutex> myLock(theMutex);
+  assert(theInFlight > 0);
+  theInFlight--;
+  if (not theBroken) {
+    theOutgoing.emplace_back(std::move(aResponse));
+  }
+  flush(myLock);
+}
+
+void EdgeServerGrpc::Stream::flush(std::unique_lock<std::mutex>& aLock) {
+  assert(aLock.owns_lock());
+  if (theWriting) {
+    // the next response will be written once the current one is done
+    return;
+  }
+
+  // no new operations are allowed once the server is stopping, since
+  // the completion queue may be shut down
+  const bool myStopping = theEdgeServer.theStopping;
+  if (not theOutgoing.empty() and not theBroken and not myStopping) {
+    // only one write at a time can be pending on a stream
+    theWriting = true;
+    theStream.Write(theOutgoing.front(), &theWriteEvent);
+    return;
+  }
+
+  if (theReading or theInFlight > 0) {
+    return;
+  }
+
+  // nothing else will happen on this stream
+  aLock.unlock();
+  if (theBroken or myStopping) {
+    delete this;
+  } else {
+    theStream.Finish(grpc::Status::OK, &theFinishEvent);
+  }
+}
+
+EdgeServerGrpc::Pool::Pool(rpc::EdgeServer::AsyncService* aService,
+                           grpc::ServerCompletionQueue*   aCq,
+                           EdgeServerGrpc&                aEdgeServer)
+    : theService(aService)
+    , theCq(aCq)
+    , theEdgeServer(aEdgeServer)
+    , theMutex()
+    , theAll()
+    , theFree() {
+  // noop
+}
+
+void EdgeServerGrpc::Pool::spawn() {
+  CallData* myCallData = nullptr;
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    if (theFree.empty()) {
+      // the new instance waits for a request as soon as created
+      theAll.emplace_back(
+          std::make_unique<CallData>(theService, theCq, theEdgeServer, this));
+      return;
+    }
+    myCallData = theFree.back();
+    theFree.pop_back();
+  }
+  assert(myCallData != nullptr);
+  myCallData->reset();
+}
+
+void EdgeServerGrpc::Pool::release(CallData* aCallData) {
+  assert(aCallData != nullptr);
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theFree.emplace_back(aCallData);
+}
+
+size_t EdgeServerGrpc::Pool::size() const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  return theAll.size();
 }
 
 EdgeServerGrpc::EdgeServerGrpc(EdgeServer&        aEdgeServer,
                                const std::string& aServerEndpoint,
-                               const size_t       aNumThreads)
+                               const size_t       aNumThreads,
+                               const size_t       aNumExecutors,
+                               const bool         aSharded,
+                               const bool         aAffinity,
+                               const bool         aPooled)
     : EdgeServerImpl(aEdgeServer)
     , theMutex()
     , theServerEndpoint(aServerEndpoint)
     , theNumThreads(aNumThreads)
-    , theCq()
+    , theNumExecutors(aNumExecutors)
+    , theSharded(aSharded)
+    , theAffinity(aAffinity)
+    , thePooled(aPooled)
+    , theCqs()
+    , thePools()
     , theService()
     , theServer()
-    , theHandlers() {
+    , theHandlers()
+    , theExecutors()
+    , theExecutorQueue()
+    , thePending(0)
+    , thePendingCond()
+    , theStreams()
+    , theStopping(false) {
   if (aNumThreads == 0) {
     throw std::runtime_error("Cannot spawn 0 threads");
   }
@@ -137,13 +474,33 @@ void EdgeServerGrpc::run() {
   myBuilder.AddListeningPort(theServerEndpoint,
                              grpc::InsecureServerCredentials());
   myBuilder.RegisterService(&theService);
-  theCq     = myBuilder.AddCompletionQueue();
+  for (size_t i = 0; i < (theSharded ? theNumThreads : 1); i++) {
+    theCqs.emplace_back(myBuilder.AddCompletionQueue());
+    if (thePooled) {
+      thePools.emplace_back(
+          std::make_unique<Pool>(&theService, theCqs.back().get(), *this));
+    }
+  }
   theServer = myBuilder.BuildAndStart();
   LOG(INFO) << "Server listening on " << theServerEndpoint << " (spawning "
-            << theNumThreads << " threads)";
+            << theNumThreads << " threads, " << theNumExecutors
+            << " executors, " << theCqs.size() << " completion queues"
+            << (theAffinity ? ", pinned to CPU cores" : "")
+            << (thePooled ? ", pooled calls)" : ")");
 
+  for (size_t i = 0; i < theNumExecutors; i++) {
+    theExecutors.emplace_back(std::thread([this]() { execute(); }));
+  }
+
+  const auto myNumCores = std::max(1u, std::thread::hardware_concurrency());
   for (size_t i = 0; i < theNumThreads; i++) {
-    theHandlers.emplace_back(std::thread([this]() { handle(); }));
+    auto& myCq   = *theCqs[i % theCqs.size()];
+    auto  myPool = thePooled ? thePools[i % thePools.size()].get() : nullptr;
+    theHandlers.emplace_back(
+        std::thread([this, &myCq, myPool]() { handle(myCq, myPool); }));
+    if (theAffinity) {
+      pin(theHandlers.back(), i % myNumCores);
+    }
   }
 
   theEdgeServer.init(threadIds());
@@ -160,38 +517,117 @@ void EdgeServerGrpc::wait() {
 
 EdgeServerGrpc::~EdgeServerGrpc() {
   if (theServer) {
-    assert(theCq);
+    assert(not theCqs.empty());
     assert(not theHandlers.empty());
+
+    // the streams would be kept open by the clients
+    {
+      const std::lock_guard<std::mutex> myLock(theMutex);
+      theStopping = true;
+      for (const auto myStream : theStreams) {
+        myStream->cancel();
+      }
+    }
     theServer->Shutdown();
-    theCq->Shutdown();
+
+    // wait for the processing in progress, if any, which needs the completion
+    // queue to send back the responses
+    {
+      std::unique_lock<std::mutex> myLock(theMutex);
+      thePendingCond.wait(myLock, [this]() { return thePending == 0; });
+    }
+    theExecutorQueue.close();
+    for (auto& myExecutor : theExecutors) {
+      myExecutor.join();
+    }
+
+    for (auto& myCq : theCqs) {
+      myCq->Shutdown();
+    }
     for (auto& myHandler : theHandlers) {
       myHandler.join();
     }
   }
 }
 
-void EdgeServerGrpc::handle() {
+void EdgeServerGrpc::handle(grpc::ServerCompletionQueue& aCq, Pool* aPool) {
   // Spawn a new CallData instance to serve new clients.
-  new CallData(&theService, theCq.get(), *this);
+  if (aPool != nullptr) {
+    aPool->spawn();
+  } else {
+    new CallData(&theService, &aCq, *this, nullptr);
+  }
+  // Same for streams and batches, which are never pooled.
+  new Stream(&theService, &aCq, *this);
+  new BatchCall(&theService, &aCq, *this);
   void* myTag; // uniquely identifies a request.
   bool  myOk;
   while (true) {
     // Block waiting to read the next event from the completion queue. The
     // event is uniquely identified by its tag, which in this case is the
-    // memory address of a CallData instance.
+    // memory address of a CallData instance or of a Stream's event.
     // The return value of Next should always be checked. This return value
     // tells us whether there is any kind of event or the completion queue is
     // shutting down.
-    if (not theCq->Next(&myTag, &myOk)) {
+    if (not aCq.Next(&myTag, &myOk)) {
       LOG(WARNING) << "terminating (ok = " << myOk << ")";
       break;
     }
 
-    if (not myOk) {
-      LOG(WARNING) << "Invalid event found";
-    } else {
-      static_cast<CallData*>(myTag)->Proceed();
+    static_cast<Tag*>(myTag)->proceed(myOk);
+  }
+}
+
+void EdgeServerGrpc::pin(std::thread& aThread, const size_t aCore) {
+#ifdef __linux__
+  cpu_set_t mySet;
+  CPU_ZERO(&mySet);
+  CPU_SET(aCore, &mySet);
+  const auto myRet =
+      pthread_setaffinity_np(aThread.native_handle(), sizeof(mySet), &mySet);
+  LOG_IF(WARNING, myRet != 0)
+      << "Could not pin thread " << aThread.get_id() << " to CPU core " << aCore
+      << ": " << strerror(myRet);
+#else
+  LOG(WARNING) << "CPU affinity not supported, ignored for thread "
+               << aThread.get_id() << " (CPU core " << aCore << ")";
+#endif
+}
+
+void EdgeServerGrpc::execute() {
+  try {
+    while (true) {
+      start(theExecutorQueue.pop());
     }
+  } catch (const support::QueueClosed&) {
+    // terminating
+  }
+}
+
+void EdgeServerGrpc::dispatch(Job* aJob) {
+  assert(aJob != nullptr);
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    thePending++;
+  }
+  if (theNumExecutors == 0) {
+    start(aJob);
+  } else {
+    theExecutorQueue.push(aJob);
+  }
+}
+
+void EdgeServerGrpc::start(Job* aJob) {
+  assert(aJob != nullptr);
+  aJob->start(*this);
+}
+
+void EdgeServerGrpc::done() {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  assert(thePending > 0);
+  thePending--;
+  if (thePending == 0) {
+    thePendingCond.notify_all();
   }
 }
 
@@ -201,7 +637,8 @@ rpc::LambdaResponse EdgeServerGrpc::process(const rpc::LambdaRequest& aReq) {
 
 std::set<std::thread::id> EdgeServerGrpc::threadIds() const {
   std::set<std::thread::id> ret;
-  for (const auto& myThread : theHandlers) {
+  for (const auto& myThread :
+       theExecutors.empty() ? theHandlers : theExecutors) {
     ret.insert(myThread.get_id());
   }
   return ret;
@@ -32,17 +32,23 @@ SOFTWARE.
 #pragma once
 
 #include "Support/macros.h"
+#include "Support/queue.h"
 
+#include <google/protobuf/arena.h>
 #include <grpc++/grpc++.h>
 
+#include <atomic>
 #include <cassert>
 #include <condition_variable>
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "edgeserver.grpc.pb.h"
 #include "edgeserverimpl.h"
@@ -55,22 +61,109 @@ struct LambdaResponse;
 /**
  * Generic edge server providing a multi-threaded gRPC server interface for the
  * processing of lambda functions.
+ *
+ * The requests are received by the threads serving the completion queue,
+ * which then start the processing via EdgeServer::processAsync(): the
+ * response is sent back to the client from the continuation, which can be
+ * called by any thread. If the number of executor threads is greater than
+ * zero, then the processing is started by one of such threads rather than
+ * by the completion queue threads, so that the latter are never held by a
+ * blocking processing implementation.
+ *
+ * By default, all the handler threads serve the same completion queue. In
+ * sharded mode, instead, there is a completion queue for each handler thread,
+ * which only serves the calls received through its own queue: this
+ * removes the contention on a single queue and keeps every call on
+ * the same thread from the request to the response. Optionally, the handler
+ * threads can be pinned to CPU cores.
+ *
+ * Besides unary calls, the server accepts bidirectional streams of lambda
+ * requests: the requests received on a stream are processed concurrently
+ * and their responses are sent back on the same stream as soon as they are
+ * ready, each with the identifier of the request it refers to.
+ *
+ * Finally, a batch of independent lambda requests can be received with a
+ * single call, in which case the batch is processed as a whole via
+ * EdgeServer::processBatchAsync() and all the responses are sent back
+ * together.
  */
 class EdgeServerGrpc final : public EdgeServerImpl
 {
+  class Pool;
+
+  // Base class of the operations pending on the completion queues.
+  class Tag
+  {
+   public:
+    virtual ~Tag() {
+    }
+    //! Progress the state of the owner upon completion of the operation.
+    virtual void proceed(const bool aOk) = 0;
+  };
+
+  // Work received whose processing can be started.
+  class Job
+  {
+   public:
+    virtual ~Job() {
+    }
+    //! Start the processing, then call done() once the response is sent.
+    virtual void start(EdgeServerGrpc& aEdgeServer) = 0;
+  };
+
+  // A single lambda request received whose processing can be started.
+  class SingleJob : public Job
+  {
+   public:
+    //! \return the lambda request received.
+    virtual const rpc::LambdaRequest& request() const = 0;
+    //! Send the response back to the client. Can be called by any thread.
+    virtual void complete(rpc::LambdaResponse&& aResponse) = 0;
+
+    void start(EdgeServerGrpc& aEdgeServer) override;
+  };
+
   // Class encompassing the state and logic needed to serve a request.
-  class CallData
+  class CallData final : public Tag, public SingleJob
   {
     enum CallStatus { CREATE, PROCESS, FINISH };
 
+    // Size of the memory block pre-allocated for the protobuf messages.
+    static constexpr size_t theInitialBlockSize = 4096;
+
    public:
+    NONCOPYABLE_NONMOVABLE(CallData);
+
+    /**
+     * Create a call waiting for a new request.
+     *
+     * \param aPool The pool to which the instance returns as part of its
+     * FINISH state. If null, then the instance deallocates itself instead.
+     */
     explicit CallData(rpc::EdgeServer::AsyncService* aService,
                       grpc::ServerCompletionQueue*   aCq,
-                      EdgeServerGrpc&                aEdgeServer);
+                      EdgeServerGrpc&                aEdgeServer,
+                      Pool*                          aPool);
 
     void Proceed();
 
+    void proceed(const bool aOk) override;
+
+    //! Release the resources of the last call and wait for a new request.
+    void reset();
+
+    void complete(rpc::LambdaResponse&& aResponse) override;
+
+    const rpc::LambdaRequest& request() const override {
+      assert(theRequest != nullptr);
+      return *theRequest;
+    }
+
    private:
+    // Give this instance back to the pool, if any, or deallocate it. Pooled
+    // instances are deallocated with the pool.
+    void dispose();
+
     // The means of communication with the gRPC runtime for an asynchronous
     // server.
     rpc::EdgeServer::AsyncService* theService;
@@ -79,30 +172,222 @@ class EdgeServerGrpc final : public EdgeServerImpl
 
     EdgeServerGrpc& theEdgeServer;
 
+    // The pool owning this instance, if any.
+    Pool* const thePool;
+
+    // Memory used for the protobuf messages, which is recycled across calls
+    // unless the messages exceed the initial block size.
+    alignas(8) char theInitialBlock[theInitialBlockSize];
+    google::protobuf::Arena theArena;
+
     // Context for the rpc, allowing to tweak aspects of it such as the use
     // of compression, authentication, as well as to send metadata back to the
-    // client.
-    grpc::ServerContext theContext;
+    // client. The context cannot be reused, hence it is re-created for
+    // every call.
+    std::optional<grpc::ServerContext> theContext;
 
-    // What we get from the client.
-    rpc::LambdaRequest theRequest;
-    // What we send back to the client.
-    rpc::LambdaResponse theResponse;
+    // What we get from the client (allocated on the arena).
+    rpc::LambdaRequest* theRequest;
+    // What we send back to the client (allocated on the arena).
+    rpc::LambdaResponse* theResponse;
 
     // The means to get back to the client.
-    grpc::ServerAsyncResponseWriter<rpc::LambdaResponse> theResponder;
+    std::optional<grpc::ServerAsyncResponseWriter<rpc::LambdaResponse>>
+        theResponder;
 
     // The current serving state.
     CallStatus theStatus;
   };
 
+  // Class encompassing the state and logic needed to serve a stream.
+  class Stream final
+  {
+    using Handler = void (Stream::*)(const bool);
+
+    // An operation of the stream, which notifies a given handler.
+    class Event final : public Tag
+    {
+     public:
+      explicit Event(Stream& aStream, const Handler aHandler)
+          : theStream(aStream)
+          , theHandler(aHandler) {
+      }
+      void proceed(const bool aOk) override {
+        (theStream.*theHandler)(aOk);
+      }
+
+     private:
+      Stream&       theStream;
+      const Handler theHandler;
+    };
+
+    // A request received from the stream, deallocated once complete.
+    class Request final : public SingleJob
+    {
+     public:
+      explicit Request(Stream& aStream)
+          : theStream(aStream)
+          , theRequest() {
+      }
+      const rpc::LambdaRequest& request() const override {
+        return theRequest;
+      }
+      void complete(rpc::LambdaResponse&& aResponse) override;
+
+      Stream&            theStream;
+      rpc::LambdaRequest theRequest;
+    };
+
+   public:
+    NONCOPYABLE_NONMOVABLE(Stream);
+
+    /**
+     * Create a stream waiting for a new client.
+     *
+     * The instance deallocates itself when the stream is terminated.
+     */
+    explicit Stream(rpc::EdgeServer::AsyncService* aService,
+                    grpc::ServerCompletionQueue*   aCq,
+                    EdgeServerGrpc&                aEdgeServer);
+
+    ~Stream();
+
+    //! Cancel the stream. Can be called by any thread.
+    void cancel();
+
+   private:
+    void connected(const bool aOk);
+    void read(const bool aOk);
+    void written(const bool aOk);
+    void finished(const bool aOk);
+
+    //! Queue a response to be written to the client.
+    void write(rpc::LambdaResponse&& aResponse);
+
+    /**
+     * Write the next response, if possible, or terminate the stream if there
+     * is nothing else to do on it, which deallocates this object.
+     *
+     * \param aLock The lock on theMutex, which is released before returning.
+     */
+    void flush(std::unique_lock<std::mutex>& aLock);
+
+   private:
+    rpc::EdgeServer::AsyncService* const theService;
+    grpc::ServerCompletionQueue* const   theCq;
+    EdgeServerGrpc&                      theEdgeServer;
+
+    grpc::ServerContext theContext;
+    grpc::ServerAsyncReaderWriter<rpc::LambdaResponse, rpc::LambdaRequest>
+        theStream;
+
+    Event theConnectEvent;
+    Event theReadEvent;
+    Event theWriteEvent;
+    Event theFinishEvent;
+
+    // The request being read from the stream.
+    std::unique_ptr<Request> theNext;
+
+    std::mutex theMutex;
+    // The responses to be written, including the one being written, if any.
+    std::deque<rpc::LambdaResponse> theOutgoing;
+    // The number of requests whose processing is not complete yet.
+    size_t theInFlight;
+    bool   theReading;
+    bool   theWriting;
+    bool   theBroken;
+  };
+
+  // Class encompassing the state and logic needed to serve a batch call.
+  class BatchCall final : public Tag, public Job
+  {
+   public:
+    NONCOPYABLE_NONMOVABLE(BatchCall);
+
+    /**
+     * Create a call waiting for a new batch of requests.
+     *
+     * The instance deallocates itself when the call is finished.
+     */
+    explicit BatchCall(rpc::EdgeServer::AsyncService* aService,
+                       grpc::ServerCompletionQueue*   aCq,
+                       EdgeServerGrpc&                aEdgeServer);
+
+    void proceed(const bool aOk) override;
+
+    void start(EdgeServerGrpc& aEdgeServer) override;
+
+   private:
+    rpc::EdgeServer::AsyncService* const                      theService;
+    grpc::ServerCompletionQueue* const                        theCq;
+    EdgeServerGrpc&                                           theEdgeServer;
+    grpc::ServerContext                                       theContext;
+    rpc::LambdaRequestBatch                                   theRequest;
+    rpc::LambdaResponseBatch                                  theResponse;
+    grpc::ServerAsyncResponseWriter<rpc::LambdaResponseBatch> theResponder;
+    bool                                                      theFinished;
+  };
+
+  // Recycled CallData instances serving the same completion queue.
+  class Pool
+  {
+   public:
+    NONCOPYABLE_NONMOVABLE(Pool);
+
+    explicit Pool(rpc::EdgeServer::AsyncService* aService,
+                  grpc::ServerCompletionQueue*   aCq,
+                  EdgeServerGrpc&                aEdgeServer);
+
+    //! Wait for a new request with a free instance or a new one, if none.
+    void spawn();
+
+    //! Return an instance whose call is finished to the pool.
+    void release(CallData* aCallData);
+
+    //! \return the number of instances created.
+    size_t size() const;
+
+   private:
+    rpc::EdgeServer::AsyncService* const theService;
+    grpc::ServerCompletionQueue* const   theCq;
+    EdgeServerGrpc&                      theEdgeServer;
+    mutable std::mutex                   theMutex;
+    std::list<std::unique_ptr<CallData>> theAll;
+    std::vector<CallData*>               theFree;
+  };
+
  public:
   NONCOPYABLE_NONMOVABLE(EdgeServerGrpc);
 
-  //! Create an edge server with a given number of threads.
+  /**
+   * Create an edge server with a given number of threads.
+   *
+   * \param aEdgeServer The edge server processing the lambda requests.
+   *
+   * \param aServerEndpoint The listening end-point.
+   *
+   * \param aNumThreads The number of threads serving the completion queue.
+   *
+   * \param aNumExecutors The number of threads starting the processing of the
+   * lambda requests. If zero, then processing is started directly by the
+   * threads serving the completion queue.
+   *
+   * \param aSharded If true use one completion queue per handler thread.
+   *
+   * \param aAffinity If true pin the i-th handler thread to the i-th CPU core,
+   * modulo the number of cores available.
+   *
+   * \param aPooled If true recycle the CallData objects instead of allocating
+   * new ones for every call.
+   */
   explicit EdgeServerGrpc(EdgeServer&        aEdgeServer,
                           const std::string& aServerEndpoint,
-                          const size_t       aNumThreads);
+                          const size_t       aNumThreads,
+                          const size_t       aNumExecutors = 0,
+                          const bool         aSharded      = false,
+                          const bool         aAffinity     = false,
+                          const bool         aPooled       = false);
 
   virtual ~EdgeServerGrpc();
 
@@ -115,15 +400,31 @@ class EdgeServerGrpc final : public EdgeServerImpl
  protected:
   /**
    * \return the set of the identifiers of the threads that have been
-   * spawned during the call to run(). The cardinality of this set
-   * if equal to the number of threads specified in the ctor. If
-   * run() has not (yet) been called, then an empty set is returned.
+   * spawned during the call to run() and that start the processing of
+   * lambda requests, i.e., the executors, if any, or the threads serving the
+   * completion queue, otherwise. If run() has not (yet) been called, then an
+   * empty set is returned.
    */
   std::set<std::thread::id> threadIds() const;
 
  private:
   //! Thread execution body.
-  void handle();
+  void handle(grpc::ServerCompletionQueue& aCq, Pool* aPool);
+
+  //! Pin a thread to a given CPU core.
+  static void pin(std::thread& aThread, const size_t aCore);
+
+  //! Executor thread execution body.
+  void execute();
+
+  //! Start the processing of a lambda request received.
+  void dispatch(Job* aJob);
+
+  //! Start the processing of a lambda request in the current thread.
+  void start(Job* aJob);
+
+  //! Mark a call as complete.
+  void done();
 
   //! Perform actual processing of a lambda request.
   rpc::LambdaResponse process(const rpc::LambdaRequest& aReq) override;
@@ -132,12 +433,27 @@ class EdgeServerGrpc final : public EdgeServerImpl
   mutable std::mutex theMutex;
   const std::string  theServerEndpoint;
   const size_t       theNumThreads;
+  const size_t       theNumExecutors;
+  const bool         theSharded;
+  const bool         theAffinity;
+  const bool         thePooled;
 
  private:
-  std::unique_ptr<grpc::ServerCompletionQueue> theCq;
-  rpc::EdgeServer::AsyncService                theService;
-  std::unique_ptr<grpc::Server>                theServer;
-  std::list<std::thread>                       theHandlers;
+  std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> theCqs;
+  std::vector<std::unique_ptr<Pool>>                        thePools;
+  rpc::EdgeServer::AsyncService                             theService;
+  std::unique_ptr<grpc::Server>                             theServer;
+  std::list<std::thread>                                    theHandlers;
+  std::list<std::thread>                                    theExecutors;
+  support::Queue<Job*>                                      theExecutorQueue;
+
+  // number of calls whose processing has started but is not complete yet
+  size_t                  thePending;
+  std::condition_variable thePendingCond;
+
+  // streams connected, which are cancelled when the server is destroyed
+  std::set<Stream*> theStreams;
+  std::atomic<bool> theStopping;
 }; // end class EdgeServer
 
 } // end namespace edge
@@ -51,7 +51,13 @@ EdgeServerImplFactory::make(EdgeServer&          aEdgeServer,
                             const support::Conf& aConf) {
   if (aConf("type") == "grpc") {
     return std::make_unique<EdgeServerGrpc>(
-        aEdgeServer, aEndpoint, aNumThreads);
+        aEdgeServer,
+        aEndpoint,
+        aNumThreads,
+        aConf.count("executors") > 0 ? aConf.getUint("executors") : 0,
+        aConf.count("sharded") > 0 and aConf.getBool("sharded"),
+        aConf.count("affinity") > 0 and aConf.getBool("affinity"),
+        aConf.count("pooled") > 0 and aConf.getBool("pooled"));
 #ifdef WITH_QUIC
   } else if (aConf("type") == "quic") {
     return std::make_unique<EdgeServerQuic>(
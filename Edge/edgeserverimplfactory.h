@@ -54,7 +54,13 @@ class EdgeServerImplFactory final
    * @param aEdgeServer The edge server.
    * @param aEndpoint The end-point of the server.
    * @param aNumThreads The number of threads to spawn.
-   * @param aConf The configuration.
+   * @param aConf The configuration. With type=grpc the optional key
+   * executors specifies the number of threads starting the processing of
+   * the lambda requests, in addition to those serving the completion queue;
+   * with sharded=true there is one completion queue per thread; with
+   * affinity=true the threads serving the completion queues are pinned to
+   * CPU cores; with pooled=true the objects holding the state of the calls
+   * are recycled.
    * @return std::unique_ptr<EdgeServerImpl>
    */
   static std::unique_ptr<EdgeServerImpl> make(EdgeServer&          aEdgeServer,
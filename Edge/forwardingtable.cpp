@@ -31,7 +31,9 @@ SOFTWARE.
 
 #include "forwardingtable.h"
 
+#include "Edge/Entries/entryconsistenthash.h"
 #include "Edge/Entries/entryleastimpedance.h"
+#include "Edge/Entries/entrypowerofchoices.h"
 #include "Edge/Entries/entryproportionalfairness.h"
 #include "Edge/Entries/entryrandom.h"
 #include "Edge/Entries/entryroundrobin.h"
@@ -40,17 +42,28 @@ SOFTWARE.
 #include <glog/logging.h>
 
 #include <cassert>
+#include <unordered_map>
 
 namespace uiiit {
 namespace edge {
 
+namespace {
+// identifiers of the tables, never reused as the thread-local caches of the
+// snapshots outlive the table that published them
+std::atomic<uint64_t> theNextId(0);
+} // namespace
+
 ForwardingTable::ForwardingTable(const Type aType)
     : ForwardingTableInterface()
     , theType(aType)
+    , theId(theNextId++)
     , theMutex()
-    , theTable()
+    , theTable(std::make_shared<const Table>())
+    , theVersion(0)
     , theAlpha(0)
-    , theBeta(0) {
+    , theBeta(0)
+    , theChoices(defaultChoices())
+    , theLoad(std::make_shared<DestinationLoad>()) {
   LOG(INFO) << "Created forwarding table of type " << toString(aType) << '\n';
 }
 
@@ -59,15 +72,35 @@ ForwardingTable::ForwardingTable(const Type   aType,
                                  const double aBeta)
     : ForwardingTableInterface()
     , theType(aType)
+    , theId(theNextId++)
     , theMutex()
-    , theTable()
+    , theTable(std::make_shared<const Table>())
+    , theVersion(0)
     , theAlpha(aAlpha)
-    , theBeta(aBeta) {
+    , theBeta(aBeta)
+    , theChoices(defaultChoices())
+    , theLoad(std::make_shared<DestinationLoad>()) {
   assert(aType == ForwardingTable::Type::ProportionalFairness);
   LOG(INFO) << "Created forwarding table of type " << toString(aType) << '\n'
             << "with alpha = " << theAlpha << " and beta = " << theBeta << '\n';
 }
 
+ForwardingTable::ForwardingTable(const Type aType, const size_t aChoices)
+    : ForwardingTableInterface()
+    , theType(aType)
+    , theId(theNextId++)
+    , theMutex()
+    , theTable(std::make_shared<const Table>())
+    , theVersion(0)
+    , theAlpha(0)
+    , theBeta(0)
+    , theChoices(aChoices)
+    , theLoad(std::make_shared<DestinationLoad>()) {
+  assert(aType == ForwardingTable::Type::PowerOfChoices);
+  LOG(INFO) << "Created forwarding table of type " << toString(aType) << '\n'
+            << "with " << theChoices << " choices\n";
+}
+
 void ForwardingTable::change(const std::string& aLambda,
                              const std::string& aDest,
                              const float        aWeight,
@@ -78,24 +111,12 @@ void ForwardingTable::change(const std::string& aLambda,
 
   const std::lock_guard<std::mutex> myLock(theMutex);
 
-  auto ret = theTable.emplace(aLambda, nullptr);
-  if (ret.second) {
-    if (theType == Type::Random) {
-      ret.first->second.reset(new entries::EntryRandom());
-    } else if (theType == Type::LeastImpedance) {
-      ret.first->second.reset(new entries::EntryLeastImpedance());
-    } else if (theType == Type::RoundRobin) {
-      ret.first->second.reset(new entries::EntryRoundRobin());
-    } else {
-      assert(theType == Type::ProportionalFairness);
-      ret.first->second.reset(
-          new entries::EntryProportionalFairness(theAlpha, theBeta));
-    }
-  }
+  auto myEntry = copyEntry(*theTable, aLambda);
+  myEntry->change(aDest, aWeight, aFinal);
 
-  assert(ret.first != theTable.end());
-  assert(static_cast<bool>(ret.first->second));
-  ret.first->second->change(aDest, aWeight, aFinal);
+  auto myTable        = std::make_shared<Table>(*theTable);
+  (*myTable)[aLambda] = std::move(myEntry);
+  publish(std::move(myTable));
 
   VLOG(1) << "Changed the weight of destination " << aDest << " for lambda "
           << aLambda << " to " << aWeight << (aFinal ? " (F)" : "");
@@ -114,17 +135,67 @@ void ForwardingTable::change(const std::string& aLambda,
 
   const std::lock_guard<std::mutex> myLock(theMutex);
 
-  const auto it = theTable.find(aLambda);
-  if (it == theTable.end()) {
+  const auto it = theTable->find(aLambda);
+  if (it == theTable->end()) {
     throw NoDestinations();
   }
 
-  it->second->change(aDest, aWeight);
+  auto myEntry = it->second->clone();
+  myEntry->change(aDest, aWeight);
+
+  auto myTable        = std::make_shared<Table>(*theTable);
+  (*myTable)[aLambda] = std::move(myEntry);
+  publish(std::move(myTable));
 
   VLOG(1) << "Changed the weight of destination " << aDest << " for lambda "
           << aLambda << " to " << aWeight;
 }
 
+void ForwardingTable::change(const std::string&                  aLambda,
+                             const std::map<std::string, float>& aWeights) {
+  applyChanges(aLambda,
+               std::vector<std::pair<std::string, float>>(aWeights.begin(),
+                                                          aWeights.end()));
+}
+
+void ForwardingTable::applyChanges(
+    const std::string&                                aLambda,
+    const std::vector<std::pair<std::string, float>>& aChanges) {
+  for (const auto& elem : aChanges) {
+    if (elem.first.empty()) {
+      throw NoDestinations();
+    }
+    if (elem.second <= 0) {
+      throw InvalidWeight(elem.second);
+    }
+  }
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+
+  const auto it = theTable->find(aLambda);
+  if (it == theTable->end()) {
+    throw NoDestinations();
+  }
+
+  // the changes are applied to a private copy, which is discarded on error
+  auto myEntry = it->second->clone();
+  for (const auto& elem : aChanges) {
+    try {
+      myEntry->change(elem.first, elem.second);
+    } catch (const NoDestinations&) {
+      VLOG(1) << "Skipped the weight of missing destination " << elem.first
+              << " for lambda " << aLambda;
+    }
+  }
+
+  auto myTable        = std::make_shared<Table>(*theTable);
+  (*myTable)[aLambda] = std::move(myEntry);
+  publish(std::move(myTable));
+
+  VLOG(1) << "Applied " << aChanges.size() << " weight changes for lambda "
+          << aLambda;
+}
+
 void ForwardingTable::multiply(const std::string& aLambda,
                                const std::string& aDest,
                                const float        aFactor) {
@@ -137,13 +208,18 @@ void ForwardingTable::multiply(const std::string& aLambda,
 
   const std::lock_guard<std::mutex> myLock(theMutex);
 
-  const auto it = theTable.find(aLambda);
-  if (it == theTable.end()) {
+  const auto it = theTable->find(aLambda);
+  if (it == theTable->end()) {
     throw NoDestinations();
   }
 
-  const auto myWeight = it->second->weight(aDest);
-  it->second->change(aDest, myWeight * aFactor);
+  auto       myEntry  = it->second->clone();
+  const auto myWeight = myEntry->weight(aDest);
+  myEntry->change(aDest, myWeight * aFactor);
+
+  auto myTable        = std::make_shared<Table>(*theTable);
+  (*myTable)[aLambda] = std::move(myEntry);
+  publish(std::move(myTable));
 
   VLOG(1) << "Changed the weight of destination " << aDest << " for lambda "
           << aLambda << " to " << (myWeight * aFactor);
@@ -153,45 +229,81 @@ void ForwardingTable::remove(const std::string& aLambda,
                              const std::string& aDest) {
   const std::lock_guard<std::mutex> myLock(theMutex);
 
-  auto it = theTable.find(aLambda);
+  const auto it = theTable->find(aLambda);
+  if (it == theTable->end()) {
+    return;
+  }
 
-  if (it != theTable.end()) {
-    const auto myRemoved = it->second->remove(aDest);
-    LOG_IF(INFO, myRemoved)
-        << "Removed destination " << aDest << " for lambda " << aLambda;
+  auto       myEntry   = it->second->clone();
+  const auto myRemoved = myEntry->remove(aDest);
+  if (not myRemoved) {
+    return;
+  }
+  LOG(INFO) << "Removed destination " << aDest << " for lambda " << aLambda;
 
-    if (it->second->empty()) {
-      LOG(INFO) << "Lambda " << aLambda << " now has no destinations";
-      theTable.erase(it);
-    }
+  auto myTable = std::make_shared<Table>(*theTable);
+  if (myEntry->empty()) {
+    LOG(INFO) << "Lambda " << aLambda << " now has no destinations";
+    myTable->erase(aLambda);
+  } else {
+    (*myTable)[aLambda] = std::move(myEntry);
   }
+  publish(std::move(myTable));
 }
 
 void ForwardingTable::remove(const std::string& aLambda) {
   const std::lock_guard<std::mutex> myLock(theMutex);
 
-  const auto myErased = theTable.erase(aLambda);
-  LOG_IF(INFO, myErased > 0)
-      << "Removed all destinations for lambda " << aLambda;
+  if (theTable->count(aLambda) == 0) {
+    return;
+  }
+
+  auto myTable = std::make_shared<Table>(*theTable);
+  myTable->erase(aLambda);
+  publish(std::move(myTable));
+
+  LOG(INFO) << "Removed all destinations for lambda " << aLambda;
 }
 
-std::string ForwardingTable::operator()(const std::string& aLambda) {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+const std::string& ForwardingTable::operator()(const std::string& aLambda) {
+  return DestinationRegistry::instance().name(select(aLambda));
+}
+
+DestinationId ForwardingTable::select(const std::string& aLambda) {
+  const auto& myTable = snapshot();
 
-  const auto it = theTable.find(aLambda);
+  const auto it = myTable.find(aLambda);
 
-  if (it != theTable.end()) {
+  if (it != myTable.end()) {
     return (*it->second)();
   }
 
   throw NoDestinations();
 }
 
+const std::string& ForwardingTable::operator()(const std::string& aLambda,
+                                               const std::string& aKey) {
+  return DestinationRegistry::instance().name(select(aLambda, aKey));
+}
+
+DestinationId ForwardingTable::select(const std::string& aLambda,
+                                      const std::string& aKey) {
+  const auto& myTable = snapshot();
+
+  const auto it = myTable.find(aLambda);
+
+  if (it != myTable.end()) {
+    return it->second->select(aKey);
+  }
+
+  throw NoDestinations();
+}
+
 std::set<std::string> ForwardingTable::lambdas() const {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto& myTable = snapshot();
 
   std::set<std::string> myLambdas;
-  for (const auto& myEntry : theTable) {
+  for (const auto& myEntry : myTable) {
     myLambdas.insert(myEntry.first);
   }
   return myLambdas;
@@ -199,10 +311,10 @@ std::set<std::string> ForwardingTable::lambdas() const {
 
 std::map<std::string, std::pair<float, bool>>
 ForwardingTable::destinations(const std::string& aLambda) const {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto& myTable = snapshot();
 
-  const auto it = theTable.find(aLambda);
-  if (it == theTable.end()) {
+  const auto it = myTable.find(aLambda);
+  if (it == myTable.end()) {
     return std::map<std::string, std::pair<float, bool>>();
   }
 
@@ -211,10 +323,10 @@ ForwardingTable::destinations(const std::string& aLambda) const {
 
 std::map<std::string, std::map<std::string, std::pair<float, bool>>>
 ForwardingTable::fullTable() const {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto& myTable = snapshot();
 
   std::map<std::string, std::map<std::string, std::pair<float, bool>>> myRet;
-  for (const auto& myEntry : theTable) {
+  for (const auto& myEntry : myTable) {
     for (const auto& myDestination : myEntry.second->destinations()) {
       myRet[myEntry.first][myDestination.first] = myDestination.second;
     }
@@ -222,12 +334,79 @@ ForwardingTable::fullTable() const {
   return myRet;
 }
 
+const ForwardingTable::Table& ForwardingTable::snapshot() const {
+  struct Cache {
+    uint64_t                     theVersion;
+    std::shared_ptr<const Table> theTable;
+  };
+
+  // key:   table identifier
+  // value: last snapshot of the table used by this thread
+  thread_local std::unordered_map<uint64_t, Cache> myCaches;
+
+  const auto myVersion = theVersion.load(std::memory_order_acquire);
+  auto       it        = myCaches.find(theId);
+  if (it != myCaches.end() and it->second.theVersion == myVersion) {
+    return *it->second.theTable;
+  }
+
+  if (it == myCaches.end()) {
+    // drop the snapshots not referenced by any table, which are either
+    // outdated or belong to tables that do not exist anymore
+    for (auto jt = myCaches.begin(); jt != myCaches.end();) {
+      if (jt->second.theTable.use_count() == 1) {
+        jt = myCaches.erase(jt);
+      } else {
+        ++jt;
+      }
+    }
+    it = myCaches.emplace(theId, Cache{0, nullptr}).first;
+  }
+
+  // the version is read again, since it may have changed in the meanwhile
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  it->second.theVersion = theVersion.load(std::memory_order_relaxed);
+  it->second.theTable   = theTable;
+  return *it->second.theTable;
+}
+
+void ForwardingTable::publish(std::shared_ptr<const Table>&& aTable) {
+  theTable = std::move(aTable);
+  theVersion.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<entries::Entry>
+ForwardingTable::copyEntry(const Table&       aTable,
+                           const std::string& aLambda) const {
+  const auto it = aTable.find(aLambda);
+  if (it != aTable.end()) {
+    return it->second->clone();
+  }
+
+  if (theType == Type::Random) {
+    return std::make_shared<entries::EntryRandom>();
+  } else if (theType == Type::LeastImpedance) {
+    return std::make_shared<entries::EntryLeastImpedance>();
+  } else if (theType == Type::RoundRobin) {
+    return std::make_shared<entries::EntryRoundRobin>();
+  } else if (theType == Type::PowerOfChoices) {
+    return std::make_shared<entries::EntryPowerOfChoices>(theChoices, theLoad);
+  } else if (theType == Type::ConsistentHash) {
+    return std::make_shared<entries::EntryConsistentHash>(theLoad);
+  }
+  assert(theType == Type::ProportionalFairness);
+  return std::make_shared<entries::EntryProportionalFairness>(theAlpha,
+                                                              theBeta);
+}
+
 const std::string& toString(const ForwardingTable::Type aType) {
   static const std::map<ForwardingTable::Type, std::string> myValues(
       {{ForwardingTable::Type::Random, "random"},
        {ForwardingTable::Type::LeastImpedance, "least-impedance"},
        {ForwardingTable::Type::RoundRobin, "round-robin"},
-       {ForwardingTable::Type::ProportionalFairness, "proportional-fairness"}});
+       {ForwardingTable::Type::ProportionalFairness, "proportional-fairness"},
+       {ForwardingTable::Type::PowerOfChoices, "power-of-choices"},
+       {ForwardingTable::Type::ConsistentHash, "consistent-hash"}});
   assert(myValues.find(aType) != myValues.end());
   return myValues.find(aType)->second;
 }
@@ -239,6 +418,10 @@ ForwardingTable::Type forwardingTableTypeFromString(const std::string& aType) {
     return ForwardingTable::Type::LeastImpedance;
   } else if (aType == "round-robin") {
     return ForwardingTable::Type::RoundRobin;
+  } else if (aType == "power-of-choices") {
+    return ForwardingTable::Type::PowerOfChoices;
+  } else if (aType == "consistent-hash") {
+    return ForwardingTable::Type::ConsistentHash;
   } else {
     assert(aType == "proportional-fairness");
     return ForwardingTable::Type::ProportionalFairness;
@@ -32,9 +32,12 @@ SOFTWARE.
 #pragma once
 
 #include "Edge/Entries/entry.h"
+#include "Edge/destinationload.h"
 #include "Edge/forwardingtableinterface.h"
 #include "Support/macros.h"
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <list>
 #include <map>
@@ -42,6 +45,8 @@ SOFTWARE.
 #include <mutex>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
@@ -49,6 +54,19 @@ namespace edge {
 /**
  * Thread-safe table returning an end-point associated to a given lambda
  * function name.
+ *
+ * The table is an immutable snapshot, which is replaced atomically with a
+ * new one by every change (read-copy-update). Only the entries of the
+ * lambdas changed are copied, while the others are shared with the
+ * previous snapshot. Therefore the lookups do not need to synchronize with
+ * the changes, which are serialized among themselves by a mutex, and
+ * multiple weight changes of the same lambda can be published at once.
+ *
+ * Every thread caches the last snapshot it has used, together with its
+ * version number, hence a lookup only reads an atomic counter unless the
+ * table has changed since the previous lookup of the same thread: this
+ * avoids both the lock of the atomic operations on std::shared_ptr and the
+ * contention on its reference count.
  */
 class ForwardingTable final : public ForwardingTableInterface
 {
@@ -58,6 +76,8 @@ class ForwardingTable final : public ForwardingTableInterface
     LeastImpedance       = 1,
     RoundRobin           = 2,
     ProportionalFairness = 3,
+    PowerOfChoices       = 4,
+    ConsistentHash       = 5,
   };
 
   NONCOPYABLE_NONMOVABLE(ForwardingTable);
@@ -70,6 +90,14 @@ class ForwardingTable final : public ForwardingTableInterface
                            const double aAlpha,
                            const double aBeta);
 
+  /**
+   * Create a forwarding table for the power-of-choices policy.
+   *
+   * \param aChoices the number of candidate destinations drawn per lambda
+   * request, among which the one with fewer requests in flight is selected.
+   */
+  explicit ForwardingTable(const Type aType, const size_t aChoices);
+
   /**
    * Add a new destination for a given lambda or change its weight.
    *
@@ -109,6 +137,45 @@ class ForwardingTable final : public ForwardingTableInterface
               const std::string& aDest,
               const float        aWeight) override;
 
+  /**
+   * Change the weights of multiple existing destinations of a lambda with
+   * a single update of the table.
+   *
+   * \param aLambda The name of the lambda function.
+   *
+   * \param aWeights The new weights, indexed by destination. The
+   * destinations not found, e.g., because they have been removed in the
+   * meanwhile, are skipped.
+   *
+   * \throw NoDestinations if the lambda is not in the table or any
+   * destination is empty, in which case no weight is changed.
+   *
+   * \throw InvalidWeight if any weight is non-positive, in which case no
+   * weight is changed.
+   */
+  void change(const std::string&                  aLambda,
+              const std::map<std::string, float>& aWeights);
+
+  /**
+   * Change the weights of existing destinations of a lambda with a single
+   * update of the table. Unlike change(), the same destination may appear
+   * multiple times, in which case the changes are applied to the entry in
+   * order, as if change() was called once for each of them.
+   *
+   * \param aLambda The name of the lambda function.
+   *
+   * \param aChanges The sequence of destinations and new weights. The
+   * destinations not found are skipped.
+   *
+   * \throw NoDestinations if the lambda is not in the table or any
+   * destination is empty, in which case no weight is changed.
+   *
+   * \throw InvalidWeight if any weight is non-positive, in which case no
+   * weight is changed.
+   */
+  void applyChanges(const std::string&                                aLambda,
+                    const std::vector<std::pair<std::string, float>>& aChanges);
+
   /**
    * Multiply the weight of the given destination by a factor.
    *
@@ -134,16 +201,56 @@ class ForwardingTable final : public ForwardingTableInterface
   void remove(const std::string& aLambda) override;
 
   /**
-   * \return the destination for the given lambda.
+   * \return the destination for the given lambda, which is interned in the
+   * DestinationRegistry and hence remains valid after the call.
+   *
+   * \throw NoDestinations if the given lambda is not in the table.
+   */
+  const std::string& operator()(const std::string& aLambda);
+
+  /**
+   * \return the identifier of the destination for the given lambda in the
+   * DestinationRegistry.
    *
    * \throw NoDestinations if the given lambda is not in the table.
    */
-  std::string operator()(const std::string& aLambda);
+  DestinationId select(const std::string& aLambda);
+
+  /**
+   * \return the destination for the given lambda and a request key, which is
+   * used by the entries that keep requests with the same key together.
+   *
+   * \throw NoDestinations if the given lambda is not in the table.
+   */
+  const std::string& operator()(const std::string& aLambda,
+                                const std::string& aKey);
+
+  //! \return the identifier of the destination for a lambda and a key.
+  DestinationId select(const std::string& aLambda, const std::string& aKey);
+
+  //! \return the type of the table.
+  Type type() const noexcept {
+    return theType;
+  }
 
   //! \return all the destinations for a given lambda.
   std::map<std::string, std::pair<float, bool>>
   destinations(const std::string& aLambda) const;
 
+  //! \return the number of choices of the power-of-choices policy by default.
+  static constexpr size_t defaultChoices() {
+    return 2;
+  }
+
+  /**
+   * \return the number of requests in flight per destination, which must be
+   * kept up to date by the user of the table for the power-of-choices and
+   * consistent-hash policies.
+   */
+  DestinationLoad& load() noexcept {
+    return *theLoad;
+  }
+
   //! \return all possible lambda served.
   std::set<std::string> lambdas() const override;
 
@@ -152,12 +259,35 @@ class ForwardingTable final : public ForwardingTableInterface
   fullTable() const override;
 
  private:
-  const Type                                             theType;
-  mutable std::mutex                                     theMutex;
-  std::map<std::string, std::unique_ptr<entries::Entry>> theTable;
+  // key:   lambda name
+  // value: entry, not modified after the table snapshot has been published
+  using Table = std::map<std::string, std::shared_ptr<entries::Entry>>;
+
+  /**
+   * \return the current snapshot of the table, which is cached by the
+   * calling thread and remains valid until its next call to this method.
+   */
+  const Table& snapshot() const;
+
+  //! Publish a new snapshot of the table, must be called with the lock held.
+  void publish(std::shared_ptr<const Table>&& aTable);
+
+  //! \return a copy of the entry of a lambda, or a new one if not present.
+  std::shared_ptr<entries::Entry> copyEntry(const Table&       aTable,
+                                            const std::string& aLambda) const;
+
+ private:
+  const Type                   theType;
+  const uint64_t               theId;      // never reused, keys the caches
+  mutable std::mutex           theMutex;   // serializes changes, not lookups
+  std::shared_ptr<const Table> theTable;   // protected by theMutex
+  std::atomic<uint64_t>        theVersion; // incremented by publish()
 
   const double theAlpha;
   const double theBeta;
+
+  const size_t                           theChoices;
+  const std::shared_ptr<DestinationLoad> theLoad;
 };
 
 const std::string& toString(const ForwardingTable::Type aType);
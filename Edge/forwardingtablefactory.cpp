@@ -12,7 +12,7 @@ ForwardingTableFactory::make(const support::Conf& aConf) {
   const auto myType = aConf("type");
 
   if (myType == "random" || myType == "round-robin" ||
-      myType == "least-impedance") {
+      myType == "least-impedance" || myType == "consistent-hash") {
     return std::make_unique<ForwardingTable>(
         forwardingTableTypeFromString(aConf("type")));
 
@@ -21,6 +21,15 @@ ForwardingTableFactory::make(const support::Conf& aConf) {
         forwardingTableTypeFromString(aConf("type")),
         aConf.getDouble("alpha"),
         aConf.getDouble("beta"));
+  } else if (myType == "power-of-choices") {
+    const auto myChoices = aConf.count("choices") > 0 ?
+                               aConf.getUint("choices") :
+                               ForwardingTable::defaultChoices();
+    if (myChoices == 0) {
+      throw std::runtime_error("Invalid number of choices: 0");
+    }
+    return std::make_unique<ForwardingTable>(
+        forwardingTableTypeFromString(aConf("type")), myChoices);
   } else {
     throw std::runtime_error("Invalid forwarding table type: " + myType);
   }
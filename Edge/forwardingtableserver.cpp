@@ -36,14 +36,38 @@ SOFTWARE.
 #include <glog/logging.h>
 #include <grpc++/grpc++.h>
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 
 namespace uiiit {
 namespace edge {
 
 ForwardingTableServer::ForwardingTableServerImpl::ForwardingTableServerImpl(
     const std::vector<ForwardingTableInterface*>& aTables)
-    : theTables(aTables) {
+    : theTables(aTables)
+    , theMutex()
+    , theCallback()
+    , theEntryCallback()
+    , theTablesMutex(nullptr) {
+}
+
+void ForwardingTableServer::ForwardingTableServerImpl::destinationsCallback(
+    const DestinationsCallback& aCallback) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theCallback = aCallback;
+}
+
+void ForwardingTableServer::ForwardingTableServerImpl::entryCallback(
+    const EntryCallback& aCallback) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theEntryCallback = aCallback;
+}
+
+void ForwardingTableServer::ForwardingTableServerImpl::tablesMutex(
+    std::mutex& aMutex) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theTablesMutex = &aMutex;
 }
 
 grpc::Status ForwardingTableServer::ForwardingTableServerImpl::Configure(
@@ -53,7 +77,23 @@ grpc::Status ForwardingTableServer::ForwardingTableServerImpl::Configure(
   assert(aReq);
   assert(aRep);
 
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  std::unique_lock<std::mutex>      myTablesLock;
+  if (theTablesMutex != nullptr) {
+    myTablesLock = std::unique_lock<std::mutex>(*theTablesMutex);
+  }
   try {
+    const auto myBefore =
+        theCallback ? destinations() : std::set<std::string>();
+
+    if (theEntryCallback) {
+      if (aReq->action() == uiiit::rpc::EdgeRouterConf::FLUSH) {
+        theEntryCallback(std::string(), std::string());
+      } else {
+        theEntryCallback(aReq->lambda(), aReq->destination());
+      }
+    }
+
     if (aReq->action() == uiiit::rpc::EdgeRouterConf::FLUSH) {
       // remove from all tables
       for (const auto myTable : theTables) {
@@ -92,6 +132,25 @@ grpc::Status ForwardingTableServer::ForwardingTableServerImpl::Configure(
       }
     }
 
+    if (theCallback) {
+      const auto            myAfter = destinations();
+      std::set<std::string> myAdded;
+      std::set<std::string> myRemoved;
+      std::set_difference(myAfter.begin(),
+                          myAfter.end(),
+                          myBefore.begin(),
+                          myBefore.end(),
+                          std::inserter(myAdded, myAdded.end()));
+      std::set_difference(myBefore.begin(),
+                          myBefore.end(),
+                          myAfter.begin(),
+                          myAfter.end(),
+                          std::inserter(myRemoved, myRemoved.end()));
+      if (not myAdded.empty() or not myRemoved.empty()) {
+        theCallback(myAdded, myRemoved);
+      }
+    }
+
     aRep->set_msg("OK");
 
   } catch (const std::exception& aErr) {
@@ -104,6 +163,18 @@ grpc::Status ForwardingTableServer::ForwardingTableServerImpl::Configure(
   return grpc::Status::OK;
 }
 
+std::set<std::string>
+ForwardingTableServer::ForwardingTableServerImpl::destinations() const {
+  assert(not theTables.empty());
+  std::set<std::string> ret;
+  for (const auto& myRow : theTables[0]->fullTable()) {
+    for (const auto& myDestination : myRow.second) {
+      ret.emplace(myDestination.first);
+    }
+  }
+  return ret;
+}
+
 grpc::Status ForwardingTableServer::ForwardingTableServerImpl::GetTable(
     [[maybe_unused]] grpc::ServerContext* aContext,
     const rpc::TableId*                   aReq,
@@ -175,5 +246,18 @@ ForwardingTableServer::ForwardingTableServer(
   }
 }
 
+void ForwardingTableServer::destinationsCallback(
+    const DestinationsCallback& aCallback) {
+  theServerImpl.destinationsCallback(aCallback);
+}
+
+void ForwardingTableServer::entryCallback(const EntryCallback& aCallback) {
+  theServerImpl.entryCallback(aCallback);
+}
+
+void ForwardingTableServer::tablesMutex(std::mutex& aMutex) {
+  theServerImpl.tablesMutex(aMutex);
+}
+
 } // namespace edge
 } // end namespace uiiit
@@ -33,6 +33,9 @@ SOFTWARE.
 
 #include "RpcSupport/simpleserver.h"
 
+#include <functional>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -45,12 +48,39 @@ class ForwardingTableInterface;
 
 class ForwardingTableServer final : public rpc::SimpleServer
 {
+ public:
+  /**
+   * Function called after every configuration with the destinations that
+   * were not in any table before and those that are not in any table anymore.
+   */
+  using DestinationsCallback =
+      std::function<void(const std::set<std::string>& aAdded,
+                         const std::set<std::string>& aRemoved)>;
+
+  /**
+   * Function called before every configuration with the lambda and the
+   * destination changed or removed, both empty if all the entries are
+   * flushed.
+   */
+  using EntryCallback = std::function<void(const std::string& aLambda,
+                                           const std::string& aDestination)>;
+
+ private:
   class ForwardingTableServerImpl final : public rpc::EdgeRouter::Service
   {
    public:
     explicit ForwardingTableServerImpl(
         const std::vector<ForwardingTableInterface*>& aTables);
 
+    //! Set the function called after every configuration.
+    void destinationsCallback(const DestinationsCallback& aCallback);
+
+    //! Set the function called before every configuration.
+    void entryCallback(const EntryCallback& aCallback);
+
+    //! Set the mutex held during every configuration.
+    void tablesMutex(std::mutex& aMutex);
+
    private:
     grpc::Status Configure(grpc::ServerContext*       aContext,
                            const rpc::EdgeRouterConf* aReq,
@@ -62,7 +92,14 @@ class ForwardingTableServer final : public rpc::SimpleServer
                               const rpc::Void*     aReq,
                               rpc::NumTables*      aRep) override;
 
+    //! \return the destinations in the first table, which has all of them.
+    std::set<std::string> destinations() const;
+
     std::vector<ForwardingTableInterface*> theTables;
+    std::mutex                             theMutex; // serializes Configure
+    DestinationsCallback                   theCallback;
+    EntryCallback                          theEntryCallback;
+    std::mutex*                            theTablesMutex;
   };
 
  public:
@@ -82,6 +119,27 @@ class ForwardingTableServer final : public rpc::SimpleServer
                                  ForwardingTableInterface& aOverallTable,
                                  ForwardingTableInterface& aFinalTable);
 
+  /**
+   * Set the function called after every configuration, e.g., to establish
+   * in advance the connections to the new destinations and to close those
+   * to the destinations removed. Must be called before run().
+   */
+  void destinationsCallback(const DestinationsCallback& aCallback);
+
+  /**
+   * Set the function called before every configuration, e.g., to forget
+   * the entries that are about to be changed by the controller. Must be
+   * called before run().
+   */
+  void entryCallback(const EntryCallback& aCallback);
+
+  /**
+   * Set a mutex held during every configuration, shared with other threads
+   * changing the same tables, which is taken before calling the callbacks.
+   * Must be called before run(); the mutex must survive this object.
+   */
+  void tablesMutex(std::mutex& aMutex);
+
  private:
   /**
    * Create a gRPC server acting as an interface for an array of forwarding
@@ -0,0 +1,121 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "hedgepolicy.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace uiiit {
+namespace edge {
+
+HedgePolicy::Window::Window()
+    : theCurrent(accuracy(), maxBins())
+    , thePrevious(accuracy(), maxBins())
+    , theDelay(0) {
+}
+
+HedgePolicy::HedgePolicy(const double aBudget, const double aQuantile)
+    : theBudget(aBudget)
+    , theQuantile(aQuantile)
+    , theMutex()
+    , theTokens(0)
+    , theLatencies() {
+  if (aBudget < 0 or aBudget > 1) {
+    throw std::runtime_error("Invalid hedge budget: " +
+                             std::to_string(aBudget));
+  }
+  if (aQuantile <= 0 or aQuantile > 1) {
+    throw InvalidQuantile(aQuantile);
+  }
+}
+
+void HedgePolicy::request() {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theTokens = std::min(maxTokens(), theTokens + theBudget);
+}
+
+double HedgePolicy::delay(const std::string& aLambda,
+                          const std::string& aDestination) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it = theLatencies.find(aLambda);
+  if (it == theLatencies.end()) {
+    return 0;
+  }
+  const auto jt = it->second.find(aDestination);
+  return jt == it->second.end() ? 0 : jt->second.theDelay;
+}
+
+bool HedgePolicy::acquire() {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  if (theTokens < 1) {
+    return false;
+  }
+  theTokens -= 1;
+  return true;
+}
+
+void HedgePolicy::refund() {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theTokens = std::min(maxTokens(), theTokens + 1);
+}
+
+void HedgePolicy::add(const std::string& aLambda,
+                      const std::string& aDestination,
+                      const double       aTime) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  auto& myWindow = theLatencies[aLambda][aDestination];
+  myWindow.theCurrent.add(aTime);
+
+  // the samples of the current window are used again in the next one
+  if (myWindow.theCurrent.count() >= windowSize()) {
+    std::swap(myWindow.thePrevious, myWindow.theCurrent);
+    myWindow.theCurrent.clear();
+    update(myWindow);
+  } else if (myWindow.theCurrent.count() % updateEvery() == 0) {
+    update(myWindow);
+  }
+}
+
+void HedgePolicy::update(Window& aWindow) const {
+  auto mySketch = aWindow.thePrevious;
+  mySketch.merge(aWindow.theCurrent);
+  if (mySketch.count() >= minSamples()) {
+    aWindow.theDelay = mySketch.quantile(theQuantile);
+    VLOG(2) << "hedge delay " << aWindow.theDelay << " s, num "
+            << mySketch.count();
+  }
+}
+
+} // namespace edge
+} // namespace uiiit
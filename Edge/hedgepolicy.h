@@ -0,0 +1,136 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Support/macros.h"
+#include "quantilesketch.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace uiiit {
+namespace edge {
+
+/**
+ * Policy deciding when to send a second copy of a lambda request, i.e., to
+ * hedge it, if the destination selected first has not answered yet.
+ *
+ * The delay after which a request is hedged is a given quantile of the
+ * latencies measured towards the destination for the same lambda, which are
+ * kept in quantile sketches of bounded size: the samples of the last two
+ * windows of a fixed number of samples are used, so that the delay follows
+ * changes of the latencies.
+ *
+ * The number of hedges is capped by a token budget: every request deposits
+ * a fraction of a token, up to a maximum, and every hedge takes a whole
+ * token, so that the hedges do not exceed that fraction of the requests.
+ */
+class HedgePolicy final
+{
+  struct Window {
+    Window();
+
+    QuantileSketch theCurrent;
+    QuantileSketch thePrevious;
+    double         theDelay; // 0 if not enough samples
+  };
+
+  // key:   lambda
+  // value: map of key:   destination
+  //               value: latency sketches
+  using Latencies = std::map<std::string, std::map<std::string, Window>>;
+
+ public:
+  NONCOPYABLE_NONMOVABLE(HedgePolicy);
+
+  /**
+   * \param aBudget The maximum fraction of requests hedged, in [0, 1]. If
+   * zero then hedging is disabled.
+   * \param aQuantile The quantile of the latencies used as the delay, in
+   * (0, 1].
+   *
+   * \throw std::runtime_error if the budget is not valid.
+   * \throw InvalidQuantile if the quantile is not valid.
+   */
+  explicit HedgePolicy(const double aBudget, const double aQuantile);
+
+  //! \return true if hedging is enabled.
+  bool enabled() const noexcept {
+    return theBudget > 0;
+  }
+
+  //! Deposit the budget of a new request.
+  void request();
+
+  /**
+   * \return the time after which a request should be hedged, in fractional
+   * seconds, or zero if there are not enough samples yet.
+   */
+  double delay(const std::string& aLambda, const std::string& aDestination);
+
+  //! Take a token from the budget. \return false if none is available.
+  bool acquire();
+
+  //! Give back a token taken with acquire() but not used.
+  void refund();
+
+  //! Add a latency sample, in fractional seconds.
+  void add(const std::string& aLambda,
+           const std::string& aDestination,
+           const double       aTime);
+
+  // clang-format off
+  static constexpr double defaultBudget()   { return    0; }
+  static constexpr double defaultQuantile() { return 0.95; }
+  static constexpr size_t minSamples()      { return   20; }
+  static constexpr size_t windowSize()      { return  500; }
+  static constexpr size_t updateEvery()     { return   16; }
+  static constexpr double maxTokens()       { return   10; }
+  static constexpr double accuracy()        { return 0.01; }
+  static constexpr size_t maxBins()         { return  512; }
+  // clang-format on
+
+ private:
+  //! Update the delay of a window.
+  void update(Window& aWindow) const;
+
+ private:
+  const double theBudget;
+  const double theQuantile;
+  std::mutex   theMutex;
+  double       theTokens;
+  Latencies    theLatencies;
+};
+
+} // namespace edge
+} // namespace uiiit
@@ -31,6 +31,8 @@ SOFTWARE.
 
 #pragma once
 
+#include "Edge/payload.h"
+
 #include <array>
 #include <functional>
 #include <iostream>
@@ -155,7 +157,7 @@ class Lambda final
   const std::string theName;
   const bool        theCopyInput;
   const bool        theCopyStates;
-  const std::string theOutput;
+  const Payload     theOutput;
   const Converter   theConverter;
 };
 
@@ -37,19 +37,39 @@ SOFTWARE.
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
+#include <unordered_map>
 
 namespace uiiit {
 namespace edge {
 
+namespace {
+// identifiers of the optimizers, never reused as the thread-local buffers
+// outlive the optimizer that registered them
+std::atomic<uint64_t> theNextId(0);
+} // namespace
+
+LocalOptimizerAsync::Buffer::Buffer()
+    : theSamples(bufferSize())
+    , theHead(0)
+    , theTail(0) {
+}
+
 LocalOptimizerAsync::LocalOptimizerAsync(ForwardingTable& aForwardingTable,
-                                         const double     aAlpha)
+                                         const double     aAlpha,
+                                         const double     aPeriod)
     : LocalOptimizer(aForwardingTable)
     , theAlpha(aAlpha)
+    , theId(theNextId++)
     , theMutex()
+    , theBuffers()
     , theWeights()
-    , theChrono(true) {
-  LOG(INFO) << "Creating an async local optimizer, with alpha = " << aAlpha;
+    , theChrono(true)
+    , theTask([this]() { merge(); }, aPeriod) {
+  LOG(INFO) << "Creating an async local optimizer, with alpha = " << aAlpha
+            << ", merge period = " << aPeriod << " s";
 }
 
 void LocalOptimizerAsync::operator()(const rpc::LambdaRequest& aReq,
@@ -57,34 +77,108 @@ void LocalOptimizerAsync::operator()(const rpc::LambdaRequest& aReq,
                                      const double              aTime) {
   assert(aTime > 0);
 
-  const auto& myLambda    = aReq.name();
-  auto        myCurWeight = aTime;
-
-  VLOG(2) << "req " << myLambda << ", dest " << aDestination << ", time "
+  VLOG(2) << "req " << aReq.name() << ", dest " << aDestination << ", time "
           << aTime << " s";
 
+  auto&      myBuffer = buffer();
+  const auto myHead   = myBuffer.theHead.load(std::memory_order_relaxed);
+  if (myHead - myBuffer.theTail.load(std::memory_order_acquire) ==
+      bufferSize()) {
+    merge();
+  }
+
+  auto& mySample          = myBuffer.theSamples[myHead % bufferSize()];
+  mySample.theLambda      = aReq.name();
+  mySample.theDestination = aDestination;
+  mySample.theTime        = aTime;
+  mySample.theTimestamp   = theChrono.time();
+  myBuffer.theHead.store(myHead + 1, std::memory_order_release);
+}
+
+LocalOptimizerAsync::Buffer& LocalOptimizerAsync::buffer() {
+  // key:   optimizer identifier
+  // value: buffer of this thread, shared with the optimizer
+  thread_local std::unordered_map<uint64_t, std::shared_ptr<Buffer>> myBuffers;
+
+  const auto it = myBuffers.find(theId);
+  if (it != myBuffers.end()) {
+    return *it->second;
+  }
+
+  // drop the buffers of the optimizers that do not exist anymore
+  for (auto jt = myBuffers.begin(); jt != myBuffers.end();) {
+    if (jt->second.use_count() == 1) {
+      jt = myBuffers.erase(jt);
+    } else {
+      ++jt;
+    }
+  }
+
+  auto myBuffer = std::make_shared<Buffer>();
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    theBuffers.emplace_back(myBuffer);
+  }
+  return *myBuffers.emplace(theId, std::move(myBuffer)).first->second;
+}
+
+void LocalOptimizerAsync::merge() {
+  // key:   lambda
+  // value: map of key:   destination
+  //               value: new weight
+  std::map<std::string, std::map<std::string, float>> myChanges;
+
+  // serializes also the updates of the forwarding table, so that the
+  // weights of an older merge cannot override those of a newer one
   const std::lock_guard<std::mutex> myLock(theMutex);
 
-  const auto myNow = theChrono.time();
-  const auto myRet =
-      theWeights.insert({myLambda,
-                         std::map<std::string, Elem>(
-                             {{aDestination, Elem{myCurWeight, myNow}}})});
-  if (not myRet.second) {
-    const auto myInnerRet =
-        myRet.first->second.insert({aDestination, Elem{myCurWeight, myNow}});
-    if (not myInnerRet.second) {
-      assert(myNow >= myInnerRet.first->second.theTimestamp);
-      if (myNow - myInnerRet.first->second.theTimestamp < stalePeriod()) {
-        myCurWeight *= (1 - theAlpha);
-        myCurWeight += theAlpha * myInnerRet.first->second.theWeight;
+  // the samples of different threads are not interleaved by time, which
+  // is harmless as long as the merge period is short
+  for (auto it = theBuffers.begin(); it != theBuffers.end();) {
+    const auto& myBuffer = *it;
+
+    // the buffer is only shared with the optimizer after its thread has
+    // exited, in which case it is dropped once its samples are merged
+    const auto myExited = myBuffer.use_count() == 1;
+    if (myExited) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    const auto myHead = myBuffer->theHead.load(std::memory_order_acquire);
+    auto       myTail = myBuffer->theTail.load(std::memory_order_relaxed);
+    for (; myTail != myHead; ++myTail) {
+      const auto& mySample    = myBuffer->theSamples[myTail % bufferSize()];
+      auto        myCurWeight = mySample.theTime;
+
+      const auto myRet = theWeights[mySample.theLambda].insert(
+          {mySample.theDestination,
+           Elem{myCurWeight, mySample.theTimestamp}});
+      if (not myRet.second) {
+        auto& myElem = myRet.first->second;
+        if (mySample.theTimestamp - myElem.theTimestamp < stalePeriod()) {
+          myCurWeight *= (1 - theAlpha);
+          myCurWeight += theAlpha * myElem.theWeight;
+        }
+        myElem.theTimestamp = std::max(myElem.theTimestamp,
+                                       mySample.theTimestamp);
+        myElem.theWeight    = myCurWeight;
       }
-      myInnerRet.first->second.theTimestamp = myNow;
-      myInnerRet.first->second.theWeight    = myCurWeight;
+
+      myChanges[mySample.theLambda][mySample.theDestination] = myCurWeight;
     }
+    myBuffer->theTail.store(myHead, std::memory_order_release);
+
+    it = myExited ? theBuffers.erase(it) : std::next(it);
   }
 
-  theForwardingTable.change(myLambda, aDestination, myCurWeight);
+  for (const auto& myChange : myChanges) {
+    try {
+      theForwardingTable.change(myChange.first, myChange.second);
+    } catch (const std::exception& aErr) {
+      VLOG(1) << "Could not update the weights of lambda " << myChange.first
+              << ": " << aErr.what();
+    }
+  }
 }
 
 } // namespace edge
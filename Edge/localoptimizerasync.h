@@ -32,10 +32,14 @@ SOFTWARE.
 #pragma once
 
 #include "Support/chrono.h"
+#include "Support/periodictask.h"
 #include "localoptimizer.h"
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
@@ -49,6 +53,14 @@ class LocalOptimizerFactory;
  * An exponentially weighted smoothing is applied:
  *
  * Weight(t) = alpha * Latency(t)  + (1 - alpha) * Weight(t=1)
+ *
+ * The latencies reported are not applied immediately: every thread appends
+ * them to its own buffer, without locking, and the buffers of all threads
+ * are merged into the smoothed weights periodically or as soon as one of
+ * them becomes full. The weights of all the destinations of a lambda that
+ * changed since the last merge are then published to the forwarding table at
+ * once. The buffers of the threads that have exited are dropped after their
+ * samples have been merged.
  */
 class LocalOptimizerAsync final : public LocalOptimizer
 {
@@ -60,26 +72,71 @@ class LocalOptimizerAsync final : public LocalOptimizer
     double theTimestamp;
   };
 
+  struct Sample {
+    std::string theLambda;
+    std::string theDestination;
+    double      theTime;
+    double      theTimestamp;
+  };
+
+  /**
+   * Single-producer single-consumer ring of samples. The producer is the
+   * thread owning the buffer, the consumer is whoever holds theMutex.
+   * The slots are reused, hence the strings do not allocate memory once
+   * their capacity is sufficient to hold the names of lambdas/destinations.
+   */
+  struct Buffer {
+    Buffer();
+
+    std::vector<Sample> theSamples;
+    std::atomic<size_t> theHead; // written only by the producer
+    std::atomic<size_t> theTail; // written only by the consumer
+  };
+
   void operator()(const rpc::LambdaRequest& aReq,
                   const std::string&        aDestination,
                   const double              aTime) override;
 
+  /**
+   * \param aForwardingTable The table to update.
+   * \param aAlpha The smoothing factor.
+   * \param aPeriod The interval between consecutive merges, in s.
+   */
   explicit LocalOptimizerAsync(ForwardingTable& aForwardingTable,
-                               const double     aAlpha);
+                               const double     aAlpha,
+                               const double     aPeriod);
+
+  //! \return the buffer of the calling thread, registered upon first use.
+  Buffer& buffer();
+
+  //! Merge the samples of all buffers and publish the new weights.
+  void merge();
 
  private:
   // ctor arguments
   const double theAlpha;
 
   // internal state
+  const uint64_t                                     theId;
   std::mutex                                         theMutex;
+  std::vector<std::shared_ptr<Buffer>>               theBuffers;
   std::map<std::string, std::map<std::string, Elem>> theWeights;
   support::Chrono                                    theChrono;
 
+  // must be the last member, so that it is stopped first on destruction
+  support::PeriodicTask theTask;
+
+ public:
   // static configuration
   static constexpr double stalePeriod() {
     return 5; // seconds
   }
+  static constexpr double defaultPeriod() {
+    return 0.1; // seconds
+  }
+  static constexpr size_t bufferSize() {
+    return 256; // samples per thread
+  }
 };
 
 } // namespace edge
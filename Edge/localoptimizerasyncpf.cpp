@@ -8,18 +8,52 @@
 namespace uiiit {
 namespace edge {
 
-LocalOptimizerAsyncPF::LocalOptimizerAsyncPF(ForwardingTable& aForwardingTable)
-    : LocalOptimizer(aForwardingTable) {
-  LOG(INFO) << "Creating an async local optimizer for proportional fairness "
-            << '\n';
+LocalOptimizerAsyncPF::LocalOptimizerAsyncPF(ForwardingTable& aForwardingTable,
+                                             const double     aPeriod)
+    : LocalOptimizer(aForwardingTable)
+    , theFlushMutex()
+    , theMutex()
+    , thePending()
+    , theNumPending(0)
+    , theTask([this]() { flush(); }, aPeriod) {
+  LOG(INFO) << "Creating an async local optimizer for proportional fairness"
+            << ", update period = " << aPeriod << " s";
 }
 
 void LocalOptimizerAsyncPF::operator()(const rpc::LambdaRequest& aReq,
                                        const std::string&        aDestination,
                                        const double              aTime) {
   assert(aTime > 0);
-  const auto& myLambda = aReq.name();
-  theForwardingTable.change(myLambda, aDestination, aTime);
+  bool myFull = false;
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    thePending[aReq.name()].emplace_back(aDestination, aTime);
+    myFull = ++theNumPending >= maxPending();
+  }
+  if (myFull) {
+    flush();
+  }
+}
+
+void LocalOptimizerAsyncPF::flush() {
+  // the latencies of an older flush cannot be applied after newer ones
+  const std::lock_guard<std::mutex> myFlushLock(theFlushMutex);
+
+  std::map<std::string, std::vector<std::pair<std::string, float>>> myPending;
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    myPending.swap(thePending);
+    theNumPending = 0;
+  }
+
+  for (const auto& elem : myPending) {
+    try {
+      theForwardingTable.applyChanges(elem.first, elem.second);
+    } catch (const std::exception& aErr) {
+      VLOG(1) << "Could not update the weights of lambda " << elem.first
+              << ": " << aErr.what();
+    }
+  }
 }
 
 } // namespace edge
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "Support/chrono.h"
+#include "Support/periodictask.h"
 #include "localoptimizer.h"
 
 #include <map>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
@@ -38,6 +42,11 @@ class LocalOptimizerFactory;
  *      + alpha = 0, beta = 1 => RoundRobin
  *      + alpha = 1, beta = 0 => max unfairness (always the best, maximizes
  * the throughput)
+ *
+ * The latencies reported are not applied one by one, since every change of
+ * the forwarding table copies the entry of the lambda: they are collected
+ * and applied in order, with a single change per lambda, periodically or as
+ * soon as too many are pending.
  */
 class LocalOptimizerAsyncPF final : public LocalOptimizer
 {
@@ -48,8 +57,39 @@ class LocalOptimizerAsyncPF final : public LocalOptimizer
                   const std::string&        aDestination,
                   const double              aTime) override;
 
-  explicit LocalOptimizerAsyncPF(ForwardingTable& aForwardingTable);
+  /**
+   * \param aForwardingTable The table to update.
+   * \param aPeriod The interval between consecutive updates of the table,
+   * in s.
+   */
+  explicit LocalOptimizerAsyncPF(ForwardingTable& aForwardingTable,
+                                 const double     aPeriod);
+
+  //! Apply the latencies reported since the previous call to the table.
+  void flush();
+
+ private:
+  std::mutex theFlushMutex; // serializes the updates of the table
+  std::mutex theMutex;      // protects the latencies pending
+
+  // key:   lambda
+  // value: destinations and latencies, in order of report
+  std::map<std::string, std::vector<std::pair<std::string, float>>> thePending;
+
+  // number of latencies in thePending
+  size_t theNumPending;
+
+  // must be the last member, so that it is stopped first on destruction
+  support::PeriodicTask theTask;
 
+ public:
+  // static configuration
+  static constexpr double defaultPeriod() {
+    return 0.1; // seconds
+  }
+  static constexpr size_t maxPending() {
+    return 1024; // latencies, for all lambdas
+  }
 };
 
 } // namespace edge
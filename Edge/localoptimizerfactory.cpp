@@ -35,6 +35,7 @@ SOFTWARE.
 #include "localoptimizerasync.h"
 #include "localoptimizerasyncpf.h"
 #include "localoptimizernone.h"
+#include "localoptimizertail.h"
 #include "localoptimizertrivial.h"
 
 namespace uiiit {
@@ -57,10 +58,24 @@ LocalOptimizerFactory::make(ForwardingTable&     aTable,
         LocalOptimizerTrivial::statFromString(aConf("stat"))));
 
   } else if (myType == "async") {
-    myRet.reset(new LocalOptimizerAsync(aTable, aConf.getDouble("alpha")));
+    myRet.reset(new LocalOptimizerAsync(
+        aTable,
+        aConf.getDouble("alpha"),
+        aConf.count("period") > 0 ? aConf.getDouble("period") :
+                                    LocalOptimizerAsync::defaultPeriod()));
 
   } else if (myType == "asyncPF") {
-    myRet.reset(new LocalOptimizerAsyncPF(aTable));
+    myRet.reset(new LocalOptimizerAsyncPF(
+        aTable,
+        aConf.count("period") > 0 ? aConf.getDouble("period") :
+                                    LocalOptimizerAsyncPF::defaultPeriod()));
+
+  } else if (myType == "tail") {
+    myRet.reset(new LocalOptimizerTail(
+        aTable,
+        aConf.getDouble("period"),
+        aConf.count("quantile") > 0 ? aConf.getDouble("quantile") :
+                                      LocalOptimizerTail::defaultQuantile()));
   }
 
   else {
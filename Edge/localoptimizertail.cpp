@@ -0,0 +1,124 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "localoptimizertail.h"
+
+#include "forwardingtable.h"
+
+#include "edgeserver.grpc.pb.h"
+
+#include <glog/logging.h>
+
+#include <iterator>
+#include <utility>
+
+namespace uiiit {
+namespace edge {
+
+LocalOptimizerTail::Window::Window()
+    : theCurrent(accuracy(), maxBins())
+    , thePrevious(accuracy(), maxBins()) {
+}
+
+LocalOptimizerTail::LocalOptimizerTail(ForwardingTable& aForwardingTable,
+                                       const double     aPeriod,
+                                       const double     aQuantile)
+    : LocalOptimizer(aForwardingTable)
+    , theQuantile(aQuantile)
+    , theMutex()
+    , theLatencies()
+    , theTask([this]() { update(); }, aPeriod) {
+  if (aQuantile <= 0 or aQuantile > 1) {
+    throw InvalidQuantile(aQuantile);
+  }
+  LOG(INFO) << "Creating a tail local optimizer with update period "
+            << aPeriod << " s, using quantile " << aQuantile;
+}
+
+void LocalOptimizerTail::operator()(const rpc::LambdaRequest& aReq,
+                                    const std::string&        aDestination,
+                                    const double              aTime) {
+  VLOG(2) << "req " << aReq.name() << ", dest " << aDestination << ", time "
+          << aTime << " s";
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  theLatencies[aReq.name()][aDestination].theCurrent.add(aTime);
+}
+
+void LocalOptimizerTail::update() {
+  VLOG(2) << "Periodic update (start)";
+
+  // key:   lambda
+  // value: map of key:   destination
+  //               value: new weight
+  std::map<std::string, std::map<std::string, float>> myWeights;
+
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    for (auto it = theLatencies.begin(); it != theLatencies.end();) {
+      auto& myEntry = it->second;
+      for (auto jt = myEntry.begin(); jt != myEntry.end();) {
+        auto& myWindow = jt->second;
+        myWindow.thePrevious.merge(myWindow.theCurrent);
+        if (myWindow.thePrevious.count() > 0) {
+          const auto myLatency = myWindow.thePrevious.quantile(theQuantile);
+          VLOG(2) << it->first << ", " << jt->first << ", num "
+                  << myWindow.thePrevious.count() << ", lat " << myLatency;
+          myWeights[it->first].emplace(jt->first, myLatency);
+        }
+
+        // the samples of the current period will be used again in the next
+        if (myWindow.theCurrent.count() == 0) {
+          jt = myEntry.erase(jt);
+        } else {
+          std::swap(myWindow.thePrevious, myWindow.theCurrent);
+          myWindow.theCurrent.clear();
+          ++jt;
+        }
+      }
+      it = myEntry.empty() ? theLatencies.erase(it) : std::next(it);
+    }
+  }
+
+  for (const auto& myElem : myWeights) {
+    try {
+      theForwardingTable.change(myElem.first, myElem.second);
+    } catch (const std::exception& aErr) {
+      VLOG(1) << "Could not update the weights of lambda " << myElem.first
+              << ": " << aErr.what();
+    }
+  }
+
+  VLOG(2) << "Periodic update (end)";
+}
+
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,113 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Support/periodictask.h"
+#include "localoptimizer.h"
+#include "quantilesketch.h"
+
+#include <map>
+#include <mutex>
+
+namespace uiiit {
+namespace edge {
+
+class LocalOptimizerFactory;
+
+/**
+ * Optimizer that sets the weight of every destination to a given percentile
+ * of the latencies measured towards it, rather than to their average,
+ * so that destinations with occasional long stalls are penalized.
+ *
+ * The latencies are kept in quantile sketches of bounded size, per lambda
+ * and destination. The weights are updated periodically using the samples
+ * of the last two periods; the destinations without samples in the last
+ * period are then forgotten.
+ */
+class LocalOptimizerTail final : public LocalOptimizer
+{
+  friend class LocalOptimizerFactory;
+
+  struct Window {
+    Window();
+
+    QuantileSketch theCurrent;
+    QuantileSketch thePrevious;
+  };
+
+  // key:   lambda
+  // value: map of key:   destination
+  //               value: latency sketches
+  using Latencies = std::map<std::string, std::map<std::string, Window>>;
+
+ public:
+  void operator()(const rpc::LambdaRequest& aReq,
+                  const std::string&        aDestination,
+                  const double              aTime) override;
+
+ private:
+  /**
+   * \param aForwardingTable The table to update.
+   * \param aPeriod The update period, in fractional seconds.
+   * \param aQuantile The quantile used as the weight, in (0, 1].
+   *
+   * \throw InvalidQuantile if the quantile is not valid.
+   */
+  explicit LocalOptimizerTail(ForwardingTable& aForwardingTable,
+                              const double     aPeriod,
+                              const double     aQuantile);
+
+  //! Update the local table and rotate the windows.
+  void update();
+
+ private:
+  const double theQuantile;
+  std::mutex   theMutex;
+  Latencies    theLatencies;
+
+  // must be the last member, so that it is stopped first on destruction
+  support::PeriodicTask theTask;
+
+  // static configuration
+  static constexpr double defaultQuantile() {
+    return 0.99;
+  }
+  static constexpr double accuracy() {
+    return 0.01;
+  }
+  static constexpr size_t maxBins() {
+    return 512; // covers a ratio of ~28000 between min and max at 1%
+  }
+};
+
+} // namespace edge
+} // namespace uiiit
@@ -83,6 +83,8 @@ void LocalOptimizerTrivial::update() {
 
 void LocalOptimizerTrivial::balance(const std::string&            aLambda,
                                     const Latencies::mapped_type& aEntry) {
+  // the new weights of all the destinations are published at once
+  std::map<std::string, float> myWeights;
   for (const auto& myElem : aEntry) {
     assert(myElem.second.count() > 0);
     double myLatency{0};
@@ -101,8 +103,9 @@ void LocalOptimizerTrivial::balance(const std::string&            aLambda,
             << myElem.second.mean() << ", min " << myElem.second.min()
             << ", max " << myElem.second.max() << ", lat " << myLatency;
     assert(myLatency > 0.0);
-    theForwardingTable.change(aLambda, myElem.first, myLatency);
+    myWeights.emplace(myElem.first, myLatency);
   }
+  theForwardingTable.change(aLambda, myWeights);
 }
 
 LocalOptimizerTrivial::Stat
@@ -0,0 +1,79 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "overload.h"
+
+#include <cassert>
+
+namespace uiiit {
+namespace edge {
+
+InFlightBudget::InFlightBudget(const size_t aMax)
+    : theMax(aMax)
+    , theMutex()
+    , theInFlight() {
+  // noop
+}
+
+bool InFlightBudget::acquire(const std::string& aDestination) {
+  if (theMax == 0) {
+    return true;
+  }
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  auto& myInFlight = theInFlight[aDestination]; // may insert
+  if (myInFlight >= theMax) {
+    return false;
+  }
+  myInFlight++;
+  return true;
+}
+
+void InFlightBudget::release(const std::string& aDestination) {
+  if (theMax == 0) {
+    return;
+  }
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto it = theInFlight.find(aDestination);
+  assert(it != theInFlight.end() and it->second > 0);
+  if (--it->second == 0) {
+    theInFlight.erase(it);
+  }
+}
+
+size_t InFlightBudget::inFlight(const std::string& aDestination) const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto it = theInFlight.find(aDestination);
+  return it == theInFlight.end() ? 0 : it->second;
+}
+
+} // namespace edge
+} // namespace uiiit
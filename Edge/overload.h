@@ -0,0 +1,96 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Support/macros.h"
+
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace uiiit {
+namespace edge {
+
+//! Return code of the lambda requests rejected because of overload.
+inline const std::string OVERLOADED_RETCODE("overloaded");
+
+//! Thrown when a lambda request cannot be admitted because of overload.
+struct Overloaded : public std::runtime_error {
+  explicit Overloaded()
+      : std::runtime_error(OVERLOADED_RETCODE) {
+  }
+};
+
+/**
+ * Thread-safe budget of the lambda requests in flight towards each
+ * destination, used to shed the load in excess rather than queueing it.
+ */
+class InFlightBudget final
+{
+ public:
+  NONCOPYABLE_NONMOVABLE(InFlightBudget);
+
+  /**
+   * \param aMax the maximum number of requests in flight per destination.
+   * 0 means unlimited.
+   */
+  explicit InFlightBudget(const size_t aMax);
+
+  /**
+   * Take one unit of the budget of a destination.
+   *
+   * \return false if the destination has no budget left.
+   */
+  bool acquire(const std::string& aDestination);
+
+  //! Return one unit of budget taken with acquire().
+  void release(const std::string& aDestination);
+
+  //! \return the number of requests in flight towards a destination.
+  size_t inFlight(const std::string& aDestination) const;
+
+  //! \return the maximum number of requests in flight per destination.
+  size_t max() const noexcept {
+    return theMax;
+  }
+
+ private:
+  const size_t                            theMax;
+  mutable std::mutex                      theMutex;
+  std::unordered_map<std::string, size_t> theInFlight;
+};
+
+} // namespace edge
+} // namespace uiiit
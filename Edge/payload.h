@@ -0,0 +1,142 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace uiiit {
+namespace edge {
+
+/**
+ * An immutable, reference-counted byte buffer.
+ *
+ * Copying a payload only increments a reference counter, while the underlying
+ * buffer is shared among all the copies and never modified after creation.
+ * This allows large function inputs and outputs to be passed around between
+ * requests, responses and clients without duplicating them.
+ *
+ * A payload is implicitly convertible to a const std::string reference, which
+ * remains valid as long as the payload (or any copy of it) is alive.
+ * A moved-from payload is empty.
+ */
+class Payload final
+{
+ public:
+  //! Create an empty payload.
+  Payload();
+
+  //! Create a payload by copying the given string.
+  Payload(const std::string& aValue);
+
+  //! Create a payload by moving the given string, without copying it.
+  Payload(std::string&& aValue);
+
+  //! Create a payload from a null-terminated string.
+  Payload(const char* aValue);
+
+  //! \return the underlying buffer.
+  operator const std::string&() const noexcept {
+    return str();
+  }
+
+  //! \return the underlying buffer.
+  const std::string& str() const noexcept {
+    return theValue ? *theValue : emptyString();
+  }
+
+  //! \return a pointer to the first byte of the buffer.
+  const char* data() const noexcept {
+    return str().data();
+  }
+
+  //! \return the size of the buffer, in bytes.
+  size_t size() const noexcept {
+    return theValue ? theValue->size() : 0;
+  }
+
+  //! \return true if the buffer is empty.
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  //! \return true if this payload shares a non-empty buffer with another.
+  bool shares(const Payload& aOther) const noexcept {
+    return theValue and theValue == aOther.theValue;
+  }
+
+ private:
+  static const std::string& emptyString() noexcept;
+
+ private:
+  // null if empty
+  std::shared_ptr<const std::string> theValue;
+};
+
+inline bool operator==(const Payload& aLhs, const Payload& aRhs) {
+  return aLhs.shares(aRhs) or aLhs.str() == aRhs.str();
+}
+inline bool operator==(const Payload& aLhs, const std::string& aRhs) {
+  return aLhs.str() == aRhs;
+}
+inline bool operator==(const std::string& aLhs, const Payload& aRhs) {
+  return aLhs == aRhs.str();
+}
+inline bool operator==(const Payload& aLhs, const char* aRhs) {
+  return aLhs.str() == aRhs;
+}
+inline bool operator==(const char* aLhs, const Payload& aRhs) {
+  return aLhs == aRhs.str();
+}
+
+inline bool operator!=(const Payload& aLhs, const Payload& aRhs) {
+  return not(aLhs == aRhs);
+}
+inline bool operator!=(const Payload& aLhs, const std::string& aRhs) {
+  return not(aLhs == aRhs);
+}
+inline bool operator!=(const std::string& aLhs, const Payload& aRhs) {
+  return not(aLhs == aRhs);
+}
+inline bool operator!=(const Payload& aLhs, const char* aRhs) {
+  return not(aLhs == aRhs);
+}
+inline bool operator!=(const char* aLhs, const Payload& aRhs) {
+  return not(aLhs == aRhs);
+}
+
+} // namespace edge
+} // namespace uiiit
+
+std::ostream& operator<<(std::ostream&               aStream,
+                         const uiiit::edge::Payload& aPayload);
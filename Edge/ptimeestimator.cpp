@@ -31,6 +31,8 @@ SOFTWARE.
 
 #include "ptimeestimator.h"
 
+#include "Edge/destinationregistry.h"
+
 #include <glog/logging.h>
 
 #include <cassert>
@@ -55,7 +57,7 @@ void PtimeEstimator::change(const std::string& aLambda,
                             const bool         aFinal) {
   std::ignore = aWeight;
 
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  std::unique_lock<std::mutex> myLock(theMutex);
 
   bool myAdded = false;
   auto it      = theTable.emplace(aLambda,
@@ -77,7 +79,11 @@ void PtimeEstimator::change(const std::string& aLambda,
   }
 
   if (myAdded) {
+    // share the end-point with the clients towards the destination
+    DestinationRegistry::instance().intern(aDest);
     privateAdd(aLambda, aDest);
+    myLock.unlock();
+    privateCleanup();
   }
 }
 
@@ -91,7 +97,7 @@ void PtimeEstimator::change(const std::string& aLambda,
 
 void PtimeEstimator::processFailure(const rpc::LambdaRequest& aReq,
                                     const std::string&        aDestination) {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  std::unique_lock<std::mutex> myLock(theMutex);
 
   // remove the pending estimates from the data structure
   const auto myRemoved = theEstimates.erase(reinterpret_cast<uint64_t>(&aReq));
@@ -100,12 +106,36 @@ void PtimeEstimator::processFailure(const rpc::LambdaRequest& aReq,
 
   // remove the destination from the edge computer table
   internalRemove(aReq.name(), aDestination);
+  myLock.unlock();
+  privateCleanup();
+}
+
+void PtimeEstimator::processAbort(const rpc::LambdaRequest& aReq,
+                                  const std::string&        aDestination) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+
+  // there are no estimates if the request has been already accounted for
+  if (theEstimates.erase(reinterpret_cast<uint64_t>(&aReq)) > 0) {
+    privateAbort(aReq.name(), aDestination);
+  }
+}
+
+void PtimeEstimator::privateAbort(const std::string& aLambda,
+                                  const std::string& aDestination) {
+  std::ignore = aLambda;
+  std::ignore = aDestination;
+}
+
+void PtimeEstimator::privateCleanup() {
+  // noop
 }
 
 void PtimeEstimator::remove(const std::string& aLambda,
                             const std::string& aDest) {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  std::unique_lock<std::mutex> myLock(theMutex);
   internalRemove(aLambda, aDest);
+  myLock.unlock();
+  privateCleanup();
 }
 
 void PtimeEstimator::internalRemove(const std::string& aLambda,
@@ -131,7 +161,7 @@ void PtimeEstimator::internalRemove(const std::string& aLambda,
 }
 
 void PtimeEstimator::remove(const std::string& aLambda) {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  std::unique_lock<std::mutex> myLock(theMutex);
   assertConsistency(aLambda);
 
   const auto it = theTable.find(aLambda);
@@ -145,6 +175,8 @@ void PtimeEstimator::remove(const std::string& aLambda) {
   const auto myErased = theTable.erase(aLambda);
   LOG_IF(INFO, myErased > 0)
       << "Removed all destinations for lambda " << aLambda;
+  myLock.unlock();
+  privateCleanup();
 }
 
 std::set<std::string> PtimeEstimator::lambdas() const {
@@ -164,6 +196,7 @@ const std::string& toString(const PtimeEstimator::Type aType) {
       {PtimeEstimator::Type::Rtt, "rtt"},
       {PtimeEstimator::Type::Util, "util"},
       {PtimeEstimator::Type::Probe, "probe"},
+      {PtimeEstimator::Type::Stream, "stream"},
   });
   assert(myValues.find(aType) != myValues.end());
   return myValues.find(aType)->second;
@@ -178,6 +211,8 @@ PtimeEstimator::Type ptimeEstimatorTypeFromString(const std::string& aType) {
     return PtimeEstimator::Type::Util;
   } else if (aType == "probe") {
     return PtimeEstimator::Type::Probe;
+  } else if (aType == "stream") {
+    return PtimeEstimator::Type::Stream;
   }
   throw InvalidPtimeEstimatorType(aType);
 }
@@ -71,10 +71,11 @@ class PtimeEstimator : public ForwardingTableInterface
 
  public:
   enum class Type : int {
-    Test  = 0,
-    Rtt   = 1,
-    Util  = 2,
-    Probe = 3,
+    Test   = 0,
+    Rtt    = 1,
+    Util   = 2,
+    Probe  = 3,
+    Stream = 4,
   };
 
   NONCOPYABLE_NONMOVABLE(PtimeEstimator);
@@ -111,6 +112,17 @@ class PtimeEstimator : public ForwardingTableInterface
   void processFailure(const rpc::LambdaRequest& aReq,
                       const std::string&        aDestination);
 
+  /**
+   * Notify that a lambda request will not be executed by the destination
+   * returned for it, e.g., because the latter is overloaded, before the
+   * request is dispatched again or answered with an error.
+   *
+   * The pending estimates are discarded, if any, while the destination is
+   * not removed.
+   */
+  void processAbort(const rpc::LambdaRequest& aReq,
+                    const std::string&        aDestination);
+
   /**
    * Add a new destination for a given lambda or change its weight.
    *
@@ -163,6 +175,15 @@ class PtimeEstimator : public ForwardingTableInterface
   //! Called as an existing destination for a given lambda is removed.
   virtual void privateRemove(const std::string& aLambda,
                              const std::string& aDestination) = 0;
+  //! Called as a request dispatched to a destination is aborted. No-op.
+  virtual void privateAbort(const std::string& aLambda,
+                            const std::string& aDestination);
+  /**
+   * Called without the lock held after destinations are added or removed,
+   * to release the resources that must not be released with the lock held.
+   * No-op.
+   */
+  virtual void privateCleanup();
 
   void assertConsistency(const std::string& aLambda) const;
 
@@ -34,6 +34,7 @@ SOFTWARE.
 #include "Edge/ptimeestimatordelay.h"
 #include "Edge/ptimeestimatorprobe.h"
 #include "Edge/ptimeestimatorrtt.h"
+#include "Edge/ptimeestimatorstream.h"
 #include "Edge/ptimeestimatorutil.h"
 #include "Support/conf.h"
 
@@ -67,8 +68,16 @@ PtimeEstimatorFactory::make(const support::Conf& aConf) {
                                           aConf.getDouble("util-window-size"),
                                           aConf("output")));
     } else if (myType == "probe") {
-      myRet.reset(new PtimeEstimatorProbe(aConf.getUint("max-clients"),
-                                          aConf("output")));
+      myRet.reset(new PtimeEstimatorProbe(
+          aConf.count("timeout") > 0 ? aConf.getDouble("timeout") :
+                                       PtimeEstimatorProbe::defaultTimeout(),
+          aConf.count("validity") > 0 ? aConf.getDouble("validity") :
+                                        PtimeEstimatorProbe::defaultValidity(),
+          aConf("output")));
+    } else if (myType == "stream") {
+      myRet.reset(new PtimeEstimatorStream(aConf.getUint("util-port"),
+                                           aConf.getDouble("load-timeout"),
+                                           aConf("output")));
     } else {
       assert(false);
     }
@@ -109,7 +118,8 @@ PtimeEstimatorFactory::defaultConfs() {
        "type=util,rtt-window-size=50,rtt-stale-period=10,"
        "util-load-timeout=10,util-window-size=50,"
        "output=out.dat"},
-      {"probe", "type=probe,max-clients=10,output=out.dat"},
+      {"probe", "type=probe,timeout=0.1,validity=0.5,output=out.dat"},
+      {"stream", "type=stream,util-port=6476,load-timeout=5,output=out.dat"},
   });
   return theDefaultConfs;
 }
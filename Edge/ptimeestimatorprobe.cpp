@@ -32,54 +32,159 @@ SOFTWARE.
 #include "ptimeestimatorprobe.h"
 
 #include "Edge/edgemessages.h"
-#include "Support/conf.h"
 
 #include <glog/logging.h>
 
+#include <chrono>
+#include <condition_variable>
 #include <limits>
+#include <memory>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
 
-PtimeEstimatorProbe::PtimeEstimatorProbe(const size_t       aMaxClients,
+namespace {
+
+//! Results of the probes issued for a single decision.
+struct Probes {
+  std::mutex                          theMutex;
+  std::condition_variable             theCond;
+  size_t                              thePending = 0;
+  std::map<std::string, unsigned int> theAnswers;
+};
+
+//! \return the destination with minimum processing time, if any.
+std::string best(const std::map<std::string, unsigned int>& aPtimes) {
+  std::string  myBestDestination;
+  unsigned int myBestPtime = std::numeric_limits<unsigned int>::max();
+  for (const auto& elem : aPtimes) {
+    if (myBestDestination.empty() or elem.second < myBestPtime) {
+      myBestPtime       = elem.second;
+      myBestDestination = elem.first;
+    }
+  }
+  return myBestDestination;
+}
+
+} // namespace
+
+PtimeEstimatorProbe::PtimeEstimatorProbe(const double       aTimeout,
+                                         const double       aValidity,
                                          const std::string& aOutput)
     : PtimeEstimator(Type::Probe)
-    , theClients(support::Conf("type=grpc"), aMaxClients)
+    , theTimeout(aTimeout)
+    , theValidity(aValidity)
     , theDestinations([](const std::string&, const std::string&) {
       return std::make_unique<Descriptor>();
     }) // with timestap, with per-line flushing, truncate
-    , theSaver(aOutput, true, true, false) {
+    , theSaver(aOutput, true, true, false)
+    , theChrono(true)
+    , theCache()
+    , theClient(1) {
+  if (aTimeout <= 0) {
+    throw std::runtime_error("Invalid probe timeout: " +
+                             std::to_string(aTimeout));
+  }
+  LOG(INFO) << "probe timeout " << aTimeout << " s, validity " << aValidity
+            << " s";
   LOG_IF(INFO, not aOutput.empty())
       << "saving measurements to output file " << aOutput;
 }
 
 std::string PtimeEstimatorProbe::operator()(const rpc::LambdaRequest& aReq) {
-  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto& myLambda = aReq.name();
+  const auto  myBucket = bucket(size(aReq));
+
+  std::map<std::string, unsigned int> myPtimes; // fresh results
+  std::map<std::string, unsigned int> myStale;  // expired results
+  std::vector<std::string>            myProbed;
+  std::string                         myFirst;
+
+  // look up the cache, without probing while holding the lock
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+
+    const auto myNow = theChrono.time();
+    for (const auto& myDestination :
+         theDestinations.all(myLambda, [](Descriptor&) { return 0.0f; })) {
+      if (myFirst.empty()) {
+        myFirst = myDestination.first;
+      }
+      const auto it =
+          theCache.find(CacheKey{myLambda, myDestination.first, myBucket});
+      if (it == theCache.end()) {
+        myProbed.emplace_back(myDestination.first);
+      } else if (myNow - it->second.theTimestamp < theValidity) {
+        myPtimes.emplace(myDestination.first, it->second.thePtime);
+      } else {
+        myStale.emplace(myDestination.first, it->second.thePtime);
+        myProbed.emplace_back(myDestination.first);
+      }
+    }
+  }
 
-  const auto myAllDestinations =
-      theDestinations.all(aReq.name(), [](Descriptor&) { return 0.0f; });
+  // send all the probes at once and wait for them up to the timeout, after
+  // which the late answers will only be used to fill the cache
+  if (not myProbed.empty()) {
+    const auto myProbes  = std::make_shared<Probes>();
+    myProbes->thePending = myProbed.size();
+    for (const auto& myDestination : myProbed) {
+      theClient.ForwardLambda(
+          myDestination,
+          aReq,
+          true, // dry
+          [this, myProbes, myLambda, myDestination, myBucket](
+              LambdaResponse&& aRep, double) {
+            VLOG(2) << "destination " << myDestination << ", simulated ptime "
+                    << aRep.theProcessingTime << " ms, " << aRep.theRetCode;
+            const auto myOk = aRep.theRetCode == "OK";
+            if (myOk) {
+              const std::lock_guard<std::mutex> myLock(theMutex);
+              theCache[CacheKey{myLambda, myDestination, myBucket}] =
+                  CacheElem{aRep.theProcessingTime, theChrono.time()};
+            }
+            const std::lock_guard<std::mutex> myLock(myProbes->theMutex);
+            if (myOk) {
+              myProbes->theAnswers.emplace(myDestination,
+                                           aRep.theProcessingTime);
+            }
+            assert(myProbes->thePending > 0);
+            myProbes->thePending--;
+            myProbes->theCond.notify_one();
+          },
+          theTimeout);
+    }
 
-  std::string  myBestDestination;
-  unsigned int myBestPtime = std::numeric_limits<unsigned int>::max();
-  const auto   myReq       = LambdaRequest(aReq);
-  for (const auto& myDestination : myAllDestinations) {
-    const auto ret = theClients(myDestination.first, myReq, true); // dry
-    VLOG(2) << "destination " << myDestination.first << ", simulated ptime "
-            << ret.first.theProcessingTime << " ms";
-
-    if (ret.first.theRetCode == "OK" and
-        ret.first.theProcessingTime < myBestPtime) {
-      myBestPtime       = ret.first.theProcessingTime;
-      myBestDestination = myDestination.first;
+    std::unique_lock<std::mutex> myLock(myProbes->theMutex);
+    myProbes->theCond.wait_for(
+        myLock, std::chrono::duration<double>(theTimeout), [&myProbes]() {
+          return myProbes->thePending == 0;
+        });
+    for (const auto& elem : myProbes->theAnswers) {
+      myPtimes[elem.first] = elem.second;
+    }
+  }
+
+  auto myBestDestination = best(myPtimes);
+  if (myBestDestination.empty()) {
+    myBestDestination = best(myStale);
+    if (myBestDestination.empty()) {
+      VLOG(1) << "no probe answered for lambda " << myLambda
+              << ", using destination " << myFirst;
+      myBestDestination = myFirst;
     }
   }
   assert(not myBestDestination.empty());
-  assert(myBestPtime < std::numeric_limits<unsigned int>::max());
 
   // add to the estimates
-  const auto it =
+  const auto myIt    = myPtimes.find(myBestDestination);
+  const auto myPtime = myIt != myPtimes.end() ? myIt->second : 0u;
+
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it =
       theEstimates.emplace(reinterpret_cast<uint64_t>(&aReq),
-                           Estimates{0.0f, static_cast<float>(myBestPtime)});
+                           Estimates{0.0f, static_cast<float>(myPtime)});
   std::ignore = it; // ifdef NDEBUG
   assert(it.second);
 
@@ -112,7 +217,23 @@ void PtimeEstimatorProbe::privateAdd(const std::string& aLambda,
 void PtimeEstimatorProbe::privateRemove(const std::string& aLambda,
                                         const std::string& aDestination) {
   ASSERT_IS_LOCKED(theMutex);
-  theDestinations.add(aLambda, aDestination);
+  theDestinations.remove(aLambda, aDestination);
+
+  // the results of the destination removed are not needed anymore
+  for (auto it = theCache.lower_bound(CacheKey{aLambda, aDestination, 0});
+       it != theCache.end() and std::get<0>(it->first) == aLambda and
+       std::get<1>(it->first) == aDestination;) {
+    it = theCache.erase(it);
+  }
 }
+
+size_t PtimeEstimatorProbe::bucket(const size_t aSize) {
+  size_t ret = 0;
+  for (auto mySize = aSize; mySize > 0; mySize >>= 1) {
+    ret++;
+  }
+  return ret;
+}
+
 } // namespace edge
 } // namespace uiiit
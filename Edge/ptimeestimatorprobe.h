@@ -32,10 +32,15 @@ SOFTWARE.
 #pragma once
 
 #include "Edge/destinationtable.h"
-#include "Edge/edgeclientpool.h"
+#include "Edge/edgeclientasync.h"
 #include "Edge/ptimeestimator.h"
+#include "Support/chrono.h"
 #include "Support/saver.h"
 
+#include <map>
+#include <string>
+#include <tuple>
+
 namespace uiiit {
 
 namespace rpc {
@@ -47,18 +52,43 @@ namespace edge {
 /**
  * Class estimating the lambda execution time by polling all the possible
  * destinations (emulates a centralized approach).
+ *
+ * The dry runs are sent to all the destinations concurrently and the
+ * decision is taken on the answers received within the probe timeout,
+ * without holding the lock of the estimator while waiting. The results are
+ * cached per lambda, destination, and input size bucket, and reused without
+ * probing again for a short validity period.
  */
 class PtimeEstimatorProbe final : public PtimeEstimator
 {
   struct Descriptor {};
 
+  struct CacheElem {
+    unsigned int thePtime;     // in ms
+    double       theTimestamp; // in s, since creation of the estimator
+  };
+
+  // lambda, destination, size bucket
+  using CacheKey = std::tuple<std::string, std::string, size_t>;
+
  public:
-  explicit PtimeEstimatorProbe(const size_t       aMaxClients,
+  /**
+   * \param aTimeout The maximum time to wait for the probes, in s.
+   * \param aValidity The time during which a probe result is reused, in s.
+   * \param aOutput The file where to save the estimates, if not empty.
+   *
+   * \throw std::runtime_error if the timeout is not positive.
+   */
+  explicit PtimeEstimatorProbe(const double       aTimeout,
+                               const double       aValidity,
                                const std::string& aOutput);
 
   /**
    * \return the destination for the given lambda.
    *
+   * If no probe is answered in time and there are no results in the cache,
+   * not even expired, then the first destination is returned.
+   *
    * \throw NoDestinations if the given lambda is not in the table.
    */
   std::string operator()(const rpc::LambdaRequest& aReq) override;
@@ -71,16 +101,31 @@ class PtimeEstimatorProbe final : public PtimeEstimator
                       const LambdaResponse&     aRep,
                       const double              aTime) override;
 
+  // clang-format off
+  static constexpr double defaultTimeout() { return 0.1; }
+  static constexpr double defaultValidity() { return 0.5; }
+  // clang-format on
+
  private:
   void privateAdd(const std::string& aLambda,
                   const std::string& aDestination) override;
   void privateRemove(const std::string& aLambda,
                      const std::string& aDestination) override;
 
+  //! \return the bucket of an input size, i.e., the size in log2 scale.
+  static size_t bucket(const size_t aSize);
+
  private:
-  EdgeClientPool               theClients;
-  DestinationTable<Descriptor> theDestinations;
-  support::Saver               theSaver;
+  const double                  theTimeout;
+  const double                  theValidity;
+  DestinationTable<Descriptor>  theDestinations;
+  support::Saver                theSaver;
+  support::Chrono               theChrono;
+  std::map<CacheKey, CacheElem> theCache;
+
+  // must be the last member, so that the callbacks of the probes pending
+  // upon destruction find the other members still alive
+  EdgeClientAsync theClient;
 };
 
 } // namespace edge
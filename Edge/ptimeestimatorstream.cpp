@@ -0,0 +1,273 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ptimeestimatorstream.h"
+
+#include "Edge/edgecomputerclient.h"
+#include "Edge/edgemessages.h"
+
+#include <glog/logging.h>
+
+#include <cassert>
+#include <chrono>
+
+namespace uiiit {
+namespace edge {
+
+PtimeEstimatorStream::Subscription::Subscription(const std::string& aEndpoint,
+                                                 const double       aRetry)
+    : theEndpoint(aEndpoint)
+    , theRetry(aRetry)
+    , theMutex()
+    , theCond()
+    , theStop(false)
+    , theClient()
+    , theLoads()
+    , theChrono(true)
+    , theThread([this]() { run(); }) {
+  VLOG(1) << "subscribing to the utilization stream of " << aEndpoint;
+}
+
+PtimeEstimatorStream::Subscription::~Subscription() {
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    theStop = true;
+    if (theClient) {
+      theClient->cancel();
+    }
+    theCond.notify_one();
+  }
+  theThread.join();
+  VLOG(1) << "unsubscribed from the utilization stream of " << theEndpoint;
+}
+
+bool PtimeEstimatorStream::Subscription::load(const std::string& aLambda,
+                                              const double       aTimeout,
+                                              Load&              aLoad) const {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  const auto                        it = theLoads.find(aLambda);
+  if (it == theLoads.end() or
+      (theChrono.time() - it->second.theTimestamp) > aTimeout) {
+    return false;
+  }
+  aLoad = it->second;
+  return true;
+}
+
+void PtimeEstimatorStream::Subscription::run() {
+  std::unique_lock<std::mutex> myLock(theMutex);
+  while (not theStop) {
+    theClient = std::make_unique<EdgeComputerClient>(theEndpoint);
+    auto& myClient = *theClient;
+    myLock.unlock();
+
+    try {
+      myClient.StreamUtil(
+          [](const std::string&, const float) {},
+          [this](const std::string& aLambda,
+                 const size_t       aActive,
+                 const size_t       aPending,
+                 const float        aWait) {
+            const std::lock_guard<std::mutex> myLoadLock(theMutex);
+            auto& myLoad         = theLoads[aLambda];
+            myLoad.theActive     = aActive;
+            myLoad.thePending    = aPending;
+            myLoad.theWait       = aWait;
+            myLoad.theTimestamp  = theChrono.time();
+            myLoad.theSequence  += 1;
+          });
+    } catch (const std::exception& aErr) {
+      VLOG(1) << "utilization stream from " << theEndpoint
+              << " interrupted: " << aErr.what();
+    }
+
+    myLock.lock();
+    theCond.wait_for(myLock,
+                     std::chrono::duration<double>(theRetry),
+                     [this]() { return theStop; });
+  }
+}
+
+PtimeEstimatorStream::PtimeEstimatorStream(const unsigned int aUtilPort,
+                                           const double       aLoadTimeout,
+                                           const std::string& aOutput)
+    : PtimeEstimator(Type::Stream)
+    , theUtilPort(aUtilPort)
+    , theLoadTimeout(aLoadTimeout)
+    , theDestinations([this](const std::string&, const std::string& aDest) {
+      const auto it = theSubscriptions.find(aDest);
+      assert(it != theSubscriptions.end());
+      return std::make_unique<Descriptor>(*it->second.second);
+    }) // with timestap, with per-line flushing, truncate
+    , theSaver(aOutput, true, true, false)
+    , theSubscriptions()
+    , theUnsubscribed() {
+  LOG(INFO) << "utilization port " << aUtilPort << ", load timeout "
+            << aLoadTimeout << " s";
+  LOG_IF(INFO, not aOutput.empty())
+      << "saving measurements to output file " << aOutput;
+}
+
+PtimeEstimatorStream::~PtimeEstimatorStream() {
+  // the subscriptions are canceled by their dtors
+}
+
+std::string PtimeEstimatorStream::operator()(const rpc::LambdaRequest& aReq) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+
+  const auto& myLambda = aReq.name();
+  const auto  ret =
+      theDestinations.best(myLambda, [this, &myLambda](Descriptor& aDesc) {
+        return -static_cast<float>(delay(myLambda, aDesc));
+      });
+
+  theDestinations.find(myLambda, ret.first).theDispatched++;
+
+  const auto it = theEstimates.emplace(reinterpret_cast<uint64_t>(&aReq),
+                                       Estimates{0.0f, -1e3f * ret.second});
+  std::ignore   = it; // ifdef NDEBUG
+  assert(it.second);
+
+  return ret.first;
+}
+
+void PtimeEstimatorStream::processSuccess(
+    const rpc::LambdaRequest& aReq,
+    const std::string&        aDestination,
+    const LambdaResponse&     aRep,
+    const double) {
+  const std::lock_guard<std::mutex> myLock(theMutex);
+  auto it = theEstimates.find(reinterpret_cast<uint64_t>(&aReq));
+  if (it != theEstimates.end()) {
+    theSaver(aReq.name() + " " + aDestination,
+             size(aReq),
+             it->second.thePtime,
+             aRep.theProcessingTime);
+    theEstimates.erase(it);
+  } else {
+    assert(false);
+  }
+
+  try {
+    auto&      myDesc  = theDestinations.find(aReq.name(), aDestination);
+    const auto myPtime = 1e-3 * aRep.theProcessingTime;
+    myDesc.thePtime    = myDesc.thePtime == 0 ?
+                          myPtime :
+                          alpha() * myPtime + (1 - alpha()) * myDesc.thePtime;
+    if (myDesc.theDispatched > 0) {
+      myDesc.theDispatched--;
+    }
+  } catch (const InvalidDestination&) {
+    // the destination has been removed in the meanwhile
+  }
+}
+
+std::string PtimeEstimatorStream::utilEndpoint(const std::string& aDestination,
+                                               const unsigned int aUtilPort) {
+  const auto myPos = aDestination.rfind(':');
+  return aDestination.substr(0, myPos) + ":" + std::to_string(aUtilPort);
+}
+
+void PtimeEstimatorStream::privateAdd(const std::string& aLambda,
+                                      const std::string& aDestination) {
+  ASSERT_IS_LOCKED(theMutex);
+  auto& mySubscription = theSubscriptions[aDestination];
+  if (not mySubscription.second) {
+    assert(mySubscription.first == 0);
+    mySubscription.second = std::make_unique<Subscription>(
+        utilEndpoint(aDestination, theUtilPort), retryPeriod());
+  }
+  if (theDestinations.add(aLambda, aDestination)) {
+    mySubscription.first++;
+  } else if (mySubscription.first == 0) {
+    // do not leave behind a subscription that is not used by any lambda
+    theUnsubscribed.emplace_back(std::move(mySubscription.second));
+    theSubscriptions.erase(aDestination);
+  }
+}
+
+void PtimeEstimatorStream::privateRemove(const std::string& aLambda,
+                                         const std::string& aDestination) {
+  ASSERT_IS_LOCKED(theMutex);
+  if (not theDestinations.remove(aLambda, aDestination)) {
+    return;
+  }
+
+  // the subscription is destroyed by privateCleanup()
+  const auto it = theSubscriptions.find(aDestination);
+  assert(it != theSubscriptions.end());
+  assert(it->second.first > 0);
+  if (--it->second.first == 0) {
+    theUnsubscribed.emplace_back(std::move(it->second.second));
+    theSubscriptions.erase(it);
+  }
+}
+
+void PtimeEstimatorStream::privateAbort(const std::string& aLambda,
+                                        const std::string& aDestination) {
+  ASSERT_IS_LOCKED(theMutex);
+  try {
+    // the request is not queued at the destination
+    auto& myDesc = theDestinations.find(aLambda, aDestination);
+    if (myDesc.theDispatched > 0) {
+      myDesc.theDispatched--;
+    }
+  } catch (const InvalidDestination&) {
+    // the destination has been removed in the meanwhile
+  }
+}
+
+void PtimeEstimatorStream::privateCleanup() {
+  std::vector<std::unique_ptr<Subscription>> myUnsubscribed;
+  {
+    const std::lock_guard<std::mutex> myLock(theMutex);
+    myUnsubscribed.swap(theUnsubscribed);
+  }
+  // the subscriptions are destroyed here, without holding the lock
+}
+
+double PtimeEstimatorStream::delay(const std::string& aLambda,
+                                   Descriptor&        aDesc) const {
+  Load myLoad;
+  auto myWait = 0.0;
+  if (aDesc.theSubscription.load(aLambda, theLoadTimeout, myLoad)) {
+    if (myLoad.theSequence != aDesc.theSequence) {
+      // the requests dispatched so far are accounted for in the new report
+      aDesc.theSequence   = myLoad.theSequence;
+      aDesc.theDispatched = 0;
+    }
+    myWait = myLoad.theWait;
+  }
+  return myWait + aDesc.theDispatched * aDesc.thePtime;
+}
+
+} // namespace edge
+} // namespace uiiit
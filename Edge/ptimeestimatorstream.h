@@ -0,0 +1,210 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Edge/destinationtable.h"
+#include "Edge/ptimeestimator.h"
+#include "Support/chrono.h"
+#include "Support/macros.h"
+#include "Support/saver.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uiiit {
+
+namespace rpc {
+class LambdaRequest;
+}
+
+namespace edge {
+
+class EdgeComputerClient;
+
+/**
+ * Class estimating the processing time of a lambda based on the loads
+ * pushed by the edge computers through their utilization stream.
+ *
+ * Every destination is subscribed to, as soon as it is added for any lambda,
+ * at the utilization end-point with the same host and the given port, until
+ * it is removed for all the lambdas. The subscription is re-established
+ * periodically if broken.
+ *
+ * The estimated delay of a destination is the time a new task would wait in
+ * the container of the lambda, as last reported by the edge computer, plus
+ * the smoothed processing time of the lambda times the number of requests
+ * dispatched to it since the last report and not completed yet. If the
+ * last report is older than the load timeout, then only the latter term is
+ * used.
+ */
+class PtimeEstimatorStream final : public PtimeEstimator
+{
+  //! Last load reported for the container of a lambda.
+  struct Load {
+    size_t   theActive;
+    size_t   thePending;
+    double   theWait;      // in s
+    double   theTimestamp; // in s, since the subscription
+    uint64_t theSequence;  // incremented at every report
+  };
+
+  //! Subscription to the utilization stream of an edge computer.
+  class Subscription final
+  {
+   public:
+    NONCOPYABLE_NONMOVABLE(Subscription);
+
+    /**
+     * \param aEndpoint The end-point of the utilization server.
+     * \param aRetry The time to wait before re-subscribing, in s.
+     */
+    explicit Subscription(const std::string& aEndpoint, const double aRetry);
+
+    //! Cancel the subscription and wait for its thread to terminate.
+    ~Subscription();
+
+    /**
+     * \param aLambda The lambda name.
+     * \param aTimeout The time after which a report is stale, in s.
+     * \param aLoad The last load reported, if any and not stale.
+     *
+     * \return true if the load has been set.
+     */
+    bool load(const std::string& aLambda,
+              const double       aTimeout,
+              Load&              aLoad) const;
+
+   private:
+    //! Thread execution body.
+    void run();
+
+   private:
+    const std::string                   theEndpoint;
+    const double                        theRetry;
+    mutable std::mutex                  theMutex;
+    std::condition_variable             theCond;
+    bool                                theStop;
+    std::unique_ptr<EdgeComputerClient> theClient;
+    std::map<std::string, Load>         theLoads;
+    support::Chrono                     theChrono;
+    std::thread                         theThread;
+  };
+
+  struct Descriptor {
+    explicit Descriptor(Subscription& aSubscription)
+        : theSubscription(aSubscription)
+        , theDispatched(0)
+        , theSequence(0)
+        , thePtime(0) {
+    }
+
+    Subscription& theSubscription;
+    size_t        theDispatched; // since the last report
+    uint64_t      theSequence;   // of the last report
+    double        thePtime;      // smoothed processing time, in s
+  };
+
+ public:
+  /**
+   * \param aUtilPort The port of the utilization server of the destinations.
+   * \param aLoadTimeout The time after which a load report is stale, in s.
+   * \param aOutput Where to save the estimated vs. measured processing time;
+   * disabled if empty.
+   */
+  explicit PtimeEstimatorStream(const unsigned int aUtilPort,
+                                const double       aLoadTimeout,
+                                const std::string& aOutput);
+
+  ~PtimeEstimatorStream() override;
+
+  /**
+   * \return the destination for the given lambda.
+   *
+   * \throw NoDestinations if the given lambda is not in the table.
+   */
+  std::string operator()(const rpc::LambdaRequest& aReq) override;
+
+  /**
+   * Update the smoothed processing time of the lambda at the destination.
+   */
+  void processSuccess(const rpc::LambdaRequest& aReq,
+                      const std::string&        aDestination,
+                      const LambdaResponse&     aRep,
+                      const double              aTime) override;
+
+  //! \return the end-point of the utilization server of a destination.
+  static std::string utilEndpoint(const std::string& aDestination,
+                                  const unsigned int aUtilPort);
+
+ private:
+  void privateAdd(const std::string& aLambda,
+                  const std::string& aDestination) override;
+  void privateRemove(const std::string& aLambda,
+                     const std::string& aDestination) override;
+  void privateAbort(const std::string& aLambda,
+                    const std::string& aDestination) override;
+  void privateCleanup() override;
+
+  //! \return the estimated delay of a destination for a lambda, in s.
+  double delay(const std::string& aLambda, Descriptor& aDescriptor) const;
+
+ private:
+  const unsigned int           theUtilPort;
+  const double                 theLoadTimeout;
+  DestinationTable<Descriptor> theDestinations;
+  support::Saver               theSaver;
+
+  // key:   destination
+  // value: number of lambdas served and subscription
+  std::map<std::string, std::pair<size_t, std::unique_ptr<Subscription>>>
+      theSubscriptions;
+
+  // subscriptions not used anymore, which are destroyed without holding
+  // theMutex since their dtor waits for their thread to terminate
+  std::vector<std::unique_ptr<Subscription>> theUnsubscribed;
+
+  // static configuration
+  static constexpr double retryPeriod() {
+    return 1; // seconds
+  }
+  static constexpr double alpha() {
+    return 0.1; // smoothing factor of the processing time
+  }
+};
+
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,164 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "quantilesketch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace uiiit {
+namespace edge {
+
+QuantileSketch::QuantileSketch(const double aAccuracy, const size_t aMaxBins)
+    : theAccuracy(aAccuracy)
+    , theGamma((1 + aAccuracy) / (1 - aAccuracy))
+    , theLogGamma(std::log(theGamma))
+    , theMaxBins(aMaxBins)
+    , theMinIndex(0)
+    , theBins()
+    , theZeroCount(0)
+    , theCount(0) {
+  if (aAccuracy <= 0 or aAccuracy >= 1) {
+    throw std::runtime_error("Invalid quantile sketch accuracy: " +
+                             std::to_string(aAccuracy));
+  }
+  if (aMaxBins == 0) {
+    throw std::runtime_error("Invalid number of quantile sketch bins: 0");
+  }
+}
+
+void QuantileSketch::add(const double aValue) {
+  theCount++;
+  if (aValue <= 0) {
+    theZeroCount++;
+    return;
+  }
+
+  const auto myIndex = index(aValue);
+  grow(myIndex, myIndex);
+  theBins[std::max(myIndex, theMinIndex) - theMinIndex]++;
+}
+
+void QuantileSketch::merge(const QuantileSketch& aOther) {
+  if (theAccuracy != aOther.theAccuracy or theMaxBins != aOther.theMaxBins) {
+    throw std::runtime_error(
+        "Cannot merge quantile sketches with different parameters");
+  }
+
+  theCount += aOther.theCount;
+  theZeroCount += aOther.theZeroCount;
+  if (aOther.theBins.empty()) {
+    return;
+  }
+
+  const int myOtherHigh =
+      aOther.theMinIndex + static_cast<int>(aOther.theBins.size()) - 1;
+  grow(aOther.theMinIndex, myOtherHigh);
+  for (size_t i = 0; i < aOther.theBins.size(); i++) {
+    const auto myIndex = aOther.theMinIndex + static_cast<int>(i);
+    theBins[std::max(myIndex, theMinIndex) - theMinIndex] += aOther.theBins[i];
+  }
+}
+
+double QuantileSketch::quantile(const double aQuantile) const {
+  if (aQuantile < 0 or aQuantile > 1) {
+    throw InvalidQuantile(aQuantile);
+  }
+  if (theCount == 0) {
+    throw EmptySketch();
+  }
+
+  // 0-based rank of the value to be returned
+  const auto myRank =
+      static_cast<uint64_t>(aQuantile * static_cast<double>(theCount - 1));
+
+  auto myCumulative = theZeroCount;
+  if (myCumulative > myRank) {
+    return 0;
+  }
+  for (size_t i = 0; i < theBins.size(); i++) {
+    myCumulative += theBins[i];
+    if (myCumulative > myRank) {
+      return value(theMinIndex + static_cast<int>(i));
+    }
+  }
+  assert(false);
+  return value(theMinIndex + static_cast<int>(theBins.size()) - 1);
+}
+
+void QuantileSketch::clear() {
+  theMinIndex = 0;
+  theBins.clear();
+  theZeroCount = 0;
+  theCount     = 0;
+}
+
+int QuantileSketch::index(const double aValue) const {
+  assert(aValue > 0);
+  return static_cast<int>(std::ceil(std::log(aValue) / theLogGamma));
+}
+
+double QuantileSketch::value(const int aIndex) const {
+  // the midpoint of (gamma^(i-1), gamma^i] in relative terms
+  return 2 * std::pow(theGamma, aIndex) / (theGamma + 1);
+}
+
+void QuantileSketch::grow(const int aLow, const int aHigh) {
+  assert(aLow <= aHigh);
+
+  if (theBins.empty()) {
+    theMinIndex = std::max(aLow, aHigh - static_cast<int>(theMaxBins) + 1);
+    theBins.resize(aHigh - theMinIndex + 1, 0);
+    return;
+  }
+
+  const int myCurHigh = theMinIndex + static_cast<int>(theBins.size()) - 1;
+  if (aLow >= theMinIndex and aHigh <= myCurHigh) {
+    return;
+  }
+
+  const int myHigh = std::max(aHigh, myCurHigh);
+  const int myLow  = std::max(std::min(aLow, theMinIndex),
+                             myHigh - static_cast<int>(theMaxBins) + 1);
+
+  // the bins below the new range are collapsed into the lowest one
+  std::vector<uint64_t> myBins(myHigh - myLow + 1, 0);
+  for (size_t i = 0; i < theBins.size(); i++) {
+    const auto myIndex = theMinIndex + static_cast<int>(i);
+    myBins[std::max(myIndex, myLow) - myLow] += theBins[i];
+  }
+  theMinIndex = myLow;
+  theBins.swap(myBins);
+}
+
+} // namespace edge
+} // namespace uiiit
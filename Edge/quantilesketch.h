@@ -0,0 +1,131 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+struct InvalidQuantile : public std::runtime_error {
+  explicit InvalidQuantile(const double aQuantile)
+      : std::runtime_error("Invalid quantile: " + std::to_string(aQuantile)) {
+  }
+};
+
+struct EmptySketch : public std::runtime_error {
+  explicit EmptySketch()
+      : std::runtime_error("No values in the quantile sketch") {
+  }
+};
+
+/**
+ * Streaming quantile estimator with relative accuracy guarantees (DDSketch).
+ *
+ * Positive values are counted in logarithmically-spaced bins, such that any
+ * quantile is returned with a relative error not greater than the accuracy
+ * specified in the ctor. Non-positive values are counted in a separate bin,
+ * whose representative value is 0.
+ *
+ * The number of bins is bounded: when the range of the values added would
+ * exceed it, the lowest bins are collapsed together, which only affects the
+ * accuracy of the lowest quantiles. Sketches with the same parameters can be
+ * merged without loss of accuracy.
+ */
+class QuantileSketch final
+{
+ public:
+  /**
+   * \param aAccuracy The relative accuracy, in (0, 1).
+   * \param aMaxBins The maximum number of bins, at least 1.
+   *
+   * \throw std::runtime_error if the parameters are invalid.
+   */
+  explicit QuantileSketch(const double aAccuracy, const size_t aMaxBins);
+
+  //! Add a value.
+  void add(const double aValue);
+
+  /**
+   * Add all the values of another sketch to this one.
+   *
+   * \throw std::runtime_error if the sketches have different parameters.
+   */
+  void merge(const QuantileSketch& aOther);
+
+  /**
+   * \return the estimate of the given quantile.
+   *
+   * \throw InvalidQuantile if the quantile is not in [0, 1].
+   * \throw EmptySketch if no values have been added.
+   */
+  double quantile(const double aQuantile) const;
+
+  //! Remove all the values.
+  void clear();
+
+  //! \return the number of values added.
+  uint64_t count() const noexcept {
+    return theCount;
+  }
+
+  //! \return the number of bins currently allocated.
+  size_t bins() const noexcept {
+    return theBins.size();
+  }
+
+ private:
+  //! \return the index of the bin of a positive value.
+  int index(const double aValue) const;
+
+  //! \return the representative value of a bin.
+  double value(const int aIndex) const;
+
+  //! Extend the bins to cover [aLow, aHigh], collapsing the lowest ones.
+  void grow(const int aLow, const int aHigh);
+
+ private:
+  double                theAccuracy;
+  double                theGamma;
+  double                theLogGamma;
+  size_t                theMaxBins;
+  int                   theMinIndex; // index of theBins[0]
+  std::vector<uint64_t> theBins;
+  uint64_t              theZeroCount;
+  uint64_t              theCount;
+};
+
+} // namespace edge
+} // namespace uiiit
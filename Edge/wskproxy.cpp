@@ -93,7 +93,7 @@ void WskProxy::handleInvocation(web::http::http_request aReq) {
                    std::string("{\"error\":\"") + res.first.theRetCode + "\"}");
       } else {
         aReq.reply(web::http::status_codes::OK,
-                   std::string("{\"payload\":\"") + res.first.theOutput +
+                   std::string("{\"payload\":\"") + res.first.theOutput.str() +
                        "\"}");
       }
     }
@@ -77,7 +77,7 @@ detect(uiiit::edge::EdgeClientInterface& aClient,
           << (1e3 * myChrono.time() + 0.5) << " ms";
 
   // read the rectangles delimiting faces in the image
-  auto myJsonFaces = json::parse(myRespFaces.theOutput);
+  auto myJsonFaces = json::parse(myRespFaces.theOutput.str());
 
   for (const auto& myRect : myJsonFaces["objects"]) {
     aFaces.push_back(Rect(static_cast<int>(myRect["x"]),
@@ -104,7 +104,7 @@ detect(uiiit::edge::EdgeClientInterface& aClient,
               << (1e3 * myChrono.time() + 0.5) << " ms";
 
       // read the rectangles delimiting eyes in the faces
-      auto myJsonEyes = json::parse(myRespEyes.theOutput);
+      auto myJsonEyes = json::parse(myRespEyes.theOutput.str());
 
       // detect normal faces (ie. with two eyes)
       if (not aNormal or myJsonEyes["objects"].size() == 2) {
@@ -85,7 +85,7 @@ int main(int argc, char* argv[]) {
      "num-cpu-workers=4,"
      "num-gpu-containers=1,"
      "num-gpu-workers=2"),
-   "Computer configuration. Use type=file,path=<myfile.json> to read configuration from file")
+   "Computer configuration. Use type=file,path=<myfile.json> to read configuration from file. Add max-pending=N to reject the tasks in excess of N pending per container.")
   ("json-example", "Dump an JSON configuration file and exit.")
   ;
   // clang-format on
@@ -119,6 +119,10 @@ int main(int argc, char* argv[]) {
     ec::EdgeComputer myServer(myAsynchronous ? myCli.numThreads() : 0,
                               myCli.serverEndpoint(),
                               myUtilCallback);
+    if (myUtilServer) {
+      myServer.computer().loadCallback(
+          [&myUtilServer](const auto& aLoads) { myUtilServer->add(aLoads); });
+    }
     if (not myCompanionEndpoint.empty()) {
       myServer.companion(myCompanionEndpoint);
     }
@@ -102,6 +102,15 @@ int main(int argc, char* argv[]) {
 
     ec::ForwardingTableServer myForwardingTableServer(
         myCli.forwardingEndpoint(), *myTables[0]);
+    myForwardingTableServer.destinationsCallback(
+        [&myEdgeDispatcher](const auto& aAdded, const auto& aRemoved) {
+          myEdgeDispatcher.destinationsChanged(aAdded, aRemoved);
+        });
+    myForwardingTableServer.entryCallback(
+        [&myEdgeDispatcher](const auto& aLambda, const auto& aDestination) {
+          myEdgeDispatcher.entryChanged(aLambda, aDestination);
+        });
+    myForwardingTableServer.tablesMutex(myEdgeDispatcher.tablesMutex());
 
     myForwardingTableServer.run(false); // non-blocking
     myServerImpl->run();
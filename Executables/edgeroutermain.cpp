@@ -107,6 +107,15 @@ int main(int argc, char* argv[]) {
 
     ec::ForwardingTableServer myForwardingTableServer(
         myCli.forwardingEndpoint(), *myTables[0], *myTables[1]);
+    myForwardingTableServer.destinationsCallback(
+        [&myEdgeRouter](const auto& aAdded, const auto& aRemoved) {
+          myEdgeRouter.destinationsChanged(aAdded, aRemoved);
+        });
+    myForwardingTableServer.entryCallback(
+        [&myEdgeRouter](const auto& aLambda, const auto& aDestination) {
+          myEdgeRouter.entryChanged(aLambda, aDestination);
+        });
+    myForwardingTableServer.tablesMutex(myEdgeRouter.tablesMutex());
 
     myForwardingTableServer.run(false); // non-blocking
     myServerImpl->run();
@@ -173,8 +173,8 @@ Client::functionChain(const std::string& aInput) {
   assert(theCallback.empty());
   assert(theChain.get() != nullptr);
 
-  std::string                           myInput = aInput;
-  std::string                           myDataIn;
+  edge::Payload                         myInput = aInput;
+  edge::Payload                         myDataIn;
   std::unique_ptr<edge::LambdaResponse> myResp(nullptr);
   unsigned int                          myHops  = 0;
   unsigned int                          myPtime = 0;
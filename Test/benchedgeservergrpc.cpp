@@ -0,0 +1,224 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Edge/edgeclientgrpc.h"
+#include "Edge/edgeserver.h"
+#include "Edge/edgeservergrpc.h"
+#include "Support/chrono.h"
+
+#include "gtest/gtest.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+// number of memory allocations in the process, counted by replacing the
+// global allocation functions, which is why the benchmarks are not part of
+// the unit tests
+std::atomic<size_t> theNumAllocations(0);
+} // namespace
+
+void* operator new(std::size_t aSize) {
+  theNumAllocations++;
+  if (auto myPtr = std::malloc(aSize == 0 ? 1 : aSize)) {
+    return myPtr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* aPtr) noexcept {
+  std::free(aPtr);
+}
+
+void operator delete(void* aPtr, std::size_t) noexcept {
+  std::free(aPtr);
+}
+
+namespace uiiit {
+namespace edge {
+
+struct BenchEdgeServerGrpc : public ::testing::Test {
+  //! Edge server echoing the input of every lambda request.
+  class EchoServer final : public EdgeServer
+  {
+   public:
+    explicit EchoServer(const std::string& aEndpoint)
+        : EdgeServer(aEndpoint) {
+    }
+
+    rpc::LambdaResponse process(const rpc::LambdaRequest& aReq) override {
+      rpc::LambdaResponse myResp;
+      myResp.set_retcode("OK");
+      myResp.set_output(aReq.input());
+      return myResp;
+    }
+  };
+
+  struct Result {
+    double theThroughput;  // requests per second
+    double theP99;         // latency, in s
+    double theAllocations; // memory allocations per request
+  };
+
+  BenchEdgeServerGrpc()
+      : theEndpoint("127.0.0.1:6500") {
+  }
+
+  /**
+   * Run a closed-loop experiment with a given number of clients, each
+   * issuing the same number of requests back to back.
+   */
+  Result run(EdgeServerGrpc& aServer,
+             const size_t    aNumClients,
+             const size_t    aNumRequests,
+             const bool      aStreaming = false) const {
+    aServer.run();
+
+    std::vector<std::vector<double>> myLatencies(aNumClients);
+    for (auto& myClientLatencies : myLatencies) {
+      myClientLatencies.reserve(aNumRequests);
+    }
+    std::list<std::thread> myClients;
+    support::Chrono        myChrono(true);
+    const size_t           myNumAllocations = theNumAllocations;
+    for (size_t i = 0; i < aNumClients; i++) {
+      myClients.emplace_back([this,
+                              i,
+                              aNumRequests,
+                              aStreaming,
+                              &myLatencies]() {
+        EdgeClientGrpc  myClient(theEndpoint, aStreaming);
+        LambdaRequest   myReq("lambda", std::string(100, 'A'));
+        support::Chrono myChrono(false);
+        for (size_t j = 0; j < aNumRequests; j++) {
+          myChrono.start();
+          const auto myResp = myClient.RunLambda(myReq, false);
+          myLatencies[i].push_back(myChrono.stop());
+          assert(myResp.theRetCode == "OK");
+        }
+      });
+    }
+    for (auto& myClient : myClients) {
+      myClient.join();
+    }
+    const auto myElapsed = myChrono.stop();
+    const auto myAllocations =
+        static_cast<double>(theNumAllocations - myNumAllocations);
+
+    std::vector<double> myAll;
+    for (const auto& myClientLatencies : myLatencies) {
+      myAll.insert(
+          myAll.end(), myClientLatencies.begin(), myClientLatencies.end());
+    }
+    std::sort(myAll.begin(), myAll.end());
+    return Result{myAll.size() / myElapsed,
+                  myAll[static_cast<size_t>(0.99 * (myAll.size() - 1))],
+                  myAllocations / myAll.size()};
+  }
+
+  const std::string theEndpoint;
+};
+
+TEST_F(BenchEdgeServerGrpc, bench_completion_queues) {
+  const size_t myNumRequests = 2000;
+  const size_t myNumThreads =
+      std::max(1u, std::thread::hardware_concurrency());
+
+  for (const size_t myNumClients : {1, 4, 16, 64}) {
+    for (const auto mySharded : {false, true}) {
+      for (const auto myAffinity : {false, true}) {
+        if (not mySharded and myAffinity) {
+          continue;
+        }
+        EchoServer     myServer(theEndpoint);
+        EdgeServerGrpc myImpl(
+            myServer, theEndpoint, myNumThreads, 0, mySharded, myAffinity);
+        const auto myResult =
+            run(myImpl, myNumClients, myNumRequests / myNumClients + 1);
+        LOG(INFO) << "threads " << myNumThreads << ", clients " << myNumClients
+                  << (mySharded ? ", sharded" : ", single queue")
+                  << (myAffinity ? ", pinned" : "") << ": "
+                  << myResult.theThroughput << " req/s, p99 "
+                  << (myResult.theP99 * 1e3) << " ms";
+      }
+    }
+  }
+}
+
+TEST_F(BenchEdgeServerGrpc, bench_pooled_calls) {
+  const size_t myNumRequests = 10000;
+  const size_t myNumThreads  = 4;
+
+  for (const size_t myNumClients : {1, 16}) {
+    for (const auto myPooled : {false, true}) {
+      EchoServer     myServer(theEndpoint);
+      EdgeServerGrpc myImpl(
+          myServer, theEndpoint, myNumThreads, 0, false, false, myPooled);
+      const auto myResult =
+          run(myImpl, myNumClients, myNumRequests / myNumClients);
+      LOG(INFO) << "clients " << myNumClients
+                << (myPooled ? ", pooled" : ", not pooled") << ": "
+                << myResult.theAllocations << " allocations/req (client+server)"
+                << ", " << myResult.theThroughput << " req/s, p99 "
+                << (myResult.theP99 * 1e3) << " ms";
+    }
+  }
+}
+
+TEST_F(BenchEdgeServerGrpc, bench_streaming) {
+  const size_t myNumRequests = 10000;
+  const size_t myNumThreads  = 4;
+
+  for (const size_t myNumClients : {1, 16}) {
+    for (const auto myStreaming : {false, true}) {
+      EchoServer     myServer(theEndpoint);
+      EdgeServerGrpc myImpl(myServer, theEndpoint, myNumThreads);
+      const auto     myResult =
+          run(myImpl, myNumClients, myNumRequests / myNumClients, myStreaming);
+      LOG(INFO) << "clients " << myNumClients
+                << (myStreaming ? ", streaming" : ", unary") << ": "
+                << myResult.theThroughput << " req/s, p99 "
+                << (myResult.theP99 * 1e3) << " ms, "
+                << myResult.theAllocations
+                << " allocations/req (client+server)";
+    }
+  }
+}
+
+} // namespace edge
+} // namespace uiiit
@@ -0,0 +1,190 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Edge/circuitbreaker.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <thread>
+
+namespace uiiit {
+namespace edge {
+
+struct TestCircuitBreaker : public ::testing::Test {
+  TestCircuitBreaker()
+      : theDest("host:6473") {
+  }
+
+  static void sleep(const double aTime) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(aTime));
+  }
+
+  const std::string theDest;
+};
+
+TEST_F(TestCircuitBreaker, test_ctor) {
+  ASSERT_NO_THROW(CircuitBreaker(0, 0, 1));
+  ASSERT_NO_THROW(CircuitBreaker(5, 1, 0.1));
+  ASSERT_THROW(CircuitBreaker(5, -0.1, 1), std::runtime_error);
+  ASSERT_THROW(CircuitBreaker(5, 1.1, 1), std::runtime_error);
+  ASSERT_THROW(CircuitBreaker(5, 0.5, 0), std::runtime_error);
+}
+
+TEST_F(TestCircuitBreaker, test_disabled) {
+  CircuitBreaker myBreaker(0, 0.5, 1);
+  ASSERT_FALSE(myBreaker.enabled());
+  for (auto i = 0; i < 100; i++) {
+    ASSERT_TRUE(myBreaker.allow(theDest));
+    ASSERT_FALSE(myBreaker.failure(theDest));
+  }
+  ASSERT_EQ(CircuitBreaker::State::Closed, myBreaker.state(theDest));
+}
+
+TEST_F(TestCircuitBreaker, test_consecutive_failures) {
+  CircuitBreaker myBreaker(3, 0, 0.1);
+  ASSERT_TRUE(myBreaker.enabled());
+
+  // successes reset the number of consecutive failures
+  for (auto i = 0; i < 10; i++) {
+    ASSERT_TRUE(myBreaker.allow(theDest));
+    ASSERT_FALSE(myBreaker.failure(theDest));
+    ASSERT_TRUE(myBreaker.allow(theDest));
+    myBreaker.success(theDest);
+  }
+  ASSERT_EQ(CircuitBreaker::State::Closed, myBreaker.state(theDest));
+
+  ASSERT_FALSE(myBreaker.failure(theDest));
+  ASSERT_FALSE(myBreaker.failure(theDest));
+  ASSERT_TRUE(myBreaker.failure(theDest));
+  ASSERT_EQ(CircuitBreaker::State::Open, myBreaker.state(theDest));
+  ASSERT_FALSE(myBreaker.allow(theDest));
+
+  // late responses do not change the state
+  myBreaker.success(theDest);
+  ASSERT_FALSE(myBreaker.failure(theDest));
+  ASSERT_EQ(CircuitBreaker::State::Open, myBreaker.state(theDest));
+
+  // other destinations are not affected
+  ASSERT_TRUE(myBreaker.allow("other:6473"));
+}
+
+TEST_F(TestCircuitBreaker, test_error_rate) {
+  CircuitBreaker myBreaker(100, 0.5, 1);
+
+  // below the minimum number of requests the error rate is not considered
+  for (size_t i = 0; i < CircuitBreaker::minRequests() / 2 - 1; i++) {
+    ASSERT_FALSE(myBreaker.failure(theDest));
+    myBreaker.success(theDest);
+  }
+  myBreaker.success(theDest);
+  ASSERT_EQ(CircuitBreaker::State::Closed, myBreaker.state(theDest));
+
+  // the error rate reaches 50% with the minimum number of requests
+  ASSERT_TRUE(myBreaker.failure(theDest));
+  ASSERT_EQ(CircuitBreaker::State::Open, myBreaker.state(theDest));
+}
+
+TEST_F(TestCircuitBreaker, test_half_open) {
+  CircuitBreaker myBreaker(1, 0, 0.1);
+  ASSERT_TRUE(myBreaker.failure(theDest));
+  ASSERT_FALSE(myBreaker.allow(theDest));
+
+  // only one probe is allowed once the ejection time has elapsed
+  sleep(0.15);
+  ASSERT_TRUE(myBreaker.allow(theDest));
+  ASSERT_EQ(CircuitBreaker::State::HalfOpen, myBreaker.state(theDest));
+  ASSERT_FALSE(myBreaker.allow(theDest));
+
+  // a probe released does not change the state but allows another one
+  myBreaker.release(theDest);
+  ASSERT_EQ(CircuitBreaker::State::HalfOpen, myBreaker.state(theDest));
+  ASSERT_TRUE(myBreaker.allow(theDest));
+
+  // a successful probe restores the destination
+  myBreaker.success(theDest);
+  ASSERT_EQ(CircuitBreaker::State::Closed, myBreaker.state(theDest));
+  ASSERT_TRUE(myBreaker.allow(theDest));
+  ASSERT_TRUE(myBreaker.allow(theDest));
+}
+
+TEST_F(TestCircuitBreaker, test_backoff) {
+  CircuitBreaker myBreaker(1, 0, 0.1);
+  ASSERT_TRUE(myBreaker.failure(theDest));
+
+  // a failed probe doubles the ejection time
+  sleep(0.15);
+  ASSERT_TRUE(myBreaker.allow(theDest));
+  ASSERT_TRUE(myBreaker.failure(theDest));
+  sleep(0.15);
+  ASSERT_FALSE(myBreaker.allow(theDest));
+  sleep(0.1);
+  ASSERT_TRUE(myBreaker.allow(theDest));
+  myBreaker.success(theDest);
+
+  // the ejection time is not reset before a full window has elapsed
+  ASSERT_TRUE(myBreaker.failure(theDest));
+  sleep(0.25);
+  ASSERT_FALSE(myBreaker.allow(theDest));
+  sleep(0.2);
+  ASSERT_TRUE(myBreaker.allow(theDest));
+}
+
+TEST_F(TestCircuitBreaker, test_exhausted) {
+  CircuitBreaker myBreaker(1, 0, 0.001);
+  ASSERT_EQ(0, myBreaker.ejection(theDest));
+  ASSERT_FALSE(myBreaker.exhausted(theDest));
+
+  // the probes keep failing until the ejection time stops doubling
+  ASSERT_TRUE(myBreaker.failure(theDest));
+  for (size_t i = 0; i < CircuitBreaker::maxDoublings(); i++) {
+    ASSERT_FALSE(myBreaker.exhausted(theDest));
+    ASSERT_LT(0, myBreaker.ejection(theDest));
+    sleep(myBreaker.ejection(theDest) + 0.001);
+    ASSERT_EQ(0, myBreaker.ejection(theDest));
+    ASSERT_TRUE(myBreaker.allow(theDest));
+    ASSERT_TRUE(myBreaker.failure(theDest));
+  }
+  ASSERT_TRUE(myBreaker.exhausted(theDest));
+  ASSERT_NEAR(0.001 * (1u << CircuitBreaker::maxDoublings()),
+              myBreaker.ejection(theDest),
+              0.01);
+
+  // a successful probe restores the destination
+  sleep(myBreaker.ejection(theDest) + 0.001);
+  ASSERT_TRUE(myBreaker.allow(theDest));
+  myBreaker.success(theDest);
+  ASSERT_FALSE(myBreaker.exhausted(theDest));
+  ASSERT_EQ(0, myBreaker.ejection(theDest));
+}
+
+} // namespace edge
+} // namespace uiiit
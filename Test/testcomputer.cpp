@@ -33,6 +33,7 @@ SOFTWARE.
 #include "Edge/container.h"
 #include "Edge/edgemessages.h"
 #include "Edge/lambda.h"
+#include "Edge/overload.h"
 #include "Edge/processor.h"
 #include "Support/testutils.h"
 #include "Support/tostring.h"
@@ -41,6 +42,8 @@ SOFTWARE.
 
 #include <glog/logging.h>
 
+#include <mutex>
+
 namespace uiiit {
 namespace edge {
 
@@ -162,12 +165,12 @@ TEST_F(TestComputer, test_add_processors_containers) {
       "processor name cpu1, type GenericCpu, 1 cores, speed 100 operations/s per core, memory total/available/used 1000/1000/0 bytes, 0 running tasks\n"
       "processor name cpu2, type GenericCpu, 1 cores, speed 100 operations/s per core, memory total/available/used 1000/1000/0 bytes, 0 running tasks\n"
       "processor name cpu3, type GenericCpu, 1 cores, speed 100 operations/s per core, memory total/available/used 1000/1000/0 bytes, 0 running tasks\n"
-      "container name a_container1, lambda name a_lambda1, num-workers 1, active 0, pending 0\n"
-      "container name a_container2, lambda name a_lambda2, num-workers 2, active 0, pending 0\n"
-      "container name a_container3, lambda name a_lambda3, num-workers 3, active 0, pending 0\n"
-      "container name b_container1, lambda name b_lambda1, num-workers 1, active 0, pending 0\n"
-      "container name b_container2, lambda name b_lambda2, num-workers 2, active 0, pending 0\n"
-      "container name b_container3, lambda name b_lambda3, num-workers 3, active 0, pending 0\n",
+      "container name a_container1, lambda name a_lambda1, num-workers 1, max-pending 0, active 0, pending 0\n"
+      "container name a_container2, lambda name a_lambda2, num-workers 2, max-pending 0, active 0, pending 0\n"
+      "container name a_container3, lambda name a_lambda3, num-workers 3, max-pending 0, active 0, pending 0\n"
+      "container name b_container1, lambda name b_lambda1, num-workers 1, max-pending 0, active 0, pending 0\n"
+      "container name b_container2, lambda name b_lambda2, num-workers 2, max-pending 0, active 0, pending 0\n"
+      "container name b_container3, lambda name b_lambda3, num-workers 3, max-pending 0, active 0, pending 0\n",
       toString(myComputer));
   // clang-format on
 }
@@ -182,6 +185,35 @@ TEST_F(TestComputer, test_single_container_100workers) {
   single_container(100);
 }
 
+TEST_F(TestComputer, test_overloaded) {
+  std::list<std::pair<uint64_t, RespPtr>> myList;
+  Collector                               myCollector(myList);
+  Computer myComputer(theName, myCollector, Computer::UtilCallback());
+
+  myComputer.addProcessor("cpu", ProcessorType::GenericCpu, 100, 1, 1000);
+  myComputer.addContainer(
+      "container", "cpu", Lambda("lambda", FixedRequirements(10, 1)), 1, 1);
+
+  // one task is active, one is pending, the others are rejected
+  LambdaRequest myReq("lambda", "input");
+  ASSERT_EQ(0u, myComputer.addTask(myReq));
+  ASSERT_EQ(1u, myComputer.addTask(myReq));
+  ASSERT_THROW(myComputer.addTask(myReq), Overloaded);
+  ASSERT_THROW(myComputer.addTask(myReq), Overloaded);
+  ASSERT_EQ(2u, myComputer.numOverloaded());
+
+  // the tasks admitted are executed normally
+  WAIT_FOR([&]() { return myList.size() == 2; }, 1.0);
+  for (const auto& elem : myList) {
+    ASSERT_EQ("OK", elem.second->theRetCode);
+  }
+
+  // once the container is empty new tasks are admitted again
+  ASSERT_NO_THROW(myComputer.addTask(myReq));
+  WAIT_FOR([&]() { return myList.size() == 3; }, 1.0);
+  ASSERT_EQ(2u, myComputer.numOverloaded());
+}
+
 TEST_F(TestComputer, test_multiple_containers) {
   std::list<std::pair<uint64_t, RespPtr>> myList;
   Collector                               myCollector(myList);
@@ -224,5 +256,49 @@ TEST_F(TestComputer, test_multiple_containers) {
   ASSERT_EQ(4, myList.back().first);
 }
 
+TEST_F(TestComputer, test_load_callback) {
+  std::list<std::pair<uint64_t, RespPtr>> myList;
+  Collector                               myCollector(myList);
+  Computer myComputer(theName, myCollector, Computer::UtilCallback());
+
+  std::mutex                                                myMutex;
+  std::list<std::map<std::string, Computer::ContainerLoad>> myLoads;
+  myComputer.loadCallback(
+      [&](const std::map<std::string, Computer::ContainerLoad>& aLoads) {
+        const std::lock_guard<std::mutex> myLock(myMutex);
+        myLoads.emplace_back(aLoads);
+      });
+
+  // each task lasts 3 s
+  myComputer.addProcessor("cpu", ProcessorType::GenericCpu, 100, 1, 1000);
+  myComputer.addContainer(
+      "container", "cpu", Lambda("lambda", FixedRequirements(300, 1)), 1);
+
+  LambdaRequest myReq("lambda", "input");
+  for (auto i = 0; i < 3; i++) {
+    myComputer.addTask(myReq);
+  }
+
+  WAIT_FOR(
+      [&]() {
+        const std::lock_guard<std::mutex> myLock(myMutex);
+        return not myLoads.empty();
+      },
+      2.0);
+
+  // cannot set the callback after the computer has started
+  ASSERT_THROW(myComputer.loadCallback(Computer::LoadCallback()), InitDone);
+
+  const std::lock_guard<std::mutex> myLock(myMutex);
+  ASSERT_FALSE(myLoads.empty());
+  const auto& myLoad = myLoads.front();
+  ASSERT_EQ(1u, myLoad.size());
+  ASSERT_EQ(1u, myLoad.count("lambda"));
+  EXPECT_EQ(1u, myLoad.at("lambda").theActive);
+  EXPECT_EQ(2u, myLoad.at("lambda").thePending);
+  EXPECT_LT(6.0, myLoad.at("lambda").theWait);
+  EXPECT_GT(9.0, myLoad.at("lambda").theWait);
+}
+
 } // namespace edge
 } // namespace uiiit
@@ -32,10 +32,14 @@ SOFTWARE.
 #include "Edge/container.h"
 #include "Edge/edgemessages.h"
 #include "Edge/lambda.h"
+#include "Edge/overload.h"
 #include "Edge/processor.h"
 
 #include "gtest/gtest.h"
 
+#include <chrono>
+#include <thread>
+
 namespace uiiit {
 namespace edge {
 
@@ -86,6 +90,68 @@ TEST_F(TestContainer, test_scheduling_worker_bound) {
   }
 }
 
+TEST_F(TestContainer, test_deadline) {
+  LambdaRequest myReq(theName, "pippo");
+  LambdaRequest myExpiringReq(theName, "pippo");
+  myExpiringReq.theDeadline = deadlineAfter(0.001);
+  LambdaRequest myLongReq(theName, "pippo");
+  myLongReq.theDeadline = deadlineAfter(3600);
+
+  Container myContainer("container1", theProcessor, theLambda, 1);
+
+  // only the first task is active, the others are pending
+  myContainer.push(myReq, 0);
+  myContainer.push(myExpiringReq, 1);
+  myContainer.push(myLongReq, 2);
+  ASSERT_EQ(1u, myContainer.active());
+  ASSERT_EQ(2u, myContainer.pending());
+  ASSERT_EQ(0u, myContainer.expired());
+
+  // the second task expires while pending and it is skipped
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(0u, myContainer.pop().theId);
+  ASSERT_EQ(1u, myContainer.active());
+  ASSERT_EQ(0u, myContainer.pending());
+  ASSERT_EQ(1u, myContainer.expired());
+  ASSERT_EQ(2u, myContainer.pop().theId);
+
+  const auto myExpired = myContainer.takeExpired();
+  ASSERT_EQ(1u, myExpired.size());
+  ASSERT_EQ(1u, myExpired.front().theId);
+  ASSERT_EQ(myExpiringReq.theDeadline, myExpired.front().theDeadline);
+  ASSERT_EQ(0u, myContainer.expired());
+}
+
+TEST_F(TestContainer, test_max_pending) {
+  LambdaRequest myReq(theName, "pippo");
+
+  Container myContainer("container1", theProcessor, theLambda, 2, 3);
+  ASSERT_EQ(3u, myContainer.maxPending());
+
+  // 2 active and 3 pending tasks are admitted, then new tasks are rejected
+  for (size_t i = 0; i < 5; i++) {
+    ASSERT_NO_THROW(myContainer.push(myReq, i));
+  }
+  ASSERT_EQ(2u, myContainer.active());
+  ASSERT_EQ(3u, myContainer.pending());
+  ASSERT_THROW(myContainer.push(myReq, 5), Overloaded);
+  ASSERT_EQ(2u, myContainer.active());
+  ASSERT_EQ(3u, myContainer.pending());
+
+  // as soon as a pending task becomes active a new task is admitted
+  ASSERT_EQ(0u, myContainer.pop().theId);
+  ASSERT_EQ(2u, myContainer.pending());
+  ASSERT_NO_THROW(myContainer.push(myReq, 6));
+  ASSERT_THROW(myContainer.push(myReq, 7), Overloaded);
+
+  // without a limit any number of tasks can be pending
+  Container myUnboundedContainer("container2", theProcessor, theLambda, 1);
+  for (size_t i = 0; i < 100; i++) {
+    ASSERT_NO_THROW(myUnboundedContainer.push(myReq, i));
+  }
+  ASSERT_EQ(99u, myUnboundedContainer.pending());
+}
+
 TEST_F(TestContainer, test_simulation) {
   LambdaRequest myReq(theName, "pippo");
 
@@ -29,10 +29,17 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "Edge/edgeclientasync.h"
 #include "Edge/edgeclientgrpc.h"
+#include "Edge/edgeclientpool.h"
+#include "Support/chrono.h"
+#include "Support/conf.h"
+#include "Support/wait.h"
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+
 namespace uiiit {
 namespace edge {
 
@@ -45,6 +52,7 @@ struct TestEdgeClient : public ::testing::Test {
 
 TEST_F(TestEdgeClient, test_ctor) {
   ASSERT_NO_THROW(EdgeClientGrpc{theEndpoint});
+  ASSERT_NO_THROW((EdgeClientGrpc{theEndpoint, false, true}));
 }
 
 TEST_F(TestEdgeClient, test_no_server) {
@@ -54,5 +62,119 @@ TEST_F(TestEdgeClient, test_no_server) {
   ASSERT_THROW(myClient.RunLambda(myReq, false), std::runtime_error);
 }
 
+TEST_F(TestEdgeClient, test_pool_shared_channels_no_server) {
+  ASSERT_THROW(
+      EdgeClientPool(support::Conf("type=grpc,streaming=true,channels=2"), 0),
+      std::runtime_error);
+  ASSERT_NO_THROW(
+      EdgeClientPool(support::Conf("type=grpc,streaming=false,channels=2"), 0));
+
+  EdgeClientPool myPool(support::Conf("type=grpc,channels=2"), 0);
+  LambdaRequest  myReq("lambda1", "");
+  for (auto i = 0; i < 3; i++) {
+    ASSERT_THROW(myPool(theEndpoint, myReq, true), std::runtime_error);
+  }
+}
+
+TEST_F(TestEdgeClient, test_pool_warm_close_no_server) {
+  for (const auto& myConf : {"type=grpc", "type=grpc,channels=2"}) {
+    EdgeClientPool myPool(support::Conf(myConf), 2);
+    LambdaRequest  myReq("lambda1", "");
+
+    // warming and closing do not throw even if the server is unreachable
+    ASSERT_NO_THROW(myPool.warm(theEndpoint));
+    ASSERT_THROW(myPool(theEndpoint, myReq, true), std::runtime_error);
+    ASSERT_NO_THROW(myPool.close(theEndpoint));
+    ASSERT_NO_THROW(myPool.close("localhost:667"));
+    ASSERT_THROW(myPool(theEndpoint, myReq, true), std::runtime_error);
+  }
+}
+
+TEST_F(TestEdgeClient, test_async_no_server) {
+  ASSERT_THROW(EdgeClientAsync(0), std::runtime_error);
+
+  EdgeClientAsync     myClient(2);
+  LambdaRequest       myReq("lambda1", "");
+  std::atomic<size_t> myErrors(0);
+  for (const auto myDry : {true, false}) {
+    myClient.RunLambda(theEndpoint,
+                       myReq,
+                       myDry,
+                       [&myErrors](LambdaResponse&& aResp, const double) {
+                         if (aResp.theRetCode != "OK") {
+                           myErrors++;
+                         }
+                       });
+  }
+  ASSERT_TRUE(support::waitFor<size_t>(
+      [&myErrors]() { return myErrors.load(); }, 2, 10));
+}
+
+TEST_F(TestEdgeClient, test_async_warm_close_no_server) {
+  for (const auto myStreaming : {false, true}) {
+    EdgeClientAsync     myClient(1, myStreaming);
+    std::atomic<size_t> myErrors(0);
+    LambdaRequest       myReq("lambda1", "");
+
+    const auto myCallback = [&myErrors](LambdaResponse&& aResp, const double) {
+      if (aResp.theRetCode != "OK") {
+        myErrors++;
+      }
+    };
+
+    // the channel is re-created after being closed
+    ASSERT_NO_THROW(myClient.warm(theEndpoint));
+    myClient.RunLambda(theEndpoint, myReq, false, myCallback);
+    ASSERT_NO_THROW(myClient.close(theEndpoint));
+    ASSERT_NO_THROW(myClient.close("localhost:667"));
+    myClient.RunLambda(theEndpoint, myReq, false, myCallback);
+    ASSERT_TRUE(support::waitFor<size_t>(
+        [&myErrors]() { return myErrors.load(); }, 2, 10));
+  }
+}
+
+TEST_F(TestEdgeClient, test_async_timer) {
+  EdgeClientAsync   myClient(1);
+  std::atomic<bool> myExpired(false);
+  support::Chrono   myChrono(true);
+  myClient.schedule(
+      0.1, [&myExpired](const bool aExpired) { myExpired = aExpired; });
+  ASSERT_FALSE(myExpired);
+  ASSERT_TRUE(support::waitFor<bool>(
+      [&myExpired]() { return myExpired.load(); }, true, 1));
+  ASSERT_GE(myChrono.stop(), 0.1);
+}
+
+TEST_F(TestEdgeClient, test_async_shutdown) {
+  EdgeClientAsync     myClient(1);
+  std::atomic<bool>   myExpired(false);
+  std::atomic<size_t> myCalled(0);
+  support::Chrono     myChrono(true);
+
+  // the timers are called anyway, but not expired
+  const auto myTimeout = [&myExpired, &myCalled](const bool aExpired) {
+    myCalled++;
+    if (aExpired) {
+      myExpired = true;
+    }
+  };
+  myClient.schedule(10, myTimeout);
+  myClient.shutdown();
+  ASSERT_LT(myChrono.stop(), 1);
+  ASSERT_FALSE(myExpired);
+  ASSERT_EQ(1u, myCalled);
+
+  // nothing can be started anymore
+  myClient.schedule(0, myTimeout);
+  ASSERT_EQ(2u, myCalled);
+  ASSERT_THROW(myClient.RunLambda(theEndpoint,
+                                  LambdaRequest("lambda1", ""),
+                                  false,
+                                  [](LambdaResponse&&, const double) {}),
+               std::runtime_error);
+  myClient.shutdown();
+  ASSERT_FALSE(myExpired);
+}
+
 } // namespace edge
 } // namespace uiiit
@@ -43,6 +43,10 @@ SOFTWARE.
 
 #include <glog/logging.h>
 
+#include <atomic>
+#include <list>
+#include <thread>
+
 namespace uiiit {
 namespace edge {
 
@@ -186,5 +190,50 @@ TEST_F(TestEdgeClientMulti, test_grpc_three_destinations) {
   ASSERT_GT(myCounter[theEndpoint2], 0u);
 }
 
+TEST_F(TestEdgeClientMulti, test_grpc_concurrent_callers) {
+  auto myComputer1 = makeComputer(theEndpoint1, 1e9);
+  auto myComputer2 = makeComputer(theEndpoint2, 1e8);
+
+  std::unique_ptr<EdgeServerImpl> myComputerEdgeServerImpl1;
+  std::unique_ptr<EdgeServerImpl> myComputerEdgeServerImpl2;
+
+  myComputerEdgeServerImpl1.reset(
+      new EdgeServerGrpc(*myComputer1, theEndpoint1, 4));
+  myComputerEdgeServerImpl2.reset(
+      new EdgeServerGrpc(*myComputer2, theEndpoint2, 4));
+
+  myComputerEdgeServerImpl1->run();
+  myComputerEdgeServerImpl2->run();
+
+  // all the requests are multicast to both destinations
+  EdgeClientMulti myClient({theEndpoint1, theEndpoint2},
+                           support::Conf("type=grpc,persistence=1"));
+
+  LambdaRequest myReq("lambda0", "hello");
+  ASSERT_TRUE(support::waitFor<std::string>(
+      [&]() { return myClient.RunLambda(myReq, false).theRetCode; },
+      "OK",
+      1.0));
+
+  // the callers do not wait for the losing replicas of other requests
+  std::atomic<size_t>    myNumOk(0);
+  std::list<std::thread> myThreads;
+  for (size_t i = 0; i < 4; i++) {
+    myThreads.emplace_back([&]() {
+      for (size_t j = 0; j < 25; j++) {
+        const auto ret = myClient.RunLambda(myReq, false);
+        if (ret.theRetCode == "OK") {
+          myNumOk++;
+        }
+      }
+    });
+  }
+  for (auto& myThread : myThreads) {
+    myThread.join();
+  }
+
+  ASSERT_EQ(100u, myNumOk.load());
+}
+
 } // namespace edge
 } // namespace uiiit
@@ -102,7 +102,9 @@ TEST_F(TestEdgeMessages, test_request_serialize_deserialize_dag) {
 TEST_F(TestEdgeMessages, test_request_copy) {
   LambdaRequest myRequest("name", "input", "datain");
   const auto    myCopy = myRequest.copy();
-  ASSERT_EQ(myRequest.theUuid, myCopy.theUuid);
+  ASSERT_EQ(myRequest.uuid(), myCopy.uuid());
+  ASSERT_TRUE(myRequest.theInput.shares(myCopy.theInput));
+  ASSERT_TRUE(myRequest.theDataIn.shares(myCopy.theDataIn));
   ASSERT_TRUE(myRequest == myCopy) << "\n"
                                    << myRequest.toString() << "\nvs.\n"
                                    << myCopy.toString();
@@ -112,10 +114,71 @@ TEST_F(TestEdgeMessages, test_request_one_more_hop) {
   LambdaRequest myRequest("name", "input", "datain");
   const auto    myCopy = myRequest.makeOneMoreHop();
   ASSERT_FALSE(myRequest == myCopy);
-  ASSERT_EQ(myRequest.theUuid, myCopy.theUuid);
+  ASSERT_EQ(myRequest.uuid(), myCopy.uuid());
   ASSERT_EQ(myRequest.theHops + 1, myCopy.theHops);
 }
 
+TEST_F(TestEdgeMessages, test_request_move) {
+  LambdaRequest myRequest("name", std::string(1000, 'x'), "datain");
+  const auto    myInput = myRequest.theInput;
+  const auto    myUuid  = myRequest.uuid();
+
+  const LambdaRequest myMoved(std::move(myRequest));
+  ASSERT_TRUE(myInput.shares(myMoved.theInput));
+  ASSERT_EQ(myUuid, myMoved.uuid());
+  ASSERT_EQ("name", myMoved.theName);
+  ASSERT_EQ("datain", myMoved.theDataIn);
+}
+
+TEST_F(TestEdgeMessages, test_request_lazy_uuid) {
+  // not assigned: not serialized
+  LambdaRequest myRequest("name", "input");
+  ASSERT_TRUE(myRequest.toProtobuf().uuid().empty());
+
+  // assigned: serialized and shared with copies, including earlier ones
+  const auto myCopy = myRequest.copy();
+  const auto myUuid = myRequest.uuid();
+  ASSERT_FALSE(myUuid.empty());
+  ASSERT_EQ(myUuid, myRequest.toProtobuf().uuid());
+  ASSERT_EQ(myUuid, myCopy.toProtobuf().uuid());
+  ASSERT_EQ(myUuid, LambdaRequest(myRequest.toProtobuf()).uuid());
+
+  // two distinct requests have different identifiers
+  ASSERT_NE(myUuid, LambdaRequest("name", "input").uuid());
+
+  // DAGs always need an identifier
+  LambdaRequest myDagRequest("", "input");
+  myDagRequest.theDag = std::make_unique<model::Dag>(model::exampleDag());
+  ASSERT_FALSE(myDagRequest.toProtobuf().uuid().empty());
+}
+
+TEST_F(TestEdgeMessages, test_request_regenerate) {
+  LambdaRequest myRequest("", "input", "datain");
+  myRequest.theChain = std::make_unique<model::Chain>(model::exampleChain());
+  LambdaResponse myResponse("OK", std::string(1000, 'y'));
+  myResponse.theDataOut = "dataout";
+
+  // the same request can be regenerated multiple times
+  for (size_t i = 0; i < 2; i++) {
+    const auto myNext = myRequest.regenerate("f1", 1, myResponse);
+    ASSERT_EQ("f1", myNext.theName);
+    ASSERT_TRUE(myResponse.theOutput.shares(myNext.theInput));
+    ASSERT_TRUE(myResponse.theDataOut.shares(myNext.theDataIn));
+    ASSERT_EQ(myRequest.uuid(), myNext.uuid());
+    ASSERT_EQ(myRequest.theHops + 1, myNext.theHops);
+    ASSERT_EQ(1u, myNext.theNextFunctionIndex);
+    ASSERT_NE(nullptr, myNext.theChain.get());
+    ASSERT_TRUE(*myRequest.theChain == *myNext.theChain);
+  }
+}
+
+TEST_F(TestEdgeMessages, test_response_move_from_protobuf) {
+  const LambdaResponse myResponse("OK", std::string(1000, 'z'));
+  auto                 myMsg = myResponse.toProtobuf();
+  const LambdaResponse myDeserialized(std::move(myMsg));
+  ASSERT_TRUE(myResponse == myDeserialized);
+}
+
 TEST_F(TestEdgeMessages, test_response_serialize_deserialize_sync) {
   LambdaResponse myResponse("name", "output", {0.1, 0.2, 0.3});
   myResponse.states().emplace("state0", State::fromContent("content"));
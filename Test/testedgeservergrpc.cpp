@@ -0,0 +1,425 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "Edge/edgeclientasync.h"
+#include "Edge/edgeclientgrpc.h"
+#include "Edge/edgeserver.h"
+#include "Edge/edgeservergrpc.h"
+#include "Support/chrono.h"
+#include "Support/wait.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <thread>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+struct TestEdgeServerGrpc : public ::testing::Test {
+  //! Edge server echoing the input of every lambda request.
+  class EchoServer final : public EdgeServer
+  {
+   public:
+    explicit EchoServer(const std::string& aEndpoint)
+        : EdgeServer(aEndpoint)
+        , theCounter(0)
+        , theDelay(0) {
+    }
+
+    rpc::LambdaResponse process(const rpc::LambdaRequest& aReq) override {
+      if (theDelay > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(theDelay));
+      }
+      {
+        const std::lock_guard<std::mutex> myLock(theMutex);
+        theLastRequest = aReq;
+      }
+      theCounter++;
+      rpc::LambdaResponse myResp;
+      myResp.set_retcode("OK");
+      myResp.set_output(aReq.input());
+      return myResp;
+    }
+
+    std::atomic<size_t> theCounter;
+    std::atomic<long>   theDelay; // before responding, in ms
+    rpc::LambdaRequest  theLastRequest;
+  };
+
+  TestEdgeServerGrpc()
+      : theEndpoint("127.0.0.1:6500") {
+  }
+
+  /**
+   * Run a given number of clients, each issuing the same number of requests
+   * back to back, until all of them are served.
+   */
+  void run(EdgeServerGrpc& aServer,
+           const size_t    aNumClients,
+           const size_t    aNumRequests,
+           const bool      aStreaming = false) const {
+    aServer.run();
+
+    std::list<std::thread> myClients;
+    for (size_t i = 0; i < aNumClients; i++) {
+      myClients.emplace_back([this, aNumRequests, aStreaming]() {
+        EdgeClientGrpc myClient(theEndpoint, aStreaming);
+        LambdaRequest  myReq("lambda", std::string(100, 'A'));
+        for (size_t j = 0; j < aNumRequests; j++) {
+          const auto myResp = myClient.RunLambda(myReq, false);
+          assert(myResp.theRetCode == "OK");
+        }
+      });
+    }
+    for (auto& myClient : myClients) {
+      myClient.join();
+    }
+  }
+
+  const std::string theEndpoint;
+};
+
+TEST_F(TestEdgeServerGrpc, test_ctor) {
+  EchoServer myServer(theEndpoint);
+  ASSERT_THROW(EdgeServerGrpc(myServer, theEndpoint, 0), std::runtime_error);
+  ASSERT_THROW(EdgeServerGrpc(myServer, "", 1), std::runtime_error);
+  ASSERT_NO_THROW(EdgeServerGrpc(myServer, theEndpoint, 1));
+}
+
+TEST_F(TestEdgeServerGrpc, test_forward_pass_through) {
+  EchoServer     myServer(theEndpoint);
+  EdgeServerGrpc myImpl(myServer, theEndpoint, 1);
+  myImpl.run();
+
+  rpc::LambdaRequest myReq;
+  myReq.set_name("lambda");
+  myReq.set_input("input");
+  myReq.set_datain(std::string(100000, 'A'));
+  myReq.set_dry(true);
+  myReq.set_forward(false);
+  myReq.set_hops(300);
+  myReq.set_callback("1.2.3.4:5");
+  myReq.set_uuid("uuid");
+  (*myReq.mutable_states())["s0"].set_content("content");
+
+  auto myExpected = myReq;
+  myExpected.set_dry(false);
+  myExpected.set_forward(true);
+  myExpected.set_hops(301);
+
+  // asynchronous client: serialized message patched
+  EdgeClientAsync     myAsyncClient(1);
+  std::atomic<size_t> myResponses(0);
+  myAsyncClient.ForwardLambda(
+      theEndpoint,
+      myReq,
+      false,
+      [this, &myResponses](LambdaResponse&& aResp, const double) {
+        if (aResp.theRetCode == "OK" and aResp.theResponder == theEndpoint) {
+          myResponses++;
+        }
+      });
+  ASSERT_TRUE(support::waitFor<size_t>(
+      [&myResponses]() { return myResponses.load(); }, 1, 1));
+  ASSERT_EQ(myExpected.SerializeAsString(),
+            myServer.theLastRequest.SerializeAsString());
+
+  // synchronous client: protobuf copied and patched
+  myServer.theLastRequest.Clear();
+  EdgeClientGrpc myClient(theEndpoint);
+  ASSERT_EQ("OK", myClient.ForwardLambda(myReq, false).theRetCode);
+  ASSERT_EQ(myExpected.SerializeAsString(),
+            myServer.theLastRequest.SerializeAsString());
+}
+
+TEST_F(TestEdgeServerGrpc, test_modes) {
+  const size_t myNumClients  = 4;
+  const size_t myNumRequests = 100;
+
+  for (const auto mySharded : {false, true}) {
+    for (const auto myAffinity : {false, true}) {
+      for (const auto myPooled : {false, true}) {
+        for (const size_t myNumExecutors : {0, 2}) {
+          EchoServer     myServer(theEndpoint);
+          EdgeServerGrpc myImpl(myServer,
+                                theEndpoint,
+                                2,
+                                myNumExecutors,
+                                mySharded,
+                                myAffinity,
+                                myPooled);
+          run(myImpl, myNumClients, myNumRequests);
+          ASSERT_EQ(myNumClients * myNumRequests, myServer.theCounter.load());
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestEdgeServerGrpc, test_deadline) {
+  EchoServer     myServer(theEndpoint);
+  EdgeServerGrpc myImpl(myServer, theEndpoint, 1);
+  myImpl.run();
+
+  // the deadline of the request is received as it is
+  EdgeClientGrpc myClient(theEndpoint);
+  LambdaRequest  myReq("lambda", "input");
+  myReq.theDeadline = deadlineAfter(10);
+  ASSERT_EQ("OK", myClient.RunLambda(myReq, false).theRetCode);
+  ASSERT_EQ(myReq.theDeadline, myServer.theLastRequest.deadline());
+
+  // without a deadline in the request, the one of the call is used
+  rpc::LambdaRequest myMsg;
+  myMsg.set_name("lambda");
+  rpc::LambdaResponse myResp;
+  grpc::ClientContext myContext;
+  myContext.set_deadline(std::chrono::system_clock::now() +
+                         std::chrono::seconds(10));
+  ASSERT_TRUE(rpc::EdgeServer::NewStub(grpc::CreateChannel(
+                                           theEndpoint,
+                                           grpc::InsecureChannelCredentials()))
+                  ->RunLambda(&myContext, myMsg, &myResp)
+                  .ok());
+  // the deadline is sent as a timeout, hence it is received approximately
+  ASSERT_NEAR(deadlineFromTimePoint(myContext.deadline()),
+              myServer.theLastRequest.deadline(),
+              1e5); // 100 ms
+
+  // no deadline at all
+  ASSERT_EQ("OK",
+            myClient.RunLambda(LambdaRequest("lambda", "input"), false)
+                .theRetCode);
+  ASSERT_EQ(0u, myServer.theLastRequest.deadline());
+
+  // the call fails if the deadline expires before the response
+  myReq.theDeadline = deadlineAfter(-1);
+  ASSERT_THROW(myClient.RunLambda(myReq, false), std::runtime_error);
+}
+
+TEST_F(TestEdgeServerGrpc, test_batch) {
+  const size_t myNumRequests = 100;
+
+  EchoServer     myServer(theEndpoint);
+  EdgeServerGrpc myImpl(myServer, theEndpoint, 2, 2);
+  myImpl.run();
+
+  // synchronous client
+  std::vector<LambdaRequest> myReqs;
+  for (size_t i = 0; i < myNumRequests; i++) {
+    myReqs.emplace_back("lambda", std::to_string(i));
+  }
+  EdgeClientGrpc mySyncClient(theEndpoint);
+  const auto     myResps = mySyncClient.RunLambdaBatch(myReqs, false);
+  ASSERT_EQ(myNumRequests, myResps.size());
+  for (size_t i = 0; i < myNumRequests; i++) {
+    ASSERT_EQ("OK", myResps[i].theRetCode);
+    ASSERT_EQ(std::to_string(i), myResps[i].theOutput);
+  }
+  ASSERT_EQ(myNumRequests, myServer.theCounter.load());
+  ASSERT_TRUE(mySyncClient.RunLambdaBatch({}, false).empty());
+
+  // asynchronous client: the requests are passed through
+  std::vector<rpc::LambdaRequest>        myMsgs(myNumRequests);
+  std::vector<const rpc::LambdaRequest*> myPtrs;
+  for (size_t i = 0; i < myNumRequests; i++) {
+    myMsgs[i].set_name("lambda");
+    myMsgs[i].set_input(std::to_string(i));
+    myMsgs[i].set_hops(i);
+    myPtrs.emplace_back(&myMsgs[i]);
+  }
+  EdgeClientAsync     myAsyncClient(1);
+  std::atomic<size_t> myResponses(0);
+  myAsyncClient.ForwardLambdaBatch(
+      theEndpoint,
+      myPtrs,
+      false,
+      [this, myNumRequests, &myResponses](std::vector<LambdaResponse>&& aResps,
+                                          const double) {
+        if (aResps.size() != myNumRequests) {
+          return;
+        }
+        for (size_t i = 0; i < myNumRequests; i++) {
+          if (aResps[i].theRetCode == "OK" and
+              aResps[i].theOutput == std::to_string(i) and
+              aResps[i].theResponder == theEndpoint) {
+            myResponses++;
+          }
+        }
+      });
+  ASSERT_TRUE(support::waitFor<size_t>(
+      [&myResponses]() { return myResponses.load(); }, myNumRequests, 5));
+  ASSERT_EQ(2 * myNumRequests, myServer.theCounter.load());
+
+  // all the requests have been patched
+  ASSERT_TRUE(myServer.theLastRequest.forward());
+  ASSERT_EQ(std::stoul(myServer.theLastRequest.input()) + 1,
+            myServer.theLastRequest.hops());
+
+  // failed call: all the responses report the error
+  myResponses = 0;
+  myAsyncClient.ForwardLambdaBatch(
+      "127.0.0.1:6501",
+      myPtrs,
+      false,
+      [&myResponses](std::vector<LambdaResponse>&& aResps, const double) {
+        for (const auto& myResp : aResps) {
+          if (myResp.theRetCode != "OK") {
+            myResponses++;
+          }
+        }
+      });
+  ASSERT_TRUE(support::waitFor<size_t>(
+      [&myResponses]() { return myResponses.load(); }, myNumRequests, 5));
+}
+
+TEST_F(TestEdgeServerGrpc, test_stream) {
+  const size_t myNumRequests = 1000;
+
+  EchoServer     myServer(theEndpoint);
+  EdgeServerGrpc myImpl(myServer, theEndpoint, 2, 2);
+  run(myImpl, 4, myNumRequests / 4, true);
+  ASSERT_EQ(myNumRequests, myServer.theCounter.load());
+
+  // asynchronous client: all the requests are pending at the same time on
+  // the same stream, with responses possibly out of order
+  EdgeClientAsync     myClient(2, true);
+  std::atomic<size_t> myResponses(0);
+  for (size_t i = 0; i < myNumRequests; i++) {
+    const auto myInput = std::to_string(i);
+    myClient.RunLambda(
+        theEndpoint,
+        LambdaRequest("lambda", myInput),
+        false,
+        [this, myInput, &myResponses](LambdaResponse&& aResp, const double) {
+          if (aResp.theRetCode == "OK" and aResp.theOutput == myInput and
+              aResp.theResponder == theEndpoint) {
+            myResponses++;
+          }
+        });
+  }
+  ASSERT_TRUE(support::waitFor<size_t>(
+      [&myResponses]() { return myResponses.load(); }, myNumRequests, 5));
+
+  // same with pass-through forwarding
+  rpc::LambdaRequest myReq;
+  myReq.set_name("lambda");
+  myReq.set_input("input");
+  myReq.set_hops(10);
+  myClient.ForwardLambda(
+      theEndpoint,
+      myReq,
+      false,
+      [&myResponses](LambdaResponse&& aResp, const double) {
+        if (aResp.theRetCode == "OK" and aResp.theOutput == "input") {
+          myResponses++;
+        }
+      });
+  ASSERT_TRUE(support::waitFor<size_t>(
+      [&myResponses]() { return myResponses.load(); }, myNumRequests + 1, 5));
+  ASSERT_EQ(11u, myServer.theLastRequest.hops());
+  ASSERT_TRUE(myServer.theLastRequest.forward());
+  ASSERT_GT(myServer.theLastRequest.id(), 0u);
+}
+
+TEST_F(TestEdgeServerGrpc, test_stream_deadline) {
+  EchoServer     myServer(theEndpoint);
+  EdgeServerGrpc myImpl(myServer, theEndpoint, 2);
+  myImpl.run();
+
+  // the stream is cancelled if the response does not arrive in time
+  EdgeClientGrpc  myClient(theEndpoint, true);
+  LambdaRequest   myReq("lambda", "input");
+  support::Chrono myChrono(true);
+  myServer.theDelay = 2000;
+  myReq.theDeadline = deadlineAfter(0.2);
+  ASSERT_THROW(myClient.RunLambda(myReq, false), std::runtime_error);
+  ASSERT_LT(myChrono.stop(), 1);
+
+  // the stream is opened again at the next call
+  myServer.theDelay = 0;
+  myReq.theDeadline = deadlineAfter(10);
+  ASSERT_EQ("OK", myClient.RunLambda(myReq, false).theRetCode);
+  ASSERT_EQ("OK",
+            myClient.RunLambda(LambdaRequest("lambda", "input"), false)
+                .theRetCode);
+}
+
+TEST_F(TestEdgeServerGrpc, test_stream_reconnect) {
+  EdgeClientGrpc      mySyncClient(theEndpoint, true);
+  EdgeClientAsync     myAsyncClient(1, true);
+  std::atomic<size_t> myResponses(0);
+  std::atomic<size_t> myErrors(0);
+  const auto          myCallback = [&myResponses, &myErrors](
+                              LambdaResponse&& aResp, const double) {
+    if (aResp.theRetCode == "OK") {
+      myResponses++;
+    } else {
+      myErrors++;
+    }
+  };
+
+  for (size_t i = 0; i < 2; i++) {
+    // the streams are opened again after the server is restarted
+    {
+      EchoServer     myServer(theEndpoint);
+      EdgeServerGrpc myImpl(myServer, theEndpoint, 1);
+      myImpl.run();
+      ASSERT_EQ("OK",
+                mySyncClient.RunLambda(LambdaRequest("lambda", "input"), false)
+                    .theRetCode);
+      myAsyncClient.RunLambda(theEndpoint,
+                              LambdaRequest("lambda", "input"),
+                              false,
+                              EdgeClientAsync::Callback(myCallback));
+      ASSERT_TRUE(support::waitFor<size_t>(
+          [&myResponses]() { return myResponses.load(); }, i + 1, 1));
+    }
+
+    // no server: the streams are broken
+    ASSERT_THROW(
+        mySyncClient.RunLambda(LambdaRequest("lambda", "input"), false),
+        std::runtime_error);
+    myAsyncClient.RunLambda(theEndpoint,
+                            LambdaRequest("lambda", "input"),
+                            false,
+                            EdgeClientAsync::Callback(myCallback));
+    ASSERT_TRUE(support::waitFor<size_t>(
+        [&myErrors]() { return myErrors.load(); }, i + 1, 5));
+  }
+}
+
+} // namespace edge
+} // namespace uiiit
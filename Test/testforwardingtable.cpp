@@ -29,19 +29,27 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "Edge/destinationregistry.h"
 #include "Edge/forwardingtable.h"
 #include "Edge/forwardingtableexceptions.h"
 #include "Edge/forwardingtablefactory.h"
 #include "Edge/lambda.h"
 #include "Support/chrono.h"
 #include "Support/conf.h"
+#include "Support/random.h"
 #include "Support/tostring.h"
 #include "Support/wait.h"
 
 #include "gtest/gtest.h"
-#include <cmath>
 #include <glog/logging.h>
 
+#include <atomic>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <set>
+#include <thread>
+
 namespace uiiit {
 namespace edge {
 
@@ -213,6 +221,162 @@ TEST_F(TestForwardingTable, test_invalid_operations) {
   ASSERT_THROW(myTable("lambda1"), NoDestinations);
 }
 
+TEST_F(TestForwardingTable, test_batch_change) {
+  ForwardingTable myTable(ForwardingTable::Type::LeastImpedance);
+
+  ASSERT_THROW(myTable.change("lambda1", {{"dest1", 1}}), NoDestinations);
+
+  myTable.change("lambda1", "dest1", 1, true);
+  myTable.change("lambda1", "dest2", 2, false);
+  myTable.change("lambda1", "dest3", 3, true);
+  ASSERT_EQ("dest1", myTable("lambda1"));
+
+  // missing destinations are skipped, the final flags are unchanged
+  myTable.change("lambda1", {{"dest1", 5}, {"dest2", 4}, {"dest4", 1}});
+  ASSERT_EQ((std::map<std::string, std::pair<float, bool>>({
+                {"dest1", {5, true}},
+                {"dest2", {4, false}},
+                {"dest3", {3, true}},
+            })),
+            myTable.destinations("lambda1"));
+  ASSERT_EQ("dest3", myTable("lambda1"));
+
+  // invalid changes are not applied at all
+  ASSERT_THROW(myTable.change("lambda1", {{"dest1", 1}, {"", 1}}),
+               NoDestinations);
+  ASSERT_THROW(myTable.change("lambda1", {{"dest1", 1}, {"dest2", -1}}),
+               InvalidWeight);
+  ASSERT_THROW(myTable.change("lambda1", {{"dest1", 1}, {"dest2", 0}}),
+               InvalidWeight);
+  ASSERT_EQ(5, myTable.destinations("lambda1")["dest1"].first);
+  ASSERT_EQ("dest3", myTable("lambda1"));
+}
+
+TEST_F(TestForwardingTable, test_apply_changes) {
+  ForwardingTable myTable(ForwardingTable::Type::LeastImpedance);
+
+  ASSERT_THROW(myTable.applyChanges("lambda1", {{"dest1", 1}}),
+               NoDestinations);
+
+  myTable.change("lambda1", "dest1", 1, true);
+  myTable.change("lambda1", "dest2", 2, false);
+
+  // the changes of the same destination are applied in order
+  myTable.applyChanges("lambda1",
+                       {{"dest2", 0.5}, {"dest1", 3}, {"dest2", 4}, {"x", 1}});
+  ASSERT_EQ((std::map<std::string, std::pair<float, bool>>({
+                {"dest1", {3, true}},
+                {"dest2", {4, false}},
+            })),
+            myTable.destinations("lambda1"));
+  ASSERT_EQ("dest1", myTable("lambda1"));
+
+  // invalid changes are not applied at all
+  ASSERT_THROW(myTable.applyChanges("lambda1", {{"dest1", 1}, {"dest2", 0}}),
+               InvalidWeight);
+  ASSERT_EQ(3, myTable.destinations("lambda1")["dest1"].first);
+}
+
+TEST_F(TestForwardingTable, test_snapshot_multiple_tables) {
+  // the snapshots cached by this thread are never mixed up among tables,
+  // including those allocated after others have been destroyed
+  for (auto i = 0; i < 10; i++) {
+    auto myTable1 = std::make_unique<ForwardingTable>(
+        ForwardingTable::Type::LeastImpedance);
+    auto myTable2 = std::make_unique<ForwardingTable>(
+        ForwardingTable::Type::LeastImpedance);
+    myTable1->change("lambda1", "dest1", 1, true);
+    ASSERT_THROW((*myTable2)("lambda1"), NoDestinations);
+    myTable2->change("lambda1", "dest2", 1, true);
+    for (auto j = 0; j < 3; j++) {
+      ASSERT_EQ("dest1", (*myTable1)("lambda1"));
+      ASSERT_EQ("dest2", (*myTable2)("lambda1"));
+    }
+
+    // every change is visible to the next lookup
+    myTable1->change("lambda1", "dest3", 1, true);
+    myTable1->remove("lambda1", "dest1");
+    ASSERT_EQ("dest3", (*myTable1)("lambda1"));
+    ASSERT_EQ(std::set<std::string>({"lambda1"}), myTable1->lambdas());
+    myTable1->remove("lambda1");
+    ASSERT_THROW((*myTable1)("lambda1"), NoDestinations);
+    ASSERT_EQ(std::set<std::string>(), myTable1->lambdas());
+  }
+}
+
+TEST_F(TestForwardingTable, test_destination_registry) {
+  auto& myRegistry = DestinationRegistry::instance();
+
+  DestinationId myId;
+  ASSERT_FALSE(myRegistry.find("registry-dest1", myId));
+
+  const auto mySize = myRegistry.size();
+  const auto myId1  = myRegistry.intern("registry-dest1");
+  const auto myId2  = myRegistry.intern("registry-dest2");
+  ASSERT_NE(myId1, myId2);
+  ASSERT_EQ(myId1, myRegistry.intern("registry-dest1"));
+  ASSERT_EQ(mySize + 2, myRegistry.size());
+
+  ASSERT_TRUE(myRegistry.find("registry-dest2", myId));
+  ASSERT_EQ(myId2, myId);
+  ASSERT_EQ("registry-dest1", myRegistry.name(myId1));
+  ASSERT_EQ("registry-dest2", myRegistry.name(myId2));
+  ASSERT_THROW(myRegistry.name(myRegistry.size()), InvalidDestinationId);
+
+  // the destinations of the forwarding tables are interned
+  ForwardingTable myTable(ForwardingTable::Type::Random);
+  myTable.change("lambda1", "registry-dest3", 1, true);
+  const auto& myDest = myTable("lambda1");
+  ASSERT_EQ("registry-dest3", myDest);
+  ASSERT_EQ(&myDest, &myRegistry.name(myTable.select("lambda1")));
+  myTable.remove("lambda1");
+  ASSERT_EQ("registry-dest3", myDest);
+}
+
+TEST_F(TestForwardingTable, test_concurrent_access) {
+  const size_t myNumReaders = 4;
+  const size_t myNumChanges = 2000;
+  for (const auto myType : {ForwardingTable::Type::Random,
+                            ForwardingTable::Type::LeastImpedance,
+                            ForwardingTable::Type::RoundRobin,
+                            ForwardingTable::Type::ProportionalFairness}) {
+    ForwardingTable myTable(myType);
+    myTable.change("lambda1", "dest0", 1, true);
+
+    // the readers always find one of the destinations in the table,
+    // which are added and removed continuously by a writer
+    std::atomic<bool>      myStop(false);
+    std::atomic<size_t>    myNumErrors(0);
+    std::list<std::thread> myReaders;
+    for (size_t i = 0; i < myNumReaders; i++) {
+      myReaders.emplace_back([&myTable, &myStop, &myNumErrors]() {
+        while (not myStop) {
+          const auto myDest = myTable("lambda1");
+          if (myDest.find("dest") != 0) {
+            myNumErrors++;
+          }
+        }
+      });
+    }
+
+    for (size_t i = 0; i < myNumChanges; i++) {
+      const auto myDest = "dest" + std::to_string(1 + i % 5);
+      myTable.change("lambda1", myDest, 1 + i % 3, true);
+      myTable.change("lambda1", "dest0", 1 + i % 7);
+      if (i % 2 == 0) {
+        myTable.remove("lambda1", myDest);
+      }
+    }
+
+    myStop = true;
+    for (auto& myReader : myReaders) {
+      myReader.join();
+    }
+    ASSERT_EQ(0u, myNumErrors) << toString(myType);
+    ASSERT_LE(1u, myTable.destinations("lambda1").size());
+  }
+}
+
 TEST_F(TestForwardingTable, test_access_random) {
   ForwardingTable myTable(ForwardingTable::Type::Random);
 
@@ -230,6 +394,115 @@ TEST_F(TestForwardingTable, test_access_random) {
   ASSERT_EQ(2, int(round(myCounters["dest3"] / myCounters["dest2"])));
 }
 
+TEST_F(TestForwardingTable, test_access_random_updates) {
+  ForwardingTable myTable(ForwardingTable::Type::Random);
+
+  // many weight changes, destinations added and removed
+  for (size_t i = 0; i < 10; i++) {
+    myTable.change("lambda1", "dest" + std::to_string(i), 1, true);
+  }
+  for (size_t i = 0; i < 1000; i++) {
+    myTable.change("lambda1", "dest" + std::to_string(i % 10), 1 + i % 7);
+  }
+  for (size_t i = 3; i < 10; i++) {
+    myTable.remove("lambda1", "dest" + std::to_string(i));
+  }
+  myTable.change("lambda1", "dest0", 1);
+  myTable.change("lambda1", "dest1", 1.0 / 3);
+  myTable.change("lambda1", "dest2", 1.0 / 6);
+
+  const size_t                 myRuns = 10000;
+  std::map<std::string, float> myCounters;
+  for (size_t i = 0; i < myRuns; i++) {
+    myCounters[myTable("lambda1")]++;
+  }
+
+  ASSERT_EQ(3u, myCounters.size());
+  ASSERT_EQ(3, int(round(myCounters["dest1"] / myCounters["dest0"])));
+  ASSERT_EQ(2, int(round(myCounters["dest2"] / myCounters["dest1"])));
+}
+
+TEST_F(TestForwardingTable, DISABLED_bench_random_selection) {
+  const size_t myNumSelections = 1000000;
+
+  for (const size_t myNumDestinations : {2, 10, 100, 1000}) {
+    ForwardingTable myTable(ForwardingTable::Type::Random);
+    std::list<std::pair<std::string, float>> myScanList;
+    for (size_t i = 0; i < myNumDestinations; i++) {
+      const auto myDest   = "dest" + std::to_string(i);
+      const auto myWeight = 1.0f + i % 10;
+      myTable.change("lambda1", myDest, myWeight, true);
+      myScanList.emplace_back(myDest, myWeight);
+    }
+
+    // linear scan over the inverse weights, as done before the tree
+    float myInvSum = 0;
+    for (const auto& elem : myScanList) {
+      myInvSum += 1.0f / elem.second;
+    }
+    const auto myScan = [&myScanList, myInvSum]() {
+      const auto myRand = support::random() * myInvSum;
+      float      mySum  = 0;
+      for (auto it = myScanList.begin(); it != std::prev(myScanList.end());
+           ++it) {
+        mySum += 1.0f / it->second;
+        if (myRand <= mySum) {
+          return it->first;
+        }
+      }
+      return myScanList.back().first;
+    };
+
+    size_t          myDummy = 0;
+    support::Chrono myChrono(true);
+    for (size_t i = 0; i < myNumSelections; i++) {
+      myDummy += myScan().size();
+    }
+    const auto myScanTime = myChrono.restart();
+    for (size_t i = 0; i < myNumSelections; i++) {
+      myDummy += myTable("lambda1").size();
+    }
+    const auto myTableTime = myChrono.stop();
+
+    LOG(INFO) << "destinations " << myNumDestinations << ": linear scan "
+              << (myScanTime * 1e9 / myNumSelections) << " ns, table "
+              << (myTableTime * 1e9 / myNumSelections) << " ns per selection"
+              << " (" << myDummy << ")";
+  }
+}
+
+TEST_F(TestForwardingTable, DISABLED_bench_scoring_selection) {
+  const size_t myNumSelections = 100000;
+
+  for (const size_t myNumDestinations : {8, 64, 256, 1024}) {
+    ForwardingTable myLiTable(ForwardingTable::Type::LeastImpedance);
+    ForwardingTable myPfTable(
+        ForwardingTable::Type::ProportionalFairness, 1.0, 1.0);
+    for (size_t i = 0; i < myNumDestinations; i++) {
+      const auto myDest   = "dest" + std::to_string(i);
+      const auto myWeight = 1.0f + i % 10;
+      myLiTable.change("lambda1", myDest, myWeight, true);
+      myPfTable.change("lambda1", myDest, myWeight, true);
+    }
+
+    size_t          myDummy = 0;
+    support::Chrono myChrono(true);
+    for (size_t i = 0; i < myNumSelections; i++) {
+      myDummy += myLiTable("lambda1").size();
+    }
+    const auto myLiTime = myChrono.restart();
+    for (size_t i = 0; i < myNumSelections; i++) {
+      myDummy += myPfTable("lambda1").size();
+    }
+    const auto myPfTime = myChrono.stop();
+
+    LOG(INFO) << "destinations " << myNumDestinations << ": least-impedance "
+              << (myNumSelections / myLiTime) << " decisions/s, "
+              << "proportional-fairness " << (myNumSelections / myPfTime)
+              << " decisions/s (" << myDummy << ")";
+  }
+}
+
 TEST_F(TestForwardingTable, test_access_least_impedance) {
   ForwardingTable myTable(ForwardingTable::Type::LeastImpedance);
 
@@ -244,6 +517,154 @@ TEST_F(TestForwardingTable, test_access_least_impedance) {
 
   myTable.remove("lambda1", "dest2");
   ASSERT_EQ("dest1", myTable("lambda1"));
+
+  // removing a destination before the best one does not change the choice
+  myTable.change("lambda1", "dest2", 3, true);
+  myTable.change("lambda1", "dest3", 4, true);
+  myTable.remove("lambda1", "dest1");
+  ASSERT_EQ("dest2", myTable("lambda1"));
+  myTable.change("lambda1", "dest2", 5);
+  ASSERT_EQ("dest3", myTable("lambda1"));
+}
+
+TEST_F(TestForwardingTable, test_access_power_of_choices) {
+  ASSERT_THROW(ForwardingTableFactory::make(
+                   support::Conf("type=power-of-choices,choices=0")),
+               std::runtime_error);
+  std::unique_ptr<ForwardingTable> myTable(ForwardingTableFactory::make(
+      support::Conf("type=power-of-choices,choices=3")));
+  ASSERT_TRUE(static_cast<bool>(myTable));
+
+  myTable->change("lambda1", "dest1", 1, true);
+  myTable->change("lambda1", "dest2", 2, true);
+  myTable->change("lambda1", "dest3", 4, true);
+
+  // with no requests in flight the smallest weight wins
+  const auto myId = [](const std::string& aDest) {
+    DestinationId ret;
+    EXPECT_TRUE(DestinationRegistry::instance().find(aDest, ret));
+    return ret;
+  };
+  ASSERT_EQ("dest1", (*myTable)("lambda1"));
+
+  // with as many choices as destinations the least loaded one wins
+  myTable->load().increment(myId("dest1"));
+  myTable->load().increment(myId("dest1"));
+  myTable->load().increment(myId("dest2"));
+  ASSERT_EQ("dest3", (*myTable)("lambda1"));
+  myTable->load().increment(myId("dest3"));
+  ASSERT_EQ("dest2", (*myTable)("lambda1"));
+  myTable->load().decrement(myId("dest1"));
+  ASSERT_EQ("dest1", (*myTable)("lambda1"));
+
+  // the loads are not lost when the entry changes
+  myTable->change("lambda1", "dest1", 8);
+  ASSERT_EQ("dest2", (*myTable)("lambda1"));
+  myTable->remove("lambda1", "dest2");
+  ASSERT_EQ("dest3", (*myTable)("lambda1"));
+}
+
+TEST_F(TestForwardingTable, test_access_power_of_choices_random) {
+  ForwardingTable myTable(ForwardingTable::Type::PowerOfChoices, 2);
+
+  const size_t myNumDestinations = 4;
+  for (size_t i = 0; i < myNumDestinations; i++) {
+    myTable.change("lambda1", "dest" + std::to_string(i), 1, true);
+  }
+
+  // only dest0 has no requests in flight: it is selected unless both
+  // candidates, which are distinct, are among the other destinations
+  for (size_t i = 1; i < myNumDestinations; i++) {
+    DestinationId myId;
+    ASSERT_TRUE(DestinationRegistry::instance().find(
+        "dest" + std::to_string(i), myId));
+    myTable.load().increment(myId);
+  }
+
+  const size_t myNumSelections = 10000;
+  size_t       myCount         = 0;
+  for (size_t i = 0; i < myNumSelections; i++) {
+    if (myTable("lambda1") == "dest0") {
+      myCount++;
+    }
+  }
+  ASSERT_NEAR(1 - 0.75 * 2.0 / 3.0,
+              static_cast<double>(myCount) / myNumSelections,
+              0.03);
+}
+
+TEST_F(TestForwardingTable, test_access_power_of_choices_distinct) {
+  ForwardingTable myTable(ForwardingTable::Type::PowerOfChoices, 2);
+
+  // dest0 would be drawn almost always, twice, but it has a request in
+  // flight: since the candidates are distinct the other one is selected
+  const size_t myNumDestinations = 4;
+  for (size_t i = 0; i < myNumDestinations; i++) {
+    myTable.change(
+        "lambda1", "dest" + std::to_string(i), i == 0 ? 1 : 1000, true);
+  }
+  DestinationId myId;
+  ASSERT_TRUE(DestinationRegistry::instance().find("dest0", myId));
+  myTable.load().increment(myId);
+
+  for (size_t i = 0; i < 1000; i++) {
+    ASSERT_NE("dest0", myTable("lambda1"));
+  }
+}
+
+TEST_F(TestForwardingTable, test_access_consistent_hash) {
+  std::unique_ptr<ForwardingTable> myTable(
+      ForwardingTableFactory::make(support::Conf("type=consistent-hash")));
+  ASSERT_TRUE(static_cast<bool>(myTable));
+
+  ASSERT_THROW((*myTable)("lambda1", "key"), NoDestinations);
+
+  const size_t myNumDestinations = 4;
+  for (size_t i = 0; i < myNumDestinations; i++) {
+    myTable->change("lambda1", "dest" + std::to_string(i), 1 + i, true);
+  }
+  ASSERT_NO_THROW((*myTable)("lambda1"));
+
+  // the same key is always mapped to the same destination, and the keys
+  // are spread across all the destinations
+  std::map<std::string, std::string> myMapping;
+  std::map<std::string, size_t>      myCounts;
+  for (size_t i = 0; i < 1000; i++) {
+    const auto myKey  = "key" + std::to_string(i);
+    myMapping[myKey]  = (*myTable)("lambda1", myKey);
+    myCounts[myMapping[myKey]]++;
+    ASSERT_EQ(myMapping[myKey], (*myTable)("lambda1", myKey));
+  }
+  ASSERT_EQ(myNumDestinations, myCounts.size());
+  for (const auto& myCount : myCounts) {
+    ASSERT_GT(myCount.second, 100u) << myCount.first;
+  }
+
+  // changing weights does not move keys, removing a destination only moves
+  // the keys that were mapped to it
+  myTable->change("lambda1", "dest0", 100);
+  myTable->remove("lambda1", "dest1");
+  for (const auto& myPair : myMapping) {
+    const auto myDest = (*myTable)("lambda1", myPair.first);
+    if (myPair.second == "dest1") {
+      ASSERT_NE("dest1", myDest);
+    } else {
+      ASSERT_EQ(myPair.second, myDest);
+    }
+  }
+
+  // a key moves away from an overloaded destination, then it comes back
+  const auto myDest = (*myTable)("lambda1", "key0");
+  DestinationId myId;
+  ASSERT_TRUE(DestinationRegistry::instance().find(myDest, myId));
+  for (size_t i = 0; i < 10; i++) {
+    myTable->load().increment(myId);
+  }
+  ASSERT_NE(myDest, (*myTable)("lambda1", "key0"));
+  for (size_t i = 0; i < 10; i++) {
+    myTable->load().decrement(myId);
+  }
+  ASSERT_EQ(myDest, (*myTable)("lambda1", "key0"));
 }
 
 TEST_F(TestForwardingTable, test_access_round_robin) {
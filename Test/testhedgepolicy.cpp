@@ -0,0 +1,117 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Edge/hedgepolicy.h"
+
+#include "gtest/gtest.h"
+
+namespace uiiit {
+namespace edge {
+
+struct TestHedgePolicy : public ::testing::Test {};
+
+TEST_F(TestHedgePolicy, test_ctor) {
+  ASSERT_NO_THROW(HedgePolicy(0, 0.95));
+  ASSERT_NO_THROW(HedgePolicy(1, 1));
+  ASSERT_THROW(HedgePolicy(-0.1, 0.95), std::runtime_error);
+  ASSERT_THROW(HedgePolicy(1.1, 0.95), std::runtime_error);
+  ASSERT_THROW(HedgePolicy(0.05, 0), InvalidQuantile);
+  ASSERT_THROW(HedgePolicy(0.05, 1.1), InvalidQuantile);
+
+  ASSERT_FALSE(HedgePolicy(0, 0.95).enabled());
+  ASSERT_TRUE(HedgePolicy(0.05, 0.95).enabled());
+}
+
+TEST_F(TestHedgePolicy, test_budget) {
+  HedgePolicy myPolicy(0.05, 0.95);
+  ASSERT_FALSE(myPolicy.acquire());
+
+  // one token every 20 requests
+  size_t myHedges = 0;
+  for (size_t i = 0; i < 1000; i++) {
+    myPolicy.request();
+    if (myPolicy.acquire()) {
+      myHedges++;
+    }
+  }
+  ASSERT_EQ(50u, myHedges);
+
+  // the tokens saved are capped
+  for (size_t i = 0; i < 1000; i++) {
+    myPolicy.request();
+  }
+  myHedges = 0;
+  while (myPolicy.acquire()) {
+    myHedges++;
+  }
+  ASSERT_EQ(static_cast<size_t>(HedgePolicy::maxTokens()), myHedges);
+
+  // a token not used is given back, still within the cap
+  myPolicy.refund();
+  ASSERT_TRUE(myPolicy.acquire());
+  ASSERT_FALSE(myPolicy.acquire());
+  for (size_t i = 0; i < 2 * HedgePolicy::maxTokens(); i++) {
+    myPolicy.refund();
+  }
+  myHedges = 0;
+  while (myPolicy.acquire()) {
+    myHedges++;
+  }
+  ASSERT_EQ(static_cast<size_t>(HedgePolicy::maxTokens()), myHedges);
+}
+
+TEST_F(TestHedgePolicy, test_delay) {
+  HedgePolicy myPolicy(0.05, 0.95);
+  ASSERT_EQ(0, myPolicy.delay("lambda", "dest"));
+
+  // not enough samples yet
+  for (size_t i = 0; i < HedgePolicy::minSamples() - 1; i++) {
+    myPolicy.add("lambda", "dest", 1);
+  }
+  ASSERT_EQ(0, myPolicy.delay("lambda", "dest"));
+
+  // 95% of the samples are 1 s, the others 10 s
+  for (size_t i = 0; i < 1000; i++) {
+    myPolicy.add("lambda", "dest", i % 20 == 0 ? 10 : 1);
+  }
+  ASSERT_NEAR(1, myPolicy.delay("lambda", "dest"), 0.05);
+  ASSERT_EQ(0, myPolicy.delay("lambda", "another-dest"));
+  ASSERT_EQ(0, myPolicy.delay("another-lambda", "dest"));
+
+  // the delay follows the latest samples
+  for (size_t i = 0; i < 2 * HedgePolicy::windowSize(); i++) {
+    myPolicy.add("lambda", "dest", 0.1);
+  }
+  ASSERT_NEAR(0.1, myPolicy.delay("lambda", "dest"), 0.005);
+}
+
+} // namespace edge
+} // namespace uiiit
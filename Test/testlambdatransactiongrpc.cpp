@@ -44,7 +44,9 @@ SOFTWARE.
 #include "Edge/edgerouter.h"
 #include "Edge/edgeservergrpc.h"
 #include "Edge/edgeserverimpl.h"
+#include "Edge/forwardingtableclient.h"
 #include "Edge/forwardingtableserver.h"
+#include "Edge/overload.h"
 #include "Edge/ptimeestimatorfactory.h"
 #include "Support/chrono.h"
 #include "Support/conf.h"
@@ -53,8 +55,12 @@ SOFTWARE.
 #include "gtest/gtest.h"
 
 #include <deque>
+#include <list>
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace uiiit {
 namespace edge {
@@ -65,7 +71,10 @@ struct TestLambdaTransactionGrpc : public ::testing::Test {
   struct System {
     enum Type { ROUTER = 0, DISPATCHER = 1 };
 
-    System(const Type aType, const std::string& aSubtype)
+    System(const Type         aType,
+           const std::string& aSubtype,
+           const std::string& aComputerConf =
+               "type=intel-server,num-containers=1,num-workers=1")
         : theControllerEndpoint("127.0.0.1:6475")
         , theRouterEndpoint("127.0.0.1:6473")
         , theForwardingEndpoint("127.0.0.1:6474")
@@ -103,9 +112,7 @@ struct TestLambdaTransactionGrpc : public ::testing::Test {
         , theForwardingTableServer(nullptr)
         , theUtils() {
       // configure the computer
-      Composer()(
-          support::Conf("type=intel-server,num-containers=1,num-workers=1"),
-          theComputer.computer());
+      Composer()(support::Conf(aComputerConf), theComputer.computer());
 
       // configure the controller
       std::unique_ptr<EdgeController> myEdgeControllerRpc;
@@ -231,6 +238,122 @@ TEST_F(TestLambdaTransactionGrpc, test_router_dispatcher) {
   }
 }
 
+TEST_F(TestLambdaTransactionGrpc, test_batch) {
+  System mySystem(System::ROUTER, "");
+
+  // the last request is for a lambda that is not available
+  std::vector<LambdaRequest> myReqs;
+  for (size_t i = 0; i < N; i++) {
+    myReqs.emplace_back("clambda0", std::to_string(i));
+  }
+  myReqs.emplace_back("nolambda", "");
+
+  // send the batch both via the router and directly to the computer
+  for (const auto& myEndpoint :
+       {mySystem.theRouterEndpoint, mySystem.theComputerEndpoint}) {
+    EdgeClientGrpc myClient(myEndpoint);
+    const auto     myResps = myClient.RunLambdaBatch(myReqs, false);
+    ASSERT_EQ(N + 1, myResps.size());
+    for (size_t i = 0; i < N; i++) {
+      ASSERT_EQ("OK", myResps[i].theRetCode);
+      ASSERT_EQ(mySystem.theComputerEndpoint, myResps[i].theResponder);
+      ASSERT_EQ(std::to_string(i), myResps[i].theOutput);
+    }
+    ASSERT_NE("OK", myResps[N].theRetCode);
+
+    ASSERT_TRUE(myClient.RunLambdaBatch({}, false).empty());
+  }
+}
+
+TEST_F(TestLambdaTransactionGrpc, test_overloaded) {
+  // only one task can wait for the only worker of the computer
+  System mySystem(
+      System::ROUTER,
+      "",
+      "type=intel-server,num-containers=1,num-workers=1,max-pending=1");
+
+  const size_t             myNumClients = 5;
+  std::vector<std::string> myRetCodes(myNumClients);
+  std::list<std::thread>   myThreads;
+  for (size_t i = 0; i < myNumClients; i++) {
+    myThreads.emplace_back([&mySystem, &myRetCodes, i]() {
+      EdgeClientGrpc myClient(mySystem.theRouterEndpoint);
+      myRetCodes[i] =
+          myClient.RunLambda(LambdaRequest("clambda0", std::string(1000, 'A')),
+                             false)
+              .theRetCode;
+    });
+  }
+  for (auto& myThread : myThreads) {
+    myThread.join();
+  }
+
+  // the requests in excess are rejected immediately, not queued
+  size_t myNumOk = 0;
+  for (const auto& myRetCode : myRetCodes) {
+    if (myRetCode == "OK") {
+      myNumOk++;
+    } else {
+      ASSERT_EQ(OVERLOADED_RETCODE, myRetCode);
+    }
+  }
+  ASSERT_LE(1u, myNumOk);
+  ASSERT_GT(myNumClients, myNumOk);
+  ASSERT_LT(0u, mySystem.theComputer.computer().numOverloaded());
+  ASSERT_LT(0u, mySystem.theRouter->numOverloaded());
+
+  // the computer has not been removed from the router
+  EdgeClientGrpc myClient(mySystem.theRouterEndpoint);
+  ASSERT_EQ("OK", myClient.RunLambda(LambdaRequest("clambda0", ""), false)
+                      .theRetCode);
+}
+
+TEST_F(TestLambdaTransactionGrpc, test_overloaded_dispatcher) {
+  // the request is dispatched again to the same overloaded computer, hence
+  // the previous estimates must have been discarded
+  for (const std::string mySubtype : {"rtt", "stream"}) {
+    LOG(INFO) << "*** Running overload experiment with an edge dispatcher "
+              << mySubtype;
+
+    System mySystem(
+        System::DISPATCHER,
+        mySubtype,
+        "type=intel-server,num-containers=1,num-workers=1,max-pending=1");
+
+    const size_t             myNumClients = 5;
+    std::vector<std::string> myRetCodes(myNumClients);
+    std::list<std::thread>   myThreads;
+    for (size_t i = 0; i < myNumClients; i++) {
+      myThreads.emplace_back([&mySystem, &myRetCodes, i]() {
+        EdgeClientGrpc myClient(mySystem.theRouterEndpoint);
+        myRetCodes[i] = myClient
+                            .RunLambda(LambdaRequest("clambda0",
+                                                     std::string(1000, 'A')),
+                                       false)
+                            .theRetCode;
+      });
+    }
+    for (auto& myThread : myThreads) {
+      myThread.join();
+    }
+
+    for (const auto& myRetCode : myRetCodes) {
+      if (myRetCode != "OK") {
+        ASSERT_EQ(OVERLOADED_RETCODE, myRetCode);
+      }
+    }
+    ASSERT_LT(0u, mySystem.theDispatcher->numOverloaded());
+
+    // the computer is still available once the load is gone
+    EdgeClientGrpc myClient(mySystem.theRouterEndpoint);
+    for (size_t i = 0; i < N; i++) {
+      ASSERT_EQ("OK",
+                myClient.RunLambda(LambdaRequest("clambda0", ""), false)
+                    .theRetCode);
+    }
+  }
+}
+
 TEST_F(TestLambdaTransactionGrpc, test_asynchronous) {
   const std::string myCallbackEndpoint = "127.0.0.1:6480";
   System            mySystem(System::ROUTER, "");
@@ -269,5 +392,62 @@ TEST_F(TestLambdaTransactionGrpc, test_asynchronous) {
   }
 }
 
+TEST_F(TestLambdaTransactionGrpc, test_remove_while_ejected) {
+  // a router without controller and destinations not reachable, which are
+  // ejected upon the first failure
+  const std::string myRouterEndpoint("127.0.0.1:6473");
+  const std::string myForwardingEndpoint("127.0.0.1:6474");
+  const std::string myDestination1("127.0.0.1:10001");
+  const std::string myDestination2("127.0.0.1:10002");
+
+  support::Conf myConf(EdgeLambdaProcessor::defaultConf());
+  myConf["breaker-failures"] = "1";
+  myConf["breaker-ejection"] = "1";
+  EdgeRouter myRouter(myRouterEndpoint,
+                      myForwardingEndpoint,
+                      "",
+                      myConf,
+                      support::Conf("type=random"),
+                      support::Conf("type=trivial,period=10,stat=mean"),
+                      support::Conf("type=grpc,persistence=0.05"));
+
+  ForwardingTableServer myServer(
+      myForwardingEndpoint, *myRouter.tables()[0], *myRouter.tables()[1]);
+  myServer.entryCallback(
+      [&myRouter](const auto& aLambda, const auto& aDestination) {
+        myRouter.entryChanged(aLambda, aDestination);
+      });
+  myServer.tablesMutex(myRouter.tablesMutex());
+  myServer.run(false);
+
+  ForwardingTableClient myClient(myForwardingEndpoint);
+  myClient.change("lambda1", myDestination1, 1, true);
+  myClient.change("lambda2", myDestination2, 1, true);
+
+  const auto myLambdas = [&myRouter]() {
+    return myRouter.tables()[0]->lambdas();
+  };
+  using Set = std::set<std::string>;
+  ASSERT_EQ(Set({"lambda1", "lambda2"}), myLambdas());
+
+  // both destinations are removed from the tables
+  EdgeServer& myServerIf = myRouter;
+  for (const auto& myLambda : {"lambda1", "lambda2"}) {
+    ASSERT_NE("OK",
+              myServerIf.process(LambdaRequest(myLambda, "").toProtobuf())
+                  .retcode());
+  }
+  ASSERT_TRUE(
+      support::waitFor<Set>([&myLambdas]() { return myLambdas(); }, Set(), 5));
+
+  // the controller removes one of them while ejected: only the other one
+  // is added back at the end of the ejection
+  myClient.remove("lambda1", myDestination1);
+  ASSERT_TRUE(support::waitFor<Set>(
+      [&myLambdas]() { return myLambdas(); }, Set({"lambda2"}), 5));
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  ASSERT_EQ(Set({"lambda2"}), myLambdas());
+}
+
 } // namespace edge
 } // namespace uiiit
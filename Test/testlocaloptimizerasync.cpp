@@ -0,0 +1,188 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Edge/forwardingtable.h"
+#include "Edge/localoptimizerasync.h"
+#include "Edge/localoptimizerfactory.h"
+#include "Support/conf.h"
+#include "Support/wait.h"
+
+#include "edgeserver.grpc.pb.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+struct TestLocalOptimizerAsync : public ::testing::Test {
+  TestLocalOptimizerAsync()
+      : theTable(ForwardingTable::Type::Random) {
+    // noop
+  }
+
+  void SetUp() override {
+    for (size_t i = 0; i < numDestinations(); i++) {
+      theTable.change("lambda1", destination(i), 100, true);
+    }
+  }
+
+  static std::string destination(const size_t aIndex) {
+    return "dest" + std::to_string(aIndex) + ":6473";
+  }
+
+  static rpc::LambdaRequest request() {
+    rpc::LambdaRequest ret;
+    ret.set_name("lambda1");
+    return ret;
+  }
+
+  float weight(const size_t aIndex) const {
+    return theTable.fullTable().at("lambda1").at(destination(aIndex)).first;
+  }
+
+  static constexpr size_t numDestinations() {
+    return 4;
+  }
+
+  ForwardingTable theTable;
+};
+
+TEST_F(TestLocalOptimizerAsync, test_merge_period) {
+  const auto myOptimizer = LocalOptimizerFactory::make(
+      theTable, support::Conf("type=async,alpha=0.25,period=0.05"));
+  const auto myReq = request();
+
+  // the latencies are applied to the table only upon merge, the first
+  // one as it is and the next ones smoothed with the previous weight
+  (*myOptimizer)(myReq, destination(0), 1);
+  (*myOptimizer)(myReq, destination(0), 3);
+  (*myOptimizer)(myReq, destination(1), 4);
+  ASSERT_TRUE(support::waitFor<float>(
+      [this]() { return weight(1); }, 4.0f, 1.0));
+  ASSERT_FLOAT_EQ(0.75f * 3 + 0.25f * 1, weight(0));
+  ASSERT_FLOAT_EQ(100, weight(2));
+  ASSERT_FLOAT_EQ(100, weight(3));
+
+  // the smoothing continues across merges
+  (*myOptimizer)(myReq, destination(0), 0.5);
+  ASSERT_TRUE(support::waitFor<float>(
+      [this]() { return weight(0); }, 0.75f * 0.5f + 0.25f * 2.5f, 1.0));
+}
+
+TEST_F(TestLocalOptimizerAsync, test_multiple_threads) {
+  const auto myOptimizer = LocalOptimizerFactory::make(
+      theTable, support::Conf("type=async,alpha=0.5,period=0.01"));
+
+  // every thread fills its buffer several times, hence merges happen both
+  // periodically and because buffers are full, while the others report
+  const auto myNumSamples = 10 * LocalOptimizerAsync::bufferSize();
+
+  std::vector<std::thread> myThreads;
+  for (size_t i = 0; i < numDestinations(); i++) {
+    myThreads.emplace_back([this, &myOptimizer, myNumSamples, i]() {
+      const auto myReq = request();
+      for (size_t j = 0; j < myNumSamples; j++) {
+        (*myOptimizer)(myReq, destination(i), 1);
+      }
+      (*myOptimizer)(myReq, destination(i), 1 + i);
+    });
+  }
+  for (auto& myThread : myThreads) {
+    myThread.join();
+  }
+
+  // the samples of every thread are merged in order and none is lost
+  for (size_t i = 0; i < numDestinations(); i++) {
+    const float myExpected = 0.5f * (1 + i) + 0.5f * 1;
+    ASSERT_TRUE(support::waitFor<float>(
+        [this, i]() { return weight(i); }, myExpected, 1.0))
+        << "destination " << i << " weight " << weight(i);
+  }
+}
+
+TEST_F(TestLocalOptimizerAsync, test_short_lived_threads) {
+  const auto myOptimizer = LocalOptimizerFactory::make(
+      theTable, support::Conf("type=async,alpha=0.5,period=0.01"));
+
+  // the samples of the threads that have exited are merged anyway, also
+  // after their buffers have been dropped by a previous merge
+  for (size_t i = 0; i < 20; i++) {
+    std::thread([this, &myOptimizer, i]() {
+      (*myOptimizer)(request(), destination(i % numDestinations()), 1);
+    }).join();
+    if (i % 5 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  }
+  for (size_t i = 0; i < numDestinations(); i++) {
+    ASSERT_TRUE(support::waitFor<float>(
+        [this, i]() { return weight(i); }, 1.0f, 1.0))
+        << "destination " << i << " weight " << weight(i);
+  }
+}
+
+TEST_F(TestLocalOptimizerAsync, test_buffer_full) {
+  // the period is long enough not to merge during the test
+  const auto myOptimizer = LocalOptimizerFactory::make(
+      theTable, support::Conf("type=async,alpha=0.5,period=10"));
+  const auto myReq = request();
+
+  // skip the first run of the periodic task, if immediate
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // filling the buffer does not merge the samples
+  for (size_t i = 0; i < LocalOptimizerAsync::bufferSize(); i++) {
+    (*myOptimizer)(myReq, destination(0), 1);
+  }
+  ASSERT_FLOAT_EQ(100, weight(0));
+
+  // the next sample merges those in the buffer, synchronously, before
+  // being added itself
+  (*myOptimizer)(myReq, destination(0), 3);
+  ASSERT_FLOAT_EQ(1, weight(0));
+  for (size_t i = 1; i < LocalOptimizerAsync::bufferSize(); i++) {
+    (*myOptimizer)(myReq, destination(1), 2);
+  }
+  ASSERT_FLOAT_EQ(1, weight(0));
+  ASSERT_FLOAT_EQ(100, weight(1));
+
+  (*myOptimizer)(myReq, destination(1), 2);
+  ASSERT_FLOAT_EQ(0.5f * 3 + 0.5f * 1, weight(0));
+  ASSERT_FLOAT_EQ(2, weight(1));
+}
+
+} // namespace edge
+} // namespace uiiit
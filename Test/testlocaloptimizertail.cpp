@@ -0,0 +1,159 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Edge/forwardingtable.h"
+#include "Edge/localoptimizerfactory.h"
+#include "Edge/localoptimizertail.h"
+#include "Edge/quantilesketch.h"
+#include "Support/chrono.h"
+#include "Support/conf.h"
+#include "Support/wait.h"
+
+#include "edgeserver.grpc.pb.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace uiiit {
+namespace edge {
+
+struct TestLocalOptimizerTail : public ::testing::Test {
+  TestLocalOptimizerTail()
+      : theTable(ForwardingTable::Type::LeastImpedance) {
+    // noop
+  }
+
+  void SetUp() override {
+    for (size_t i = 0; i < numDestinations(); i++) {
+      theTable.change("lambda1", destination(i), 100, true);
+    }
+  }
+
+  static std::string destination(const size_t aIndex) {
+    return "dest" + std::to_string(aIndex) + ":6473";
+  }
+
+  static rpc::LambdaRequest request() {
+    rpc::LambdaRequest ret;
+    ret.set_name("lambda1");
+    return ret;
+  }
+
+  float weight(const size_t aIndex) const {
+    return theTable.fullTable().at("lambda1").at(destination(aIndex)).first;
+  }
+
+  //! \return true if the weight of a destination changes within 1 s.
+  bool waitChange(const size_t aIndex, const float aFrom) const {
+    return support::waitFor<bool>(
+        [this, aIndex, aFrom]() { return weight(aIndex) != aFrom; }, true, 1);
+  }
+
+  static constexpr size_t numDestinations() {
+    return 2;
+  }
+
+  ForwardingTable theTable;
+};
+
+TEST_F(TestLocalOptimizerTail, test_factory) {
+  ASSERT_NO_THROW(LocalOptimizerFactory::make(
+      theTable, support::Conf("type=tail,period=1,quantile=0.9")));
+  ASSERT_NO_THROW(LocalOptimizerFactory::make(
+      theTable, support::Conf("type=tail,period=1")));
+  ASSERT_THROW(LocalOptimizerFactory::make(
+                   theTable, support::Conf("type=tail,period=1,quantile=0")),
+               InvalidQuantile);
+  ASSERT_THROW(LocalOptimizerFactory::make(
+                   theTable, support::Conf("type=tail,period=1,quantile=1.5")),
+               InvalidQuantile);
+}
+
+TEST_F(TestLocalOptimizerTail, test_lowest_tail) {
+  const auto myOptimizer = LocalOptimizerFactory::make(
+      theTable, support::Conf("type=tail,period=0.05,quantile=0.95"));
+  const auto myReq = request();
+
+  // destination 0 is faster on average, but has a longer tail
+  for (size_t i = 0; i < 100; i++) {
+    (*myOptimizer)(myReq, destination(0), i < 90 ? 1 : 50);
+    (*myOptimizer)(myReq, destination(1), 10);
+  }
+  ASSERT_TRUE(waitChange(0, 100));
+  ASSERT_TRUE(waitChange(1, 100));
+  ASSERT_NEAR(50, weight(0), 0.5);
+  ASSERT_NEAR(10, weight(1), 0.1);
+  ASSERT_EQ(destination(1), theTable("lambda1"));
+}
+
+TEST_F(TestLocalOptimizerTail, test_window_rotation) {
+  const double myPeriod    = 0.2;
+  const auto   myOptimizer = LocalOptimizerFactory::make(
+      theTable,
+      support::Conf("type=tail,quantile=0.99,period=" +
+                    std::to_string(myPeriod)));
+  const auto myReq = request();
+
+  // the weight is set at the first update after the samples are reported
+  for (size_t i = 0; i < 10; i++) {
+    (*myOptimizer)(myReq, destination(0), 20);
+  }
+  ASSERT_TRUE(waitChange(0, 100));
+  ASSERT_NEAR(20, weight(0), 0.2);
+
+  // the samples of a period are used also in the next one, hence the
+  // weight changes only two updates later, when the old samples are forgotten
+  support::Chrono myChrono(true);
+  (*myOptimizer)(myReq, destination(0), 2);
+  ASSERT_TRUE(waitChange(0, weight(0)));
+  ASSERT_NEAR(2, weight(0), 0.02);
+  ASSERT_GT(myChrono.stop(), 1.5 * myPeriod);
+
+  // without samples, the destination is forgotten, but its weight in the
+  // table is not changed
+  std::this_thread::sleep_for(
+      std::chrono::milliseconds(static_cast<long>(3 * myPeriod * 1e3)));
+  ASSERT_NEAR(2, weight(0), 0.02);
+
+  // the samples reported afterwards are not mixed with the forgotten ones
+  (*myOptimizer)(myReq, destination(0), 30);
+  ASSERT_TRUE(waitChange(0, weight(0)));
+  ASSERT_NEAR(30, weight(0), 0.3);
+
+  // the other destination has never been updated
+  ASSERT_FLOAT_EQ(100, weight(1));
+}
+
+} // namespace edge
+} // namespace uiiit
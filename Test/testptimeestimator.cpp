@@ -29,13 +29,26 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "Edge/edgecomputerserver.h"
 #include "Edge/edgemessages.h"
+#include "Edge/edgeserver.h"
+#include "Edge/edgeservergrpc.h"
+#include "Edge/forwardingtableexceptions.h"
 #include "Edge/ptimeestimator.h"
+#include "Edge/ptimeestimatorprobe.h"
+#include "Edge/ptimeestimatorstream.h"
+#include "Support/chrono.h"
 #include "Support/tostring.h"
+#include "Support/wait.h"
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <chrono>
 #include <list>
+#include <map>
+#include <memory>
+#include <thread>
 
 namespace uiiit {
 namespace edge {
@@ -189,5 +202,217 @@ TEST_F(TestPtimeEstimator, test_print) {
       ::toString(myEst));
 }
 
+struct TestPtimeEstimatorProbe : public ::testing::Test {
+  //! Edge server answering with a fixed processing time after a delay.
+  class ProbeServer final : public EdgeServer
+  {
+   public:
+    explicit ProbeServer(const std::string& aEndpoint,
+                         const unsigned int aPtime,
+                         const double       aDelay)
+        : EdgeServer(aEndpoint)
+        , thePtime(aPtime)
+        , theDelay(aDelay)
+        , theCounter(0) {
+    }
+
+    rpc::LambdaResponse process(const rpc::LambdaRequest& aReq) override {
+      std::ignore = aReq;
+      theCounter++;
+      std::this_thread::sleep_for(std::chrono::duration<double>(theDelay));
+      rpc::LambdaResponse myResp;
+      myResp.set_retcode("OK");
+      myResp.set_ptime(thePtime);
+      return myResp;
+    }
+
+    const unsigned int  thePtime;
+    const double        theDelay;
+    std::atomic<size_t> theCounter;
+  };
+
+  TestPtimeEstimatorProbe()
+      : theFastEndpoint("127.0.0.1:6510")
+      , theSlowEndpoint("127.0.0.1:6511")
+      , theFast(theFastEndpoint, 10, 0)
+      , theSlow(theSlowEndpoint, 1, 0.3)
+      , theFastImpl(
+            std::make_unique<EdgeServerGrpc>(theFast, theFastEndpoint, 1))
+      , theSlowImpl(
+            std::make_unique<EdgeServerGrpc>(theSlow, theSlowEndpoint, 1)) {
+    theFastImpl->run();
+    theSlowImpl->run();
+  }
+
+  //! Add the two computers to an estimator.
+  void add(PtimeEstimatorProbe& aEstimator) const {
+    aEstimator.change("lambda1", theFastEndpoint, 1, true);
+    aEstimator.change("lambda1", theSlowEndpoint, 1, true);
+  }
+
+  //! \return the destination selected by an estimator, without keeping it.
+  static std::string select(PtimeEstimatorProbe& aEstimator) {
+    LambdaRequest myReq("lambda1", "input");
+    const auto    myMsg = myReq.toProtobuf();
+    const auto    ret   = aEstimator(myMsg);
+    aEstimator.processAbort(myMsg, ret);
+    return ret;
+  }
+
+  const std::string               theFastEndpoint;
+  const std::string               theSlowEndpoint;
+  ProbeServer                     theFast;
+  ProbeServer                     theSlow;
+  std::unique_ptr<EdgeServerGrpc> theFastImpl;
+  std::unique_ptr<EdgeServerGrpc> theSlowImpl;
+};
+
+TEST_F(TestPtimeEstimatorProbe, test_ctor) {
+  ASSERT_THROW(PtimeEstimatorProbe(0, 1, ""), std::runtime_error);
+  ASSERT_NO_THROW(PtimeEstimatorProbe(0.1, 1, ""));
+}
+
+TEST_F(TestPtimeEstimatorProbe, test_timeout) {
+  // the slow computer has the shortest processing time but it does not
+  // answer within the timeout
+  PtimeEstimatorProbe myEstimator(0.1, 10, "");
+  add(myEstimator);
+
+  support::Chrono myChrono(true);
+  ASSERT_EQ(theFastEndpoint, select(myEstimator));
+  ASSERT_LT(myChrono.stop(), theSlow.theDelay);
+  ASSERT_EQ(1u, theFast.theCounter);
+}
+
+TEST_F(TestPtimeEstimatorProbe, test_cache) {
+  PtimeEstimatorProbe myEstimator(1, 10, "");
+  add(myEstimator);
+
+  // both computers answer within the timeout
+  ASSERT_EQ(theSlowEndpoint, select(myEstimator));
+  ASSERT_EQ(1u, theFast.theCounter);
+  ASSERT_EQ(1u, theSlow.theCounter);
+
+  // the results are reused within the validity period, without probing
+  support::Chrono myChrono(true);
+  for (size_t i = 0; i < 10; i++) {
+    ASSERT_EQ(theSlowEndpoint, select(myEstimator));
+  }
+  ASSERT_LT(myChrono.stop(), theSlow.theDelay);
+  ASSERT_EQ(1u, theFast.theCounter);
+  ASSERT_EQ(1u, theSlow.theCounter);
+
+  // a destination removed does not leave its results in the cache: when
+  // added back it is probed again, but it does not answer anymore
+  theSlowImpl.reset();
+  myEstimator.remove("lambda1", theSlowEndpoint);
+  myEstimator.change("lambda1", theSlowEndpoint, 1, true);
+  ASSERT_EQ(theFastEndpoint, select(myEstimator));
+  ASSERT_EQ(1u, theFast.theCounter);
+}
+
+TEST_F(TestPtimeEstimatorProbe, test_stale) {
+  PtimeEstimatorProbe myEstimator(1, 0.1, "");
+  add(myEstimator);
+  ASSERT_EQ(theSlowEndpoint, select(myEstimator));
+
+  // the expired results are used if no computer answers
+  theFastImpl.reset();
+  theSlowImpl.reset();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ASSERT_EQ(theSlowEndpoint, select(myEstimator));
+  ASSERT_EQ(1u, theFast.theCounter);
+  ASSERT_EQ(1u, theSlow.theCounter);
+
+  // without any result the first destination is returned
+  myEstimator.change("lambda2", theFastEndpoint, 1, true);
+  LambdaRequest myReq("lambda2", "input");
+  const auto    myMsg = myReq.toProtobuf();
+  ASSERT_EQ(theFastEndpoint, myEstimator(myMsg));
+  myEstimator.processAbort(myMsg, theFastEndpoint);
+}
+
+struct TestPtimeEstimatorStream : public ::testing::Test {
+  // the destinations have different hosts, hence utilization servers
+  TestPtimeEstimatorStream()
+      : theUtilPort(6482)
+      , theDest1("127.0.0.1:10001")
+      , theDest2("127.0.0.2:10002")
+      , theServer1(PtimeEstimatorStream::utilEndpoint(theDest1, theUtilPort))
+      , theServer2(PtimeEstimatorStream::utilEndpoint(theDest2, theUtilPort)) {
+    theServer1.run(false);
+    theServer2.run(false);
+  }
+
+  //! Push the wait time of lambda1 to the subscribers of both servers.
+  void report(const double aWait1, const double aWait2) {
+    using Loads = std::map<std::string, Computer::ContainerLoad>;
+    theServer1.add(Loads({{"lambda1", Computer::ContainerLoad{0, 0, aWait1}}}));
+    theServer2.add(Loads({{"lambda1", Computer::ContainerLoad{0, 0, aWait2}}}));
+  }
+
+  /**
+   * \return true if an estimator selects a destination after the given
+   * waits are reported, possibly multiple times, within 5 s.
+   */
+  bool waitSelected(PtimeEstimatorStream& aEstimator,
+                    const std::string&    aDestination,
+                    const double          aWait1,
+                    const double          aWait2) {
+    return support::waitFor<bool>(
+        [&]() {
+          report(aWait1, aWait2);
+          return select(aEstimator) == aDestination;
+        },
+        true,
+        5);
+  }
+
+  //! \return the destination selected by an estimator, without keeping it.
+  static std::string select(PtimeEstimatorStream& aEstimator) {
+    LambdaRequest myReq("lambda1", "input");
+    const auto    myMsg = myReq.toProtobuf();
+    const auto    ret   = aEstimator(myMsg);
+    aEstimator.processAbort(myMsg, ret);
+    return ret;
+  }
+
+  const unsigned int theUtilPort;
+  const std::string  theDest1;
+  const std::string  theDest2;
+  EdgeComputerServer theServer1;
+  EdgeComputerServer theServer2;
+};
+
+TEST_F(TestPtimeEstimatorStream, test_subscriptions) {
+  PtimeEstimatorStream myEstimator(theUtilPort, 10, "");
+  myEstimator.change("lambda1", theDest1, 1, true);
+  myEstimator.change("lambda1", theDest2, 1, true);
+
+  // the destination with the shortest wait reported is selected
+  ASSERT_TRUE(waitSelected(myEstimator, theDest2, 1, 0.1));
+  ASSERT_TRUE(waitSelected(myEstimator, theDest1, 0.1, 1));
+
+  // a destination is unsubscribed when removed, without blocking the
+  // selection of the others in the meanwhile
+  std::atomic<bool> myStop(false);
+  std::thread       mySelector([this, &myEstimator, &myStop]() {
+    while (not myStop) {
+      ASSERT_NO_THROW(select(myEstimator));
+    }
+  });
+  myEstimator.remove("lambda1", theDest1);
+  myStop = true;
+  mySelector.join();
+  ASSERT_EQ(theDest2, select(myEstimator));
+
+  // once added back, the destination is subscribed to again
+  myEstimator.change("lambda1", theDest1, 1, true);
+  ASSERT_TRUE(waitSelected(myEstimator, theDest1, 0.1, 1));
+
+  myEstimator.remove("lambda1");
+  ASSERT_THROW(select(myEstimator), NoDestinations);
+}
+
 } // namespace edge
 } // namespace uiiit
@@ -0,0 +1,153 @@
+/*
+              __ __ __
+             |__|__|  | __
+             |  |  |  ||__|
+  ___ ___ __ |  |  |  |
+ |   |   |  ||  |  |  |    Ubiquitous Internet @ IIT-CNR
+ |   |   |  ||  |  |  |    C++ edge computing libraries and tools
+ |_______|__||__|__|__|    https://github.com/ccicconetti/serverlessonedge
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+Copyright (c) 2021 C. Cicconetti <https://ccicconetti.github.io/>
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Edge/quantilesketch.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace uiiit {
+namespace edge {
+
+struct TestQuantileSketch : public ::testing::Test {
+  //! \return the exact quantile of the given values, using the same rank.
+  static double exact(std::vector<double> aValues, const double aQuantile) {
+    std::sort(aValues.begin(), aValues.end());
+    return aValues[static_cast<size_t>(aQuantile * (aValues.size() - 1))];
+  }
+};
+
+TEST_F(TestQuantileSketch, test_ctor) {
+  ASSERT_NO_THROW(QuantileSketch(0.01, 1));
+  ASSERT_THROW(QuantileSketch(0, 10), std::runtime_error);
+  ASSERT_THROW(QuantileSketch(1, 10), std::runtime_error);
+  ASSERT_THROW(QuantileSketch(0.01, 0), std::runtime_error);
+
+  QuantileSketch mySketch(0.01, 100);
+  ASSERT_EQ(0u, mySketch.count());
+  ASSERT_EQ(0u, mySketch.bins());
+  ASSERT_THROW(mySketch.quantile(0.5), EmptySketch);
+  mySketch.add(1);
+  ASSERT_THROW(mySketch.quantile(-0.1), InvalidQuantile);
+  ASSERT_THROW(mySketch.quantile(1.1), InvalidQuantile);
+}
+
+TEST_F(TestQuantileSketch, test_accuracy) {
+  const double                        myAccuracy = 0.01;
+  QuantileSketch                      mySketch(myAccuracy, 2048);
+  std::vector<double>                 myValues;
+  std::mt19937                        myRng(42);
+  std::lognormal_distribution<double> myDist(-3, 1.5);
+  for (size_t i = 0; i < 10000; i++) {
+    myValues.emplace_back(myDist(myRng));
+    mySketch.add(myValues.back());
+  }
+
+  ASSERT_EQ(myValues.size(), mySketch.count());
+  for (const auto q : {0.0, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+    const auto myExact = exact(myValues, q);
+    EXPECT_NEAR(myExact, mySketch.quantile(q), myExact * myAccuracy)
+        << "q = " << q;
+  }
+}
+
+TEST_F(TestQuantileSketch, test_non_positive) {
+  QuantileSketch mySketch(0.01, 100);
+  mySketch.add(0);
+  mySketch.add(-1);
+  mySketch.add(1);
+  ASSERT_EQ(3u, mySketch.count());
+  ASSERT_EQ(1u, mySketch.bins());
+  ASSERT_EQ(0, mySketch.quantile(0));
+  ASSERT_EQ(0, mySketch.quantile(0.5));
+  ASSERT_NEAR(1, mySketch.quantile(1), 0.01);
+
+  mySketch.clear();
+  ASSERT_EQ(0u, mySketch.count());
+  ASSERT_EQ(0u, mySketch.bins());
+}
+
+TEST_F(TestQuantileSketch, test_collapse) {
+  // 1% accuracy and 100 bins cover a ratio of about e^2 only
+  QuantileSketch mySketch(0.01, 100);
+  for (size_t i = 0; i < 1000; i++) {
+    mySketch.add(0.001);
+  }
+  for (size_t i = 0; i < 1000; i++) {
+    mySketch.add(1 + i / 1000.0);
+  }
+  ASSERT_EQ(100u, mySketch.bins());
+  ASSERT_EQ(2000u, mySketch.count());
+
+  // the low values are collapsed, but the high ones are still accurate
+  ASSERT_LT(mySketch.quantile(0), 1);
+  ASSERT_NEAR(1.5, mySketch.quantile(0.75), 0.015);
+  ASSERT_NEAR(1.999, mySketch.quantile(1), 0.02);
+
+  // adding a value lower than the lowest bin does not allocate new bins
+  mySketch.add(0.0001);
+  ASSERT_EQ(100u, mySketch.bins());
+}
+
+TEST_F(TestQuantileSketch, test_merge) {
+  QuantileSketch      myFirst(0.01, 1000);
+  QuantileSketch      mySecond(0.01, 1000);
+  QuantileSketch      myAll(0.01, 1000);
+  std::vector<double> myValues;
+  for (size_t i = 1; i <= 1000; i++) {
+    const auto myValue = i * 0.01;
+    (i % 3 == 0 ? myFirst : mySecond).add(myValue);
+    myAll.add(myValue);
+    myValues.emplace_back(myValue);
+  }
+
+  myFirst.merge(mySecond);
+  ASSERT_EQ(myAll.count(), myFirst.count());
+  for (const auto q : {0.0, 0.25, 0.5, 0.95, 0.99, 1.0}) {
+    ASSERT_DOUBLE_EQ(myAll.quantile(q), myFirst.quantile(q)) << "q = " << q;
+    const auto myExact = exact(myValues, q);
+    EXPECT_NEAR(myExact, myFirst.quantile(q), myExact * 0.01) << "q = " << q;
+  }
+
+  // merging an empty sketch does not change anything
+  myFirst.merge(QuantileSketch(0.01, 1000));
+  ASSERT_EQ(myAll.count(), myFirst.count());
+
+  ASSERT_THROW(myFirst.merge(QuantileSketch(0.02, 1000)), std::runtime_error);
+  ASSERT_THROW(myFirst.merge(QuantileSketch(0.01, 100)), std::runtime_error);
+}
+
+} // namespace edge
+} // namespace uiiit